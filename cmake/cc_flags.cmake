@@ -61,6 +61,22 @@ IF (OONF_REMOVE_HELPTEXT)
     ADD_DEFINITIONS(-DREMOVE_HELPTEXT)
 ENDIF(OONF_REMOVE_HELPTEXT)
 
+IF (OONF_TIMER_WHEEL)
+    ADD_DEFINITIONS(-DOONF_TIMER_WHEEL)
+ENDIF(OONF_TIMER_WHEEL)
+
+IF (OONF_TIMERFD_DEADLINE)
+    ADD_DEFINITIONS(-DOONF_TIMERFD_DEADLINE)
+ENDIF(OONF_TIMERFD_DEADLINE)
+
+IF (OONF_PARALLEL_DIJKSTRA)
+    ADD_DEFINITIONS(-DOONF_PARALLEL_DIJKSTRA)
+ENDIF(OONF_PARALLEL_DIJKSTRA)
+
+IF (OONF_NETLINK_ROUTING_WINDOW)
+    ADD_DEFINITIONS(-DOONF_NETLINK_ROUTING_WINDOW=${OONF_NETLINK_ROUTING_WINDOW})
+ENDIF(OONF_NETLINK_ROUTING_WINDOW)
+
 # OS-specific compiler settings
 IF(ANDROID OR WIN32)
     # Android and windows don't compile well with c99
@@ -26,6 +26,22 @@ set (OONF_REMOVE_HELPTEXT false CACHE BOOL
 set (OONF_SANITIZE false CACHE BOOL
      "Activate the address sanitizer")
 
+# use a hierarchical timer wheel instead of an AVL tree for the timer scheduler
+set (OONF_TIMER_WHEEL false CACHE BOOL
+     "Use a hierarchical timer wheel instead of an AVL tree for the timer scheduler")
+
+# wake up the scheduler with a timerfd instead of the millisecond epoll timeout
+set (OONF_TIMERFD_DEADLINE false CACHE BOOL
+     "Use a nanosecond timerfd for the deadline of the socket scheduler (Linux)")
+
+# calculate the olsrv2 shortest path trees of all domains in worker threads
+set (OONF_PARALLEL_DIJKSTRA false CACHE BOOL
+     "Calculate the OLSRv2 shortest path trees of domains and address families in parallel threads")
+
+# number of netlink buffers the routing subsystem sends before waiting for kernel feedback
+set (OONF_NETLINK_ROUTING_WINDOW 8 CACHE STRING
+     "Number of page sized netlink buffers with route changes in transit to the kernel (Linux)")
+
 ######################################
 #### Install target configuration ####
 ######################################
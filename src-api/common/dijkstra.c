@@ -0,0 +1,455 @@
+
+/*
+ * The olsr.org Optimized Link-State Routing daemon version 2 (olsrd2)
+ * Copyright (c) 2004-2015, the olsr.org team - see HISTORY file
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in
+ *   the documentation and/or other materials provided with the
+ *   distribution.
+ * * Neither the name of olsr.org, olsrd nor the names of its
+ *   contributors may be used to endorse or promote products derived
+ *   from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Visit http://www.olsr.org for more information.
+ *
+ * If you find this software useful feel free to make a donation
+ * to the project. For more information see the website or contact
+ * the copyright holders.
+ *
+ */
+
+
+/**
+ * @file
+ */
+
+#include <string.h>
+
+#include "common/common_types.h"
+#include "common/heap.h"
+#include "common/list.h"
+
+#include "common/dijkstra.h"
+
+/* list a node is stored in during incremental processing */
+enum {
+  _WORK_NONE = 0,
+  _WORK_PENDING,
+  _WORK_AFFECTED,
+};
+
+static void _reset_node(struct dijkstra_node *node);
+static void _unlink_node(struct dijkstra_tree *tree, struct dijkstra_node *node);
+static void _set_work(struct dijkstra_tree *tree, struct dijkstra_node *node, uint8_t work);
+static void _invalidate_subtree(struct dijkstra_tree *tree, struct dijkstra_node *node);
+static void _clear_work(struct dijkstra_tree *tree);
+static void _process_work(struct dijkstra_tree *tree);
+static bool _is_better(struct dijkstra_tree *tree, const struct dijkstra_node *node, uint32_t cost,
+  uint32_t hops, const struct dijkstra_node *first_hop, const struct dijkstra_node *parent);
+
+/**
+ * Initialize a shortest path tree. The callbacks must be set
+ * by the user afterwards. The first calculation is always
+ * a full one.
+ * @param tree shortest path tree
+ */
+void
+dijkstra_init(struct dijkstra_tree *tree) {
+  memset(tree, 0, sizeof(*tree));
+
+  heap_init(&tree->_queue);
+  list_init_head(&tree->_affected);
+  list_init_head(&tree->_pending);
+
+  list_init_head(&tree->root._children);
+  tree->root.state = DIJKSTRA_DONE;
+
+  tree->_full = true;
+}
+
+/**
+ * Force the next calculation of a tree to start from scratch
+ * @param tree shortest path tree
+ */
+void
+dijkstra_invalidate(struct dijkstra_tree *tree) {
+  tree->_full = true;
+}
+
+/**
+ * Start a new calculation of the shortest path tree. If the tree has
+ * not been invalidated this will only recalculate the parts of the tree
+ * affected by the edges reported with dijkstra_edge_changed() and
+ * the nodes removed with dijkstra_remove_node().
+ * A calculation still running will be restarted.
+ * @param tree shortest path tree
+ */
+void
+dijkstra_start(struct dijkstra_tree *tree) {
+  tree->settled = 0;
+  tree->incremental = !tree->_full && tree->expand_incoming != NULL;
+
+  if (tree->incremental) {
+    tree->incremental_runs++;
+    return;
+  }
+
+  tree->full_runs++;
+  tree->_full = false;
+
+  /* remove everything but the root from the tree */
+  _clear_work(tree);
+  _invalidate_subtree(tree, &tree->root);
+  _clear_work(tree);
+
+  /* relax the edges of the root */
+  _set_work(tree, &tree->root, _WORK_PENDING);
+}
+
+/**
+ * Do a number of steps of the current calculation
+ * @param tree shortest path tree
+ * @param count maximum number of nodes to take from the working queue
+ * @return true if the calculation is finished, false otherwise
+ */
+bool
+dijkstra_step(struct dijkstra_tree *tree, uint32_t count) {
+  struct dijkstra_node *node;
+
+  while (count > 0) {
+    /* seed nodes that lost their path and relax changed edges */
+    _process_work(tree);
+
+    node = heap_min_element(&tree->_queue, node, _queue_node);
+    if (node == NULL) {
+      return true;
+    }
+    heap_remove(&tree->_queue, &node->_queue_node);
+
+    node->state = DIJKSTRA_DONE;
+    tree->settled++;
+    count--;
+
+    tree->expand(tree, node);
+  }
+
+  _process_work(tree);
+  return heap_is_empty(&tree->_queue);
+}
+
+/**
+ * Calculate the complete shortest path tree in one go
+ * @param tree shortest path tree
+ */
+void
+dijkstra_calculate(struct dijkstra_tree *tree) {
+  dijkstra_start(tree);
+  while (!dijkstra_step(tree, UINT32_MAX)) {}
+}
+
+/**
+ * Relax an edge of the graph. Must only be called from
+ * the expand and expand_incoming callbacks of the tree.
+ * @param tree shortest path tree
+ * @param from source node of edge
+ * @param to destination node of edge
+ * @param cost cost of edge, must be larger than zero
+ */
+void
+dijkstra_relax(struct dijkstra_tree *tree, struct dijkstra_node *from, struct dijkstra_node *to, uint32_t cost) {
+  struct dijkstra_node *first_hop;
+  uint32_t path_cost;
+
+  if (from->state != DIJKSTRA_DONE || to == &tree->root || to == from) {
+    return;
+  }
+  if (cost == 0 || cost >= DIJKSTRA_INFINITE - from->cost) {
+    /* invalid edge or path too long */
+    return;
+  }
+
+  path_cost = from->cost + cost;
+  first_hop = from == &tree->root ? to : from->first_hop;
+
+  if (to->state != DIJKSTRA_UNREACHED
+      && !_is_better(tree, to, path_cost, from->hops + 1, first_hop, from)) {
+    return;
+  }
+
+  switch (to->state) {
+    case DIJKSTRA_UNREACHED:
+      list_init_head(&to->_children);
+      break;
+    case DIJKSTRA_QUEUED:
+      list_remove(&to->_sibling);
+      break;
+    case DIJKSTRA_DONE:
+    default:
+      /* paths through this node got better too */
+      _invalidate_subtree(tree, to);
+      list_remove(&to->_sibling);
+      break;
+  }
+
+  to->cost = path_cost;
+  to->hops = from->hops + 1;
+  to->first_hop = first_hop;
+  to->parent = from;
+  list_add_tail(&from->_children, &to->_sibling);
+
+  if (to->state == DIJKSTRA_QUEUED) {
+    /* path cost cannot be larger than before */
+    heap_decrease_key(&tree->_queue, &to->_queue_node, path_cost);
+  }
+  else {
+    to->state = DIJKSTRA_QUEUED;
+    heap_insert(&tree->_queue, &to->_queue_node, path_cost);
+  }
+}
+
+/**
+ * Report an edge of the graph that was added, removed or changed
+ * its cost since the last calculation.
+ * @param tree shortest path tree
+ * @param from source node of edge
+ * @param to destination node of edge
+ */
+void
+dijkstra_edge_changed(struct dijkstra_tree *tree, struct dijkstra_node *from, struct dijkstra_node *to) {
+  if (to != &tree->root && to->state != DIJKSTRA_UNREACHED && to->parent == from) {
+    /* path of destination (and all paths through it) is not valid anymore */
+    _unlink_node(tree, to);
+    _set_work(tree, to, _WORK_AFFECTED);
+  }
+  /* edge might offer a better path */
+  dijkstra_relax_again(tree, from);
+}
+
+/**
+ * Relax all outgoing edges of a node again during the next
+ * calculation. This is an alternative to reporting each edge
+ * that was added or got cheaper.
+ * @param tree shortest path tree
+ * @param node dijkstra node
+ */
+void
+dijkstra_relax_again(struct dijkstra_tree *tree, struct dijkstra_node *node) {
+  if (node->state == DIJKSTRA_DONE && node->_work == _WORK_NONE) {
+    _set_work(tree, node, _WORK_PENDING);
+  }
+}
+
+/**
+ * Remove a node and all its edges from the shortest path tree.
+ * Must be called before the memory of the node is freed.
+ * @param tree shortest path tree
+ * @param node dijkstra node
+ */
+void
+dijkstra_remove_node(struct dijkstra_tree *tree, struct dijkstra_node *node) {
+  if (node == &tree->root) {
+    return;
+  }
+
+  if (node->state != DIJKSTRA_UNREACHED) {
+    _unlink_node(tree, node);
+  }
+  _set_work(tree, node, _WORK_NONE);
+}
+
+/**
+ * Reset the path information of a node
+ * @param node dijkstra node
+ */
+static void
+_reset_node(struct dijkstra_node *node) {
+  node->state = DIJKSTRA_UNREACHED;
+  node->cost = DIJKSTRA_INFINITE;
+  node->hops = 0;
+  node->parent = NULL;
+  node->first_hop = NULL;
+}
+
+/**
+ * Remove a node from the tree and put the nodes that
+ * used it as part of their path into the affected list
+ * @param tree shortest path tree
+ * @param node dijkstra node
+ */
+static void
+_unlink_node(struct dijkstra_tree *tree, struct dijkstra_node *node) {
+  _invalidate_subtree(tree, node);
+
+  if (node->state == DIJKSTRA_QUEUED) {
+    heap_remove(&tree->_queue, &node->_queue_node);
+  }
+  list_remove(&node->_sibling);
+  _reset_node(node);
+}
+
+/**
+ * Move a node into one of the work lists of a tree
+ * @param tree shortest path tree
+ * @param node dijkstra node
+ * @param work target work list, _WORK_NONE to remove it from all lists
+ */
+static void
+_set_work(struct dijkstra_tree *tree, struct dijkstra_node *node, uint8_t work) {
+  if (node->_work != _WORK_NONE) {
+    list_remove(&node->_work_node);
+  }
+
+  node->_work = work;
+  if (work == _WORK_AFFECTED) {
+    list_add_tail(&tree->_affected, &node->_work_node);
+  }
+  else if (work == _WORK_PENDING) {
+    list_add_tail(&tree->_pending, &node->_work_node);
+  }
+}
+
+/**
+ * Remove all descendants of a node from the tree and
+ * put them into the affected list
+ * @param tree shortest path tree
+ * @param node dijkstra node
+ */
+static void
+_invalidate_subtree(struct dijkstra_tree *tree, struct dijkstra_node *node) {
+  struct dijkstra_node *current, *child, *it;
+  struct list_entity *ptr;
+
+  /* remember where the new part of the affected list begins */
+  ptr = tree->_affected.prev;
+
+  current = node;
+  while (true) {
+    list_for_each_element_safe(&current->_children, child, _sibling, it) {
+      if (child->state == DIJKSTRA_QUEUED) {
+        heap_remove(&tree->_queue, &child->_queue_node);
+      }
+      list_remove(&child->_sibling);
+      _reset_node(child);
+
+      /* a queued node that has not been seeded yet has no children */
+      if (child->_work != _WORK_AFFECTED) {
+        _set_work(tree, child, _WORK_AFFECTED);
+      }
+    }
+
+    /* breadth first walk over the nodes that have been added to the list */
+    if (ptr->next == &tree->_affected) {
+      return;
+    }
+    ptr = ptr->next;
+    current = container_of(ptr, struct dijkstra_node, _work_node);
+  }
+}
+
+/**
+ * Remove all nodes from the work lists
+ * @param tree shortest path tree
+ */
+static void
+_clear_work(struct dijkstra_tree *tree) {
+  struct dijkstra_node *node, *it;
+
+  list_for_each_element_safe(&tree->_affected, node, _work_node, it) {
+    list_remove(&node->_work_node);
+    node->_work = _WORK_NONE;
+  }
+  list_for_each_element_safe(&tree->_pending, node, _work_node, it) {
+    list_remove(&node->_work_node);
+    node->_work = _WORK_NONE;
+  }
+}
+
+/**
+ * Seed the affected nodes from their incoming edges and
+ * relax the outgoing edges of the pending nodes.
+ * @param tree shortest path tree
+ */
+static void
+_process_work(struct dijkstra_tree *tree) {
+  struct dijkstra_node *node;
+
+  /* relaxing pending nodes can invalidate more parts of the tree */
+  while (!list_is_empty(&tree->_affected) || !list_is_empty(&tree->_pending)) {
+    /* all affected nodes have been reset before the first of them is seeded */
+    while (!list_is_empty(&tree->_affected)) {
+      node = list_first_element(&tree->_affected, node, _work_node);
+      _set_work(tree, node, _WORK_NONE);
+
+      if (tree->expand_incoming) {
+        tree->expand_incoming(tree, node);
+      }
+    }
+
+    if (!list_is_empty(&tree->_pending)) {
+      node = list_first_element(&tree->_pending, node, _work_node);
+      _set_work(tree, node, _WORK_NONE);
+
+      if (node->state == DIJKSTRA_DONE) {
+        tree->expand(tree, node);
+      }
+    }
+  }
+}
+
+/**
+ * Check if a new path to a node is better than the current one
+ * @param tree shortest path tree
+ * @param node dijkstra node
+ * @param cost cost of new path
+ * @param hops number of hops of new path
+ * @param first_hop first hop of new path
+ * @param parent predecessor of node on new path
+ * @return true if the new path should be used
+ */
+static bool
+_is_better(struct dijkstra_tree *tree, const struct dijkstra_node *node, uint32_t cost, uint32_t hops,
+  const struct dijkstra_node *first_hop, const struct dijkstra_node *parent) {
+  int result;
+
+  if (cost != node->cost) {
+    return cost < node->cost;
+  }
+  if (hops != node->hops) {
+    return hops < node->hops;
+  }
+  if (tree->compare == NULL) {
+    return false;
+  }
+
+  if (first_hop != node->first_hop) {
+    result = tree->compare(tree, first_hop, node->first_hop);
+    if (result != 0) {
+      return result < 0;
+    }
+  }
+  if (parent != node->parent) {
+    return tree->compare(tree, parent, node->parent) < 0;
+  }
+  return false;
+}
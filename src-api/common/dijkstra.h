@@ -0,0 +1,223 @@
+
+/*
+ * The olsr.org Optimized Link-State Routing daemon version 2 (olsrd2)
+ * Copyright (c) 2004-2015, the olsr.org team - see HISTORY file
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in
+ *   the documentation and/or other materials provided with the
+ *   distribution.
+ * * Neither the name of olsr.org, olsrd nor the names of its
+ *   contributors may be used to endorse or promote products derived
+ *   from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Visit http://www.olsr.org for more information.
+ *
+ * If you find this software useful feel free to make a donation
+ * to the project. For more information see the website or contact
+ * the copyright holders.
+ *
+ */
+
+
+/**
+ * @file
+ */
+
+#ifndef DIJKSTRA_H_
+#define DIJKSTRA_H_
+
+#include "common/common_types.h"
+#include "common/heap.h"
+#include "common/list.h"
+
+/*! path cost of a node that cannot be reached */
+#define DIJKSTRA_INFINITE UINT32_MAX
+
+/**
+ * State of a node in a shortest path tree
+ */
+enum dijkstra_state {
+  /*! node has no path to the root */
+  DIJKSTRA_UNREACHED = 0,
+
+  /*! node is in the working queue with a tentative path */
+  DIJKSTRA_QUEUED,
+
+  /*! node is part of the shortest path tree */
+  DIJKSTRA_DONE,
+};
+
+/**
+ * Node of a shortest path tree. The node must be initialized with zero
+ * bytes before it is used the first time.
+ */
+struct dijkstra_node {
+  /*! total cost of the path from the root to the node */
+  uint32_t cost;
+
+  /*! number of hops from the root to the node */
+  uint32_t hops;
+
+  /*! predecessor of the node on the path from the root */
+  struct dijkstra_node *parent;
+
+  /*! first node after the root on the path to this node */
+  struct dijkstra_node *first_hop;
+
+  /*! state of the node */
+  enum dijkstra_state state;
+
+  /*! list of the node during incremental processing */
+  uint8_t _work;
+
+  /**
+   * user defined label of the node, not used by dijkstra. Allows a
+   * graph node to be represented by multiple nodes of the same tree,
+   * e.g. to calculate a sub-topology in the same run.
+   */
+  uint8_t label;
+
+  /*! hook into working queue */
+  struct heap_node _queue_node;
+
+  /*! list of nodes with this node as their parent */
+  struct list_entity _children;
+
+  /*! hook into children list of parent */
+  struct list_entity _sibling;
+
+  /*! hook into the list of affected or pending nodes */
+  struct list_entity _work_node;
+};
+
+/**
+ * Shortest path tree that can be updated incrementally after
+ * edges of the graph changed. The graph itself is not stored in
+ * the tree, the user provides its edges through callbacks that
+ * call dijkstra_relax() for each edge.
+ *
+ * Edge costs must be larger than zero. Paths with the same cost
+ * are resolved by the number of hops and the compare callback, which
+ * makes the tree independent from the order edges are processed in.
+ * So an incremental update results in the same tree as a full
+ * calculation.
+ */
+struct dijkstra_tree {
+  /*! root of the tree, the node the paths are calculated for */
+  struct dijkstra_node root;
+
+  /**
+   * Callback to relax all outgoing edges of a node
+   * @param tree shortest path tree
+   * @param node node whose edges must be handed to dijkstra_relax()
+   */
+  void (*expand)(struct dijkstra_tree *tree, struct dijkstra_node *node);
+
+  /**
+   * Callback to relax all incoming edges of a node, necessary
+   * for incremental updates.
+   * @param tree shortest path tree
+   * @param node node whose edges must be handed to dijkstra_relax()
+   */
+  void (*expand_incoming)(struct dijkstra_tree *tree, struct dijkstra_node *node);
+
+  /**
+   * Callback to compare two nodes for resolving paths with the same cost,
+   * NULL to keep the path found first.
+   * @param tree shortest path tree
+   * @param n1 first node
+   * @param n2 second node
+   * @return <0 if n1 should be preferred, >0 if n2, 0 if both are the same
+   */
+  int (*compare)(struct dijkstra_tree *tree,
+      const struct dijkstra_node *n1, const struct dijkstra_node *n2);
+
+  /*! number of full calculations */
+  uint64_t full_runs;
+
+  /*! number of incremental calculations */
+  uint64_t incremental_runs;
+
+  /*! number of nodes taken from the working queue by the last calculation */
+  uint32_t settled;
+
+  /*! true if the last calculation was incremental */
+  bool incremental;
+
+  /*! true if the next calculation must start from scratch */
+  bool _full;
+
+  /*! working queue sorted by path cost */
+  struct heap _queue;
+
+  /*! nodes that lost their path and must be seeded from their neighbors */
+  struct list_entity _affected;
+
+  /*! nodes whose outgoing edges must be relaxed again */
+  struct list_entity _pending;
+};
+
+EXPORT void dijkstra_init(struct dijkstra_tree *);
+EXPORT void dijkstra_invalidate(struct dijkstra_tree *);
+EXPORT void dijkstra_start(struct dijkstra_tree *);
+EXPORT bool dijkstra_step(struct dijkstra_tree *, uint32_t count);
+EXPORT void dijkstra_calculate(struct dijkstra_tree *);
+EXPORT void dijkstra_relax(struct dijkstra_tree *,
+    struct dijkstra_node *from, struct dijkstra_node *to, uint32_t cost);
+EXPORT void dijkstra_edge_changed(struct dijkstra_tree *,
+    struct dijkstra_node *from, struct dijkstra_node *to);
+EXPORT void dijkstra_relax_again(struct dijkstra_tree *, struct dijkstra_node *);
+EXPORT void dijkstra_remove_node(struct dijkstra_tree *, struct dijkstra_node *);
+
+/**
+ * @param node dijkstra node
+ * @return true if node is part of the shortest path tree
+ */
+static INLINE bool
+dijkstra_is_reached(const struct dijkstra_node *node) {
+  return node->state == DIJKSTRA_DONE;
+}
+
+/**
+ * @param tree shortest path tree
+ * @param node dijkstra node
+ * @return true if node is a direct child of the root
+ */
+static INLINE bool
+dijkstra_is_root_child(const struct dijkstra_tree *tree,
+    const struct dijkstra_node *node) {
+  return node->state == DIJKSTRA_DONE && node->parent == &tree->root;
+}
+
+/**
+ * Loop over all children of a node in the shortest path tree,
+ * the current child can be handed to dijkstra_edge_changed().
+ * @param node parent node
+ * @param child iterator pointer to child node
+ * @param it temporary iterator pointer
+ */
+#define dijkstra_for_each_child_safe(node, child, it) \
+  list_for_each_element_safe(&(node)->_children, child, _sibling, it)
+
+#endif /* DIJKSTRA_H_ */
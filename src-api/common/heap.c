@@ -0,0 +1,222 @@
+
+/*
+ * The olsr.org Optimized Link-State Routing daemon version 2 (olsrd2)
+ * Copyright (c) 2004-2015, the olsr.org team - see HISTORY file
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in
+ *   the documentation and/or other materials provided with the
+ *   distribution.
+ * * Neither the name of olsr.org, olsrd nor the names of its
+ *   contributors may be used to endorse or promote products derived
+ *   from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Visit http://www.olsr.org for more information.
+ *
+ * If you find this software useful feel free to make a donation
+ * to the project. For more information see the website or contact
+ * the copyright holders.
+ *
+ */
+
+
+/**
+ * @file
+ */
+
+#include "common/common_types.h"
+
+#include "common/heap.h"
+
+static struct heap_node *_meld(struct heap_node *a, struct heap_node *b);
+static struct heap_node *_merge_pairs(struct heap_node *first);
+static void _cut(struct heap_node *node);
+
+/**
+ * Initialize a new heap
+ * @param heap pointer to heap
+ */
+void
+heap_init(struct heap *heap) {
+  heap->root = NULL;
+  heap->count = 0;
+}
+
+/**
+ * Insert a node into a heap
+ * @param heap pointer to heap
+ * @param node pointer to node, must not be part of a heap
+ * @param key key of the node
+ */
+void
+heap_insert(struct heap *heap, struct heap_node *node, uint64_t key) {
+  node->key = key;
+  node->child = NULL;
+  node->next = NULL;
+  node->prev = NULL;
+
+  heap->root = _meld(heap->root, node);
+  heap->count++;
+}
+
+/**
+ * Decrease the key of a node in a heap
+ * @param heap pointer to heap
+ * @param node pointer to node
+ * @param key new key of the node, must not be larger than the old one
+ */
+void
+heap_decrease_key(struct heap *heap, struct heap_node *node, uint64_t key) {
+  node->key = key;
+
+  if (node != heap->root) {
+    /* move subtree of node to the top */
+    _cut(node);
+    heap->root = _meld(heap->root, node);
+  }
+}
+
+/**
+ * Remove a node from a heap
+ * @param heap pointer to heap
+ * @param node pointer to node
+ */
+void
+heap_remove(struct heap *heap, struct heap_node *node) {
+  struct heap_node *children;
+
+  children = _merge_pairs(node->child);
+
+  if (node == heap->root) {
+    heap->root = children;
+  }
+  else {
+    _cut(node);
+    heap->root = _meld(heap->root, children);
+  }
+
+  node->child = NULL;
+  node->next = NULL;
+  node->prev = NULL;
+  heap->count--;
+}
+
+/**
+ * Combine two heaps
+ * @param a root of first heap, might be NULL
+ * @param b root of second heap, might be NULL
+ * @return root of combined heap
+ */
+static struct heap_node *
+_meld(struct heap_node *a, struct heap_node *b) {
+  struct heap_node *tmp;
+
+  if (a == NULL) {
+    return b;
+  }
+  if (b == NULL) {
+    return a;
+  }
+
+  if (b->key < a->key) {
+    tmp = a;
+    a = b;
+    b = tmp;
+  }
+
+  /* make b the first child of a */
+  b->prev = a;
+  b->next = a->child;
+  if (a->child) {
+    a->child->prev = b;
+  }
+  a->child = b;
+
+  a->next = NULL;
+  a->prev = NULL;
+  return a;
+}
+
+/**
+ * Combine a list of siblings into a single heap with
+ * the standard two-pass pairing.
+ * @param first first sibling, might be NULL
+ * @return root of combined heap
+ */
+static struct heap_node *
+_merge_pairs(struct heap_node *first) {
+  struct heap_node *a, *b, *next, *pairs, *result;
+
+  /* first pass: meld pairs from left to right, collect them in reverse order */
+  pairs = NULL;
+  while (first) {
+    a = first;
+    b = a->next;
+    next = b ? b->next : NULL;
+
+    a->next = NULL;
+    a->prev = NULL;
+    if (b) {
+      b->next = NULL;
+      b->prev = NULL;
+    }
+
+    a = _meld(a, b);
+    a->next = pairs;
+    pairs = a;
+
+    first = next;
+  }
+
+  /* second pass: meld the pairs from right to left */
+  result = NULL;
+  while (pairs) {
+    next = pairs->next;
+    pairs->next = NULL;
+
+    result = _meld(pairs, result);
+    pairs = next;
+  }
+  return result;
+}
+
+/**
+ * Remove a node (with its subtree) from its parent
+ * @param node pointer to node, must not be the root of the heap
+ */
+static void
+_cut(struct heap_node *node) {
+  if (node->prev->child == node) {
+    /* first child of parent */
+    node->prev->child = node->next;
+  }
+  else {
+    node->prev->next = node->next;
+  }
+  if (node->next) {
+    node->next->prev = node->prev;
+  }
+
+  node->next = NULL;
+  node->prev = NULL;
+}
@@ -0,0 +1,138 @@
+
+/*
+ * The olsr.org Optimized Link-State Routing daemon version 2 (olsrd2)
+ * Copyright (c) 2004-2015, the olsr.org team - see HISTORY file
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in
+ *   the documentation and/or other materials provided with the
+ *   distribution.
+ * * Neither the name of olsr.org, olsrd nor the names of its
+ *   contributors may be used to endorse or promote products derived
+ *   from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Visit http://www.olsr.org for more information.
+ *
+ * If you find this software useful feel free to make a donation
+ * to the project. For more information see the website or contact
+ * the copyright holders.
+ *
+ */
+
+
+/**
+ * @file
+ */
+
+#ifndef HEAP_H_
+#define HEAP_H_
+
+#include "common/common_types.h"
+#include "common/container_of.h"
+
+/**
+ * This element is a member of a heap. It must be contained in all
+ * larger structs that should be put into a heap.
+ */
+struct heap_node {
+  /*! key of the node, the heap returns the smallest key first */
+  uint64_t key;
+
+  /*! pointer to first child */
+  struct heap_node *child;
+
+  /*! pointer to next sibling */
+  struct heap_node *next;
+
+  /**
+   * pointer to previous sibling, or to the parent for the first child.
+   * NULL for the root or if the node is not in a heap.
+   */
+  struct heap_node *prev;
+};
+
+/**
+ * Priority queue implemented as a pairing heap. Insert and
+ * decrease-key are constant time operations, removing a node
+ * takes amortized logarithmic time. The heap does not need
+ * memory beyond the embedded heap_node.
+ */
+struct heap {
+  /*! node with the smallest key, NULL if heap is empty */
+  struct heap_node *root;
+
+  /*! number of nodes in heap */
+  uint32_t count;
+};
+
+EXPORT void heap_init(struct heap *);
+EXPORT void heap_insert(struct heap *, struct heap_node *, uint64_t key);
+EXPORT void heap_decrease_key(struct heap *, struct heap_node *, uint64_t key);
+EXPORT void heap_remove(struct heap *, struct heap_node *);
+
+/**
+ * @param heap pointer to heap
+ * @return true if heap is empty, false otherwise
+ */
+static INLINE bool
+heap_is_empty(const struct heap *heap) {
+  return heap->root == NULL;
+}
+
+/**
+ * @param heap pointer to heap
+ * @return node with the smallest key, NULL if heap is empty
+ */
+static INLINE struct heap_node *
+heap_get_min(const struct heap *heap) {
+  return heap->root;
+}
+
+/**
+ * Remove the node with the smallest key from a heap
+ * @param heap pointer to heap
+ * @return node with the smallest key, NULL if heap is empty
+ */
+static INLINE struct heap_node *
+heap_extract_min(struct heap *heap) {
+  struct heap_node *node = heap->root;
+
+  if (node) {
+    heap_remove(heap, node);
+  }
+  return node;
+}
+
+/**
+ * @param element pointer to a node element
+ *    (don't need to be initialized)
+ * @param heap pointer to heap
+ * @param node_member name of heap_node element inside the
+ *    larger struct
+ * @return pointer to element with the smallest key,
+ *    NULL if heap is empty
+ */
+#define heap_min_element(heap, element, node_member) \
+  (heap_is_empty(heap) ? NULL : container_of(heap_get_min(heap), typeof(*(element)), node_member))
+
+#endif /* HEAP_H_ */
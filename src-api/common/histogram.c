@@ -0,0 +1,93 @@
+
+/*
+ * The olsr.org Optimized Link-State Routing daemon version 2 (olsrd2)
+ * Copyright (c) 2004-2015, the olsr.org team - see HISTORY file
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in
+ *   the documentation and/or other materials provided with the
+ *   distribution.
+ * * Neither the name of olsr.org, olsrd nor the names of its
+ *   contributors may be used to endorse or promote products derived
+ *   from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Visit http://www.olsr.org for more information.
+ *
+ * If you find this software useful feel free to make a donation
+ * to the project. For more information see the website or contact
+ * the copyright holders.
+ *
+ */
+
+/**
+ * @file
+ */
+
+#include "common/common_types.h"
+
+#include "common/histogram.h"
+
+/**
+ * @param idx index of histogram bucket
+ * @return smallest value that is too large for the bucket,
+ *   UINT64_MAX for the last bucket
+ */
+uint64_t
+histogram_get_bucket_limit(unsigned idx) {
+  if (idx >= HISTOGRAM_BUCKETS - 1) {
+    return UINT64_MAX;
+  }
+  return 1ull << (HISTOGRAM_MIN_BITS + idx);
+}
+
+/**
+ * Calculate an upper bound for a percentile of the values
+ * stored in a histogram. The result is never larger than
+ * the maximum value of the histogram.
+ * @param h pointer to histogram
+ * @param percent percentile (1-100)
+ * @return upper bound of percentile, 0 if histogram is empty
+ */
+uint64_t
+histogram_get_percentile(const struct histogram *h, unsigned percent) {
+  uint64_t threshold, sum, limit;
+  unsigned i;
+
+  if (h->count == 0) {
+    return 0;
+  }
+
+  /* number of values that must be at or below the percentile */
+  threshold = (h->count * percent + 99) / 100;
+
+  sum = 0;
+  for (i=0; i<HISTOGRAM_BUCKETS; i++) {
+    sum += h->bucket[i];
+    if (sum >= threshold) {
+      break;
+    }
+  }
+
+  limit = histogram_get_bucket_limit(i);
+  return limit < h->max ? limit : h->max;
+}
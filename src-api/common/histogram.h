@@ -0,0 +1,116 @@
+
+/*
+ * The olsr.org Optimized Link-State Routing daemon version 2 (olsrd2)
+ * Copyright (c) 2004-2015, the olsr.org team - see HISTORY file
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in
+ *   the documentation and/or other materials provided with the
+ *   distribution.
+ * * Neither the name of olsr.org, olsrd nor the names of its
+ *   contributors may be used to endorse or promote products derived
+ *   from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Visit http://www.olsr.org for more information.
+ *
+ * If you find this software useful feel free to make a donation
+ * to the project. For more information see the website or contact
+ * the copyright holders.
+ *
+ */
+
+/**
+ * @file
+ */
+
+#ifndef HISTOGRAM_H_
+#define HISTOGRAM_H_
+
+#include <string.h>
+
+#include "common/common_types.h"
+
+/*! number of buckets of a histogram */
+#define HISTOGRAM_BUCKETS 32
+
+/*! values smaller than 1 << HISTOGRAM_MIN_BITS end up in the first bucket */
+#define HISTOGRAM_MIN_BITS 10
+
+/**
+ * Histogram with logarithmic scale. Bucket 0 counts values below
+ * 1 << HISTOGRAM_MIN_BITS, bucket i counts values between
+ * 1 << (HISTOGRAM_MIN_BITS+i-1) (inclusive) and 1 << (HISTOGRAM_MIN_BITS+i).
+ * The last bucket counts all larger values.
+ */
+struct histogram {
+  /*! number of values added to the histogram */
+  uint64_t count;
+
+  /*! sum of all values added to the histogram */
+  uint64_t sum;
+
+  /*! largest value added to the histogram */
+  uint64_t max;
+
+  /*! number of values in each bucket */
+  uint64_t bucket[HISTOGRAM_BUCKETS];
+};
+
+EXPORT uint64_t histogram_get_percentile(
+    const struct histogram *h, unsigned percent);
+EXPORT uint64_t histogram_get_bucket_limit(unsigned idx);
+
+/**
+ * Add a value to a histogram
+ * @param h pointer to histogram
+ * @param value new value
+ */
+static INLINE void
+histogram_add(struct histogram *h, uint64_t value) {
+  unsigned idx = 0;
+
+  if (value >> HISTOGRAM_MIN_BITS) {
+    idx = 64 - HISTOGRAM_MIN_BITS - __builtin_clzll(value);
+    if (idx >= HISTOGRAM_BUCKETS) {
+      idx = HISTOGRAM_BUCKETS - 1;
+    }
+  }
+
+  h->bucket[idx]++;
+  h->count++;
+  h->sum += value;
+  if (value > h->max) {
+    h->max = value;
+  }
+}
+
+/**
+ * Remove all values from a histogram
+ * @param h pointer to histogram
+ */
+static INLINE void
+histogram_reset(struct histogram *h) {
+  memset(h, 0, sizeof(*h));
+}
+
+#endif /* HISTOGRAM_H_ */
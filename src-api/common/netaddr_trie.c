@@ -0,0 +1,210 @@
+
+/*
+ * The olsr.org Optimized Link-State Routing daemon version 2 (olsrd2)
+ * Copyright (c) 2004-2015, the olsr.org team - see HISTORY file
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in
+ *   the documentation and/or other materials provided with the
+ *   distribution.
+ * * Neither the name of olsr.org, olsrd nor the names of its
+ *   contributors may be used to endorse or promote products derived
+ *   from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Visit http://www.olsr.org for more information.
+ *
+ * If you find this software useful feel free to make a donation
+ * to the project. For more information see the website or contact
+ * the copyright holders.
+ *
+ */
+
+
+/**
+ * @file
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "common/common_types.h"
+#include "common/netaddr.h"
+
+#include "common/netaddr_trie.h"
+
+static void _free_subtree(struct netaddr_trie_node *, void (*cb_remove)(void *));
+
+/**
+ * @param addr pointer to address
+ * @param bit index of bit, starting with the most significant one
+ * @return value of the bit
+ */
+static INLINE int
+_get_bit(const struct netaddr *addr, uint8_t bit) {
+  const uint8_t *bin = netaddr_get_binptr(addr);
+
+  return (bin[bit / 8] >> (7 - (bit % 8))) & 1;
+}
+
+/**
+ * Initialize an empty prefix trie
+ * @param trie pointer to trie
+ * @param af_type address family of the prefixes
+ */
+void
+netaddr_trie_init(struct netaddr_trie *trie, uint8_t af_type) {
+  memset(trie, 0, sizeof(*trie));
+  trie->af_type = af_type;
+}
+
+/**
+ * Remove all prefixes from a trie and free its nodes
+ * @param trie pointer to trie
+ * @param cb_remove callback for the value of each prefix, NULL for none
+ */
+void
+netaddr_trie_clear(struct netaddr_trie *trie, void (*cb_remove)(void *)) {
+  _free_subtree(trie->root._child[0], cb_remove);
+  _free_subtree(trie->root._child[1], cb_remove);
+
+  if (cb_remove != NULL && trie->root.value != NULL) {
+    cb_remove(trie->root.value);
+  }
+  netaddr_trie_init(trie, trie->af_type);
+}
+
+/**
+ * Add a prefix to a trie or replace the value of an existing one.
+ * Bits of the prefix beyond its prefix length are ignored.
+ * @param trie pointer to trie
+ * @param prefix prefix to add
+ * @param value value of the prefix, must not be NULL
+ * @return -1 if the address family does not match or out of memory,
+ *   0 otherwise
+ */
+int
+netaddr_trie_insert(struct netaddr_trie *trie, const struct netaddr *prefix, void *value) {
+  struct netaddr_trie_node *node;
+  uint8_t bit, len;
+  int b;
+
+  if (netaddr_get_address_family(prefix) != trie->af_type) {
+    return -1;
+  }
+
+  node = &trie->root;
+  len = netaddr_get_prefix_length(prefix);
+  for (bit = 0; bit < len; bit++) {
+    b = _get_bit(prefix, bit);
+    if (node->_child[b] == NULL) {
+      node->_child[b] = calloc(1, sizeof(*node));
+      if (node->_child[b] == NULL) {
+        return -1;
+      }
+    }
+    node = node->_child[b];
+  }
+
+  if (node->value == NULL) {
+    trie->count++;
+  }
+  node->value = value;
+  return 0;
+}
+
+/**
+ * Get the value of a prefix stored in a trie
+ * @param trie pointer to trie
+ * @param prefix prefix to look for
+ * @return value of the prefix, NULL if not in trie
+ */
+void *
+netaddr_trie_get(const struct netaddr_trie *trie, const struct netaddr *prefix) {
+  const struct netaddr_trie_node *node;
+  uint8_t bit, len;
+
+  if (netaddr_get_address_family(prefix) != trie->af_type) {
+    return NULL;
+  }
+
+  node = &trie->root;
+  len = netaddr_get_prefix_length(prefix);
+  for (bit = 0; node != NULL && bit < len; bit++) {
+    node = node->_child[_get_bit(prefix, bit)];
+  }
+  return node == NULL ? NULL : node->value;
+}
+
+/**
+ * Look for the longest prefix of a trie that contains an address.
+ * The prefix length of the address is ignored, like in
+ * netaddr_is_in_subnet().
+ * @param trie pointer to trie
+ * @param addr address to look for
+ * @return value of the longest matching prefix, NULL if none
+ */
+void *
+netaddr_trie_lookup(const struct netaddr_trie *trie, const struct netaddr *addr) {
+  const struct netaddr_trie_node *node;
+  void *value;
+  uint8_t bit, len;
+
+  if (netaddr_get_address_family(addr) != trie->af_type) {
+    return NULL;
+  }
+
+  node = &trie->root;
+  value = node->value;
+  len = netaddr_get_af_maxprefix(trie->af_type);
+  for (bit = 0; bit < len; bit++) {
+    node = node->_child[_get_bit(addr, bit)];
+    if (node == NULL) {
+      break;
+    }
+    if (node->value != NULL) {
+      value = node->value;
+    }
+  }
+  return value;
+}
+
+/**
+ * Free a subtree of a trie
+ * @param node root of subtree, might be NULL
+ * @param cb_remove callback for the value of each prefix, NULL for none
+ */
+static void
+_free_subtree(struct netaddr_trie_node *node, void (*cb_remove)(void *)) {
+  if (node == NULL) {
+    return;
+  }
+
+  /* depth is limited by the address length */
+  _free_subtree(node->_child[0], cb_remove);
+  _free_subtree(node->_child[1], cb_remove);
+
+  if (cb_remove != NULL && node->value != NULL) {
+    cb_remove(node->value);
+  }
+  free(node);
+}
@@ -0,0 +1,88 @@
+
+/*
+ * The olsr.org Optimized Link-State Routing daemon version 2 (olsrd2)
+ * Copyright (c) 2004-2015, the olsr.org team - see HISTORY file
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in
+ *   the documentation and/or other materials provided with the
+ *   distribution.
+ * * Neither the name of olsr.org, olsrd nor the names of its
+ *   contributors may be used to endorse or promote products derived
+ *   from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Visit http://www.olsr.org for more information.
+ *
+ * If you find this software useful feel free to make a donation
+ * to the project. For more information see the website or contact
+ * the copyright holders.
+ *
+ */
+
+
+/**
+ * @file
+ */
+
+#ifndef NETADDR_TRIE_H_
+#define NETADDR_TRIE_H_
+
+#include "common/common_types.h"
+#include "common/netaddr.h"
+
+/**
+ * Node of a prefix trie, each level of the trie represents one
+ * bit of the address.
+ */
+struct netaddr_trie_node {
+  /*! value of the prefix ending at this node, NULL if none */
+  void *value;
+
+  /*! subtrees for the next bit being 0 or 1 */
+  struct netaddr_trie_node *_child[2];
+};
+
+/**
+ * Binary trie of prefixes of a single address family for
+ * longest prefix matching. Lookups take at most one step
+ * per bit of the address, independent of the number of
+ * stored prefixes.
+ */
+struct netaddr_trie {
+  /*! node of the zero length prefix */
+  struct netaddr_trie_node root;
+
+  /*! address family of the prefixes in the trie */
+  uint8_t af_type;
+
+  /*! number of prefixes in the trie */
+  uint32_t count;
+};
+
+EXPORT void netaddr_trie_init(struct netaddr_trie *, uint8_t af_type);
+EXPORT void netaddr_trie_clear(struct netaddr_trie *, void (*cb_remove)(void *));
+EXPORT int netaddr_trie_insert(struct netaddr_trie *, const struct netaddr *prefix, void *value);
+EXPORT void *netaddr_trie_get(const struct netaddr_trie *, const struct netaddr *prefix);
+EXPORT void *netaddr_trie_lookup(const struct netaddr_trie *, const struct netaddr *addr);
+
+#endif /* NETADDR_TRIE_H_ */
@@ -0,0 +1,98 @@
+
+/*
+ * The olsr.org Optimized Link-State Routing daemon version 2 (olsrd2)
+ * Copyright (c) 2004-2015, the olsr.org team - see HISTORY file
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in
+ *   the documentation and/or other materials provided with the
+ *   distribution.
+ * * Neither the name of olsr.org, olsrd nor the names of its
+ *   contributors may be used to endorse or promote products derived
+ *   from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Visit http://www.olsr.org for more information.
+ *
+ * If you find this software useful feel free to make a donation
+ * to the project. For more information see the website or contact
+ * the copyright holders.
+ *
+ */
+
+/**
+ * @file
+ */
+
+#include <string.h>
+
+#include "common/common_types.h"
+
+#include "common/prng.h"
+
+/**
+ * Initialize a pseudo random number generator. The seed is
+ * expanded into the generator state with splitmix64, so every
+ * seed (including zero) results in a valid state.
+ * @param state pointer to generator state
+ * @param seed 64 bit seed, should come from a real random source
+ */
+void
+prng_seed(struct prng_state *state, uint64_t seed) {
+  uint64_t z;
+  size_t i;
+
+  for (i=0; i<ARRAYSIZE(state->s); i++) {
+    seed += 0x9e3779b97f4a7c15ull;
+
+    z = seed;
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+    state->s[i] = z ^ (z >> 31);
+  }
+}
+
+/**
+ * Fill a buffer with pseudo random data
+ * @param state pointer to generator state
+ * @param dst pointer to destination buffer
+ * @param length number of bytes requested
+ */
+void
+prng_get_bytes(struct prng_state *state, void *dst, size_t length) {
+  uint8_t *ptr;
+  uint64_t rnd;
+
+  ptr = dst;
+  while (length >= sizeof(rnd)) {
+    rnd = prng_next(state);
+    memcpy(ptr, &rnd, sizeof(rnd));
+
+    ptr += sizeof(rnd);
+    length -= sizeof(rnd);
+  }
+
+  if (length > 0) {
+    rnd = prng_next(state);
+    memcpy(ptr, &rnd, length);
+  }
+}
@@ -0,0 +1,108 @@
+
+/*
+ * The olsr.org Optimized Link-State Routing daemon version 2 (olsrd2)
+ * Copyright (c) 2004-2015, the olsr.org team - see HISTORY file
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in
+ *   the documentation and/or other materials provided with the
+ *   distribution.
+ * * Neither the name of olsr.org, olsrd nor the names of its
+ *   contributors may be used to endorse or promote products derived
+ *   from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Visit http://www.olsr.org for more information.
+ *
+ * If you find this software useful feel free to make a donation
+ * to the project. For more information see the website or contact
+ * the copyright holders.
+ *
+ */
+
+/**
+ * @file
+ */
+
+#ifndef PRNG_H_
+#define PRNG_H_
+
+#include "common/common_types.h"
+
+/**
+ * State of a fast non-cryptographic pseudo random number
+ * generator (xoshiro256**). Use it for timer jitter and
+ * similar things, never for anything security related.
+ */
+struct prng_state {
+  /*! internal state, must not be all zero */
+  uint64_t s[4];
+};
+
+EXPORT void prng_seed(struct prng_state *state, uint64_t seed);
+EXPORT void prng_get_bytes(struct prng_state *state, void *dst, size_t length);
+
+/**
+ * @param x 64 bit value
+ * @param k number of bits to rotate
+ * @return x rotated left by k bits
+ */
+static INLINE uint64_t
+_prng_rotl(const uint64_t x, int k) {
+  return (x << k) | (x >> (64 - k));
+}
+
+/**
+ * Generate the next 64 bit pseudo random number
+ * @param state pointer to generator state
+ * @return pseudo random number
+ */
+static INLINE uint64_t
+prng_next(struct prng_state *state) {
+  uint64_t result, t;
+
+  result = _prng_rotl(state->s[1] * 5, 7) * 9;
+  t = state->s[1] << 17;
+
+  state->s[2] ^= state->s[0];
+  state->s[3] ^= state->s[1];
+  state->s[1] ^= state->s[2];
+  state->s[0] ^= state->s[3];
+
+  state->s[2] ^= t;
+  state->s[3] = _prng_rotl(state->s[3], 45);
+
+  return result;
+}
+
+/**
+ * Generate the next 32 bit pseudo random number
+ * @param state pointer to generator state
+ * @return pseudo random number
+ */
+static INLINE uint32_t
+prng_next32(struct prng_state *state) {
+  /* the upper bits have the better statistical quality */
+  return (uint32_t)(prng_next(state) >> 32);
+}
+
+#endif /* PRNG_H_ */
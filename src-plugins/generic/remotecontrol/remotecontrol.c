@@ -43,12 +43,14 @@
  * @file
  */
 
+#include <stdio.h>
 #include <stdlib.h>
 
 #include "common/common_types.h"
 #include "common/autobuf.h"
 #include "common/avl.h"
 #include "common/avl_comp.h"
+#include "common/histogram.h"
 #include "common/list.h"
 #include "common/netaddr.h"
 #include "common/string.h"
@@ -59,6 +61,9 @@
 #include "core/oonf_logging.h"
 #include "core/oonf_subsystem.h"
 #include "subsystems/oonf_class.h"
+#include "subsystems/oonf_clock.h"
+#include "subsystems/oonf_packet_socket.h"
+#include "subsystems/oonf_socket.h"
 #include "subsystems/oonf_timer.h"
 #include "subsystems/oonf_telnet.h"
 #include "subsystems/os_routing.h"
@@ -106,6 +111,11 @@ static enum oonf_telnet_result _update_logfilter(struct oonf_telnet_data *data,
 
 static void _print_memory(struct autobuf *buf);
 static void _print_timer(struct autobuf *buf);
+static void _print_packet(struct autobuf *buf);
+static void _print_latency(struct autobuf *buf);
+static void _print_histogram(struct autobuf *buf,
+    const char *name, const char *type, struct histogram *h);
+static void _reset_latency(void);
 
 static enum oonf_telnet_result _start_logging(struct oonf_telnet_data *data,
     struct _remotecontrol_session *rc_session);
@@ -139,6 +149,9 @@ static struct _remotecontrol_cfg _remotecontrol_config;
 /* plugin declaration */
 static const char *_dependencies[] = {
   OONF_CLASS_SUBSYSTEM,
+  OONF_CLOCK_SUBSYSTEM,
+  OONF_PACKET_SUBSYSTEM,
+  OONF_SOCKET_SUBSYSTEM,
   OONF_TELNET_SUBSYSTEM,
   OONF_TIMER_SUBSYSTEM,
   OONF_OS_ROUTING_SUBSYSTEM,
@@ -162,7 +175,10 @@ DECLARE_OONF_PLUGIN(_oonf_remotecontrol_subsystem);
 static struct oonf_telnet_command _telnet_cmds[] = {
   TELNET_CMD("resources", _cb_handle_resource,
       "\"resources memory\": display information about memory usage\n"
-      "\"resources timer\": display information about active timers\n",
+      "\"resources timer\": display information about active timers\n"
+      "\"resources packet\": display information about packet socket queues\n"
+      "\"resources latency\": display runtime of timer and socket callbacks\n"
+      "\"resources latency reset\": reset runtime statistics of callbacks and timer wakeups\n",
       .acl = &_remotecontrol_config.acl),
   TELNET_CMD("log", _cb_handle_log,
       "\"log\":      continuous output of logging to this console\n"
@@ -272,14 +288,121 @@ _print_memory(struct autobuf *buf) {
  */
 static void
 _print_timer(struct autobuf *buf) {
+  const struct oonf_timer_statistics *stats;
   struct oonf_timer_class *t;
+  uint64_t duration;
 
   list_for_each_element(oonf_timer_get_list(), t, _node) {
-    abuf_appendf(buf, "%-25s (TIMER) usage: %u changes: %u\n",
-        t->name, t->usage, t->changes);
+    abuf_appendf(buf, "%-25s (TIMER) usage: %u changes: %u slack: %"PRIu64"\n",
+        t->name, t->usage, t->changes, t->slack);
+  }
+
+  stats = oonf_timer_get_statistics();
+  duration = oonf_clock_getNow() - stats->start;
+  if (duration == 0) {
+    duration = 1;
+  }
+
+  /* wakeups per second with two fractional digits */
+  abuf_appendf(buf, "%-25s (TIMER) walks: %"PRIu64" wakeups: %"PRIu64
+      " (%"PRIu64".%02"PRIu64"/s)\n", "timer walker",
+      stats->walks, stats->wakeups,
+      stats->wakeups * 1000 / duration, (stats->wakeups * 100000 / duration) % 100);
+}
+
+/**
+ * Print current state of the outgoing queues of packet sockets
+ * @param buf output buffer
+ */
+static void
+_print_packet(struct autobuf *buf) {
+  struct oonf_packet_socket *pkt;
+  struct netaddr_str nbuf;
+
+  list_for_each_element(oonf_packet_get_list(), pkt, node) {
+    abuf_appendf(buf, "%-25s (PACKET) if: %s queue: %u/%u max: %u"
+        " queued: %"PRIu64" dropped: %"PRIu64
+        " rx: %"PRIu64"/%"PRIu64" (%u) tx: %"PRIu64"/%"PRIu64" (%u)"
+        " gso: %"PRIu64" mmsg: %"PRIu64" saved: %"PRIu64"\n",
+        netaddr_socket_to_string(&nbuf, &pkt->local_socket),
+        pkt->os_if != NULL ? pkt->os_if->name : "-",
+        oonf_packet_get_queue_depth(pkt), pkt->config.queue_length,
+        pkt->queue_stats.max_depth,
+        pkt->queue_stats.queued, pkt->queue_stats.dropped,
+        pkt->rx_stats.packets, pkt->rx_stats.calls, pkt->rx_stats.max_batch,
+        pkt->tx_stats.packets, pkt->tx_stats.calls, pkt->tx_stats.max_batch,
+        pkt->burst_stats.segmented, pkt->burst_stats.batched,
+        pkt->burst_stats.saved);
+  }
+}
+
+/**
+ * Print the runtime statistics of timer and socket callbacks
+ * @param buf output buffer
+ */
+static void
+_print_latency(struct autobuf *buf) {
+  struct oonf_timer_class *t;
+  struct oonf_socket_entry *sock;
+  char name[32];
+
+  list_for_each_element(oonf_timer_get_list(), t, _node) {
+    _print_histogram(buf, t->name, "TIMER", &t->latency);
+  }
+
+  list_for_each_element(oonf_socket_get_list(), sock, _node) {
+    snprintf(name, sizeof(name), "%s %d",
+        sock->name != NULL ? sock->name : "socket", os_fd_get_fd(&sock->fd));
+    _print_histogram(buf, name, "SOCKET", &sock->latency);
   }
 }
 
+/**
+ * Print a latency histogram in microseconds
+ * @param buf output buffer
+ * @param name name of histogram
+ * @param type type of histogram source
+ * @param h pointer to histogram with nanosecond values
+ */
+static void
+_print_histogram(struct autobuf *buf,
+    const char *name, const char *type, struct histogram *h) {
+  unsigned i, last;
+
+  abuf_appendf(buf, "%-25s (%s) calls: %"PRIu64" avg: %"PRIu64" us"
+      " p99: %"PRIu64" us max: %"PRIu64" us buckets:",
+      name, type, h->count,
+      h->count ? h->sum / h->count / 1000 : 0,
+      histogram_get_percentile(h, 99) / 1000, h->max / 1000);
+
+  /* only print buckets up to the last used one */
+  last = HISTOGRAM_BUCKETS;
+  while (last > 0 && h->bucket[last-1] == 0) {
+    last--;
+  }
+  for (i=0; i<last; i++) {
+    abuf_appendf(buf, " %"PRIu64, h->bucket[i]);
+  }
+  abuf_puts(buf, "\n");
+}
+
+/**
+ * Reset the runtime statistics of timer and socket callbacks
+ */
+static void
+_reset_latency(void) {
+  struct oonf_timer_class *t;
+  struct oonf_socket_entry *sock;
+
+  list_for_each_element(oonf_timer_get_list(), t, _node) {
+    histogram_reset(&t->latency);
+  }
+  list_for_each_element(oonf_socket_get_list(), sock, _node) {
+    histogram_reset(&sock->latency);
+  }
+  oonf_timer_reset_statistics();
+}
+
 /**
  * Handle resource command
  * @param data pointer to telnet data
@@ -296,6 +419,20 @@ _cb_handle_resource(struct oonf_telnet_data *data) {
     abuf_puts(data->out, "\nTimer cookies:\n");
     _print_timer(data->out);
   }
+
+  if (data->parameter == NULL || strcasecmp(data->parameter, "packet") == 0) {
+    abuf_puts(data->out, "\nPacket sockets:\n");
+    _print_packet(data->out);
+  }
+
+  if (data->parameter != NULL && strcasecmp(data->parameter, "latency reset") == 0) {
+    _reset_latency();
+    abuf_puts(data->out, "Latency statistics reset\n");
+  }
+  else if (data->parameter == NULL || strcasecmp(data->parameter, "latency") == 0) {
+    abuf_puts(data->out, "\nCallback latency:\n");
+    _print_latency(data->out);
+  }
   return TELNET_RESULT_ACTIVE;
 }
 
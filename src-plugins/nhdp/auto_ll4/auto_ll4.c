@@ -49,6 +49,7 @@
 #include "common/common_types.h"
 #include "common/autobuf.h"
 #include "common/avl.h"
+#include "common/prng.h"
 #include "config/cfg_schema.h"
 #include "core/oonf_cfg.h"
 #include "core/oonf_logging.h"
@@ -201,12 +202,23 @@ static struct oonf_class_extension _nhdp_2hop_listener = {
   .cb_remove = _cb_2hop_change,
 };
 
+/* generator for random link-local addresses */
+static struct prng_state _prng;
+
 /**
  * Initialize plugin
  * @return -1 if an error happened, 0 otherwise
  */
 static int
 _init(void) {
+  uint64_t seed;
+
+  if (os_core_get_random(&seed, sizeof(seed))) {
+    OONF_WARN(LOG_AUTO_LL4, "Could not get random data");
+    seed = 0;
+  }
+  prng_seed(&_prng, seed);
+
   if (oonf_class_extension_add(&_nhdp_if_extenstion)) {
     OONF_WARN(LOG_AUTO_LL4, "Cannot allocate extension for NHDP interface data");
     return -1;
@@ -505,10 +517,7 @@ _cb_update_timer(struct oonf_timer_instance *ptr) {
 
   while (_nhdp_if_has_collision(nhdp_if, &auto_ll4->auto_ll4_addr)) {
     /* roll up a random address */
-    if (os_core_get_random(&rnd, sizeof(rnd))) {
-      OONF_WARN(LOG_AUTO_LL4, "Could not get random data");
-      return;
-    }
+    rnd = prng_next32(&_prng);
     hash = htons((rnd % (256 * 254)) + 256);
     netaddr_create_host_bin(&auto_ll4->auto_ll4_addr,
         &NETADDR_IPV4_LINKLOCAL, &hash, sizeof(hash));
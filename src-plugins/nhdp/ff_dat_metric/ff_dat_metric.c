@@ -293,6 +293,7 @@ static struct oonf_timer_class _sampling_timer_info = {
   .name = "Sampling timer for DATFF-metric",
   .callback = _cb_dat_sampling,
   .periodic = true,
+  .slack = 200,
 };
 
 static struct oonf_timer_instance _sampling_timer = {
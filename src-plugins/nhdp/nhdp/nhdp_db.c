@@ -105,26 +105,31 @@ static struct oonf_class _naddr_info = {
 static struct oonf_timer_class _link_vtime_info = {
   .name = "NHDP link vtime",
   .callback = _cb_link_vtime,
+  .slack = 500,
 };
 
 static struct oonf_timer_class _link_heard_info = {
   .name = "NHDP link heard-time",
   .callback = _cb_link_heard,
+  .slack = 500,
 };
 
 static struct oonf_timer_class _link_symtime_info = {
   .name = "NHDP link symtime",
   .callback = _cb_link_symtime,
+  .slack = 500,
 };
 
 static struct oonf_timer_class _naddr_vtime_info = {
   .name = "NHDP neighbor address vtime",
   .callback = _cb_naddr_vtime,
+  .slack = 500,
 };
 
 static struct oonf_timer_class _l2hop_vtime_info = {
   .name = "NHDP 2hop vtime",
   .callback = _cb_l2hop_vtime,
+  .slack = 500,
 };
 
 /* global tree of neighbor addresses */
@@ -54,6 +54,7 @@
 #include "core/oonf_logging.h"
 #include "core/oonf_subsystem.h"
 #include "core/os_core.h"
+#include "subsystems/oonf_job.h"
 #include "subsystems/oonf_rfc5444.h"
 #include "subsystems/oonf_telnet.h"
 #include "subsystems/oonf_timer.h"
@@ -65,6 +66,7 @@
 #include "olsrv2/olsrv2_lan.h"
 #include "olsrv2/olsrv2_originator.h"
 #include "olsrv2/olsrv2_reader.h"
+#include "olsrv2/olsrv2_routing.h"
 #include "olsrv2/olsrv2_tc.h"
 #include "olsrv2/olsrv2_writer.h"
 
@@ -110,6 +112,12 @@ struct _config {
   /*! olsrv2 p_hold_time */
   uint64_t p_hold_time;
 
+  /*! minimal hold-down time between two dijkstra calculations */
+  uint64_t dijkstra_min_holddown;
+
+  /*! maximal hold-down time between two dijkstra calculations */
+  uint64_t dijkstra_max_holddown;
+
   /*! decides NHDP routable status */
   bool nhdp_routable;
 
@@ -166,6 +174,16 @@ static struct cfg_schema_entry _rt_domain_entries[] = {
       "Metric Distance to be used in routing table", 0, false, 1, 255),
   CFG_MAP_BOOL(olsrv2_routing_domain, source_specific, "source_specific", "true",
       "This domain uses IPv6 source specific routing"),
+  CFG_MAP_INT32_MINMAX(olsrv2_routing_domain, multipath, "multipath", "1",
+      "Maximum number of equal cost paths used for a route, 1 to disable multipath routing",
+      0, false, 1, OS_ROUTE_MAX_NEXTHOPS),
+  CFG_MAP_BOOL(olsrv2_routing_domain, use_nexthop_objects, "nexthop_objects", "false",
+      "Routes through the same neighbor share a kernel nexthop object,"
+      " so a change of the neighbors link needs a single kernel update"),
+  CFG_MAP_CLOCK(olsrv2_routing_domain, warm_restart, "warm_restart", "0",
+      "Keep the kernel routes of a previous run at startup and replace them"
+      " with the routing results. Routes not confirmed within this time are removed,"
+      " 0 to ignore the routes of a previous run."),
 };
 
 static struct cfg_schema_section _rt_domain_section = {
@@ -186,6 +204,11 @@ static struct cfg_schema_entry _olsrv2_entries[] = {
     "Holdtime for forwarding set information", 100),
   CFG_MAP_CLOCK_MIN(_config, p_hold_time, "processing_hold_time", "300.0",
     "Holdtime for processing set information", 100),
+  CFG_MAP_CLOCK_MIN(_config, dijkstra_min_holddown, "dijkstra_min_holddown", "0.1",
+    "Minimal time between two routing calculations. The time doubles while"
+    " the topology keeps changing and falls back to the minimum once it is stable.", 1),
+  CFG_MAP_CLOCK_MIN(_config, dijkstra_max_holddown, "dijkstra_max_holddown", "10.0",
+    "Maximal time between two routing calculations", 100),
   CFG_MAP_BOOL(_config, nhdp_routable, "nhdp_routable", "no",
     "Decides if NHDP interface addresses"
     " are routed to other nodes. 'true' means the 'routable_acl' parameter"
@@ -219,6 +242,7 @@ static struct cfg_schema_section _olsrv2_section = {
 
 static const char *_dependencies[] = {
   OONF_CLASS_SUBSYSTEM,
+  OONF_JOB_SUBSYSTEM,
   OONF_RFC5444_SUBSYSTEM,
   OONF_TIMER_SUBSYSTEM,
   OONF_OS_INTERFACE_SUBSYSTEM,
@@ -901,6 +925,10 @@ _cb_cfg_olsrv2_changed(void) {
   /* set tc timer interval */
   oonf_timer_set(&_tc_timer, _olsrv2_config.tc_interval);
 
+  /* set rate limitation of routing calculation */
+  olsrv2_routing_set_holddown(_olsrv2_config.dijkstra_min_holddown,
+      _olsrv2_config.dijkstra_max_holddown);
+
   /* check if we have to change the originators */
   _update_originator(AF_INET);
   _update_originator(AF_INET6);
@@ -44,16 +44,21 @@
  */
 
 #include <errno.h>
+#include <stdlib.h>
+#include <string.h>
 
 #include "common/avl.h"
 #include "common/avl_comp.h"
 #include "common/common_types.h"
+#include "common/dijkstra.h"
 #include "common/list.h"
 #include "common/netaddr.h"
 #include "core/oonf_logging.h"
 #include "subsystems/oonf_class.h"
+#include "subsystems/oonf_job.h"
 #include "subsystems/oonf_rfc5444.h"
 #include "subsystems/oonf_timer.h"
+#include "subsystems/os_clock.h"
 #include "subsystems/os_routing.h"
 
 #include "nhdp/nhdp_db.h"
@@ -64,31 +69,82 @@
 #include "olsrv2/olsrv2_lan.h"
 #include "olsrv2/olsrv2_originator.h"
 #include "olsrv2/olsrv2_tc.h"
+#include "olsrv2/olsrv2_routing_internal.h"
 #include "olsrv2/olsrv2_routing.h"
 #include "olsrv2/olsrv2.h"
 
+/* number of nodes the routing calculation processes in one job step */
+#define DIJKSTRA_NODES_PER_STEP 16
+
+/**
+ * phases of a single dijkstra run
+ */
+enum _dijkstra_phase {
+  /*! shortest path tree calculation has to be started */
+  _PHASE_START,
+
+  /*! shortest path tree calculation is running */
+  _PHASE_DIJKSTRA,
+
+  /*! routing entries are filled from the shortest path tree */
+  _PHASE_ROUTES,
+};
+
 /* Prototypes */
-static void _run_dijkstra(struct nhdp_domain *domain, int af_family,
-    bool use_non_ss, bool use_ss);
-static struct olsrv2_routing_entry *_add_entry(
-    struct nhdp_domain *, struct os_route_key *prefix);
+static void _start_domain(struct nhdp_domain *domain);
+static void _start_dijkstra(struct nhdp_domain *domain, struct olsrv2_spf_tree *spf);
+static void _finish_dijkstra(struct nhdp_domain *domain, struct olsrv2_spf_tree *spf);
+static void _start_routing(bool skip_wait);
+static bool _abort_routing_job(void);
+static void _finish_routing_run(void);
 static void _remove_entry(struct olsrv2_routing_entry *);
-static void _insert_into_working_tree(struct olsrv2_tc_target *target,
-    struct nhdp_neighbor *neigh, uint32_t linkcost,
-    uint32_t path_cost, uint8_t path_hops,
-    uint8_t distance, bool single_hop,
-    const struct netaddr *last_originator);
+static struct olsrv2_spf_tree *_get_spf_tree(int index, int af_family);
+static struct olsrv2_tc_node *_get_tc_node(
+    struct olsrv2_spf_tree *spf, const struct dijkstra_node *dnode);
+static bool _use_node(struct olsrv2_tc_node *node, enum olsrv2_spf_label label);
+static uint32_t _get_edge_cost(struct olsrv2_tc_edge *edge, int index);
+static uint32_t _get_neighbor_cost(struct olsrv2_spf_tree *spf, struct nhdp_neighbor *neigh);
+static void _mark_node_dirty(struct olsrv2_tc_node *node);
+static bool _check_originator_change(void);
+static void _update_local_nodes(void);
+static void _update_spf_trees(void);
+static void _update_ssnode_split(void);
+static void _update_root_edges(struct olsrv2_spf_tree *spf);
+#ifdef OONF_PARALLEL_DIJKSTRA
+static void _calculate_parallel(void);
+#endif
 static void _prepare_routes(struct nhdp_domain *);
-static void _prepare_nodes(void);
-static bool _check_ssnode_split(struct nhdp_domain *domain, int af_family);
-static void _add_one_hop_nodes(struct nhdp_domain *domain, int family, bool, bool);
-static void _handle_working_queue(struct nhdp_domain *, bool, bool);
+static void _calculate_multipath(struct olsrv2_spf_tree *spf,
+    enum olsrv2_spf_label label, int max_paths);
+static void _add_first_hop(struct olsrv2_dijkstra_multipath *multipath,
+    struct olsrv2_tc_node *first_hop, struct olsrv2_tc_node *primary, int max_paths);
+static int _cb_cmp_dijkstra_cost(const void *, const void *);
+static void _prepare_entry(struct olsrv2_routing_entry *rtentry);
+static void _check_entry_changed(struct olsrv2_routing_entry *rtentry);
+static void _mark_all_entries_dirty(void);
+static void _mark_stale_entries(struct nhdp_domain *);
+static void _add_node_routes(struct nhdp_domain *,
+    struct olsrv2_spf_tree *spf, struct olsrv2_tc_node *node);
+static void _add_label_routes(struct nhdp_domain *, struct olsrv2_spf_tree *spf,
+    struct olsrv2_tc_node *node, enum olsrv2_spf_label label);
 static void _handle_nhdp_routes(struct nhdp_domain *);
 static void _add_route_to_kernel_queue(struct olsrv2_routing_entry *rtentry);
 static void _process_dijkstra_result(struct nhdp_domain *);
 static void _process_kernel_queue(void);
+static bool _routing_step(void);
+static bool _cb_routing_step(struct oonf_job_instance *);
+static void _cb_topology_removed(void *);
+static void _cb_spf_expand(struct dijkstra_tree *, struct dijkstra_node *);
+static void _cb_spf_expand_incoming(struct dijkstra_tree *, struct dijkstra_node *);
+static int _cb_spf_compare(struct dijkstra_tree *,
+    const struct dijkstra_node *, const struct dijkstra_node *);
+static void _cb_tc_node_added(void *);
+static void _cb_tc_node_changed(void *);
+static void _cb_tc_edge_added(void *);
+static void _cb_tc_edge_removed(void *);
 static void _cb_trigger_dijkstra(struct oonf_timer_instance *);
 static void _cb_nhdp_update(struct nhdp_neighbor *);
+static void _handle_job_route_result(struct olsrv2_routing_entry *rtentry, int error);
 static void _cb_route_finished(struct os_route *route, int error);
 
 /* Domain parameter of dijkstra algorithm */
@@ -110,6 +166,41 @@ static struct oonf_timer_instance _rate_limit_timer = {
   .class = &_dijkstra_timer_info
 };
 
+/* time-sliced routing calculation */
+static struct oonf_job_class _routing_job_class = {
+  .name = "Olsrv2 routing calculation",
+  .step = _cb_routing_step,
+};
+
+static struct oonf_job_instance _routing_job = {
+  .class = &_routing_job_class,
+};
+
+/*
+ * listeners to track topology changes for the shortest path trees
+ * and to abort the calculation when topology data is removed
+ */
+static struct oonf_class_extension _tc_node_listener = {
+  .ext_name = "olsrv2 routing",
+  .class_name = OLSRV2_CLASS_TC_NODE,
+  .cb_add = _cb_tc_node_added,
+  .cb_change = _cb_tc_node_changed,
+  .cb_remove = _cb_topology_removed,
+};
+
+static struct oonf_class_extension _tc_edge_listener = {
+  .ext_name = "olsrv2 routing",
+  .class_name = OLSRV2_CLASS_TC_EDGE,
+  .cb_add = _cb_tc_edge_added,
+  .cb_remove = _cb_tc_edge_removed,
+};
+
+static struct oonf_class_extension _tc_endpoint_listener = {
+  .ext_name = "olsrv2 routing",
+  .class_name = OLSRV2_CLASS_ENDPOINT,
+  .cb_remove = _cb_topology_removed,
+};
+
 /* callback for NHDP domain events */
 static struct nhdp_domain_listener _nhdp_listener = {
   .update = _cb_nhdp_update,
@@ -117,13 +208,55 @@ static struct nhdp_domain_listener _nhdp_listener = {
 
 static bool _trigger_dijkstra = false;
 
+/* adaptive hold-down between two dijkstra calculations */
+static uint64_t _holddown_min = OLSRv2_DIJKSTRA_MIN_HOLDDOWN;
+static uint64_t _holddown_max = OLSRv2_DIJKSTRA_MAX_HOLDDOWN;
+static uint64_t _holddown = OLSRv2_DIJKSTRA_MIN_HOLDDOWN;
+
+/* true if the rate limit timer runs the hold-down after a calculation */
+static bool _holddown_active;
+
+/* processing time of the running calculation in nanoseconds */
+static uint64_t _run_time;
+
+static struct olsrv2_routing_statistics _statistics;
+
 /* global datastructures for routing */
 static struct avl_tree _routing_tree[NHDP_MAXIMUM_DOMAINS];
 static struct list_entity _routing_filter_list;
 
-static struct avl_tree _dijkstra_working_tree;
+/* routing entries sorted by the dijkstra run that refreshed them last */
+static struct list_entity _refresh_list[NHDP_MAXIMUM_DOMAINS];
+static uint32_t _generation[NHDP_MAXIMUM_DOMAINS];
+
+/* routing entries that need post-processing after the dijkstra run */
+static struct list_entity _dirty_list[NHDP_MAXIMUM_DOMAINS];
+
 static struct list_entity _kernel_queue;
 
+/* shortest path trees for each domain and address family */
+static struct olsrv2_spf_tree _spf_trees[NHDP_MAXIMUM_DOMAINS][2];
+
+/* tc nodes whose edges might have changed since the last calculation */
+static struct list_entity _dirty_nodes;
+
+/* originator addresses used for the shortest path trees */
+static struct netaddr _spf_originator[2];
+static uint32_t _spf_originator_count;
+
+/* state of the running routing calculation */
+static struct nhdp_domain *_job_domain;
+static int _job_run_current;
+static enum _dijkstra_phase _job_run_phase;
+static struct olsrv2_tc_node *_job_route_node;
+
+/* address families of the dijkstra runs of a domain */
+static const int _job_run_af_family[] = { AF_INET, AF_INET6 };
+
+/* reached shortest path tree nodes sorted by cost for multipath calculation */
+static struct dijkstra_node **_multipath_nodes;
+static size_t _multipath_size;
+
 static bool _initiate_shutdown = false;
 
 /**
@@ -131,19 +264,48 @@ static bool _initiate_shutdown = false;
  */
 void
 olsrv2_routing_init(void) {
-  int i;
+  struct olsrv2_spf_tree *spf;
+  int i, j;
 
   oonf_class_add(&_rtset_entry);
   oonf_timer_add(&_dijkstra_timer_info);
+  oonf_job_add(&_routing_job_class);
 
   for (i=0; i<NHDP_MAXIMUM_DOMAINS; i++) {
     avl_init(&_routing_tree[i], os_routing_avl_cmp_route_key, false);
+    list_init_head(&_refresh_list[i]);
+    list_init_head(&_dirty_list[i]);
   }
   list_init_head(&_routing_filter_list);
-  avl_init(&_dijkstra_working_tree, avl_comp_uint32, true);
   list_init_head(&_kernel_queue);
+  list_init_head(&_dirty_nodes);
+
+  for (i=0; i<NHDP_MAXIMUM_DOMAINS; i++) {
+    for (j=0; j<2; j++) {
+      spf = &_spf_trees[i][j];
+
+      dijkstra_init(&spf->tree);
+      spf->tree.expand = _cb_spf_expand;
+      spf->tree.expand_incoming = _cb_spf_expand_incoming;
+      spf->tree.compare = _cb_spf_compare;
+
+      spf->index = i;
+      spf->af_family = j == 0 ? AF_INET : AF_INET6;
+    }
+  }
 
   nhdp_domain_listener_add(&_nhdp_listener);
+
+  oonf_class_extension_add(&_tc_node_listener);
+  oonf_class_extension_add(&_tc_edge_listener);
+  oonf_class_extension_add(&_tc_endpoint_listener);
+
+  olsrv2_routing_nexthop_init();
+  olsrv2_routing_warm_init();
+
+#ifdef OONF_PARALLEL_DIJKSTRA
+  olsrv2_routing_parallel_init();
+#endif
 }
 
 /**
@@ -152,11 +314,18 @@ olsrv2_routing_init(void) {
 void
 olsrv2_routing_initiate_shutdown(void) {
   struct olsrv2_routing_entry *entry, *e_it;
+  struct nhdp_domain *domain;
   int i;
 
   /* remember we are in shutdown */
   _initiate_shutdown = true;
 
+  /* stop running calculation */
+  _abort_routing_job();
+
+  /* stop reading kernel routes of a previous run */
+  olsrv2_routing_warm_initiate_shutdown();
+
   /* remove all routes */
   for (i=0; i<NHDP_MAXIMUM_DOMAINS; i++) {
     avl_for_each_element_safe(&_routing_tree[i], entry, _node, e_it) {
@@ -173,6 +342,11 @@ olsrv2_routing_initiate_shutdown(void) {
   }
 
   _process_kernel_queue();
+
+  /* remove nexthop objects after the routes using them */
+  list_for_each_element(nhdp_domain_get_list(), domain, _node) {
+    olsrv2_routing_nexthop_remove(domain);
+  }
 }
 
 /**
@@ -184,10 +358,21 @@ olsrv2_routing_cleanup(void) {
   struct olsrv2_routing_filter *filter, *f_it;
   int i;
 
+  olsrv2_routing_nexthop_cleanup();
+
+  oonf_class_extension_remove(&_tc_endpoint_listener);
+  oonf_class_extension_remove(&_tc_edge_listener);
+  oonf_class_extension_remove(&_tc_node_listener);
+
   nhdp_domain_listener_remove(&_nhdp_listener);
 
+  _abort_routing_job();
   oonf_timer_stop(&_rate_limit_timer);
 
+#ifdef OONF_PARALLEL_DIJKSTRA
+  olsrv2_routing_parallel_cleanup();
+#endif
+
   for (i=0; i<NHDP_MAXIMUM_DOMAINS; i++) {
     avl_for_each_element_safe(&_routing_tree[i], entry, _node, e_it) {
       /* remove entry from database */
@@ -199,6 +384,14 @@ olsrv2_routing_cleanup(void) {
     olsrv2_routing_filter_remove(filter);
   }
 
+  free(_multipath_nodes);
+  _multipath_nodes = NULL;
+  _multipath_size = 0;
+
+  olsrv2_routing_graph_cleanup();
+  olsrv2_routing_warm_cleanup();
+
+  oonf_job_remove(&_routing_job_class);
   oonf_timer_remove(&_dijkstra_timer_info);
   oonf_class_remove(&_rtset_entry);
 }
@@ -209,6 +402,11 @@ olsrv2_routing_cleanup(void) {
  */
 void
 olsrv2_routing_trigger_update(void) {
+  _statistics.triggers++;
+  if (_trigger_dijkstra) {
+    _statistics.coalesced++;
+  }
+
   _trigger_dijkstra = true;
   if (!oonf_timer_is_active(&_rate_limit_timer)) {
     /* trigger as soon as we hit the next time slice */
@@ -228,70 +426,47 @@ olsrv2_routing_get_parameters(struct nhdp_domain *domain) {
 }
 
 /**
- * Trigger dijkstra and routing update now
+ * Trigger dijkstra and routing update now. The calculation
+ * runs as a job in time slices between the socket events.
  * @param skip_wait true to ignore rate limitation timer
  */
 void
 olsrv2_routing_force_update(bool skip_wait) {
-  struct nhdp_domain *domain;
-  bool splitv4, splitv6;
+  _statistics.triggers++;
+  _start_routing(skip_wait);
+}
 
-  if (_initiate_shutdown) {
-    /* no dijkstra anymore when in shutdown */
-    return;
+/**
+ * Set the range of the adaptive hold-down time between two
+ * dijkstra calculations. The hold-down doubles if the topology
+ * changed again during the last one and falls back to the minimum
+ * after a hold-down without changes.
+ * @param min_holddown minimal hold-down time in milliseconds,
+ *   at least 1 ms is used so the hold-down can grow
+ * @param max_holddown maximal hold-down time in milliseconds
+ */
+void
+olsrv2_routing_set_holddown(uint64_t min_holddown, uint64_t max_holddown) {
+  if (min_holddown == 0) {
+    min_holddown = 1;
   }
+  _holddown_min = min_holddown;
+  _holddown_max = max_holddown < min_holddown ? min_holddown : max_holddown;
 
-  /* handle dijkstra rate limitation timer */
-  if (oonf_timer_is_active(&_rate_limit_timer)) {
-    if (!skip_wait) {
-      /* trigger dijkstra later */
-      _trigger_dijkstra = true;
-
-      OONF_DEBUG(LOG_OLSRV2_ROUTING, "Delay Dijkstra");
-      return;
-    }
-    oonf_timer_stop(&_rate_limit_timer);
+  if (_holddown < _holddown_min) {
+    _holddown = _holddown_min;
   }
-
-  OONF_DEBUG(LOG_OLSRV2_ROUTING, "Run Dijkstra");
-
-  list_for_each_element(nhdp_domain_get_list(), domain, _node) {
-    /* initialize dijkstra specific fields */
-    _prepare_routes(domain);
-    _prepare_nodes();
-
-    /* run IPv4 dijkstra (might be two times because of source-specific data) */
-    splitv4 = _check_ssnode_split(domain, AF_INET);
-    _run_dijkstra(domain, AF_INET, true, !splitv4);
-
-    /* run IPv6 dijkstra (might be two times because of source-specific data) */
-    splitv6 = _check_ssnode_split(domain, AF_INET6);
-    _run_dijkstra(domain, AF_INET6, true, !splitv6);
-
-    /* handle source-specific sub-topology if necessary */
-    if (splitv4 || splitv6) {
-      /* re-initialize dijkstra specific node fields */
-      _prepare_nodes();
-
-      if (splitv4) {
-        _run_dijkstra(domain, AF_INET, false, true);
-      }
-      if (splitv6) {
-        _run_dijkstra(domain, AF_INET6, false, true);
-      }
-    }
-
-    /* check if direct one-hop routes are quicker */
-    _handle_nhdp_routes(domain);
-
-    /* update kernel routes */
-    _process_dijkstra_result(domain);
+  if (_holddown > _holddown_max) {
+    _holddown = _holddown_max;
   }
+}
 
-  _process_kernel_queue();
-
-  /* make sure dijkstra is not called too often */
-  oonf_timer_set(&_rate_limit_timer, OLSRv2_DIJKSTRA_RATE_LIMITATION);
+/**
+ * @return statistics of the dijkstra triggers and calculations
+ */
+const struct olsrv2_routing_statistics *
+olsrv2_routing_get_statistics(void) {
+  return &_statistics;
 }
 
 /**
@@ -301,7 +476,37 @@ olsrv2_routing_force_update(bool skip_wait) {
  */
 void
 olsrv2_routing_dijkstra_node_init(struct olsrv2_dijkstra_node *dijkstra) {
-  dijkstra->_node.key = &dijkstra->path_cost;
+  int i;
+
+  list_init_node(&dijkstra->_dirty_node);
+
+  for (i=0; i<NHDP_MAXIMUM_DOMAINS; i++) {
+    dijkstra->ss_spf[i].label = OLSRV2_SPF_SOURCE_SPECIFIC;
+  }
+}
+
+/**
+ * Remove a tc node from the shortest path trees before
+ * its memory is freed.
+ * Should normally not be called by other parts of OLSRv2.
+ * @param node pointer to tc node
+ */
+void
+olsrv2_routing_dijkstra_node_cleanup(struct olsrv2_tc_node *node) {
+  struct olsrv2_spf_tree *spf;
+  int i;
+
+  for (i=0; i<NHDP_MAXIMUM_DOMAINS; i++) {
+    spf = _get_spf_tree(i, netaddr_get_address_family(&node->target.prefix.dst));
+    dijkstra_remove_node(&spf->tree, &node->_dijkstra.spf[i]);
+    dijkstra_remove_node(&spf->tree, &node->_dijkstra.ss_spf[i]);
+  }
+
+  if (list_is_node_added(&node->_dijkstra._dirty_node)) {
+    list_remove(&node->_dijkstra._dirty_node);
+  }
+
+  olsrv2_routing_graph_mark_stale(netaddr_get_address_family(&node->target.prefix.dst));
 }
 
 /**
@@ -320,11 +525,25 @@ olsrv2_routing_set_domain_parameter(struct nhdp_domain *domain,
     return;
   }
 
+  /* stop running calculation, it will be restarted below */
+  _abort_routing_job();
+
+  if (parameter->use_nexthop_objects && !os_routing_supports_nexthop_objects()) {
+    OONF_WARN(LOG_OLSRV2_ROUTING, "Kernel does not support nexthop objects,"
+        " domain %u uses gateway routes", domain->ext);
+  }
+
   /* copy parameters */
   memcpy(&_domain_parameter[domain->index], parameter, sizeof(*parameter));
 
   if (avl_is_empty(&_routing_tree[domain->index])) {
     /* no routes present */
+    olsrv2_routing_nexthop_remove(domain);
+
+    if (_generation[domain->index] == 0 && parameter->warm_restart > 0) {
+      /* first configuration, take over the routes of a previous run */
+      olsrv2_routing_warm_start(domain);
+    }
     return;
   }
 
@@ -344,7 +563,11 @@ olsrv2_routing_set_domain_parameter(struct nhdp_domain *domain,
 
   _process_kernel_queue();
 
+  /* nexthop objects are recreated with the new parameters */
+  olsrv2_routing_nexthop_remove(domain);
+
   /* trigger a dijkstra to write new routes in 100 milliseconds */
+  _holddown_active = false;
   oonf_timer_set(&_rate_limit_timer, 100);
   _trigger_dijkstra = true;
 }
@@ -359,6 +582,18 @@ olsrv2_routing_get_tree(struct nhdp_domain *domain) {
   return &_routing_tree[domain->index];
 }
 
+/**
+ * Apply the routing filters again to all routing entries with the
+ * next dijkstra run. Must be called by the owner of a routing filter
+ * if its results changed, because the dijkstra only applies the
+ * filters to changed routes.
+ */
+void
+olsrv2_routing_reapply_filters(void) {
+  _mark_all_entries_dirty();
+  olsrv2_routing_trigger_update();
+}
+
 /**
  * Get list of olsrv2 routing filters
  * @return filter list
@@ -369,27 +604,169 @@ olsrv2_routing_get_filter_list(void) {
 }
 
 /**
- * Run Dijkstra for a set domain, address family and
- * (non-)source-specific nodes
+ * Initialize the routing calculation of a domain
  * @param domain nhdp domain
- * @param af_family address family
- * @param use_non_ss dijkstra should include non-source-specific ndoes
- * @param use_ss dijkstra should include source-specific ndoes
  */
 static void
-_run_dijkstra(struct nhdp_domain *domain, int af_family,
-    bool use_non_ss, bool use_ss) {
-  OONF_INFO(LOG_OLSRV2_ROUTING, "Run %s dijkstra on domain %d: %s/%s",
-      af_family == AF_INET ? "ipv4" : "ipv6", domain->index,
-      use_non_ss ? "true" : "false", use_ss ? "true" : "false");
+_start_domain(struct nhdp_domain *domain) {
+  _job_domain = domain;
+  _job_run_current = 0;
+  _job_run_phase = _PHASE_START;
+
+  /* initialize dijkstra specific fields */
+  _prepare_routes(domain);
+}
+
+/**
+ * Start Dijkstra for a set domain and address family. The working
+ * queue is processed by the following job steps.
+ * @param domain nhdp domain
+ * @param spf shortest path tree of domain and address family
+ */
+static void
+_start_dijkstra(struct nhdp_domain *domain, struct olsrv2_spf_tree *spf) {
+  OONF_INFO(LOG_OLSRV2_ROUTING, "Run %s dijkstra on domain %d%s",
+      spf->af_family == AF_INET ? "ipv4" : "ipv6", domain->index,
+      spf->split ? " with source-specific sub-topology" : "");
+
+  spf->domain = domain;
+
+  /* only recalculate the parts of the tree affected by topology changes */
+  dijkstra_start(&spf->tree);
+}
+
+/**
+ * Post-process a finished shortest path tree and prepare filling
+ * the routing entries from it
+ * @param domain nhdp domain
+ * @param spf shortest path tree of domain and address family
+ */
+static void
+_finish_dijkstra(struct nhdp_domain *domain, struct olsrv2_spf_tree *spf) {
+  int max_paths;
+
+  OONF_INFO(LOG_OLSRV2_ROUTING, "%s %s dijkstra on domain %d settled %u nodes",
+      spf->tree.incremental ? "Incremental" : "Full",
+      spf->af_family == AF_INET ? "ipv4" : "ipv6", domain->index, spf->tree.settled);
+
+  max_paths = _domain_parameter[domain->index].multipath;
+  if (max_paths > 1) {
+    _calculate_multipath(spf, OLSRV2_SPF_FULL, max_paths);
+    if (spf->split) {
+      _calculate_multipath(spf, OLSRV2_SPF_SOURCE_SPECIFIC, max_paths);
+    }
+  }
+
+  /* fill routing entries from shortest path tree */
+  _job_route_node = avl_first_element_safe(
+      olsrv2_tc_get_tree(), _job_route_node, _originator_node);
+  _job_run_phase = _PHASE_ROUTES;
+}
+
+/**
+ * Start the dijkstra and routing update job unless the
+ * rate limitation delays it
+ * @param skip_wait true to ignore rate limitation timer
+ */
+static void
+_start_routing(bool skip_wait) {
+  struct nhdp_domain *domain;
+  uint64_t start, end;
+
+  if (_initiate_shutdown) {
+    /* no dijkstra anymore when in shutdown */
+    return;
+  }
+
+  if (oonf_job_is_active(&_routing_job)) {
+    /* calculation is running, trigger the next one when its finished */
+    if (_trigger_dijkstra) {
+      _statistics.coalesced++;
+    }
+    _trigger_dijkstra = true;
+
+    OONF_DEBUG(LOG_OLSRV2_ROUTING, "Dijkstra already running");
+    return;
+  }
+
+  /* handle dijkstra rate limitation timer */
+  if (oonf_timer_is_active(&_rate_limit_timer)) {
+    if (!skip_wait) {
+      /* trigger dijkstra later */
+      if (_trigger_dijkstra) {
+        _statistics.coalesced++;
+      }
+      _trigger_dijkstra = true;
+
+      OONF_DEBUG(LOG_OLSRV2_ROUTING, "Delay Dijkstra");
+      return;
+    }
+    oonf_timer_stop(&_rate_limit_timer);
+    _holddown_active = false;
+  }
+
+  if (list_is_empty(nhdp_domain_get_list())) {
+    return;
+  }
+
+  OONF_DEBUG(LOG_OLSRV2_ROUTING, "Run Dijkstra");
+
+  os_clock_gettime64_ns(&start);
+
+  /* collect topology changes since the last calculation */
+  _update_spf_trees();
+  olsrv2_routing_graph_update();
+
+#ifdef OONF_PARALLEL_DIJKSTRA
+  /* calculate the full topology of all domains, the job only fills the routes */
+  _calculate_parallel();
+#endif
+
+  domain = list_first_element(nhdp_domain_get_list(), domain, _node);
+  _start_domain(domain);
+  oonf_job_start(&_routing_job);
+
+  os_clock_gettime64_ns(&end);
+  _run_time = end - start;
+}
+
+/**
+ * Stop a running routing calculation and restore the routing
+ * entries of the domain in calculation
+ * @return true if a calculation was stopped, false otherwise
+ */
+static bool
+_abort_routing_job(void) {
+  struct olsrv2_routing_entry *rtentry, *rt_it;
+
+  if (!oonf_job_is_active(&_routing_job)) {
+    return false;
+  }
+
+  OONF_DEBUG(LOG_OLSRV2_ROUTING, "Abort Dijkstra");
+
+  oonf_job_stop(&_routing_job);
+
+  if (_job_domain) {
+    /* only the entries at the end of the list were touched by the calculation */
+    list_for_each_element_reverse_safe(&_refresh_list[_job_domain->index],
+        rtentry, _refresh_node, rt_it) {
+      if (rtentry->_generation != _generation[_job_domain->index]) {
+        break;
+      }
 
-  /* add direct neighbors to working queue */
-  _add_one_hop_nodes(domain, af_family, use_non_ss, use_ss);
+      if (!rtentry->_old_set && !rtentry->in_processing) {
+        /* entry was created by the aborted calculation */
+        _remove_entry(rtentry);
+        continue;
+      }
 
-  /* run dijkstra */
-  while (!avl_is_empty(&_dijkstra_working_tree)) {
-    _handle_working_queue(domain, use_non_ss, use_ss);
+      rtentry->set = rtentry->_old_set;
+      memcpy(&rtentry->route.p, &rtentry->_old, sizeof(rtentry->_old));
+    }
+    _job_domain = NULL;
   }
+  return true;
 }
 
 /**
@@ -398,8 +775,8 @@ _run_dijkstra(struct nhdp_domain *domain, int af_family,
  * @param prefix network prefix of routing entry
  * @return pointer to routing entry, NULL if our of memory.
  */
-static struct olsrv2_routing_entry *
-_add_entry(struct nhdp_domain *domain, struct os_route_key *prefix) {
+struct olsrv2_routing_entry *
+olsrv2_routing_entry_add(struct nhdp_domain *domain, struct os_route_key *prefix) {
   struct olsrv2_routing_entry *rtentry;
 
   rtentry = avl_find_element(
@@ -429,9 +806,24 @@ _add_entry(struct nhdp_domain *domain, struct os_route_key *prefix) {
   rtentry->route.p.type = OS_ROUTE_UNICAST;
 
   avl_insert(&_routing_tree[domain->index], &rtentry->_node);
+  list_add_tail(&_refresh_list[domain->index], &rtentry->_refresh_node);
   return rtentry;
 }
 
+/**
+ * Mark a routing entry as not refreshed by the current dijkstra
+ * run, it is removed unless the next run refreshes it.
+ * @param rtentry routing entry
+ */
+void
+olsrv2_routing_entry_set_unrefreshed(struct olsrv2_routing_entry *rtentry) {
+  int index = rtentry->domain->index;
+
+  rtentry->_generation = _generation[index] - 1;
+  list_remove(&rtentry->_refresh_node);
+  list_add_head(&_refresh_list[index], &rtentry->_refresh_node);
+}
+
 /**
  * Remove a routing entry from the global database
  * @param entry pointer to routing entry
@@ -444,74 +836,11 @@ _remove_entry(struct olsrv2_routing_entry *entry) {
 
   /* remove entry from database */
   avl_remove(&_routing_tree[entry->domain->index], &entry->_node);
-  oonf_class_free(&_rtset_entry, entry);
-}
-
-/**
- * Insert a new entry into the dijkstra working queue
- * @param target pointer to tc target
- * @param neigh next hop through which the target can be reached
- * @param linkcost cost of the last hop of the path towards the target
- * @param pathcost remainder of the cost to the target
- * @param distance hopcount to be used for the route to the target
- * @param single_hop true if this is a single-hop route, false otherwise
- * @param last_node address of the last originator before we reached the
- *   destination prefix
- */
-static void
-_insert_into_working_tree(struct olsrv2_tc_target *target,
-    struct nhdp_neighbor *neigh, uint32_t linkcost,
-    uint32_t path_cost, uint8_t path_hops,
-    uint8_t distance, bool single_hop,
-    const struct netaddr *last_originator) {
-  struct olsrv2_dijkstra_node *node;
-#ifdef OONF_LOG_DEBUG_INFO
-  struct netaddr_str nbuf1, nbuf2;
-#endif
-  if (linkcost > RFC7181_METRIC_MAX) {
-    return;
-  }
-
-  node = &target->_dijkstra;
-
-  /*
-   * do not add ourselves to working queue,
-   * do not add nodes already processed to the working queue
-   */
-  if (node->local || node->done) {
-    return;
-  }
-
-  /* calculate new total pathcost */
-  path_cost += linkcost;
-  path_hops += 1;
-
-  if (avl_is_node_added(&node->_node)) {
-    /* node already in dijkstra working queue */
-
-    if (node->path_cost <= path_cost) {
-      /* current path is shorter than new one */
-      return;
-    }
-
-    /* we found a better path, remove node from working queue */
-    avl_remove(&_dijkstra_working_tree, &node->_node);
+  list_remove(&entry->_refresh_node);
+  if (list_is_node_added(&entry->_dirty_node)) {
+    list_remove(&entry->_dirty_node);
   }
-  
-  OONF_DEBUG(LOG_OLSRV2_ROUTING, "Add dst %s [%s] with pathcost %u to dijstra tree (0x%zx)",
-          netaddr_to_string(&nbuf1, &target->prefix.dst),
-          netaddr_to_string(&nbuf2, &target->prefix.src), path_cost,
-          (size_t)target);
-
-  node->path_cost = path_cost;
-  node->path_hops = path_hops;
-  node->first_hop = neigh;
-  node->distance = distance;
-  node->single_hop = single_hop;
-  node->last_originator = last_originator;
-
-  avl_insert(&_dijkstra_working_tree, &node->_node);
-  return;
+  oonf_class_free(&_rtset_entry, entry);
 }
 
 /**
@@ -525,14 +854,20 @@ _insert_into_working_tree(struct olsrv2_tc_target *target,
  * @param path_hops number of hops to the target
  * @param single_hop true if route is single hop
  * @param last_originator last originator before destination
+ * @param multipath equal cost first hops of the destination,
+ *   NULL for a single path route
  */
 static void
 _update_routing_entry(struct nhdp_domain *domain,
     struct os_route_key *prefix,
     struct nhdp_neighbor *first_hop,
     uint8_t distance, uint32_t pathcost, uint8_t path_hops,
-    bool single_hop, const struct netaddr *last_originator) {
+    bool single_hop, const struct netaddr *last_originator,
+    const struct olsrv2_dijkstra_multipath *multipath) {
   struct nhdp_neighbor_domaindata *neighdata;
+  struct nhdp_neighbor *neigh;
+  struct os_route_nexthop *nexthop;
+  int i;
   struct olsrv2_routing_entry *rtentry;
   const struct netaddr *originator;
   struct olsrv2_lan_entry *lan;
@@ -569,11 +904,12 @@ _update_routing_entry(struct nhdp_domain *domain,
   }
 
   /* make sure routing entry is present */
-  rtentry = _add_entry(domain, prefix);
+  rtentry = olsrv2_routing_entry_add(domain, prefix);
   if (rtentry == NULL) {
     /* out of memory... */
     return;
   }
+  _prepare_entry(rtentry);
 
   /*
    * routing entry might already be present because it can be set by
@@ -583,6 +919,11 @@ _update_routing_entry(struct nhdp_domain *domain,
     /* active routing entry is already cheaper, ignore new one */
     return;
   }
+  if (rtentry->set && rtentry->path_cost == pathcost
+      && multipath == NULL && rtentry->route.p.nexthop_count > 1) {
+    /* keep multipath route with the same cost */
+    return;
+  }
 
   neighdata = nhdp_domain_get_neighbordata(domain, first_hop);
   /* copy route parameters into data structure */
@@ -616,238 +957,736 @@ _update_routing_entry(struct nhdp_domain *domain,
     memcpy(&rtentry->route.p.gw, &neighdata->best_link->if_addr,
         sizeof(struct netaddr));
   }
+
+  /* fill in equal cost nexthops */
+  memset(rtentry->route.p.nexthops, 0, sizeof(rtentry->route.p.nexthops));
+  rtentry->route.p.nexthop_count = 0;
+
+  for (i=0; multipath != NULL && multipath->count > 1
+      && i < multipath->count; i++) {
+    neigh = nhdp_db_neighbor_get_by_originator(
+        &multipath->first_hops[i]->target.prefix.dst);
+    if (neigh == NULL) {
+      continue;
+    }
+
+    neighdata = nhdp_domain_get_neighbordata(domain, neigh);
+    if (neighdata->best_link == NULL) {
+      continue;
+    }
+
+    nexthop = &rtentry->route.p.nexthops[rtentry->route.p.nexthop_count++];
+    memcpy(&nexthop->gw, &neighdata->best_link->if_addr, sizeof(nexthop->gw));
+    nexthop->if_index = neighdata->best_link_ifindex;
+  }
+  if (rtentry->route.p.nexthop_count == 1) {
+    memset(rtentry->route.p.nexthops, 0, sizeof(rtentry->route.p.nexthops));
+    rtentry->route.p.nexthop_count = 0;
+  }
+
+  /* reference the nexthop object of the first hop instead of the gateway */
+  rtentry->route.p.nexthop_id = 0;
+  if (_domain_parameter[domain->index].use_nexthop_objects
+      && olsrv2_routing_nexthop_is_usable()
+      && rtentry->route.p.nexthop_count == 0
+      && netaddr_get_address_family(&rtentry->route.p.gw)
+          == netaddr_get_address_family(&rtentry->route.p.key.dst)) {
+    rtentry->route.p.nexthop_id = olsrv2_routing_nexthop_get_id(domain, first_hop,
+        netaddr_get_address_family(&rtentry->route.p.gw));
+  }
+
+  _check_entry_changed(rtentry);
 }
 
 /**
- * Initialize internal fields for dijkstra calculation
+ * Initialize internal fields for dijkstra calculation. The routing
+ * entries are prepared when the calculation touches them first.
  * @param domain nhdp domain
- * @return true if source-specific and non-source specific can
- *   be handled in the same dijkstra run, false otherwise
  */
 static void
 _prepare_routes(struct nhdp_domain *domain) {
-  struct olsrv2_routing_entry *rtentry;
-  /* prepare all existing routing entries and put them into the working queue */
-  avl_for_each_element(&_routing_tree[domain->index], rtentry, _node) {
-    rtentry->set = false;
-    memcpy(&rtentry->_old, &rtentry->route.p, sizeof(rtentry->_old));
-  }
+  _generation[domain->index]++;
 }
 
 /**
- * Initialize internal fields for dijkstra calculation
- * @param domain nhdp domain
- * @return true if source-specific and non-source specific can
- *   be handled in the same dijkstra run, false otherwise
+ * Remember the state of a routing entry before the current dijkstra
+ * run changes it for the first time
+ * @param rtentry routing entry
  */
 static void
-_prepare_nodes(void) {
-  struct olsrv2_tc_endpoint *end;
-  struct olsrv2_tc_node *node;
+_prepare_entry(struct olsrv2_routing_entry *rtentry) {
+  int index = rtentry->domain->index;
 
-  /* initialize private dijkstra data on nodes */
-  avl_for_each_element(olsrv2_tc_get_tree(), node, _originator_node) {
-    node->target._dijkstra.first_hop = NULL;
-    node->target._dijkstra.path_cost = RFC7181_METRIC_INFINITE_PATH;
-    node->target._dijkstra.path_hops = 255;
-    node->target._dijkstra.local =
-        olsrv2_originator_is_local(&node->target.prefix.dst);
-    node->target._dijkstra.done = false;
+  if (rtentry->_generation == _generation[index]) {
+    return;
   }
 
-  /* initialize private dijkstra data on endpoints */
-  avl_for_each_element(olsrv2_tc_get_endpoint_tree(), end, _node) {
-    end->target._dijkstra.first_hop = NULL;
-    end->target._dijkstra.path_cost = RFC7181_METRIC_INFINITE_PATH;
-    end->target._dijkstra.path_hops = 255;
-    end->target._dijkstra.done = false;
+  rtentry->_generation = _generation[index];
+  rtentry->_old_set = rtentry->set;
+  rtentry->set = false;
+  memcpy(&rtentry->_old, &rtentry->route.p, sizeof(rtentry->_old));
+
+  /* keep the refreshed entries at the end of the list */
+  list_remove(&rtentry->_refresh_node);
+  list_add_tail(&_refresh_list[index], &rtentry->_refresh_node);
+}
+
+/**
+ * Put a routing entry on the dirty list if the dijkstra result
+ * changed its kernel route, otherwise restore the parameters
+ * set by the last post-processing
+ * @param rtentry routing entry
+ */
+static void
+_check_entry_changed(struct olsrv2_routing_entry *rtentry) {
+  struct netaddr gw;
+  unsigned int if_index;
+
+  if (list_is_node_added(&rtentry->_dirty_node)) {
+    return;
+  }
+
+  if (rtentry->_warm) {
+    /* kernel route of a previous run, compare all parameters */
+    list_add_tail(&_dirty_list[rtentry->domain->index], &rtentry->_dirty_node);
+    return;
   }
+
+  if (rtentry->_old_set && rtentry->route.p.nexthop_id != 0
+      && rtentry->route.p.nexthop_id == rtentry->_old.nexthop_id) {
+    /* gateway changes are applied to the nexthop object */
+    memcpy(&gw, &rtentry->route.p.gw, sizeof(gw));
+    if_index = rtentry->route.p.if_index;
+
+    memcpy(&rtentry->route.p, &rtentry->_old, sizeof(rtentry->_old));
+    memcpy(&rtentry->route.p.gw, &gw, sizeof(gw));
+    rtentry->route.p.if_index = if_index;
+    return;
+  }
+
+  if (rtentry->_old_set
+      && rtentry->route.p.if_index == rtentry->_old.if_index
+      && netaddr_cmp(&rtentry->route.p.gw, &rtentry->_old.gw) == 0
+      && rtentry->route.p.nexthop_count == rtentry->_old.nexthop_count
+      && memcmp(rtentry->route.p.nexthops, rtentry->_old.nexthops,
+          sizeof(rtentry->_old.nexthops)) == 0) {
+    memcpy(&rtentry->route.p, &rtentry->_old, sizeof(rtentry->_old));
+    return;
+  }
+  list_add_tail(&_dirty_list[rtentry->domain->index], &rtentry->_dirty_node);
 }
 
 /**
- * calculates if source- and non-source-specific targets must be done
- * in separate dijkstra runs
- * @param domain nhdp domain for dijkstra run
- * @param af_family address family for dijkstra run
- * @return true if two dijkstra runs are necessary, false for one
+ * Put all routing entries of all domains on the dirty list, so their
+ * kernel routes are compared again during the next ROUTES phase
  */
-static bool
-_check_ssnode_split(struct nhdp_domain *domain, int af_family) {
+static void
+_mark_all_entries_dirty(void) {
+  struct olsrv2_routing_entry *rtentry;
+  int i;
+
+  for (i=0; i<NHDP_MAXIMUM_DOMAINS; i++) {
+    avl_for_each_element(&_routing_tree[i], rtentry, _node) {
+      if (!list_is_node_added(&rtentry->_dirty_node)) {
+        list_add_tail(&_dirty_list[i], &rtentry->_dirty_node);
+      }
+    }
+  }
+}
+
+/**
+ * Mark all routing entries that were not refreshed by the current
+ * dijkstra run for removal. They are at the start of the refresh list.
+ * @param domain nhdp domain
+ */
+static void
+_mark_stale_entries(struct nhdp_domain *domain) {
+  struct olsrv2_routing_entry *rtentry;
+
+  while (!list_is_empty(&_refresh_list[domain->index])) {
+    rtentry = list_first_element(&_refresh_list[domain->index], rtentry, _refresh_node);
+    if (rtentry->_generation == _generation[domain->index]) {
+      break;
+    }
+
+    if (rtentry->_warm && olsrv2_routing_warm_is_active(domain->index)) {
+      /* keep route of previous run until the network has converged */
+      rtentry->_generation = _generation[domain->index];
+      list_remove(&rtentry->_refresh_node);
+      list_add_tail(&_refresh_list[domain->index], &rtentry->_refresh_node);
+      continue;
+    }
+
+    _prepare_entry(rtentry);
+    if (!list_is_node_added(&rtentry->_dirty_node)) {
+      list_add_tail(&_dirty_list[domain->index], &rtentry->_dirty_node);
+    }
+  }
+}
+
+/**
+ * Calculates for all shortest path trees if source- and
+ * non-source-specific targets must be done on separate topologies.
+ * The source-specific sub-topology is calculated in the same
+ * dijkstra run with a second node for each tc node.
+ */
+static void
+_update_ssnode_split(void) {
   struct olsrv2_tc_node *node;
-  uint32_t ssnode_count, full_count;
-  bool ssnode_prefix;
+  struct nhdp_domain *domain;
+  struct olsrv2_spf_tree *spf;
+  uint32_t ssnode_count[2], full_count[2];
+  bool ssnode_prefix[NHDP_MAXIMUM_DOMAINS];
+  bool split;
+  int i, j;
 
-  ssnode_count = 0;
-  full_count = 0;
-  ssnode_prefix = false;
+  memset(ssnode_count, 0, sizeof(ssnode_count));
+  memset(full_count, 0, sizeof(full_count));
+  memset(ssnode_prefix, 0, sizeof(ssnode_prefix));
 
   avl_for_each_element(olsrv2_tc_get_tree(), node, _originator_node) {
     /* count number of source specific nodes */
-    if (netaddr_get_address_family(&node->target.prefix.dst) == af_family) {
-      full_count++;
-      if (node->source_specific) {
-        ssnode_count++;
-      }
+    j = netaddr_get_address_family(&node->target.prefix.dst) == AF_INET ? 0 : 1;
+    full_count[j]++;
+    if (node->source_specific) {
+      ssnode_count[j]++;
     }
 
     /* remember node domain with source specific prefix */
-    ssnode_prefix |= node->ss_attached_networks[domain->index];
+    for (i=0; i<NHDP_MAXIMUM_DOMAINS; i++) {
+      ssnode_prefix[i] |= node->ss_attached_networks[i];
+    }
+  }
+
+  list_for_each_element(nhdp_domain_get_list(), domain, _node) {
+    for (j=0; j<2; j++) {
+      spf = &_spf_trees[domain->index][j];
+      split = ssnode_count[j] != 0 && ssnode_count[j] != full_count[j]
+          && ssnode_prefix[domain->index];
+
+      OONF_INFO(LOG_OLSRV2_ROUTING, "ss split for %d/%d: %d of %d/%s",
+          domain->index, spf->af_family, ssnode_count[j], full_count[j],
+          ssnode_prefix[domain->index] ? "true" : "false");
+
+      if (split != spf->split) {
+        /* the tree gets or loses the nodes of the sub-topology */
+        spf->split = split;
+        dijkstra_invalidate(&spf->tree);
+      }
+    }
   }
+}
 
-  OONF_INFO(LOG_OLSRV2_ROUTING, "ss split for %d/%d: %d of %d/%s",
-      domain->index, af_family, ssnode_count, full_count,
-      ssnode_prefix ? "true" : "false");
+/**
+ * @param index domain index
+ * @param af_family address family
+ * @return shortest path tree of domain and address family
+ */
+static struct olsrv2_spf_tree *
+_get_spf_tree(int index, int af_family) {
+  return &_spf_trees[index][af_family == AF_INET ? 0 : 1];
+}
 
-  return ssnode_count != 0 && ssnode_count != full_count && ssnode_prefix;
+/**
+ * @param spf shortest path tree
+ * @param dnode node of shortest path tree, must not be the root
+ * @return tc node of shortest path tree node
+ */
+static struct olsrv2_tc_node *
+_get_tc_node(struct olsrv2_spf_tree *spf, const struct dijkstra_node *dnode) {
+  if (dnode->label == OLSRV2_SPF_SOURCE_SPECIFIC) {
+    return container_of(dnode - spf->index, struct olsrv2_tc_node, _dijkstra.ss_spf[0]);
+  }
+  return container_of(dnode - spf->index, struct olsrv2_tc_node, _dijkstra.spf[0]);
 }
 
 /**
- * Add the single-hop TC neighbors to the dijkstra working list
- * @param domain nhdp domain for dijkstra run
- * @param af_family address family for dijkstra run
- * @param use_non_ss include non-source-specific nodes into working list
- * @param use_ss include source-specific nodes into working list
+ * @param node tc node
+ * @param label label of shortest path tree node
+ * @return true if node can be used as a one-hop node or to forward
+ *   to other nodes in the topology of the label
+ */
+static bool
+_use_node(struct olsrv2_tc_node *node, enum olsrv2_spf_label label) {
+  return label == OLSRV2_SPF_FULL || node->source_specific;
+}
+
+/**
+ * @param edge tc edge
+ * @param index domain index
+ * @return link cost of edge usable for dijkstra,
+ *   RFC7181_METRIC_INFINITE if edge cannot be used
+ */
+static uint32_t
+_get_edge_cost(struct olsrv2_tc_edge *edge, int index) {
+  if (edge->virtual || edge->cost[index] > RFC7181_METRIC_MAX) {
+    return RFC7181_METRIC_INFINITE;
+  }
+  return edge->cost[index];
+}
+
+/**
+ * @param spf shortest path tree
+ * @param neigh nhdp neighbor
+ * @return link cost to neighbor usable for dijkstra,
+ *   RFC7181_METRIC_INFINITE if link cannot be used
+ */
+static uint32_t
+_get_neighbor_cost(struct olsrv2_spf_tree *spf, struct nhdp_neighbor *neigh) {
+  struct nhdp_neighbor_domaindata *neigh_metric;
+
+  if (netaddr_get_address_family(&neigh->originator) != spf->af_family
+      || neigh->symmetric == 0) {
+    return RFC7181_METRIC_INFINITE;
+  }
+
+  neigh_metric = nhdp_domain_get_neighbordata(spf->domain, neigh);
+  if (neigh_metric->metric.in > RFC7181_METRIC_MAX
+      || neigh_metric->metric.out > RFC7181_METRIC_MAX) {
+    /* ignore link with infinite metric */
+    return RFC7181_METRIC_INFINITE;
+  }
+  return neigh_metric->metric.out;
+}
+
+/**
+ * Remember that the edges of a tc node have to be compared with
+ * the shortest path trees during the next calculation
+ * @param node tc node
+ */
+static void
+_mark_node_dirty(struct olsrv2_tc_node *node) {
+  if (!list_is_node_added(&node->_dijkstra._dirty_node)) {
+    list_add_tail(&_dirty_nodes, &node->_dijkstra._dirty_node);
+  }
+}
+
+/**
+ * @return true if the originator addresses of the local node
+ *   changed since the last call
+ */
+static bool
+_check_originator_change(void) {
+  const struct netaddr *v4, *v6;
+  uint32_t count;
+
+  v4 = olsrv2_originator_get(AF_INET);
+  v6 = olsrv2_originator_get(AF_INET6);
+  count = olsrv2_originator_get_tree()->count;
+
+  if (netaddr_cmp(v4, &_spf_originator[0]) == 0
+      && netaddr_cmp(v6, &_spf_originator[1]) == 0
+      && count == _spf_originator_count) {
+    return false;
+  }
+
+  memcpy(&_spf_originator[0], v4, sizeof(*v4));
+  memcpy(&_spf_originator[1], v6, sizeof(*v6));
+  _spf_originator_count = count;
+  return true;
+}
+
+/**
+ * Mark all tc nodes that represent the local node
  */
 static void
-_add_one_hop_nodes(struct nhdp_domain *domain, int af_family,
-    bool use_non_ss, bool use_ss) {
+_update_local_nodes(void) {
+  struct olsrv2_tc_node *node;
+
+  avl_for_each_element(olsrv2_tc_get_tree(), node, _originator_node) {
+    node->_dijkstra.local =
+        olsrv2_originator_is_local(&node->target.prefix.dst);
+  }
+
+  olsrv2_routing_graph_mark_stale(AF_INET);
+  olsrv2_routing_graph_mark_stale(AF_INET6);
+}
+
+/**
+ * Report all topology changes since the last calculation
+ * to the shortest path trees
+ */
+static void
+_update_spf_trees(void) {
+  struct olsrv2_tc_node *node, *n_it;
+  struct olsrv2_tc_edge *edge;
+  struct nhdp_domain *domain;
+  struct olsrv2_spf_graph *graph;
+  struct olsrv2_spf_tree *spf;
+  uint32_t cost;
+  bool cost_changed, ss_changed;
+  int i, j;
+
+  if (_check_originator_change()) {
+    /* nodes might have become local or non-local */
+    _update_local_nodes();
+
+    /* source address of routes with unchanged nexthop is outdated */
+    _mark_all_entries_dirty();
+
+    for (i=0; i<NHDP_MAXIMUM_DOMAINS; i++) {
+      for (j=0; j<2; j++) {
+        dijkstra_invalidate(&_spf_trees[i][j].tree);
+      }
+    }
+  }
+
+  _update_ssnode_split();
+
+  /* compare edges of changed nodes with the costs the trees know about */
+  list_for_each_element_safe(&_dirty_nodes, node, _dijkstra._dirty_node, n_it) {
+    list_remove(&node->_dijkstra._dirty_node);
+
+    graph = olsrv2_routing_graph_get(netaddr_get_address_family(&node->target.prefix.dst));
+    if (olsrv2_routing_graph_has_node(graph, node)) {
+      /* source-specific status is part of the changed node data */
+      graph->flags[node->_dijkstra._graph_index] = olsrv2_routing_graph_get_flags(node);
+    }
+
+    /* source-specific sub-topology only uses edges of source-specific nodes */
+    ss_changed = node->_dijkstra._source_specific != node->source_specific;
+    node->_dijkstra._source_specific = node->source_specific;
+
+    avl_for_each_element(&node->_edges, edge, _node) {
+      for (i=0; i<NHDP_MAXIMUM_DOMAINS; i++) {
+        cost = _get_edge_cost(edge, i);
+        cost_changed = cost != edge->_spf_cost[i];
+        if (!cost_changed && !ss_changed) {
+          continue;
+        }
+
+        spf = _get_spf_tree(i, netaddr_get_address_family(&node->target.prefix.dst));
+        if (cost_changed) {
+          edge->_spf_cost[i] = cost;
+          olsrv2_routing_graph_set_cost(edge, i, cost);
+
+          dijkstra_edge_changed(&spf->tree,
+              &node->_dijkstra.spf[i], &edge->dst->_dijkstra.spf[i]);
+        }
+        if (spf->split) {
+          dijkstra_edge_changed(&spf->tree,
+              &node->_dijkstra.ss_spf[i], &edge->dst->_dijkstra.ss_spf[i]);
+        }
+      }
+    }
+  }
+
+  /* links to the one-hop neighbors are not tracked, check them all */
+  list_for_each_element(nhdp_domain_get_list(), domain, _node) {
+    spf = _get_spf_tree(domain->index, AF_INET);
+    spf->domain = domain;
+    _update_root_edges(spf);
+
+    spf = _get_spf_tree(domain->index, AF_INET6);
+    spf->domain = domain;
+    _update_root_edges(spf);
+  }
+}
+
+/**
+ * Compare the one-hop nodes of a shortest path tree with
+ * the current nhdp neighbors
+ * @param spf shortest path tree
+ */
+static void
+_update_root_edges(struct olsrv2_spf_tree *spf) {
+  struct dijkstra_node *child, *c_it;
   struct olsrv2_tc_node *node;
   struct nhdp_neighbor *neigh;
-  struct nhdp_neighbor_domaindata *neigh_metric;
-#ifdef OONF_LOG_DEBUG_INFO
-  struct netaddr_str nbuf;
+
+  dijkstra_for_each_child_safe(&spf->tree.root, child, c_it) {
+    node = _get_tc_node(spf, child);
+    neigh = nhdp_db_neighbor_get_by_originator(&node->target.prefix.dst);
+
+    if (neigh == NULL || !_use_node(node, child->label)
+        || _get_neighbor_cost(spf, neigh) != child->cost) {
+      dijkstra_edge_changed(&spf->tree, &spf->tree.root, child);
+    }
+  }
+
+  /* new neighbors or better links are found by relaxing all of them */
+  dijkstra_relax_again(&spf->tree, &spf->tree.root);
+}
+
+#ifdef OONF_PARALLEL_DIJKSTRA
+/**
+ * Calculate the shortest path trees of all domains and address
+ * families in the worker threads. The routing job only fills
+ * the routes of the calculated trees.
+ */
+static void
+_calculate_parallel(void) {
+  struct olsrv2_spf_tree *trees[DIJKSTRA_MAX_TREES];
+  struct nhdp_domain *domain;
+  struct olsrv2_spf_tree *spf;
+  int count, j;
+
+  count = 0;
+  list_for_each_element(nhdp_domain_get_list(), domain, _node) {
+    for (j=0; j<2; j++) {
+      spf = _get_spf_tree(domain->index, j == 0 ? AF_INET : AF_INET6);
+
+      _start_dijkstra(domain, spf);
+      spf->calculated = true;
+
+      trees[count++] = spf;
+    }
+  }
+
+  olsrv2_routing_parallel_calculate(trees, count);
+}
 #endif
 
-  OONF_DEBUG(LOG_OLSRV2_ROUTING, "Start add one-hop nodes");
+/**
+ * Calculate the equal cost first hops of all nodes reached by
+ * a shortest path tree. A node inherits the first hops of all
+ * its predecessors on a shortest path, which are settled before
+ * because every edge has a positive cost.
+ * @param spf shortest path tree
+ * @param label label of the nodes in the shortest path tree
+ * @param max_paths maximum number of first hops per node
+ */
+static void
+_calculate_multipath(struct olsrv2_spf_tree *spf, enum olsrv2_spf_label label, int max_paths) {
+  struct olsrv2_dijkstra_multipath *multipath, *src_multipath;
+  struct olsrv2_tc_node *node, *src, *primary;
+  struct olsrv2_tc_edge *edge;
+  struct nhdp_neighbor *neigh;
+  struct dijkstra_node *dnode, *src_dnode, **ptr;
+  size_t count, i;
+  int j;
 
-  /* initialize Dijkstra working queue with one-hop neighbors */
-  list_for_each_element(nhdp_db_get_neigh_list(), neigh, _global_node) {
-    if (netaddr_get_address_family(&neigh->originator) != af_family) {
+  /* collect and sort all reached nodes */
+  count = 0;
+  avl_for_each_element(olsrv2_tc_get_tree(), node, _originator_node) {
+    dnode = olsrv2_routing_get_spf_node(node, spf->index, label);
+    node->_dijkstra._multipath[label].count = 0;
+
+    if (netaddr_get_address_family(&node->target.prefix.dst) != spf->af_family
+        || !dijkstra_is_reached(dnode)) {
       continue;
     }
 
-    if (neigh->symmetric == 0
-        || (node = olsrv2_tc_node_get(&neigh->originator)) == NULL) {
-      continue;
+    if (count == _multipath_size) {
+      ptr = realloc(_multipath_nodes, (count + 64) * 2 * sizeof(*ptr));
+      if (ptr == NULL) {
+        OONF_WARN(LOG_OLSRV2_ROUTING, "Not enough memory for multipath calculation");
+        return;
+      }
+      _multipath_nodes = ptr;
+      _multipath_size = (count + 64) * 2;
+    }
+    _multipath_nodes[count++] = dnode;
+  }
+  qsort(_multipath_nodes, count, sizeof(*_multipath_nodes), _cb_cmp_dijkstra_cost);
+
+  for (i=0; i<count; i++) {
+    dnode = _multipath_nodes[i];
+    node = _get_tc_node(spf, dnode);
+    multipath = &node->_dijkstra._multipath[label];
+
+    /* the first hop of the shortest path tree is always used */
+    primary = _get_tc_node(spf, dnode->first_hop);
+    _add_first_hop(multipath, primary, primary, max_paths);
+
+    /* direct link to a neighbor */
+    neigh = nhdp_db_neighbor_get_by_originator(&node->target.prefix.dst);
+    if (neigh != NULL && _use_node(node, label)
+        && _get_neighbor_cost(spf, neigh) == dnode->cost) {
+      _add_first_hop(multipath, node, primary, max_paths);
     }
 
-    if (!use_non_ss && !(node->source_specific && use_ss)) {
-      continue;
+    /* the inverse of each edge points towards this node */
+    avl_for_each_element(&node->_edges, edge, _node) {
+      src = edge->inverse->src;
+      src_dnode = olsrv2_routing_get_spf_node(src, spf->index, label);
+
+      if (src->_dijkstra.local || !dijkstra_is_reached(src_dnode)
+          || !_use_node(src, label)
+          || edge->inverse->_spf_cost[spf->index] > RFC7181_METRIC_MAX
+          || src_dnode->cost >= dnode->cost
+          || src_dnode->cost + edge->inverse->_spf_cost[spf->index] != dnode->cost) {
+        continue;
+      }
+
+      src_multipath = &src->_dijkstra._multipath[label];
+      for (j=0; j<src_multipath->count; j++) {
+        _add_first_hop(multipath, src_multipath->first_hops[j], primary, max_paths);
+      }
     }
+  }
+}
 
-    neigh_metric = nhdp_domain_get_neighbordata(domain, neigh);
+/**
+ * Add a first hop to the sorted first hop array of a node. If the
+ * array is full, the primary first hop and the other first hops with
+ * the lowest originators are kept, so the result does not depend on
+ * the order of the calculation.
+ * @param multipath first hops of the node
+ * @param first_hop first hop towards the node
+ * @param primary first hop of the shortest path tree, never dropped
+ * @param max_paths maximum number of first hops
+ */
+static void
+_add_first_hop(struct olsrv2_dijkstra_multipath *multipath,
+    struct olsrv2_tc_node *first_hop, struct olsrv2_tc_node *primary, int max_paths) {
+  int i, j, last, cmp;
+
+  for (i=0; i<multipath->count; i++) {
+    cmp = netaddr_cmp(&first_hop->target.prefix.dst,
+        &multipath->first_hops[i]->target.prefix.dst);
+    if (cmp == 0) {
+      /* already known */
+      return;
+    }
+    if (cmp < 0) {
+      break;
+    }
+  }
 
-    if (neigh_metric->metric.in > RFC7181_METRIC_MAX
-        || neigh_metric->metric.out > RFC7181_METRIC_MAX) {
-      /* ignore link with infinite metric */
-      continue;
+  if (multipath->count < max_paths) {
+    last = multipath->count++;
+  }
+  else {
+    /* array is full, drop the highest first hop except the primary one */
+    last = multipath->count - 1;
+    if (multipath->first_hops[last] == primary) {
+      last--;
     }
+    if (i > last) {
+      return;
+    }
+  }
 
-    OONF_DEBUG(LOG_OLSRV2_ROUTING, "Add one-hop node %s",
-        netaddr_to_string(&nbuf, &neigh->originator));
+  for (j = last; j > i; j--) {
+    multipath->first_hops[j] = multipath->first_hops[j-1];
+  }
+  multipath->first_hops[i] = first_hop;
+}
 
-    /* found node for neighbor, add to worker list */
-    _insert_into_working_tree(&node->target, neigh,
-        neigh_metric->metric.out, 0, 0, 0, true,
-        olsrv2_originator_get(af_family));
+/**
+ * Compare two nodes of a shortest path tree by their path cost
+ * @param p1 pointer to pointer to first node
+ * @param p2 pointer to pointer to second node
+ * @return -1, 0 or 1
+ */
+static int
+_cb_cmp_dijkstra_cost(const void *p1, const void *p2) {
+  const struct dijkstra_node *n1 = *(struct dijkstra_node * const *)p1;
+  const struct dijkstra_node *n2 = *(struct dijkstra_node * const *)p2;
+
+  if (n1->cost != n2->cost) {
+    return n1->cost < n2->cost ? -1 : 1;
   }
+  return 0;
 }
 
 /**
- * Remove item from dijkstra working queue and process it
+ * Add the routes to a tc node and its attached networks
+ * to the routing set
  * @param domain nhdp domain
+ * @param spf shortest path tree of the current run
+ * @param node tc node
  */
 static void
-_handle_working_queue(struct nhdp_domain *domain,
-    bool use_non_ss, bool use_ss) {
-  struct olsrv2_tc_target *target;
-  struct nhdp_neighbor *first_hop;
+_add_node_routes(struct nhdp_domain *domain,
+    struct olsrv2_spf_tree *spf, struct olsrv2_tc_node *node) {
+  if (netaddr_get_address_family(&node->target.prefix.dst) != spf->af_family) {
+    return;
+  }
+
+  _add_label_routes(domain, spf, node, OLSRV2_SPF_FULL);
+  if (spf->split) {
+    _add_label_routes(domain, spf, node, OLSRV2_SPF_SOURCE_SPECIFIC);
+  }
+}
 
-  struct olsrv2_tc_node *tc_node;
-  struct olsrv2_tc_edge *tc_edge;
+/**
+ * Add the routes to a tc node and its attached networks
+ * reached in the full topology or the source-specific
+ * sub-topology to the routing set
+ * @param domain nhdp domain
+ * @param spf shortest path tree of the current run
+ * @param node tc node
+ * @param label label of the shortest path tree nodes
+ */
+static void
+_add_label_routes(struct nhdp_domain *domain, struct olsrv2_spf_tree *spf,
+    struct olsrv2_tc_node *node, enum olsrv2_spf_label label) {
   struct olsrv2_tc_attachment *tc_attached;
   struct olsrv2_tc_endpoint *tc_endpoint;
-
+  struct dijkstra_node *dnode;
+  struct nhdp_neighbor *first_hop;
+  const struct netaddr *last_originator;
+  const struct olsrv2_dijkstra_multipath *multipath;
+  uint8_t path_hops;
+  bool use_non_ss, use_ss;
 #ifdef OONF_LOG_DEBUG_INFO
-  struct netaddr_str nbuf1, nbuf2;
+  struct netaddr_str nbuf;
 #endif
 
-  /* get tc target */
-  target = avl_first_element(&_dijkstra_working_tree, target, _dijkstra._node);
+  dnode = olsrv2_routing_get_spf_node(node, domain->index, label);
+  if (!dijkstra_is_reached(dnode)) {
+    return;
+  }
+
+  /* without the sub-topology the full topology is used for all targets */
+  use_non_ss = label == OLSRV2_SPF_FULL;
+  use_ss = label == OLSRV2_SPF_SOURCE_SPECIFIC || !spf->split;
 
-  /* remove current node from working tree */
-  OONF_DEBUG(LOG_OLSRV2_ROUTING, "Remove node %s [%s] from dijkstra tree",
-      netaddr_to_string(&nbuf1, &target->prefix.dst),
-      netaddr_to_string(&nbuf2, &target->prefix.src));
-  avl_remove(&_dijkstra_working_tree, &target->_dijkstra._node);
+  first_hop = nhdp_db_neighbor_get_by_originator(
+      &_get_tc_node(spf, dnode->first_hop)->target.prefix.dst);
+  if (first_hop == NULL) {
+    return;
+  }
 
-  /* mark current node as done */
-  target->_dijkstra.done = true;
+  OONF_DEBUG(LOG_OLSRV2_ROUTING, "Node %s has pathcost %u (%u hops)",
+      netaddr_to_string(&nbuf, &node->target.prefix.dst), dnode->cost, dnode->hops);
+
+  if (dnode->parent == &spf->tree.root) {
+    last_originator = olsrv2_originator_get(spf->af_family);
+  }
+  else {
+    last_originator = &_get_tc_node(spf, dnode->parent)->target.prefix.dst;
+  }
+
+  path_hops = dnode->hops > 254 ? 255 : dnode->hops;
+
+  /* first hops are only calculated if the domain uses multipath routes */
+  multipath = _domain_parameter[domain->index].multipath > 1
+      ? &node->_dijkstra._multipath[label] : NULL;
 
   /* fill routing entry with dijkstra result */
   if (use_non_ss) {
-    _update_routing_entry(domain, &target->prefix,
-        target->_dijkstra.first_hop,
-        target->_dijkstra.distance,
-        target->_dijkstra.path_cost,
-        target->_dijkstra.path_hops,
-        target->_dijkstra.single_hop,
-        target->_dijkstra.last_originator);
-  }
-
-  if (target->type == OLSRV2_NODE_TARGET) {
-    /* get neighbor and its domain specific data */
-    first_hop = target->_dijkstra.first_hop;
-
-    /* calculate pointer of olsrv2_tc_node */
-    tc_node = container_of(target, struct olsrv2_tc_node, target);
-
-    /* iterate over edges */
-    avl_for_each_element(&tc_node->_edges, tc_edge, _node) {
-      if (!tc_edge->virtual && tc_edge->cost[domain->index] <= RFC7181_METRIC_MAX) {
-        if (!use_non_ss && !tc_node->source_specific) {
-          continue;
-        }
+    _update_routing_entry(domain, &node->target.prefix,
+        first_hop, 0, dnode->cost, path_hops,
+        dnode->parent == &spf->tree.root, last_originator, multipath);
+  }
 
-        /* add new tc_node to working tree */
-        _insert_into_working_tree(&tc_edge->dst->target, first_hop,
-            tc_edge->cost[domain->index],
-            target->_dijkstra.path_cost, target->_dijkstra.path_hops,
-            0, false, &target->prefix.dst);
-      }
-    }
+  path_hops = path_hops == 255 ? 255 : path_hops + 1;
 
-    /* iterate over attached networks and addresses */
-    avl_for_each_element(&tc_node->_attached_networks, tc_attached, _src_node) {
-      if (tc_attached->cost[domain->index] <= RFC7181_METRIC_MAX) {
-        tc_endpoint = tc_attached->dst;
+  /* iterate over attached networks and addresses */
+  avl_for_each_element(&node->_attached_networks, tc_attached, _src_node) {
+    if (tc_attached->cost[domain->index] > RFC7181_METRIC_MAX) {
+      continue;
+    }
 
-        if (!(netaddr_get_prefix_length(&tc_endpoint->target.prefix.src) > 0
-            ? use_ss : use_non_ss)) {
-          /* filter out (non-)source-specific targets if necessary */
-          continue;
-        }
-        if (tc_endpoint->_attached_networks.count > 1) {
-          /* add attached network or address to working tree */
-          _insert_into_working_tree(&tc_attached->dst->target, first_hop,
-              tc_attached->cost[domain->index],
-              target->_dijkstra.path_cost, target->_dijkstra.path_hops,
-              tc_attached->distance[domain->index], false,
-              &target->prefix.dst);
-        }
-        else {
-          /* no other way to this endpoint */
-          tc_endpoint->target._dijkstra.done = true;
-
-          /* fill routing entry with dijkstra result */
-          _update_routing_entry(domain, &tc_endpoint->target.prefix,
-              first_hop, tc_attached->distance[domain->index],
-              target->_dijkstra.path_cost + tc_attached->cost[domain->index],
-              tc_endpoint->target._dijkstra.path_hops + 1,
-              false, &target->prefix.dst);
-        }
-      }
+    tc_endpoint = tc_attached->dst;
+    if (!(netaddr_get_prefix_length(&tc_endpoint->target.prefix.src) > 0
+        ? use_ss : use_non_ss)) {
+      /* filter out (non-)source-specific targets if necessary */
+      continue;
     }
+    if (tc_endpoint->_attached_networks.count > 1 && !use_non_ss) {
+      /* endpoints reachable through multiple nodes need the full topology */
+      continue;
+    }
+
+    /* the cheapest attachment will win in the routing entry */
+    _update_routing_entry(domain, &tc_endpoint->target.prefix,
+        first_hop, tc_attached->distance[domain->index],
+        dnode->cost + tc_attached->cost[domain->index], path_hops,
+        false, &node->target.prefix.dst, multipath);
   }
 }
 
@@ -890,11 +1729,11 @@ _handle_nhdp_routes(struct nhdp_domain *domain) {
       /* update routing entry */
       if (olsrv2_originator_get(family)) {
         _update_routing_entry(domain, &ssprefix,
-            neigh, 0, neighcost, 1, true, olsrv2_originator_get(family));
+            neigh, 0, neighcost, 1, true, olsrv2_originator_get(family), NULL);
       }
       else {
         _update_routing_entry(domain, &ssprefix,
-            neigh, 0, neighcost, 1, true, &NETADDR_UNSPEC);
+            neigh, 0, neighcost, 1, true, &NETADDR_UNSPEC, NULL);
       }
     }
 
@@ -917,7 +1756,7 @@ _handle_nhdp_routes(struct nhdp_domain *domain) {
 
         /* the 2-hop route is better than the dijkstra calculation */
         _update_routing_entry(domain, &ssprefix,
-            neigh, 0, l2hop_pathcost, 2, false, &neigh->originator);
+            neigh, 0, l2hop_pathcost, 2, false, &neigh->originator, NULL);
       }
     }
   }
@@ -978,7 +1817,23 @@ _process_dijkstra_result(struct nhdp_domain *domain) {
   struct os_route_str rbuf1, rbuf2;
 #endif
 
-  avl_for_each_element(&_routing_tree[domain->index], rtentry, _node) {
+  /* routes that were not refreshed must be removed */
+  _mark_stale_entries(domain);
+
+  /* update nexthop objects before the routes using them */
+  olsrv2_routing_nexthop_update(domain);
+
+  while (!list_is_empty(&_dirty_list[domain->index])) {
+    rtentry = list_first_element(&_dirty_list[domain->index], rtentry, _dirty_node);
+    list_remove(&rtentry->_dirty_node);
+    rtentry->_warm = false;
+
+    if (!rtentry->set && !rtentry->_old_set && !rtentry->in_processing) {
+      /* kernel already removed the route during the calculation */
+      _remove_entry(rtentry);
+      continue;
+    }
+
     /* initialize rest of route parameters */
     rtentry->route.p.table = _domain_parameter[rtentry->domain->index].table;
     rtentry->route.p.protocol = _domain_parameter[rtentry->domain->index].protocol;
@@ -999,7 +1854,7 @@ _process_dijkstra_result(struct nhdp_domain *domain) {
       }
     }
 
-    if (rtentry->set
+    if (rtentry->set && rtentry->_old_set
         && memcmp(&rtentry->_old, &rtentry->route.p, sizeof(rtentry->_old)) == 0) {
       /* no change, ignore this entry */
       OONF_INFO(LOG_OLSRV2_ROUTING,
@@ -1048,6 +1903,367 @@ _process_kernel_queue(void) {
   }
 }
 
+/**
+ * Callback to run one step of the routing calculation
+ * @param job routing job
+ * @return true if routing calculation is finished, false otherwise
+ */
+static bool
+_cb_routing_step(struct oonf_job_instance *job __attribute__((unused))) {
+  uint64_t start, end;
+  bool finished;
+
+  os_clock_gettime64_ns(&start);
+  finished = _routing_step();
+  os_clock_gettime64_ns(&end);
+
+  _run_time += end - start;
+  if (finished) {
+    _finish_routing_run();
+  }
+  return finished;
+}
+
+/**
+ * Run one step of the routing calculation
+ * @return true if routing calculation is finished, false otherwise
+ */
+static bool
+_routing_step(void) {
+  struct nhdp_domain *domain;
+  struct olsrv2_spf_tree *spf;
+  int i;
+
+  domain = _job_domain;
+
+  if (_job_run_current < (int)ARRAYSIZE(_job_run_af_family)) {
+    spf = _get_spf_tree(domain->index, _job_run_af_family[_job_run_current]);
+
+    switch (_job_run_phase) {
+      case _PHASE_START:
+        if (spf->calculated) {
+          /*
+           * tree was calculated by the worker threads, the next phase
+           * only processes changes reported since then
+           */
+          spf->calculated = false;
+        }
+        else {
+          _start_dijkstra(domain, spf);
+        }
+        _job_run_phase = _PHASE_DIJKSTRA;
+        break;
+
+      case _PHASE_DIJKSTRA:
+        if (dijkstra_step(&spf->tree, DIJKSTRA_NODES_PER_STEP)) {
+          _finish_dijkstra(domain, spf);
+        }
+        break;
+
+      case _PHASE_ROUTES:
+      default:
+        for (i = 0; i < DIJKSTRA_NODES_PER_STEP && _job_route_node != NULL; i++) {
+          _add_node_routes(domain, spf, _job_route_node);
+          _job_route_node = avl_next_element_safe(
+              olsrv2_tc_get_tree(), _job_route_node, _originator_node);
+        }
+
+        if (_job_route_node == NULL) {
+          /* continue with next dijkstra run */
+          _job_run_current++;
+          _job_run_phase = _PHASE_START;
+        }
+        break;
+    }
+    return false;
+  }
+
+  /* check if direct one-hop routes are quicker */
+  _handle_nhdp_routes(domain);
+
+  /* update kernel routes */
+  _process_dijkstra_result(domain);
+
+  /* domain is finished, kernel callbacks cannot interfere anymore */
+  _job_domain = NULL;
+  _process_kernel_queue();
+
+  if (!list_is_last(nhdp_domain_get_list(), &domain->_node)) {
+    _start_domain(list_next_element(domain, _node));
+    return false;
+  }
+
+  return true;
+}
+
+/**
+ * Update the statistics after a routing calculation and start
+ * the hold-down before the next one. The hold-down is at least
+ * a multiple of the processing time to keep the calculation from
+ * starving the event loop.
+ */
+static void
+_finish_routing_run(void) {
+  uint64_t holddown;
+
+  _statistics.runs++;
+  _statistics.last_runtime = _run_time;
+  _statistics.total_runtime += _run_time;
+  if (_run_time > _statistics.max_runtime) {
+    _statistics.max_runtime = _run_time;
+  }
+
+  holddown = _run_time / 1000000ull * OLSRv2_DIJKSTRA_LOAD_FACTOR;
+  if (holddown < _holddown) {
+    holddown = _holddown;
+  }
+  if (holddown > _holddown_max) {
+    holddown = _holddown_max;
+  }
+  _statistics.holddown = holddown;
+
+  OONF_DEBUG(LOG_OLSRV2_ROUTING, "Dijkstra took %" PRIu64 " ns, hold-down %" PRIu64 " ms",
+      _run_time, holddown);
+
+  /* make sure dijkstra is not called too often */
+  _holddown_active = true;
+  oonf_timer_set(&_rate_limit_timer, holddown);
+}
+
+/**
+ * Callback triggered when a tc node, tc endpoint or nhdp neighbor
+ * is removed. The running calculation might reference it, so
+ * it is restarted.
+ * @param ptr pointer to removed object
+ */
+static void
+_cb_topology_removed(void *ptr __attribute__((unused))) {
+  olsrv2_routing_restart_job();
+}
+
+/**
+ * Restart a running routing calculation because
+ * topology data it might reference changed
+ */
+void
+olsrv2_routing_restart_job(void) {
+  if (_abort_routing_job()) {
+    olsrv2_routing_trigger_update();
+  }
+}
+
+/**
+ * Callback to relax the outgoing edges of a node of a shortest path tree
+ * @param tree shortest path tree
+ * @param dnode node of shortest path tree
+ */
+static void
+_cb_spf_expand(struct dijkstra_tree *tree, struct dijkstra_node *dnode) {
+  struct olsrv2_spf_graph *graph;
+  struct olsrv2_spf_tree *spf;
+  struct olsrv2_tc_node *node;
+  struct olsrv2_tc_edge *edge;
+  struct nhdp_neighbor *neigh;
+  uint32_t cost;
+
+  spf = container_of(tree, struct olsrv2_spf_tree, tree);
+
+  if (dnode == &tree->root) {
+    /* add the single-hop TC neighbors */
+    list_for_each_element(nhdp_db_get_neigh_list(), neigh, _global_node) {
+      node = olsrv2_tc_node_get(&neigh->originator);
+      if (node == NULL || node->_dijkstra.local) {
+        continue;
+      }
+
+      cost = _get_neighbor_cost(spf, neigh);
+      if (cost > RFC7181_METRIC_MAX) {
+        continue;
+      }
+
+      dijkstra_relax(tree, dnode, &node->_dijkstra.spf[spf->index], cost);
+      if (spf->split && _use_node(node, OLSRV2_SPF_SOURCE_SPECIFIC)) {
+        dijkstra_relax(tree, dnode, &node->_dijkstra.ss_spf[spf->index], cost);
+      }
+    }
+    return;
+  }
+
+  node = _get_tc_node(spf, dnode);
+  if (!_use_node(node, dnode->label)) {
+    return;
+  }
+
+  graph = olsrv2_routing_graph_get(spf->af_family);
+  if (graph->valid) {
+    olsrv2_routing_graph_expand(spf, graph, dnode, node->_dijkstra._graph_index);
+    return;
+  }
+
+  avl_for_each_element(&node->_edges, edge, _node) {
+    if (edge->_spf_cost[spf->index] <= RFC7181_METRIC_MAX
+        && !edge->dst->_dijkstra.local) {
+      dijkstra_relax(tree, dnode,
+          olsrv2_routing_get_spf_node(edge->dst, spf->index, dnode->label),
+          edge->_spf_cost[spf->index]);
+    }
+  }
+}
+
+/**
+ * Callback to relax the incoming edges of a node of a shortest path tree
+ * @param tree shortest path tree
+ * @param dnode node of shortest path tree
+ */
+static void
+_cb_spf_expand_incoming(struct dijkstra_tree *tree, struct dijkstra_node *dnode) {
+  struct olsrv2_spf_graph *graph;
+  struct olsrv2_spf_tree *spf;
+  struct olsrv2_tc_node *node, *src;
+  struct olsrv2_tc_edge *edge;
+  struct nhdp_neighbor *neigh;
+  uint32_t cost;
+
+  spf = container_of(tree, struct olsrv2_spf_tree, tree);
+  node = _get_tc_node(spf, dnode);
+
+  if (node->_dijkstra.local) {
+    return;
+  }
+
+  graph = olsrv2_routing_graph_get(spf->af_family);
+  if (graph->valid) {
+    olsrv2_routing_graph_expand_incoming(spf, graph, dnode, node->_dijkstra._graph_index);
+  }
+  else {
+    /* the inverse of each edge points towards this node */
+    avl_for_each_element(&node->_edges, edge, _node) {
+      src = edge->inverse->src;
+      cost = edge->inverse->_spf_cost[spf->index];
+
+      if (cost <= RFC7181_METRIC_MAX && _use_node(src, dnode->label)) {
+        dijkstra_relax(tree,
+            olsrv2_routing_get_spf_node(src, spf->index, dnode->label), dnode, cost);
+      }
+    }
+  }
+
+  neigh = nhdp_db_neighbor_get_by_originator(&node->target.prefix.dst);
+  if (neigh != NULL && _use_node(node, dnode->label)) {
+    cost = _get_neighbor_cost(spf, neigh);
+    if (cost <= RFC7181_METRIC_MAX) {
+      dijkstra_relax(tree, &tree->root, dnode, cost);
+    }
+  }
+}
+
+/**
+ * Callback to decide between paths with the same cost, prefers
+ * the lower originator address to make the result independent
+ * of the order changes were processed in.
+ * @param tree shortest path tree
+ * @param dn1 first node of shortest path tree
+ * @param dn2 second node of shortest path tree
+ * @return <0 if first node is preferred, >0 if second, 0 if same node
+ */
+static int
+_cb_spf_compare(struct dijkstra_tree *tree,
+    const struct dijkstra_node *dn1, const struct dijkstra_node *dn2) {
+  struct olsrv2_spf_tree *spf;
+
+  if (dn1 == dn2) {
+    return 0;
+  }
+  if (dn1 == &tree->root) {
+    return -1;
+  }
+  if (dn2 == &tree->root) {
+    return 1;
+  }
+
+  spf = container_of(tree, struct olsrv2_spf_tree, tree);
+  return netaddr_cmp(&_get_tc_node(spf, dn1)->target.prefix.dst,
+      &_get_tc_node(spf, dn2)->target.prefix.dst);
+}
+
+/**
+ * Callback triggered when a tc node is added
+ * @param ptr pointer to tc node
+ */
+static void
+_cb_tc_node_added(void *ptr) {
+  struct olsrv2_tc_node *node = ptr;
+
+  node->_dijkstra.local = olsrv2_originator_is_local(&node->target.prefix.dst);
+  _mark_node_dirty(node);
+  olsrv2_routing_graph_mark_stale(netaddr_get_address_family(&node->target.prefix.dst));
+}
+
+/**
+ * Callback triggered when the edges of a tc node were updated
+ * @param ptr pointer to tc node
+ */
+static void
+_cb_tc_node_changed(void *ptr) {
+  _mark_node_dirty(ptr);
+}
+
+/**
+ * Callback triggered when a tc edge is added,
+ * its cost will be set afterwards
+ * @param ptr pointer to tc edge
+ */
+static void
+_cb_tc_edge_added(void *ptr) {
+  struct olsrv2_tc_edge *edge = ptr;
+
+  _mark_node_dirty(edge->src);
+
+  if (!olsrv2_routing_graph_has_node(olsrv2_routing_graph_get(
+      netaddr_get_address_family(&edge->src->target.prefix.dst)), edge->src)) {
+    /* new edge */
+    olsrv2_routing_graph_mark_stale(netaddr_get_address_family(&edge->src->target.prefix.dst));
+  }
+}
+
+/**
+ * Callback triggered when a tc edge is removed. The edge becomes
+ * virtual or is freed, so it has to be removed from the
+ * shortest path trees now. A running calculation would lose the
+ * subtree behind the edge, so it is restarted.
+ * @param ptr pointer to tc edge
+ */
+static void
+_cb_tc_edge_removed(void *ptr) {
+  struct olsrv2_tc_edge *edge = ptr;
+  struct olsrv2_spf_tree *spf;
+  int i;
+
+  olsrv2_routing_restart_job();
+
+  for (i=0; i<NHDP_MAXIMUM_DOMAINS; i++) {
+    if (edge->_spf_cost[i] == RFC7181_METRIC_INFINITE) {
+      continue;
+    }
+
+    edge->_spf_cost[i] = RFC7181_METRIC_INFINITE;
+    olsrv2_routing_graph_set_cost(edge, i, RFC7181_METRIC_INFINITE);
+
+    spf = _get_spf_tree(i, netaddr_get_address_family(&edge->src->target.prefix.dst));
+    dijkstra_edge_changed(&spf->tree,
+        &edge->src->_dijkstra.spf[i], &edge->dst->_dijkstra.spf[i]);
+    if (spf->split) {
+      dijkstra_edge_changed(&spf->tree,
+          &edge->src->_dijkstra.ss_spf[i], &edge->dst->_dijkstra.ss_spf[i]);
+    }
+  }
+
+  if (edge->inverse->virtual) {
+    /* both directions of the edge will be freed */
+    olsrv2_routing_graph_mark_stale(netaddr_get_address_family(&edge->src->target.prefix.dst));
+  }
+}
+
 /**
  * Callback for checking if dijkstra was triggered during
  * rate limitation time
@@ -1055,9 +2271,25 @@ _process_kernel_queue(void) {
  */
 static void
 _cb_trigger_dijkstra(struct oonf_timer_instance *ptr __attribute__((unused))) {
+  if (_holddown_active) {
+    _holddown_active = false;
+
+    if (_trigger_dijkstra) {
+      /* topology is still changing, back off */
+      _holddown *= 2;
+      if (_holddown > _holddown_max) {
+        _holddown = _holddown_max;
+      }
+    }
+    else {
+      /* topology was stable during the hold-down */
+      _holddown = _holddown_min;
+    }
+  }
+
   if (_trigger_dijkstra) {
     _trigger_dijkstra = false;
-    olsrv2_routing_force_update(false);
+    _start_routing(false);
   }
 }
 
@@ -1070,6 +2302,45 @@ _cb_nhdp_update(struct nhdp_neighbor *neigh __attribute__((unused))) {
   olsrv2_routing_trigger_update();
 }
 
+/**
+ * Handle a kernel route result for a routing entry the running
+ * calculation already changed. The kernel request was done with
+ * the parameters stored in _old, the ROUTES phase of the calculation
+ * compares them with the new result.
+ * @param rtentry routing entry
+ * @param error 0 if no error happened
+ */
+static void
+_handle_job_route_result(struct olsrv2_routing_entry *rtentry, int error) {
+  struct os_route_str rbuf;
+
+  if (error == -1) {
+    /* someone called an interrupt */
+    return;
+  }
+
+  if (error != 0
+      && !(rtentry->_old_set && error == EEXIST)
+      && !(!rtentry->_old_set && error == ESRCH)) {
+    OONF_WARN(LOG_OLSRV2_ROUTING, "Error in route %s %s: %s (%d)",
+        rtentry->_old_set ? "setting" : "removal",
+            os_routing_to_string(&rbuf, &rtentry->_old),
+            strerror(error), error);
+
+    /* attempted change did not happen */
+    rtentry->_old_set = !rtentry->_old_set;
+  }
+  else {
+    OONF_INFO(LOG_OLSRV2_ROUTING, "Successfully %s route %s",
+        rtentry->_old_set ? "set" : "removed",
+        os_routing_to_string(&rbuf, &rtentry->_old));
+  }
+
+  if (!list_is_node_added(&rtentry->_dirty_node)) {
+    list_add_tail(&_dirty_list[rtentry->domain->index], &rtentry->_dirty_node);
+  }
+}
+
 /**
  * Callback for kernel route processing results
  * @param route pointer to kernel route
@@ -1085,6 +2356,13 @@ _cb_route_finished(struct os_route *route, int error) {
   /* kernel is not processing this route anymore */
   rtentry->in_processing = false;
 
+  if (rtentry->domain == _job_domain
+      && rtentry->_generation == _generation[rtentry->domain->index]) {
+    /* entry was already changed by the running calculation */
+    _handle_job_route_result(rtentry, error);
+    return;
+  }
+
   if (!rtentry->set && error == ESRCH) {
     OONF_DEBUG(LOG_OLSRV2_ROUTING, "Route %s was already gone",
         os_routing_to_string(&rbuf, &rtentry->route.p));
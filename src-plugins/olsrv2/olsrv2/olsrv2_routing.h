@@ -48,6 +48,7 @@
 
 #include "common/avl.h"
 #include "common/common_types.h"
+#include "common/dijkstra.h"
 #include "common/list.h"
 #include "common/netaddr.h"
 
@@ -57,42 +58,59 @@
 #include "nhdp/nhdp_db.h"
 #include "nhdp/nhdp_domain.h"
 
-/*! minimum time between two dijkstra calculations in milliseconds */
-enum { OLSRv2_DIJKSTRA_RATE_LIMITATION = 1000 };
+/*! default minimum hold-down time between two dijkstra calculations in milliseconds */
+enum { OLSRv2_DIJKSTRA_MIN_HOLDDOWN = 100 };
 
-/**
- * representation of a node in the dijkstra tree
- */
-struct olsrv2_dijkstra_node {
-  /*! hook into the working list of the dijkstra */
-  struct avl_node _node;
+/*! default maximum hold-down time between two dijkstra calculations in milliseconds */
+enum { OLSRv2_DIJKSTRA_MAX_HOLDDOWN = 10000 };
 
-  /*! total path cost */
-  uint32_t path_cost;
+/*! hold-down after a dijkstra calculation is at least this multiple of its run time */
+enum { OLSRv2_DIJKSTRA_LOAD_FACTOR = 4 };
 
-  /*! path hops to the target */
-  uint8_t path_hops;
+/*! first id of kernel nexthop objects used by olsrv2 routes */
+#define OLSRv2_NEXTHOP_ID_BASE 0x4f4c0000u
 
-  /*! hopcount to be inserted into the route */
-  uint8_t distance;
+struct olsrv2_tc_node;
 
-  /*! pointer to nhpd neighbor that represents the first hop */
-  struct nhdp_neighbor *first_hop;
+/**
+ * equal cost first hops of a node in the current calculation
+ */
+struct olsrv2_dijkstra_multipath {
+  /*! first hops, sorted by originator */
+  struct olsrv2_tc_node *first_hops[OS_ROUTE_MAX_NEXTHOPS];
+
+  /*! number of first hops */
+  uint8_t count;
+};
+
+/**
+ * representation of a node in the dijkstra tree
+ */
+struct olsrv2_dijkstra_node {
+  /*! node of the shortest path tree of each domain */
+  struct dijkstra_node spf[NHDP_MAXIMUM_DOMAINS];
 
   /**
-   * address of the last originator in the routing tree before
-   * the destination
+   * node of the source-specific sub-topology in the shortest path
+   * tree of each domain, only used if the domain has source-specific
+   * and non-source-specific nodes
    */
-  const struct netaddr *last_originator;
+  struct dijkstra_node ss_spf[NHDP_MAXIMUM_DOMAINS];
 
-  /*! true if route is single-hop */
-  bool single_hop;
+  /*! hook into list of nodes whose edges must be checked for changes */
+  struct list_entity _dirty_node;
 
   /*! true if this node is ourself */
   bool local;
 
-  /*! true if node already has been processed */
-  bool done;
+  /*! source-specific flag of the node known to the shortest path trees */
+  bool _source_specific;
+
+  /*! equal cost first hops in the full topology and the source-specific sub-topology */
+  struct olsrv2_dijkstra_multipath _multipath[2];
+
+  /*! index of the node in the compact graph of its address family */
+  uint32_t _graph_index;
 };
 
 /**
@@ -129,6 +147,21 @@ struct olsrv2_routing_entry {
   /*! old values of route before current dijstra run */
   struct os_route_parameter _old;
 
+  /*! value of set before current dijkstra run */
+  bool _old_set;
+
+  /*! true if entry was read from the kernel and not yet compared to a dijkstra result */
+  bool _warm;
+
+  /*! dijkstra run of the domain that refreshed this entry last */
+  uint32_t _generation;
+
+  /*! hook into list of all entries of the domain, sorted by last refresh */
+  struct list_entity _refresh_node;
+
+  /*! hook into list of entries changed by the current dijkstra run */
+  struct list_entity _dirty_node;
+
   /*! hook into working queues */
   struct list_entity _working_node;
 
@@ -154,6 +187,15 @@ struct olsrv2_routing_domain {
 
   /*! domain uses source specific routing */
   bool source_specific;
+
+  /*! maximum number of equal cost paths of a route, 1 to disable multipath */
+  int multipath;
+
+  /*! true if routes should reference one kernel nexthop object per neighbor */
+  bool use_nexthop_objects;
+
+  /*! time to keep kernel routes of a previous run at startup, 0 to ignore them */
+  uint64_t warm_restart;
 };
 
 /**
@@ -173,16 +215,45 @@ struct olsrv2_routing_filter {
   struct list_entity _node;
 };
 
+/**
+ * Statistics of the dijkstra triggers and calculations
+ */
+struct olsrv2_routing_statistics {
+  /*! number of requested routing updates */
+  uint64_t triggers;
+
+  /*! number of requests merged into an already pending update */
+  uint64_t coalesced;
+
+  /*! number of finished routing calculations */
+  uint64_t runs;
+
+  /*! processing time of the last calculation in nanoseconds */
+  uint64_t last_runtime;
+
+  /*! longest processing time of a calculation in nanoseconds */
+  uint64_t max_runtime;
+
+  /*! processing time of all calculations in nanoseconds */
+  uint64_t total_runtime;
+
+  /*! hold-down time after the last calculation in milliseconds */
+  uint64_t holddown;
+};
+
 void olsrv2_routing_init(void);
 void olsrv2_routing_initiate_shutdown(void);
 void olsrv2_routing_cleanup(void);
 
 void olsrv2_routing_dijkstra_node_init(struct olsrv2_dijkstra_node *);
+void olsrv2_routing_dijkstra_node_cleanup(struct olsrv2_tc_node *);
 
 EXPORT void olsrv2_routing_set_domain_parameter(struct nhdp_domain *domain,
     struct olsrv2_routing_domain *parameter);
 
 EXPORT void olsrv2_routing_force_update(bool skip_wait);
+EXPORT void olsrv2_routing_set_holddown(uint64_t min_holddown, uint64_t max_holddown);
+EXPORT const struct olsrv2_routing_statistics *olsrv2_routing_get_statistics(void);
 EXPORT void olsrv2_routing_trigger_update(void);
 
 EXPORT const struct olsrv2_routing_domain *
@@ -190,6 +261,7 @@ EXPORT const struct olsrv2_routing_domain *
 
 EXPORT struct avl_tree *olsrv2_routing_get_tree(struct nhdp_domain *domain);
 EXPORT struct list_entity *olsrv2_routing_get_filter_list(void);
+EXPORT void olsrv2_routing_reapply_filters(void);
 
 /**
  * Add a routing filter to the dijkstra processing list
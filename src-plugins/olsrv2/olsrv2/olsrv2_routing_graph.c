@@ -0,0 +1,377 @@
+
+/*
+ * The olsr.org Optimized Link-State Routing daemon version 2 (olsrd2)
+ * Copyright (c) 2004-2015, the olsr.org team - see HISTORY file
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in
+ *   the documentation and/or other materials provided with the
+ *   distribution.
+ * * Neither the name of olsr.org, olsrd nor the names of its
+ *   contributors may be used to endorse or promote products derived
+ *   from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Visit http://www.olsr.org for more information.
+ *
+ * If you find this software useful feel free to make a donation
+ * to the project. For more information see the website or contact
+ * the copyright holders.
+ *
+ */
+
+/**
+ * @file
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "common/avl.h"
+#include "common/common_types.h"
+#include "common/dijkstra.h"
+#include "common/netaddr.h"
+#include "core/oonf_logging.h"
+
+#include "olsrv2/olsrv2_internal.h"
+#include "olsrv2/olsrv2_routing_internal.h"
+#include "olsrv2/olsrv2_tc.h"
+
+/* prototypes */
+static uint32_t _find_graph_edge(struct olsrv2_spf_graph *graph, uint32_t src, uint32_t dst);
+static int _build_spf_graph(struct olsrv2_spf_graph *graph, int af_family);
+static void _free_spf_graph(struct olsrv2_spf_graph *graph);
+
+/* compact tc graph for each address family */
+static struct olsrv2_spf_graph _spf_graphs[2];
+
+/**
+ * Free the compact graphs
+ */
+void
+olsrv2_routing_graph_cleanup(void) {
+  _free_spf_graph(&_spf_graphs[0]);
+  _free_spf_graph(&_spf_graphs[1]);
+}
+
+/**
+ * @param af_family address family
+ * @return compact tc graph of address family
+ */
+struct olsrv2_spf_graph *
+olsrv2_routing_graph_get(int af_family) {
+  return &_spf_graphs[af_family == AF_INET ? 0 : 1];
+}
+
+/**
+ * @param node tc node
+ * @return compact graph flags of node
+ */
+uint8_t
+olsrv2_routing_graph_get_flags(struct olsrv2_tc_node *node) {
+  return (node->_dijkstra.local ? OLSRV2_GRAPH_LOCAL : 0)
+      | (node->source_specific ? OLSRV2_GRAPH_SOURCE_SPECIFIC : 0);
+}
+
+/**
+ * @param graph compact graph
+ * @param node tc node
+ * @return true if node and all its edges are part of the graph
+ */
+bool
+olsrv2_routing_graph_has_node(struct olsrv2_spf_graph *graph, struct olsrv2_tc_node *node) {
+  uint32_t idx = node->_dijkstra._graph_index;
+
+  return graph->valid && idx < graph->node_count && graph->nodes[idx] == node
+      && graph->first_edge[idx+1] - graph->first_edge[idx] == node->_edges.count;
+}
+
+/**
+ * Look for an edge in the compact graph
+ * @param graph compact graph
+ * @param src index of source node
+ * @param dst index of destination node
+ * @return index of edge, UINT32_MAX if not in graph
+ */
+static uint32_t
+_find_graph_edge(struct olsrv2_spf_graph *graph, uint32_t src, uint32_t dst) {
+  uint32_t low, high, mid;
+
+  /* edges of a node are sorted by destination */
+  low = graph->first_edge[src];
+  high = graph->first_edge[src+1];
+  while (low < high) {
+    mid = low + (high - low) / 2;
+    if (graph->edge_dst[mid] == dst) {
+      return mid;
+    }
+    if (graph->edge_dst[mid] < dst) {
+      low = mid + 1;
+    }
+    else {
+      high = mid;
+    }
+  }
+  return UINT32_MAX;
+}
+
+/**
+ * Copy the new cost of a tc edge into the compact graph, it might
+ * be used by a running calculation before it is rebuilt.
+ * @param edge tc edge
+ * @param index domain index
+ * @param cost new cost of edge
+ */
+void
+olsrv2_routing_graph_set_cost(struct olsrv2_tc_edge *edge, int index, uint32_t cost) {
+  struct olsrv2_spf_graph *graph;
+  uint32_t src, dst, e;
+
+  graph = olsrv2_routing_graph_get(netaddr_get_address_family(&edge->src->target.prefix.dst));
+  src = edge->src->_dijkstra._graph_index;
+  dst = edge->dst->_dijkstra._graph_index;
+
+  if (!graph->valid
+      || src >= graph->node_count || graph->nodes[src] != edge->src
+      || dst >= graph->node_count || graph->nodes[dst] != edge->dst) {
+    return;
+  }
+
+  e = _find_graph_edge(graph, src, dst);
+  if (e != UINT32_MAX) {
+    graph->cost[(size_t)index * graph->edge_count + e] = cost;
+  }
+}
+
+/**
+ * Rebuild the compact graph of an address family before the
+ * next calculation
+ * @param af_family address family
+ */
+void
+olsrv2_routing_graph_mark_stale(int af_family) {
+  olsrv2_routing_graph_get(af_family)->stale = true;
+}
+
+/**
+ * Rebuild the compact graphs whose tc nodes or edges changed.
+ * Compile with OLSRV2_NO_SPF_GRAPH to let dijkstra walk the
+ * tc database instead.
+ */
+void
+olsrv2_routing_graph_update(void) {
+  struct olsrv2_spf_graph *graph;
+  int i;
+
+#ifdef OLSRV2_NO_SPF_GRAPH
+  return;
+#endif
+
+  for (i=0; i<2; i++) {
+    graph = &_spf_graphs[i];
+    if (graph->valid && !graph->stale) {
+      continue;
+    }
+
+    graph->valid = _build_spf_graph(graph, i == 0 ? AF_INET : AF_INET6) == 0;
+    graph->stale = false;
+
+    if (!graph->valid) {
+      OONF_WARN(LOG_OLSRV2_ROUTING, "Could not build compact %s graph,"
+          " dijkstra uses the tc database", i == 0 ? "ipv4" : "ipv6");
+    }
+  }
+}
+
+/**
+ * Build the compact graph of an address family from the tc database
+ * @param graph compact graph
+ * @param af_family address family
+ * @return -1 if out of memory, 0 otherwise
+ */
+static int
+_build_spf_graph(struct olsrv2_spf_graph *graph, int af_family) {
+  struct olsrv2_tc_node *node;
+  struct olsrv2_tc_edge *edge;
+  uint32_t node_count, edge_count, idx, e, inv;
+  void *ptr;
+  int i;
+
+  node_count = 0;
+  edge_count = 0;
+  avl_for_each_element(olsrv2_tc_get_tree(), node, _originator_node) {
+    if (netaddr_get_address_family(&node->target.prefix.dst) == af_family) {
+      node_count++;
+      edge_count += node->_edges.count;
+    }
+  }
+
+  if (node_count + 1 > graph->node_size) {
+    _free_spf_graph(graph);
+    graph->node_size = node_count + 1 + node_count / 4;
+    graph->nodes = calloc(graph->node_size, sizeof(*graph->nodes));
+    graph->flags = calloc(graph->node_size, sizeof(*graph->flags));
+    graph->first_edge = calloc(graph->node_size, sizeof(*graph->first_edge));
+    if (graph->nodes == NULL || graph->flags == NULL || graph->first_edge == NULL) {
+      _free_spf_graph(graph);
+      return -1;
+    }
+  }
+
+  if (edge_count > graph->edge_size || graph->edge_dst == NULL) {
+    idx = edge_count + 1 + edge_count / 4;
+
+    ptr = realloc(graph->edge_dst, idx * sizeof(*graph->edge_dst));
+    if (ptr == NULL) {
+      return -1;
+    }
+    graph->edge_dst = ptr;
+
+    ptr = realloc(graph->edge_inverse, idx * sizeof(*graph->edge_inverse));
+    if (ptr == NULL) {
+      return -1;
+    }
+    graph->edge_inverse = ptr;
+
+    ptr = realloc(graph->cost, (size_t)idx * NHDP_MAXIMUM_DOMAINS * sizeof(*graph->cost));
+    if (ptr == NULL) {
+      return -1;
+    }
+    graph->cost = ptr;
+    graph->edge_size = idx;
+  }
+
+  graph->node_count = node_count;
+  graph->edge_count = edge_count;
+
+  /* number the nodes in tc tree order */
+  idx = 0;
+  e = 0;
+  avl_for_each_element(olsrv2_tc_get_tree(), node, _originator_node) {
+    if (netaddr_get_address_family(&node->target.prefix.dst) != af_family) {
+      continue;
+    }
+
+    node->_dijkstra._graph_index = idx;
+    graph->nodes[idx] = node;
+    graph->flags[idx] = olsrv2_routing_graph_get_flags(node);
+    graph->first_edge[idx] = e;
+
+    idx++;
+    e += node->_edges.count;
+  }
+  graph->first_edge[idx] = e;
+
+  /* edges are sorted by destination address, so by index too */
+  for (idx = 0; idx < node_count; idx++) {
+    e = graph->first_edge[idx];
+    avl_for_each_element(&graph->nodes[idx]->_edges, edge, _node) {
+      graph->edge_dst[e] = edge->dst->_dijkstra._graph_index;
+      for (i=0; i<NHDP_MAXIMUM_DOMAINS; i++) {
+        graph->cost[(size_t)i * edge_count + e] = edge->_spf_cost[i];
+      }
+      e++;
+    }
+  }
+
+  for (idx = 0; idx < node_count; idx++) {
+    for (e = graph->first_edge[idx]; e < graph->first_edge[idx+1]; e++) {
+      inv = _find_graph_edge(graph, graph->edge_dst[e], idx);
+      if (inv == UINT32_MAX) {
+        /* every tc edge has an inverse */
+        return -1;
+      }
+      graph->edge_inverse[e] = inv;
+    }
+  }
+
+  OONF_DEBUG(LOG_OLSRV2_ROUTING, "Compact %s graph: %u nodes, %u edges",
+      af_family == AF_INET ? "ipv4" : "ipv6", node_count, edge_count);
+  return 0;
+}
+
+/**
+ * Free the memory of a compact graph
+ * @param graph compact graph
+ */
+static void
+_free_spf_graph(struct olsrv2_spf_graph *graph) {
+  free(graph->nodes);
+  free(graph->flags);
+  free(graph->first_edge);
+  free(graph->edge_dst);
+  free(graph->edge_inverse);
+  free(graph->cost);
+
+  memset(graph, 0, sizeof(*graph));
+}
+
+/**
+ * Relax the outgoing edges of a node with the compact graph,
+ * the node must be usable for the topology of its label
+ * @param spf shortest path tree
+ * @param graph compact graph of the address family of the tree
+ * @param dnode node of shortest path tree
+ * @param idx index of the node in the compact graph
+ */
+void
+olsrv2_routing_graph_expand(struct olsrv2_spf_tree *spf, struct olsrv2_spf_graph *graph,
+    struct dijkstra_node *dnode, uint32_t idx) {
+  const uint32_t *cost;
+  uint32_t e, dst;
+
+  cost = &graph->cost[(size_t)spf->index * graph->edge_count];
+  for (e = graph->first_edge[idx]; e < graph->first_edge[idx+1]; e++) {
+    dst = graph->edge_dst[e];
+    if (cost[e] <= RFC7181_METRIC_MAX && (graph->flags[dst] & OLSRV2_GRAPH_LOCAL) == 0) {
+      dijkstra_relax(&spf->tree, dnode,
+          olsrv2_routing_get_spf_node(graph->nodes[dst], spf->index, dnode->label), cost[e]);
+    }
+  }
+}
+
+/**
+ * Relax the incoming edges of a node with the compact graph,
+ * the inverse of each edge points towards the node
+ * @param spf shortest path tree
+ * @param graph compact graph of the address family of the tree
+ * @param dnode node of shortest path tree
+ * @param idx index of the node in the compact graph
+ */
+void
+olsrv2_routing_graph_expand_incoming(struct olsrv2_spf_tree *spf, struct olsrv2_spf_graph *graph,
+    struct dijkstra_node *dnode, uint32_t idx) {
+  const uint32_t *cost;
+  uint32_t e, src, c;
+
+  cost = &graph->cost[(size_t)spf->index * graph->edge_count];
+  for (e = graph->first_edge[idx]; e < graph->first_edge[idx+1]; e++) {
+    src = graph->edge_dst[e];
+    c = cost[graph->edge_inverse[e]];
+
+    if (c <= RFC7181_METRIC_MAX && (dnode->label == OLSRV2_SPF_FULL
+        || (graph->flags[src] & OLSRV2_GRAPH_SOURCE_SPECIFIC) != 0)) {
+      dijkstra_relax(&spf->tree,
+          olsrv2_routing_get_spf_node(graph->nodes[src], spf->index, dnode->label), dnode, c);
+    }
+  }
+}
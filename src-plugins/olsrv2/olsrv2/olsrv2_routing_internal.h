@@ -0,0 +1,216 @@
+
+/*
+ * The olsr.org Optimized Link-State Routing daemon version 2 (olsrd2)
+ * Copyright (c) 2004-2015, the olsr.org team - see HISTORY file
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in
+ *   the documentation and/or other materials provided with the
+ *   distribution.
+ * * Neither the name of olsr.org, olsrd nor the names of its
+ *   contributors may be used to endorse or promote products derived
+ *   from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Visit http://www.olsr.org for more information.
+ *
+ * If you find this software useful feel free to make a donation
+ * to the project. For more information see the website or contact
+ * the copyright holders.
+ *
+ */
+
+/**
+ * @file
+ */
+
+#ifndef OLSRV2_ROUTING_INTERNAL_H_
+#define OLSRV2_ROUTING_INTERNAL_H_
+
+#include "common/common_types.h"
+#include "common/dijkstra.h"
+
+#include "nhdp/nhdp_db.h"
+#include "nhdp/nhdp_domain.h"
+
+#include "olsrv2/olsrv2_tc.h"
+#include "olsrv2/olsrv2_routing.h"
+
+/* headers only for use inside the olsrv2 routing code */
+
+/* number of shortest path trees (domains and address families) */
+#define DIJKSTRA_MAX_TREES (NHDP_MAXIMUM_DOMAINS * 2)
+
+/**
+ * labels of the nodes of a shortest path tree
+ */
+enum olsrv2_spf_label {
+  /*! node in the full topology */
+  OLSRV2_SPF_FULL = 0,
+
+  /*! node in the sub-topology of the source-specific nodes */
+  OLSRV2_SPF_SOURCE_SPECIFIC = 1,
+};
+
+/**
+ * shortest path tree of a domain and address family
+ */
+struct olsrv2_spf_tree {
+  /*! incremental shortest path tree */
+  struct dijkstra_tree tree;
+
+  /*! nhdp domain of the last calculation */
+  struct nhdp_domain *domain;
+
+  /*! index of the domain */
+  int index;
+
+  /*! address family of tree */
+  int af_family;
+
+  /**
+   * true if the source-specific sub-topology is calculated in the
+   * same run, with a second node for each tc node
+   */
+  bool split;
+
+  /*! true if the tree was calculated before the routing job started */
+  bool calculated;
+};
+
+/**
+ * flags of a node in the compact graph
+ */
+enum olsrv2_graph_flags {
+  /*! node is ourself */
+  OLSRV2_GRAPH_LOCAL = 1<<0,
+
+  /*! node is source-specific */
+  OLSRV2_GRAPH_SOURCE_SPECIFIC = 1<<1,
+};
+
+/**
+ * Compact copy of the tc graph of one address family, the shortest
+ * path calculation walks these arrays instead of the edge trees of
+ * the tc nodes. The outgoing edges of node i are the edges from
+ * first_edge[i] to first_edge[i+1]-1, in the order of the edge tree
+ * of the node. Nodes are sorted like the tc tree, so the destinations
+ * of the edges of a node are sorted too.
+ */
+struct olsrv2_spf_graph {
+  /*! tc node of each index */
+  struct olsrv2_tc_node **nodes;
+
+  /*! olsrv2_graph_flags of each node */
+  uint8_t *flags;
+
+  /*! index of the first outgoing edge of each node, plus end of edges */
+  uint32_t *first_edge;
+
+  /*! index of the destination node of each edge */
+  uint32_t *edge_dst;
+
+  /*! index of the inverse of each edge */
+  uint32_t *edge_inverse;
+
+  /*! cost of edge e in domain d is cost[d * edge_count + e] */
+  uint32_t *cost;
+
+  /*! number of nodes */
+  uint32_t node_count;
+
+  /*! number of edges */
+  uint32_t edge_count;
+
+  /*! allocated number of nodes */
+  uint32_t node_size;
+
+  /*! allocated number of edges */
+  uint32_t edge_size;
+
+  /*! true if the arrays match the tc database */
+  bool valid;
+
+  /*! true if the tc database changed and the graph must be rebuilt */
+  bool stale;
+};
+
+/* olsrv2_routing.c */
+void olsrv2_routing_restart_job(void);
+struct olsrv2_routing_entry *olsrv2_routing_entry_add(
+    struct nhdp_domain *, struct os_route_key *prefix);
+void olsrv2_routing_entry_set_unrefreshed(struct olsrv2_routing_entry *rtentry);
+
+/* olsrv2_routing_graph.c */
+struct olsrv2_spf_graph *olsrv2_routing_graph_get(int af_family);
+uint8_t olsrv2_routing_graph_get_flags(struct olsrv2_tc_node *node);
+bool olsrv2_routing_graph_has_node(
+    struct olsrv2_spf_graph *graph, struct olsrv2_tc_node *node);
+void olsrv2_routing_graph_set_cost(struct olsrv2_tc_edge *edge, int index, uint32_t cost);
+void olsrv2_routing_graph_mark_stale(int af_family);
+void olsrv2_routing_graph_update(void);
+void olsrv2_routing_graph_cleanup(void);
+void olsrv2_routing_graph_expand(struct olsrv2_spf_tree *spf,
+    struct olsrv2_spf_graph *graph, struct dijkstra_node *dnode, uint32_t idx);
+void olsrv2_routing_graph_expand_incoming(struct olsrv2_spf_tree *spf,
+    struct olsrv2_spf_graph *graph, struct dijkstra_node *dnode, uint32_t idx);
+
+/* olsrv2_routing_parallel.c */
+#ifdef OONF_PARALLEL_DIJKSTRA
+void olsrv2_routing_parallel_init(void);
+void olsrv2_routing_parallel_cleanup(void);
+void olsrv2_routing_parallel_calculate(struct olsrv2_spf_tree **trees, int count);
+#endif
+
+/* olsrv2_routing_nexthop.c */
+void olsrv2_routing_nexthop_init(void);
+void olsrv2_routing_nexthop_cleanup(void);
+uint32_t olsrv2_routing_nexthop_get_id(struct nhdp_domain *domain,
+    struct nhdp_neighbor *neigh, int af_family);
+void olsrv2_routing_nexthop_reserve_id(uint32_t id);
+bool olsrv2_routing_nexthop_is_usable(void);
+void olsrv2_routing_nexthop_update(struct nhdp_domain *domain);
+void olsrv2_routing_nexthop_remove(struct nhdp_domain *domain);
+
+/* olsrv2_routing_warm.c */
+void olsrv2_routing_warm_init(void);
+void olsrv2_routing_warm_initiate_shutdown(void);
+void olsrv2_routing_warm_cleanup(void);
+void olsrv2_routing_warm_start(struct nhdp_domain *domain);
+bool olsrv2_routing_warm_is_active(int index);
+
+/**
+ * @param node tc node
+ * @param index domain index
+ * @param label label of shortest path tree node
+ * @return shortest path tree node of tc node
+ */
+static INLINE struct dijkstra_node *
+olsrv2_routing_get_spf_node(struct olsrv2_tc_node *node,
+    int index, enum olsrv2_spf_label label) {
+  if (label == OLSRV2_SPF_SOURCE_SPECIFIC) {
+    return &node->_dijkstra.ss_spf[index];
+  }
+  return &node->_dijkstra.spf[index];
+}
+
+#endif /* OLSRV2_ROUTING_INTERNAL_H_ */
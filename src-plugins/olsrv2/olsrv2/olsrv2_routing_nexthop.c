@@ -0,0 +1,329 @@
+
+/*
+ * The olsr.org Optimized Link-State Routing daemon version 2 (olsrd2)
+ * Copyright (c) 2004-2015, the olsr.org team - see HISTORY file
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in
+ *   the documentation and/or other materials provided with the
+ *   distribution.
+ * * Neither the name of olsr.org, olsrd nor the names of its
+ *   contributors may be used to endorse or promote products derived
+ *   from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Visit http://www.olsr.org for more information.
+ *
+ * If you find this software useful feel free to make a donation
+ * to the project. For more information see the website or contact
+ * the copyright holders.
+ *
+ */
+
+/**
+ * @file
+ */
+
+#include <errno.h>
+#include <string.h>
+
+#include "common/common_types.h"
+#include "common/list.h"
+#include "common/netaddr.h"
+#include "core/oonf_logging.h"
+#include "subsystems/oonf_class.h"
+#include "subsystems/os_routing.h"
+
+#include "nhdp/nhdp_db.h"
+#include "nhdp/nhdp_domain.h"
+
+#include "olsrv2/olsrv2_internal.h"
+#include "olsrv2/olsrv2_routing_internal.h"
+#include "olsrv2/olsrv2_routing.h"
+
+/**
+ * kernel nexthop object of a nhdp neighbor for one domain and address family
+ */
+struct _routing_nexthop {
+  /*! nexthop object, id is 0 until a route uses it */
+  struct os_nexthop os;
+
+  /*! true if kernel nexthop object matches the current best link */
+  bool installed;
+};
+
+/* prototypes */
+static struct _routing_nexthop *_get_routing_nexthop(
+    struct nhdp_domain *domain, struct nhdp_neighbor *neigh, int af_family);
+static void _cb_nhdp_neighbor_added(void *);
+static void _cb_nhdp_neighbor_removed(void *);
+static void _cb_nexthop_finished(struct os_nexthop *nexthop, int error);
+
+/* kernel nexthop objects of each domain and address family of a neighbor */
+static struct oonf_class_extension _nhdp_neighbor_listener = {
+  .ext_name = "olsrv2 routing",
+  .class_name = NHDP_CLASS_NEIGHBOR,
+  .size = sizeof(struct _routing_nexthop) * NHDP_MAXIMUM_DOMAINS * 2,
+  .cb_add = _cb_nhdp_neighbor_added,
+  .cb_remove = _cb_nhdp_neighbor_removed,
+};
+
+/* next id for kernel nexthop objects */
+static uint32_t _next_nexthop_id = OLSRv2_NEXTHOP_ID_BASE;
+
+/* true if the kernel rejected nexthop objects, routes use gateways again */
+static bool _nexthop_objects_failed;
+
+/**
+ * Initialize kernel nexthop objects of the nhdp neighbors
+ */
+void
+olsrv2_routing_nexthop_init(void) {
+  oonf_class_extension_add(&_nhdp_neighbor_listener);
+}
+
+/**
+ * Remove all kernel nexthop objects and cleanup
+ */
+void
+olsrv2_routing_nexthop_cleanup(void) {
+  struct nhdp_domain *domain;
+
+  list_for_each_element(nhdp_domain_get_list(), domain, _node) {
+    olsrv2_routing_nexthop_remove(domain);
+  }
+
+  oonf_class_extension_remove(&_nhdp_neighbor_listener);
+}
+
+/**
+ * Make sure a nexthop id used by a kernel route of a previous
+ * run is not allocated again
+ * @param id nexthop id in use
+ */
+void
+olsrv2_routing_nexthop_reserve_id(uint32_t id) {
+  if (id >= _next_nexthop_id) {
+    _next_nexthop_id = id + 1;
+  }
+}
+
+/**
+ * @return true if routes can reference kernel nexthop objects
+ */
+bool
+olsrv2_routing_nexthop_is_usable(void) {
+  return !_nexthop_objects_failed && os_routing_supports_nexthop_objects();
+}
+
+/**
+ * @param domain nhdp domain
+ * @param neigh nhdp neighbor
+ * @param af_family address family of nexthop
+ * @return nexthop object of neighbor
+ */
+static struct _routing_nexthop *
+_get_routing_nexthop(struct nhdp_domain *domain,
+    struct nhdp_neighbor *neigh, int af_family) {
+  struct _routing_nexthop *nexthops;
+
+  nexthops = oonf_class_get_extension(&_nhdp_neighbor_listener, neigh);
+  return &nexthops[domain->index * 2 + (af_family == AF_INET ? 0 : 1)];
+}
+
+/**
+ * Get the id of the kernel nexthop object of a neighbor,
+ * allocate a new one if the neighbor has none yet.
+ * @param domain nhdp domain
+ * @param neigh nhdp neighbor
+ * @param af_family address family of nexthop
+ * @return nexthop id
+ */
+uint32_t
+olsrv2_routing_nexthop_get_id(struct nhdp_domain *domain,
+    struct nhdp_neighbor *neigh, int af_family) {
+  struct _routing_nexthop *nexthop;
+
+  nexthop = _get_routing_nexthop(domain, neigh, af_family);
+  if (nexthop->os.id == 0) {
+    nexthop->os.id = _next_nexthop_id++;
+    if (_next_nexthop_id == 0) {
+      _next_nexthop_id = OLSRv2_NEXTHOP_ID_BASE;
+    }
+  }
+  return nexthop->os.id;
+}
+
+/**
+ * Update the kernel nexthop objects of all neighbors whose
+ * best link changed. This moves all routes through
+ * the neighbor with a single kernel update.
+ * @param domain nhdp domain
+ */
+void
+olsrv2_routing_nexthop_update(struct nhdp_domain *domain) {
+  struct nhdp_neighbor_domaindata *neighdata;
+  struct _routing_nexthop *nexthop;
+  struct nhdp_neighbor *neigh;
+  const struct olsrv2_routing_domain *parameter;
+  struct netaddr_str nbuf;
+  int af_family;
+
+  parameter = olsrv2_routing_get_parameters(domain);
+  list_for_each_element(nhdp_db_get_neigh_list(), neigh, _global_node) {
+    neighdata = nhdp_domain_get_neighbordata(domain, neigh);
+    if (neighdata->best_link == NULL) {
+      continue;
+    }
+
+    af_family = netaddr_get_address_family(&neighdata->best_link->if_addr);
+    if (af_family != AF_INET && af_family != AF_INET6) {
+      continue;
+    }
+
+    nexthop = _get_routing_nexthop(domain, neigh, af_family);
+    if (nexthop->os.id == 0) {
+      /* no route uses this nexthop */
+      continue;
+    }
+
+    if (nexthop->installed
+        && nexthop->os.protocol == parameter->protocol
+        && nexthop->os.if_index == neighdata->best_link_ifindex
+        && netaddr_cmp(&nexthop->os.gw, &neighdata->best_link->if_addr) == 0) {
+      continue;
+    }
+
+    os_routing_interrupt_nexthop(&nexthop->os);
+
+    nexthop->os.protocol = parameter->protocol;
+    nexthop->os.if_index = neighdata->best_link_ifindex;
+    memcpy(&nexthop->os.gw, &neighdata->best_link->if_addr, sizeof(nexthop->os.gw));
+
+    OONF_INFO(LOG_OLSRV2_ROUTING, "Set nexthop %u: %s (%u)",
+        nexthop->os.id, netaddr_to_string(&nbuf, &nexthop->os.gw),
+        nexthop->os.if_index);
+
+    nexthop->installed = os_routing_set_nexthop(&nexthop->os, true) == 0;
+    if (!nexthop->installed) {
+      OONF_WARN(LOG_OLSRV2_ROUTING, "Could not set nexthop %u: %s",
+          nexthop->os.id, netaddr_to_string(&nbuf, &nexthop->os.gw));
+    }
+  }
+}
+
+/**
+ * Remove all kernel nexthop objects of a domain. The kernel
+ * removes all routes still using them.
+ * @param domain nhdp domain
+ */
+void
+olsrv2_routing_nexthop_remove(struct nhdp_domain *domain) {
+  struct _routing_nexthop *nexthop;
+  struct nhdp_neighbor *neigh;
+  int i;
+
+  list_for_each_element(nhdp_db_get_neigh_list(), neigh, _global_node) {
+    for (i=0; i<2; i++) {
+      nexthop = _get_routing_nexthop(domain, neigh, i == 0 ? AF_INET : AF_INET6);
+      os_routing_interrupt_nexthop(&nexthop->os);
+
+      if (nexthop->installed) {
+        /* no feedback necessary */
+        nexthop->os.cb_finished = NULL;
+        os_routing_set_nexthop(&nexthop->os, false);
+        nexthop->os.cb_finished = _cb_nexthop_finished;
+      }
+      nexthop->os.id = 0;
+      nexthop->installed = false;
+    }
+  }
+}
+
+/**
+ * Callback triggered when a nhdp neighbor is added
+ * @param ptr nhdp neighbor
+ */
+static void
+_cb_nhdp_neighbor_added(void *ptr) {
+  struct _routing_nexthop *nexthops;
+  size_t i;
+
+  nexthops = oonf_class_get_extension(&_nhdp_neighbor_listener, ptr);
+  for (i=0; i<NHDP_MAXIMUM_DOMAINS * 2; i++) {
+    nexthops[i].os.cb_finished = _cb_nexthop_finished;
+  }
+}
+
+/**
+ * Callback triggered when a nhdp neighbor is removed. Its
+ * nexthop objects are removed from the kernel, the routes
+ * using them will be recalculated.
+ * @param ptr nhdp neighbor
+ */
+static void
+_cb_nhdp_neighbor_removed(void *ptr) {
+  struct _routing_nexthop *nexthops;
+  size_t i;
+
+  olsrv2_routing_restart_job();
+
+  nexthops = oonf_class_get_extension(&_nhdp_neighbor_listener, ptr);
+  for (i=0; i<NHDP_MAXIMUM_DOMAINS * 2; i++) {
+    nexthops[i].os.cb_finished = NULL;
+    os_routing_interrupt_nexthop(&nexthops[i].os);
+
+    if (nexthops[i].installed) {
+      os_routing_set_nexthop(&nexthops[i].os, false);
+    }
+  }
+}
+
+/**
+ * Callback for kernel feedback of a nexthop object
+ * @param nexthop os nexthop
+ * @param error 0 if no error happened
+ */
+static void
+_cb_nexthop_finished(struct os_nexthop *nexthop, int error) {
+  struct _routing_nexthop *rt_nexthop;
+
+  if (error == 0 || error == -1) {
+    /* success or interrupted */
+    return;
+  }
+
+  rt_nexthop = container_of(nexthop, struct _routing_nexthop, os);
+  rt_nexthop->installed = false;
+
+  OONF_WARN(LOG_OLSRV2_ROUTING, "Error in setting nexthop %u: %s (%d)",
+      nexthop->id, strerror(error), error);
+
+  if (error == EOPNOTSUPP || error == EAFNOSUPPORT || error == EINVAL) {
+    /* kernel cannot handle nexthop objects, fall back to gateway routes */
+    OONF_WARN(LOG_OLSRV2_ROUTING, "Disable nexthop objects");
+    _nexthop_objects_failed = true;
+  }
+
+  /* retry or rewrite the routes using this nexthop */
+  olsrv2_routing_trigger_update();
+}
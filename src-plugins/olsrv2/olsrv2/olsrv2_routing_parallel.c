@@ -0,0 +1,200 @@
+
+/*
+ * The olsr.org Optimized Link-State Routing daemon version 2 (olsrd2)
+ * Copyright (c) 2004-2015, the olsr.org team - see HISTORY file
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in
+ *   the documentation and/or other materials provided with the
+ *   distribution.
+ * * Neither the name of olsr.org, olsrd nor the names of its
+ *   contributors may be used to endorse or promote products derived
+ *   from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Visit http://www.olsr.org for more information.
+ *
+ * If you find this software useful feel free to make a donation
+ * to the project. For more information see the website or contact
+ * the copyright holders.
+ *
+ */
+
+/**
+ * @file
+ */
+
+#include <errno.h>
+#include <pthread.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "common/common_types.h"
+#include "common/dijkstra.h"
+#include "core/oonf_logging.h"
+
+#include "olsrv2/olsrv2_internal.h"
+#include "olsrv2/olsrv2_routing_internal.h"
+
+/* prototypes */
+static void _calculate_parallel_trees(void);
+static void *_cb_dijkstra_worker(void *);
+
+/* shortest path trees calculated by the worker threads */
+static struct olsrv2_spf_tree **_parallel_trees;
+static int _parallel_count;
+
+/* index of the next tree to be taken by a worker, accessed atomically */
+static int _parallel_next;
+
+/* worker threads, created once and reused for every calculation */
+static pthread_t _worker_threads[DIJKSTRA_MAX_TREES];
+static int _worker_count;
+
+/* synchronization between mainloop and worker threads */
+static pthread_mutex_t _worker_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t _worker_start = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t _worker_done = PTHREAD_COND_INITIALIZER;
+static uint32_t _worker_round;
+static int _worker_busy;
+static bool _worker_shutdown;
+
+/**
+ * Create the worker threads for parallel dijkstra. The mainloop
+ * thread is one of the workers, so one thread less than the number
+ * of cpus is created.
+ */
+void
+olsrv2_routing_parallel_init(void) {
+  long cpus;
+  int i;
+
+  cpus = sysconf(_SC_NPROCESSORS_ONLN);
+  if (cpus > DIJKSTRA_MAX_TREES) {
+    cpus = DIJKSTRA_MAX_TREES;
+  }
+
+  _worker_shutdown = false;
+  for (i=0; i<cpus-1; i++) {
+    if (pthread_create(&_worker_threads[i], NULL, _cb_dijkstra_worker, NULL)) {
+      OONF_WARN(LOG_OLSRV2_ROUTING, "Could not create dijkstra thread: %s (%d)",
+          strerror(errno), errno);
+      break;
+    }
+  }
+  _worker_count = i;
+}
+
+/**
+ * Stop and join all worker threads for parallel dijkstra
+ */
+void
+olsrv2_routing_parallel_cleanup(void) {
+  int i;
+
+  pthread_mutex_lock(&_worker_mutex);
+  _worker_shutdown = true;
+  pthread_cond_broadcast(&_worker_start);
+  pthread_mutex_unlock(&_worker_mutex);
+
+  for (i=0; i<_worker_count; i++) {
+    pthread_join(_worker_threads[i], NULL);
+  }
+  _worker_count = 0;
+}
+
+/**
+ * Calculate started shortest path trees in the worker threads.
+ * The mainloop waits for the workers, so the topology database
+ * stays unchanged while they read it. Each tree only writes
+ * its own nodes.
+ * @param trees array of started shortest path trees
+ * @param count number of trees
+ */
+void
+olsrv2_routing_parallel_calculate(struct olsrv2_spf_tree **trees, int count) {
+  _parallel_trees = trees;
+  _parallel_count = count;
+  _parallel_next = 0;
+
+  pthread_mutex_lock(&_worker_mutex);
+  _worker_round++;
+  _worker_busy = _worker_count;
+  pthread_cond_broadcast(&_worker_start);
+  pthread_mutex_unlock(&_worker_mutex);
+
+  _calculate_parallel_trees();
+
+  pthread_mutex_lock(&_worker_mutex);
+  while (_worker_busy > 0) {
+    pthread_cond_wait(&_worker_done, &_worker_mutex);
+  }
+  pthread_mutex_unlock(&_worker_mutex);
+
+  OONF_DEBUG(LOG_OLSRV2_ROUTING, "Parallel dijkstra used %d threads", _worker_count + 1);
+}
+
+/**
+ * Calculate shortest path trees until no tree is left
+ */
+static void
+_calculate_parallel_trees(void) {
+  struct olsrv2_spf_tree *spf;
+  int i;
+
+  while ((i = __atomic_fetch_add(&_parallel_next, 1, __ATOMIC_RELAXED)) < _parallel_count) {
+    spf = _parallel_trees[i];
+    while (!dijkstra_step(&spf->tree, UINT32_MAX)) {}
+  }
+}
+
+/**
+ * Worker thread for parallel dijkstra, waits for the mainloop
+ * to start a calculation until the workers are stopped.
+ * @param ptr unused
+ * @return always NULL
+ */
+static void *
+_cb_dijkstra_worker(void *ptr __attribute__((unused))) {
+  uint32_t round = 0;
+
+  pthread_mutex_lock(&_worker_mutex);
+  while (true) {
+    while (!_worker_shutdown && round == _worker_round) {
+      pthread_cond_wait(&_worker_start, &_worker_mutex);
+    }
+    if (_worker_shutdown) {
+      break;
+    }
+    round = _worker_round;
+    pthread_mutex_unlock(&_worker_mutex);
+
+    _calculate_parallel_trees();
+
+    pthread_mutex_lock(&_worker_mutex);
+    if (--_worker_busy == 0) {
+      pthread_cond_signal(&_worker_done);
+    }
+  }
+  pthread_mutex_unlock(&_worker_mutex);
+  return NULL;
+}
@@ -0,0 +1,326 @@
+
+/*
+ * The olsr.org Optimized Link-State Routing daemon version 2 (olsrd2)
+ * Copyright (c) 2004-2015, the olsr.org team - see HISTORY file
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in
+ *   the documentation and/or other materials provided with the
+ *   distribution.
+ * * Neither the name of olsr.org, olsrd nor the names of its
+ *   contributors may be used to endorse or promote products derived
+ *   from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Visit http://www.olsr.org for more information.
+ *
+ * If you find this software useful feel free to make a donation
+ * to the project. For more information see the website or contact
+ * the copyright holders.
+ *
+ */
+
+/**
+ * @file
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "common/avl.h"
+#include "common/common_types.h"
+#include "common/list.h"
+#include "common/netaddr.h"
+#include "core/oonf_logging.h"
+#include "subsystems/oonf_timer.h"
+#include "subsystems/os_routing.h"
+
+#include "nhdp/nhdp_domain.h"
+
+#include "olsrv2/olsrv2_internal.h"
+#include "olsrv2/olsrv2_routing_internal.h"
+#include "olsrv2/olsrv2_routing.h"
+
+/* prototypes */
+static struct nhdp_domain *_get_query_domain(struct os_route *filter);
+static void _cb_warm_query(struct os_route *filter, struct os_route *route);
+static void _cb_warm_query_finished(struct os_route *filter, int error);
+static void _cb_warm_restart_timeout(struct oonf_timer_instance *);
+
+/* convergence timeout for kernel routes of a previous run */
+static struct oonf_timer_class _warm_restart_timer_info = {
+  .name = "Warm restart convergence timer",
+  .callback = _cb_warm_restart_timeout,
+};
+
+static struct oonf_timer_instance _warm_restart_timer[NHDP_MAXIMUM_DOMAINS];
+
+/* kernel queries for routes of a previous run */
+static struct os_route _warm_query[NHDP_MAXIMUM_DOMAINS];
+
+/* nexthop objects referenced by kernel routes of a previous run */
+static uint32_t *_warm_nexthop_ids;
+static size_t _warm_nexthop_count;
+
+/**
+ * Initialize warm restart of the kernel routes of a previous run
+ */
+void
+olsrv2_routing_warm_init(void) {
+  int i;
+
+  oonf_timer_add(&_warm_restart_timer_info);
+  for (i=0; i<NHDP_MAXIMUM_DOMAINS; i++) {
+    _warm_restart_timer[i].class = &_warm_restart_timer_info;
+  }
+}
+
+/**
+ * Stop reading kernel routes of a previous run
+ */
+void
+olsrv2_routing_warm_initiate_shutdown(void) {
+  int i;
+
+  for (i=0; i<NHDP_MAXIMUM_DOMAINS; i++) {
+    _warm_query[i].cb_finished = NULL;
+    os_routing_interrupt(&_warm_query[i]);
+    oonf_timer_stop(&_warm_restart_timer[i]);
+  }
+}
+
+/**
+ * Cleanup warm restart of the kernel routes of a previous run
+ */
+void
+olsrv2_routing_warm_cleanup(void) {
+  int i;
+
+  free(_warm_nexthop_ids);
+  _warm_nexthop_ids = NULL;
+  _warm_nexthop_count = 0;
+
+  for (i=0; i<NHDP_MAXIMUM_DOMAINS; i++) {
+    os_routing_interrupt(&_warm_query[i]);
+    oonf_timer_stop(&_warm_restart_timer[i]);
+  }
+
+  oonf_timer_remove(&_warm_restart_timer_info);
+}
+
+/**
+ * Read the routes of a previous run from the kernel. They are
+ * kept until the first routing calculations confirm or replace
+ * them, so traffic keeps flowing while the network converges.
+ * @param domain nhdp domain
+ */
+void
+olsrv2_routing_warm_start(struct nhdp_domain *domain) {
+  const struct olsrv2_routing_domain *parameter;
+  struct os_route *query;
+
+  parameter = olsrv2_routing_get_parameters(domain);
+  query = &_warm_query[domain->index];
+  if (os_routing_is_in_progress(query)) {
+    return;
+  }
+
+  os_routing_init_wildcard_route(query);
+  query->cb_get = _cb_warm_query;
+  query->cb_finished = _cb_warm_query_finished;
+  query->p.type = OS_ROUTE_UNICAST;
+  query->p.table = parameter->table;
+  query->p.protocol = parameter->protocol;
+
+  if (os_routing_query(query)) {
+    OONF_WARN(LOG_OLSRV2_ROUTING, "Could not query kernel routes of domain %u",
+        domain->ext);
+    return;
+  }
+
+  oonf_timer_set(&_warm_restart_timer[domain->index], parameter->warm_restart);
+}
+
+/**
+ * @param index domain index
+ * @return true if kernel routes of a previous run are still kept
+ */
+bool
+olsrv2_routing_warm_is_active(int index) {
+  return oonf_timer_is_active(&_warm_restart_timer[index]);
+}
+
+/**
+ * @param filter kernel query
+ * @return nhdp domain of kernel query, NULL if domain is gone
+ */
+static struct nhdp_domain *
+_get_query_domain(struct os_route *filter) {
+  struct nhdp_domain *domain;
+  int index;
+
+  index = filter - &_warm_query[0];
+  list_for_each_element(nhdp_domain_get_list(), domain, _node) {
+    if (domain->index == index) {
+      return domain;
+    }
+  }
+  return NULL;
+}
+
+/**
+ * Callback for each kernel route of a previous run
+ * @param filter kernel query
+ * @param route kernel route
+ */
+static void
+_cb_warm_query(struct os_route *filter, struct os_route *route) {
+  struct olsrv2_routing_entry *rtentry;
+  struct nhdp_domain *domain;
+  struct os_route_key key;
+  uint32_t *ids;
+  size_t i;
+#ifdef OONF_LOG_DEBUG_INFO
+  struct os_route_str rbuf;
+#endif
+
+  domain = _get_query_domain(filter);
+  if (domain == NULL) {
+    return;
+  }
+
+  /* use the same key as the routing calculation */
+  memcpy(&key, &route->p.key, sizeof(key));
+  if (netaddr_get_address_family(&key.src) == AF_UNSPEC) {
+    os_routing_init_sourcespec_prefix(&key, &route->p.key.dst);
+  }
+
+  if (avl_find(olsrv2_routing_get_tree(domain), &key)) {
+    /* routing calculation was faster */
+    return;
+  }
+
+  rtentry = olsrv2_routing_entry_add(domain, &key);
+  if (rtentry == NULL) {
+    return;
+  }
+
+  rtentry->route.p.family = route->p.family;
+  rtentry->route.p.type = route->p.type;
+  rtentry->route.p.metric = route->p.metric;
+  rtentry->route.p.table = route->p.table;
+  rtentry->route.p.protocol = route->p.protocol;
+  rtentry->route.p.if_index = route->p.if_index;
+  rtentry->route.p.nexthop_id = route->p.nexthop_id;
+  rtentry->route.p.nexthop_count = route->p.nexthop_count;
+  memcpy(&rtentry->route.p.src_ip, &route->p.src_ip, sizeof(route->p.src_ip));
+  memcpy(rtentry->route.p.nexthops, route->p.nexthops, sizeof(route->p.nexthops));
+
+  if (netaddr_cmp(&route->p.gw, &route->p.key.dst) != 0) {
+    /* ipv4 host routes use their destination as gateway in the kernel */
+    memcpy(&rtentry->route.p.gw, &route->p.gw, sizeof(route->p.gw));
+  }
+
+  rtentry->set = true;
+  rtentry->_warm = true;
+
+  /* entry was not refreshed by a routing calculation yet */
+  olsrv2_routing_entry_set_unrefreshed(rtentry);
+
+  if (route->p.nexthop_id) {
+    /* never reuse the nexthop ids of the previous run */
+    olsrv2_routing_nexthop_reserve_id(route->p.nexthop_id);
+
+    for (i=0; i<_warm_nexthop_count; i++) {
+      if (_warm_nexthop_ids[i] == route->p.nexthop_id) {
+        break;
+      }
+    }
+
+    if (i == _warm_nexthop_count) {
+      ids = realloc(_warm_nexthop_ids, sizeof(*ids) * (_warm_nexthop_count + 1));
+      if (ids) {
+        _warm_nexthop_ids = ids;
+        _warm_nexthop_ids[_warm_nexthop_count++] = route->p.nexthop_id;
+      }
+    }
+  }
+
+  OONF_DEBUG(LOG_OLSRV2_ROUTING, "Keep route of previous run: %s",
+      os_routing_to_string(&rbuf, &rtentry->route.p));
+}
+
+/**
+ * Callback triggered when all kernel routes of a previous run have been read
+ * @param filter kernel query
+ * @param error 0 if no error happened
+ */
+static void
+_cb_warm_query_finished(struct os_route *filter, int error) {
+  struct nhdp_domain *domain;
+
+  if (error) {
+    OONF_WARN(LOG_OLSRV2_ROUTING, "Could not read kernel routes of previous run: %s (%d)",
+        strerror(error), error);
+  }
+
+  domain = _get_query_domain(filter);
+  if (domain) {
+    OONF_INFO(LOG_OLSRV2_ROUTING, "Read %u kernel routes of domain %u",
+        olsrv2_routing_get_tree(domain)->count, domain->ext);
+  }
+}
+
+/**
+ * Callback triggered when the network had time to converge after a
+ * warm restart. Routes of the previous run that were not confirmed by
+ * the routing calculation are removed with the next calculation.
+ * @param ptr timer instance that fired
+ */
+static void
+_cb_warm_restart_timeout(struct oonf_timer_instance *ptr) {
+  struct os_nexthop nexthop;
+  size_t i;
+
+  OONF_INFO(LOG_OLSRV2_ROUTING, "Warm restart of domain index %d finished",
+      (int)(ptr - &_warm_restart_timer[0]));
+
+  for (i=0; i<NHDP_MAXIMUM_DOMAINS; i++) {
+    if (olsrv2_routing_warm_is_active(i)) {
+      olsrv2_routing_trigger_update();
+      return;
+    }
+  }
+
+  /* remove nexthop objects of the previous run */
+  memset(&nexthop, 0, sizeof(nexthop));
+  for (i=0; i<_warm_nexthop_count; i++) {
+    nexthop.id = _warm_nexthop_ids[i];
+    os_routing_set_nexthop(&nexthop, false);
+  }
+
+  free(_warm_nexthop_ids);
+  _warm_nexthop_ids = NULL;
+  _warm_nexthop_count = 0;
+
+  olsrv2_routing_trigger_update();
+}
@@ -170,7 +170,7 @@ olsrv2_tc_node_add(struct netaddr *originator,
 
     /* initialize dijkstra data */
     node->target.type = OLSRV2_NODE_TARGET;
-    olsrv2_routing_dijkstra_node_init(&node->target._dijkstra);
+    olsrv2_routing_dijkstra_node_init(&node->_dijkstra);
 
     /* hook into global tree */
     avl_insert(&_tc_tree, &node->_originator_node);
@@ -217,6 +217,8 @@ olsrv2_tc_node_remove(struct olsrv2_tc_node *node) {
 
   /* remove from global tree and free memory if node is not needed anymore*/
   if (node->_edges.count == 0) {
+    olsrv2_routing_dijkstra_node_cleanup(node);
+
     avl_remove(&_tc_tree, &node->_originator_node);
     oonf_class_free(&_tc_node_class, node);
   }
@@ -279,6 +281,7 @@ olsrv2_tc_edge_add(struct olsrv2_tc_node *src, struct netaddr *addr) {
   edge->inverse = inverse;
   for (i=0; i<NHDP_MAXIMUM_DOMAINS; i++) {
     edge->cost[i] = RFC7181_METRIC_INFINITE;
+    edge->_spf_cost[i] = RFC7181_METRIC_INFINITE;
   }
 
   /* hook edge into src node */
@@ -292,6 +295,7 @@ olsrv2_tc_edge_add(struct olsrv2_tc_node *src, struct netaddr *addr) {
   inverse->virtual = true;
   for (i=0; i<NHDP_MAXIMUM_DOMAINS; i++) {
     inverse->cost[i] = RFC7181_METRIC_INFINITE;
+    inverse->_spf_cost[i] = RFC7181_METRIC_INFINITE;
   }
 
   /* hook inverse edge into dst node */
@@ -374,9 +378,6 @@ olsrv2_tc_endpoint_add(struct olsrv2_tc_node *node,
   net->_endpoint_node.key = &node->target.prefix;
   avl_insert(&end->_attached_networks, &net->_endpoint_node);
 
-  /* initialize dijkstra data */
-  olsrv2_routing_dijkstra_node_init(&end->target._dijkstra);
-
   oonf_class_event(&_tc_attached_class, net, OONF_OBJECT_ADDED);
   return net;
 }
@@ -98,9 +98,6 @@ struct olsrv2_tc_target {
 
   /*! type of target */
   enum olsrv2_target_type type;
-
-  /*! internal data for dijkstra run */
-  struct olsrv2_dijkstra_node _dijkstra;
 };
 
 /**
@@ -132,6 +129,9 @@ struct olsrv2_tc_node {
   /*! tree of olsrv2_tc_attached_networks */
   struct avl_tree _attached_networks;
 
+  /*! internal data for dijkstra run */
+  struct olsrv2_dijkstra_node _dijkstra;
+
   /*! node for tree of tc_nodes */
   struct avl_node _originator_node;
 };
@@ -152,6 +152,9 @@ struct olsrv2_tc_edge {
   /*! link cost of edge */
   uint32_t cost[NHDP_MAXIMUM_DOMAINS];
 
+  /*! link cost of edge known to the shortest path trees */
+  uint32_t _spf_cost[NHDP_MAXIMUM_DOMAINS];
+
   /*! answer set number which set this edge */
   uint16_t ansn;
 
@@ -45,6 +45,7 @@
 
 #include "common/common_types.h"
 #include "common/autobuf.h"
+#include "common/isonumber.h"
 #include "common/template.h"
 
 #include "core/oonf_logging.h"
@@ -83,6 +84,7 @@ static void _initialize_node_values(struct olsrv2_tc_node *);
 static void _initialize_attached_network_values(struct olsrv2_tc_attachment *edge);
 static void _initialize_edge_values(struct olsrv2_tc_edge *edge);
 static void _initialize_route_values(struct olsrv2_routing_entry *route);
+static void _initialize_dijkstra_values(struct oonf_viewer_template *template);
 
 static int _cb_create_text_originator(struct oonf_viewer_template *);
 static int _cb_create_text_old_originator(struct oonf_viewer_template *);
@@ -91,6 +93,7 @@ static int _cb_create_text_node(struct oonf_viewer_template *);
 static int _cb_create_text_attached_network(struct oonf_viewer_template *);
 static int _cb_create_text_edge(struct oonf_viewer_template *);
 static int _cb_create_text_route(struct oonf_viewer_template *);
+static int _cb_create_text_dijkstra(struct oonf_viewer_template *);
 
 /*
  * list of template keys and corresponding buffers for values.
@@ -191,6 +194,27 @@ static int _cb_create_text_route(struct oonf_viewer_template *);
 /*! template key for the last hop before the route destination */
 #define KEY_ROUTE_LASTHOP           "route_lasthop"
 
+/*! template key for number of requested routing updates */
+#define KEY_DIJKSTRA_TRIGGERS       "dijkstra_triggers"
+
+/*! template key for number of requests merged into a pending update */
+#define KEY_DIJKSTRA_COALESCED      "dijkstra_coalesced"
+
+/*! template key for number of routing calculations */
+#define KEY_DIJKSTRA_RUNS           "dijkstra_runs"
+
+/*! template key for processing time of the last calculation */
+#define KEY_DIJKSTRA_LAST_RUNTIME   "dijkstra_last_runtime"
+
+/*! template key for longest processing time of a calculation */
+#define KEY_DIJKSTRA_MAX_RUNTIME    "dijkstra_max_runtime"
+
+/*! template key for processing time of all calculations */
+#define KEY_DIJKSTRA_TOTAL_RUNTIME  "dijkstra_total_runtime"
+
+/*! template key for hold-down after the last calculation */
+#define KEY_DIJKSTRA_HOLDDOWN       "dijkstra_holddown"
+
 /*
  * buffer space for values that will be assembled
  * into the output of the plugin
@@ -232,6 +256,14 @@ static char                       _value_route_if[IF_NAMESIZE];
 static char                       _value_route_ifindex[12];
 static struct netaddr_str         _value_route_lasthop;
 
+static char                       _value_dijkstra_triggers[21];
+static char                       _value_dijkstra_coalesced[21];
+static char                       _value_dijkstra_runs[21];
+static struct isonumber_str       _value_dijkstra_last_runtime;
+static struct isonumber_str       _value_dijkstra_max_runtime;
+static struct isonumber_str       _value_dijkstra_total_runtime;
+static struct isonumber_str       _value_dijkstra_holddown;
+
 /* definition of the template data entries for JSON and table output */
 static struct abuf_template_data_entry _tde_originator[] = {
     { KEY_ORIGINATOR, _value_originator.buf, true },
@@ -299,6 +331,16 @@ static struct abuf_template_data_entry _tde_route[] = {
     { KEY_ROUTE_LASTHOP, _value_route_lasthop.buf, true },
 };
 
+static struct abuf_template_data_entry _tde_dijkstra[] = {
+    { KEY_DIJKSTRA_TRIGGERS, _value_dijkstra_triggers, false },
+    { KEY_DIJKSTRA_COALESCED, _value_dijkstra_coalesced, false },
+    { KEY_DIJKSTRA_RUNS, _value_dijkstra_runs, false },
+    { KEY_DIJKSTRA_LAST_RUNTIME, _value_dijkstra_last_runtime.buf, false },
+    { KEY_DIJKSTRA_MAX_RUNTIME, _value_dijkstra_max_runtime.buf, false },
+    { KEY_DIJKSTRA_TOTAL_RUNTIME, _value_dijkstra_total_runtime.buf, false },
+    { KEY_DIJKSTRA_HOLDDOWN, _value_dijkstra_holddown.buf, false },
+};
+
 static struct abuf_template_storage _template_storage;
 
 /* Template Data objects (contain one or more Template Data Entries) */
@@ -336,6 +378,9 @@ static struct abuf_template_data _td_route[] = {
     { _tde_domain_metric_out, ARRAYSIZE(_tde_domain_metric_out) },
     { _tde_domain_path_hops, ARRAYSIZE(_tde_domain_path_hops) },
 };
+static struct abuf_template_data _td_dijkstra[] = {
+    { _tde_dijkstra, ARRAYSIZE(_tde_dijkstra) },
+};
 
 /* OONF viewer templates (based on Template Data arrays) */
 static struct oonf_viewer_template _templates[] = {
@@ -380,6 +425,12 @@ static struct oonf_viewer_template _templates[] = {
         .data_size = ARRAYSIZE(_td_route),
         .json_name = "route",
         .cb_function = _cb_create_text_route,
+    },
+    {
+        .data = _td_dijkstra,
+        .data_size = ARRAYSIZE(_td_dijkstra),
+        .json_name = "dijkstra",
+        .cb_function = _cb_create_text_dijkstra,
     }
 };
 
@@ -603,6 +654,34 @@ _initialize_route_values(struct olsrv2_routing_entry *route) {
   netaddr_to_string(&_value_route_lasthop, &route->last_originator);
 }
 
+/**
+ * Initialize the value buffers for the routing calculation statistics
+ * @param template viewer template
+ */
+static void
+_initialize_dijkstra_values(struct oonf_viewer_template *template) {
+  const struct olsrv2_routing_statistics *stats;
+
+  stats = olsrv2_routing_get_statistics();
+
+  snprintf(_value_dijkstra_triggers, sizeof(_value_dijkstra_triggers),
+      "%" PRIu64, stats->triggers);
+  snprintf(_value_dijkstra_coalesced, sizeof(_value_dijkstra_coalesced),
+      "%" PRIu64, stats->coalesced);
+  snprintf(_value_dijkstra_runs, sizeof(_value_dijkstra_runs),
+      "%" PRIu64, stats->runs);
+
+  /* processing times are nanoseconds, the hold-down milliseconds */
+  isonumber_from_u64(&_value_dijkstra_last_runtime,
+      stats->last_runtime, "s", 9, false, template->create_raw);
+  isonumber_from_u64(&_value_dijkstra_max_runtime,
+      stats->max_runtime, "s", 9, false, template->create_raw);
+  isonumber_from_u64(&_value_dijkstra_total_runtime,
+      stats->total_runtime, "s", 9, false, template->create_raw);
+  isonumber_from_u64(&_value_dijkstra_holddown,
+      stats->holddown, "s", 3, false, template->create_raw);
+}
+
 /**
  * Displays the known data about each NHDP interface.
  * @param template oonf viewer template
@@ -786,3 +865,17 @@ _cb_create_text_route(struct oonf_viewer_template *template) {
   }
   return 0;
 }
+
+/**
+ * Display the statistics of the routing calculation
+ * @param template oonf viewer template
+ * @return -1 if an error happened, 0 otherwise
+ */
+static int
+_cb_create_text_dijkstra(struct oonf_viewer_template *template) {
+  _initialize_dijkstra_values(template);
+
+  /* generate template output */
+  oonf_viewer_output_print_line(template);
+  return 0;
+}
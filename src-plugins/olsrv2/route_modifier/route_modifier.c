@@ -43,6 +43,8 @@
  * @file
  */
 
+#include <stdlib.h>
+
 #include "common/autobuf.h"
 #include "common/avl.h"
 #include "common/avl_comp.h"
@@ -50,11 +52,14 @@
 #include "common/list.h"
 #include "common/netaddr.h"
 #include "common/netaddr_acl.h"
+#include "common/netaddr_trie.h"
 
 #include "core/oonf_logging.h"
 #include "core/oonf_subsystem.h"
 #include "subsystems/oonf_class.h"
 
+#include "nhdp/nhdp_domain.h"
+
 #include "olsrv2/olsrv2.h"
 #include "olsrv2/olsrv2_routing.h"
 
@@ -92,6 +97,30 @@ struct _routemodifier {
   struct avl_node _node;
 };
 
+/**
+ * Route modifiers of a domain that accept all destinations with
+ * the same longest matching ACL prefix, in the order of the
+ * modifier tree
+ */
+struct _modifier_candidates {
+  /*! number of modifiers */
+  size_t count;
+
+  /*! array of modifiers */
+  struct _routemodifier *modifiers[0];
+};
+
+/**
+ * Route modifiers of a domain compiled into prefix tries
+ */
+struct _compiled_domain {
+  /*! IPv4 and IPv6 ACL prefixes of the modifiers, value is _modifier_candidates */
+  struct netaddr_trie tries[2];
+
+  /*! modifiers for destinations that match no ACL prefix, NULL if none */
+  struct _modifier_candidates *no_match;
+};
+
 /* prototypes */
 static int _init(void);
 static void _cleanup(void);
@@ -99,6 +128,15 @@ static void _cleanup(void);
 static struct _routemodifier *_get_modifier(const char *name);
 static void _destroy_modifier(struct _routemodifier *);
 
+static int _compile_modifiers(void);
+static int _compile_prefix(int32_t domain, struct _compiled_domain *, const struct netaddr *);
+static struct _modifier_candidates *_create_candidates(int32_t domain, const struct netaddr *);
+static bool _acl_accepts_prefix(const struct netaddr_acl *, const struct netaddr *);
+static bool _acl_array_contains(const struct netaddr *, size_t, const struct netaddr *);
+static void _clear_compiled_modifiers(void);
+static struct _routemodifier *_find_modifier(
+    struct nhdp_domain *, const struct netaddr *dst);
+
 static bool _cb_rt_filter(
     struct nhdp_domain *, struct os_route_parameter *, bool set);
 static void _cb_cfg_changed(void);
@@ -163,13 +201,23 @@ static struct olsrv2_routing_filter _dijkstra_filter = {
 /* tree of routing filters */
 static struct avl_tree _modifier_tree;
 
+/* modifiers compiled into prefix tries, rebuilt on demand after configuration changes */
+static struct _compiled_domain _compiled[NHDP_MAXIMUM_DOMAINS];
+static bool _compiled_valid;
+
 /**
  * Initialize plugin
  * @return always returns 0 (cannot fail)
  */
 static int
 _init(void) {
+  int i;
+
   avl_init(&_modifier_tree, avl_comp_strcasecmp, false);
+  for (i = 0; i < NHDP_MAXIMUM_DOMAINS; i++) {
+    netaddr_trie_init(&_compiled[i].tries[0], AF_INET);
+    netaddr_trie_init(&_compiled[i].tries[1], AF_INET6);
+  }
   oonf_class_add(&_modifier_class);
   olsrv2_routing_filter_add(&_dijkstra_filter);
   return 0;
@@ -182,6 +230,7 @@ static void
 _cleanup(void) {
   struct _routemodifier *mod, *mod_it;
 
+  _clear_compiled_modifiers();
   avl_for_each_element_safe(&_modifier_tree, mod, _node, mod_it) {
     _destroy_modifier(mod);
   }
@@ -205,42 +254,280 @@ _cb_rt_filter(struct nhdp_domain *domain,
   struct netaddr_str nbuf;
 #endif
 
-  avl_for_each_element(&_modifier_tree, modifier, _node) {
-    /* check filter matches this domain */
-    if (domain->index != modifier->domain) {
-      continue;
+  modifier = _find_modifier(domain, &route_param->key.dst);
+  if (modifier == NULL) {
+    return true;
+  }
+
+  /* apply modifiers */
+  if (modifier->table) {
+    OONF_DEBUG(LOG_ROUTE_MODIFIER, "Modify routing table for route to %s: %d",
+        netaddr_to_string(&nbuf, &route_param->key.dst), modifier->table);
+    route_param->table = modifier->table;
+  }
+  if (modifier->protocol) {
+    OONF_DEBUG(LOG_ROUTE_MODIFIER, "Modify routing protocol for route to %s: %d",
+        netaddr_to_string(&nbuf, &route_param->key.dst), modifier->protocol);
+    route_param->protocol = modifier->protocol;
+  }
+  if (modifier->distance) {
+    OONF_DEBUG(LOG_ROUTE_MODIFIER, "Modify routing distance for route to %s: %d",
+        netaddr_to_string(&nbuf, &route_param->key.dst), modifier->distance);
+    route_param->metric = modifier->distance;
+  }
+  return true;
+}
+
+/**
+ * Find the first route modifier (in name order) of a domain that
+ * matches a destination
+ * @param domain pointer to domain of route
+ * @param dst destination prefix of route
+ * @return matching route modifier, NULL if none
+ */
+static struct _routemodifier *
+_find_modifier(struct nhdp_domain *domain, const struct netaddr *dst) {
+  struct _modifier_candidates *candidates;
+  struct _routemodifier *modifier;
+  struct _compiled_domain *compiled;
+  size_t i;
+
+  if (!_compiled_valid && _compile_modifiers()) {
+    OONF_WARN(LOG_ROUTE_MODIFIER, "Not enough memory to compile route modifiers");
+    _clear_compiled_modifiers();
+
+    /* check all modifiers directly */
+    avl_for_each_element(&_modifier_tree, modifier, _node) {
+      if (domain->index == modifier->domain
+          && (modifier->prefix_length == -1
+              || modifier->prefix_length == netaddr_get_prefix_length(dst))
+          && netaddr_acl_check_accept(&modifier->filter, dst)) {
+        return modifier;
+      }
+    }
+    return NULL;
+  }
+
+  if (domain->index < 0 || domain->index >= NHDP_MAXIMUM_DOMAINS) {
+    return NULL;
+  }
+  compiled = &_compiled[domain->index];
+
+  /* the longest matching ACL prefix decides which ACLs accept the destination */
+  switch (netaddr_get_address_family(dst)) {
+    case AF_INET:
+      candidates = netaddr_trie_lookup(&compiled->tries[0], dst);
+      break;
+    case AF_INET6:
+      candidates = netaddr_trie_lookup(&compiled->tries[1], dst);
+      break;
+    default:
+      candidates = NULL;
+      break;
+  }
+  if (candidates == NULL) {
+    candidates = compiled->no_match;
+  }
+  if (candidates == NULL) {
+    return NULL;
+  }
+
+  for (i = 0; i < candidates->count; i++) {
+    modifier = candidates->modifiers[i];
+    if (modifier->prefix_length == -1
+        || modifier->prefix_length == netaddr_get_prefix_length(dst)) {
+      return modifier;
     }
+  }
+  return NULL;
+}
+
+/**
+ * Compile the ACLs of all route modifiers into one prefix trie per
+ * domain and address family.
+ * @return -1 if out of memory, 0 otherwise
+ */
+static int
+_compile_modifiers(void) {
+  struct _compiled_domain *compiled;
+  struct _routemodifier *modifier;
+  int32_t domain;
+  size_t i;
+
+  _clear_compiled_modifiers();
+
+  for (domain = 0; domain < NHDP_MAXIMUM_DOMAINS; domain++) {
+    compiled = &_compiled[domain];
+
+    avl_for_each_element(&_modifier_tree, modifier, _node) {
+      if (modifier->domain != domain) {
+        continue;
+      }
+
+      if (compiled->no_match == NULL) {
+        compiled->no_match = _create_candidates(domain, NULL);
+        if (compiled->no_match == NULL) {
+          return -1;
+        }
+      }
+
+      for (i = 0; i < modifier->filter.accept_count; i++) {
+        if (_compile_prefix(domain, compiled, &modifier->filter.accept[i])) {
+          return -1;
+        }
+      }
+      for (i = 0; i < modifier->filter.reject_count; i++) {
+        if (_compile_prefix(domain, compiled, &modifier->filter.reject[i])) {
+          return -1;
+        }
+      }
+    }
+  }
+
+  _compiled_valid = true;
+  return 0;
+}
+
+/**
+ * Add an ACL prefix to the trie of a domain
+ * @param domain domain index
+ * @param compiled compiled modifiers of domain
+ * @param prefix ACL prefix
+ * @return -1 if out of memory, 0 otherwise
+ */
+static int
+_compile_prefix(int32_t domain, struct _compiled_domain *compiled, const struct netaddr *prefix) {
+  struct _modifier_candidates *candidates;
+  struct netaddr_trie *trie;
+
+  switch (netaddr_get_address_family(prefix)) {
+    case AF_INET:
+      trie = &compiled->tries[0];
+      break;
+    case AF_INET6:
+      trie = &compiled->tries[1];
+      break;
+    default:
+      /* cannot match a route */
+      return 0;
+  }
+
+  if (netaddr_trie_get(trie, prefix) != NULL) {
+    /* already used by another ACL */
+    return 0;
+  }
 
-    /* check prefix length */
-    if (modifier->prefix_length != -1
-        && modifier->prefix_length != netaddr_get_prefix_length(&route_param->key.dst)) {
-      continue;
+  candidates = _create_candidates(domain, prefix);
+  if (candidates == NULL) {
+    return -1;
+  }
+  if (netaddr_trie_insert(trie, prefix, candidates)) {
+    free(candidates);
+    return -1;
+  }
+  return 0;
+}
+
+/**
+ * Collect the route modifiers of a domain that accept the
+ * destinations whose longest matching ACL prefix is a prefix
+ * @param domain domain index
+ * @param prefix longest matching ACL prefix, NULL for none
+ * @return modifier array, NULL if out of memory
+ */
+static struct _modifier_candidates *
+_create_candidates(int32_t domain, const struct netaddr *prefix) {
+  struct _modifier_candidates *candidates;
+  struct _routemodifier *modifier;
+  size_t count;
+
+  count = 0;
+  avl_for_each_element(&_modifier_tree, modifier, _node) {
+    if (modifier->domain == domain) {
+      count++;
     }
+  }
 
-    /* check if destination matches */
-    if (!netaddr_acl_check_accept(&modifier->filter, &route_param->key.dst)) {
-      continue;
+  candidates = malloc(sizeof(*candidates) + count * sizeof(candidates->modifiers[0]));
+  if (candidates == NULL) {
+    return NULL;
+  }
+
+  candidates->count = 0;
+  avl_for_each_element(&_modifier_tree, modifier, _node) {
+    if (modifier->domain == domain && _acl_accepts_prefix(&modifier->filter, prefix)) {
+      candidates->modifiers[candidates->count++] = modifier;
     }
+  }
+  return candidates;
+}
 
-    /* apply modifiers */
-    if (modifier->table) {
-      OONF_DEBUG(LOG_ROUTE_MODIFIER, "Modify routing table for route to %s: %d",
-          netaddr_to_string(&nbuf, &route_param->key.dst), modifier->table);
-      route_param->table = modifier->table;
+/**
+ * Check if an ACL accepts the destinations whose longest matching
+ * ACL prefix is a prefix. This is netaddr_acl_check_accept() for all
+ * destinations inside the prefix, but not inside a longer ACL prefix.
+ * @param acl pointer to ACL
+ * @param prefix longest matching ACL prefix, NULL for none
+ * @return true if ACL accepts the destinations, false otherwise
+ */
+static bool
+_acl_accepts_prefix(const struct netaddr_acl *acl, const struct netaddr *prefix) {
+  if (acl->reject_first) {
+    if (_acl_array_contains(acl->reject, acl->reject_count, prefix)) {
+      return false;
     }
-    if (modifier->protocol) {
-      OONF_DEBUG(LOG_ROUTE_MODIFIER, "Modify routing protocol for route to %s: %d",
-          netaddr_to_string(&nbuf, &route_param->key.dst), modifier->protocol);
-      route_param->protocol = modifier->protocol;
+  }
+
+  if (_acl_array_contains(acl->accept, acl->accept_count, prefix)) {
+    return true;
+  }
+
+  if (!acl->reject_first) {
+    if (_acl_array_contains(acl->reject, acl->reject_count, prefix)) {
+      return false;
     }
-    if (modifier->distance) {
-      OONF_DEBUG(LOG_ROUTE_MODIFIER, "Modify routing distance for route to %s: %d",
-          netaddr_to_string(&nbuf, &route_param->key.dst), modifier->distance);
-      route_param->metric = modifier->distance;
+  }
+
+  return acl->accept_default;
+}
+
+/**
+ * @param array array of ACL prefixes
+ * @param length number of ACL prefixes
+ * @param prefix prefix, NULL for none
+ * @return true if one of the ACL prefixes contains the prefix
+ */
+static bool
+_acl_array_contains(const struct netaddr *array, size_t length, const struct netaddr *prefix) {
+  size_t i;
+
+  if (prefix == NULL) {
+    return false;
+  }
+
+  for (i = 0; i < length; i++) {
+    if (netaddr_get_prefix_length(&array[i]) <= netaddr_get_prefix_length(prefix)
+        && netaddr_is_in_subnet(&array[i], prefix)) {
+      return true;
     }
-    break;
   }
-  return true;
+  return false;
+}
+
+/**
+ * Free the compiled route modifiers
+ */
+static void
+_clear_compiled_modifiers(void) {
+  int i;
+
+  for (i = 0; i < NHDP_MAXIMUM_DOMAINS; i++) {
+    netaddr_trie_clear(&_compiled[i].tries[0], free);
+    netaddr_trie_clear(&_compiled[i].tries[1], free);
+    free(_compiled[i].no_match);
+    _compiled[i].no_match = NULL;
+  }
+  _compiled_valid = false;
 }
 
 /**
@@ -288,6 +575,9 @@ static void
 _cb_cfg_changed(void) {
   struct _routemodifier *modifier;
 
+  /* compiled modifiers are rebuilt by the next routing filter call */
+  _clear_compiled_modifiers();
+
   /* get existing modifier */
   modifier = _get_modifier(_modifier_section.section_name);
   if (!modifier) {
@@ -298,10 +588,8 @@ _cb_cfg_changed(void) {
   if (_modifier_section.post == NULL) {
     /* section was removed */
     _destroy_modifier(modifier);
-    return;
   }
-
-  if (cfg_schema_tobin(modifier, _modifier_section.post,
+  else if (cfg_schema_tobin(modifier, _modifier_section.post,
       _modifier_entries, ARRAYSIZE(_modifier_entries))) {
     OONF_WARN(LOG_ROUTE_MODIFIER,
         "Could not convert configuration data of section '%s'",
@@ -312,4 +600,7 @@ _cb_cfg_changed(void) {
     }
     return;
   }
+
+  /* dijkstra only filters changed routes, so existing routes must be refreshed */
+  olsrv2_routing_reapply_filters();
 }
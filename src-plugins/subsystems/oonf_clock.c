@@ -128,6 +128,24 @@ oonf_clock_getNow(void) {
   return now_times;
 }
 
+/**
+ * Calculates the number of nanoseconds until a timestamp will happen.
+ * Other than oonf_clock_get_relative() this reads the system clock
+ * instead of using the time of the last oonf_clock_update() call.
+ * @param absolute timestamp
+ * @return nanoseconds until event will happen, negative if it already
+ *   happened.
+ */
+int64_t
+oonf_clock_get_relative_ns(uint64_t absolute) {
+  uint64_t now;
+
+  if (os_clock_gettime64_ns(&now)) {
+    return oonf_clock_get_relative(absolute) * 1000000ll;
+  }
+  return (int64_t)((absolute + start_time) * 1000000ull - now);
+}
+
 /**
  * Format an internal time value into a string.
  * Displays hours:minutes:seconds.millisecond.
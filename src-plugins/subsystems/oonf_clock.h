@@ -164,6 +164,7 @@ enum {
 EXPORT int oonf_clock_update(void) __attribute__((warn_unused_result));
 
 EXPORT uint64_t oonf_clock_getNow(void);
+EXPORT int64_t oonf_clock_get_relative_ns(uint64_t absolute);
 
 EXPORT const char *oonf_clock_toClockString(struct isonumber_str *, uint64_t);
 
@@ -0,0 +1,238 @@
+
+/*
+ * The olsr.org Optimized Link-State Routing daemon version 2 (olsrd2)
+ * Copyright (c) 2004-2015, the olsr.org team - see HISTORY file
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in
+ *   the documentation and/or other materials provided with the
+ *   distribution.
+ * * Neither the name of olsr.org, olsrd nor the names of its
+ *   contributors may be used to endorse or promote products derived
+ *   from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Visit http://www.olsr.org for more information.
+ *
+ * If you find this software useful feel free to make a donation
+ * to the project. For more information see the website or contact
+ * the copyright holders.
+ *
+ */
+
+/**
+ * @file
+ */
+
+
+#include <assert.h>
+
+#include "common/common_types.h"
+#include "common/list.h"
+#include "core/oonf_logging.h"
+#include "core/oonf_subsystem.h"
+#include "subsystems/oonf_clock.h"
+#include "subsystems/os_clock.h"
+
+#include "subsystems/oonf_job.h"
+
+/* Definitions */
+#define LOG_JOB _oonf_job_subsystem.logging
+
+/* prototypes */
+static int _init(void);
+static void _cleanup(void);
+
+/* queue of running jobs, processed round robin */
+static struct list_entity _job_queue;
+
+/* List of job classes */
+static struct list_entity _job_class_list;
+
+/* subsystem definition */
+static const char *_dependencies[] = {
+  OONF_CLOCK_SUBSYSTEM,
+};
+
+static struct oonf_subsystem _oonf_job_subsystem = {
+  .name = OONF_JOB_SUBSYSTEM,
+  .dependencies = _dependencies,
+  .dependencies_count = ARRAYSIZE(_dependencies),
+  .init = _init,
+  .cleanup = _cleanup,
+};
+DECLARE_OONF_PLUGIN(_oonf_job_subsystem);
+
+/**
+ * Initialize job scheduler subsystem
+ * @return always returns 0
+ */
+static int
+_init(void) {
+  list_init_head(&_job_queue);
+  list_init_head(&_job_class_list);
+  return 0;
+}
+
+/**
+ * Cleanup job scheduler, this stops all jobs
+ */
+static void
+_cleanup(void) {
+  struct oonf_job_class *jc, *iterator;
+
+  list_for_each_element_safe(&_job_class_list, jc, _node, iterator) {
+    oonf_job_remove(jc);
+  }
+}
+
+/**
+ * Add a new class of jobs to the scheduler
+ * @param jc pointer to uninitialized job class
+ */
+void
+oonf_job_add(struct oonf_job_class *jc) {
+  assert (jc->step);
+  assert (jc->name);
+  list_add_tail(&_job_class_list, &jc->_node);
+}
+
+/**
+ * Removes a class of jobs from the scheduler and stops
+ * all of its running jobs.
+ * @param jc pointer to job class
+ */
+void
+oonf_job_remove(struct oonf_job_class *jc) {
+  struct oonf_job_instance *job, *iterator;
+
+  if (!list_is_node_added(&jc->_node)) {
+    return;
+  }
+
+  list_for_each_element_safe(&_job_queue, job, _node, iterator) {
+    if (job->class == jc) {
+      oonf_job_stop(job);
+    }
+  }
+  list_remove(&jc->_node);
+}
+
+/**
+ * Start a job. The first step will run in the next
+ * iteration of the scheduler. Starting an already running
+ * job has no effect.
+ * @param job initialized job instance
+ */
+void
+oonf_job_start(struct oonf_job_instance *job) {
+  assert(job->class);
+
+  if (oonf_job_is_active(job)) {
+    return;
+  }
+
+  OONF_DEBUG(LOG_JOB, "JOB: start '%s'", job->class->name);
+
+  job->class->usage++;
+  list_add_tail(&_job_queue, &job->_node);
+}
+
+/**
+ * Stop a running job before it has finished.
+ * @param job pointer to job instance
+ */
+void
+oonf_job_stop(struct oonf_job_instance *job) {
+  if (!oonf_job_is_active(job)) {
+    return;
+  }
+
+  OONF_DEBUG(LOG_JOB, "JOB: stop '%s'", job->class->name);
+
+  list_remove(&job->_node);
+  job->class->usage--;
+
+  if (job->class->_job_in_callback == job) {
+    job->class->_job_stopped = true;
+  }
+}
+
+/**
+ * Run steps of all pending jobs (round robin) until
+ * they are finished or the time slice is used up.
+ */
+void
+oonf_job_run_slice(void) {
+  struct oonf_job_instance *job;
+  struct oonf_job_class *jc;
+  uint64_t start_time, now;
+  bool finished;
+
+  os_clock_gettime64_ns(&start_time);
+  now = start_time;
+
+  while (!list_is_empty(&_job_queue)
+      && now - start_time < OONF_JOB_SLICE * 1000000ull) {
+    job = list_first_element(&_job_queue, job, _node);
+    jc = job->class;
+
+    /* move job to the end of the queue so other jobs get their share */
+    list_remove(&job->_node);
+    list_add_tail(&_job_queue, &job->_node);
+
+    jc->_job_in_callback = job;
+    jc->_job_stopped = false;
+    jc->steps++;
+
+    finished = jc->step(job);
+
+    jc->_job_in_callback = NULL;
+
+    /* the callback might have called oonf_job_stop() */
+    if (finished && !jc->_job_stopped) {
+      OONF_DEBUG(LOG_JOB, "JOB: '%s' finished", jc->name);
+
+      jc->runs++;
+      oonf_job_stop(job);
+    }
+
+    os_clock_gettime64_ns(&now);
+  }
+}
+
+/**
+ * @return true if at least one job is waiting for its next step
+ */
+bool
+oonf_job_is_pending(void) {
+  return !list_is_empty(&_job_queue);
+}
+
+/**
+ * get list of job classes
+ * @return job class list
+ */
+struct list_entity *
+oonf_job_get_list(void) {
+  return &_job_class_list;
+}
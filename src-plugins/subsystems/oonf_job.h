@@ -0,0 +1,130 @@
+
+/*
+ * The olsr.org Optimized Link-State Routing daemon version 2 (olsrd2)
+ * Copyright (c) 2004-2015, the olsr.org team - see HISTORY file
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in
+ *   the documentation and/or other materials provided with the
+ *   distribution.
+ * * Neither the name of olsr.org, olsrd nor the names of its
+ *   contributors may be used to endorse or promote products derived
+ *   from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Visit http://www.olsr.org for more information.
+ *
+ * If you find this software useful feel free to make a donation
+ * to the project. For more information see the website or contact
+ * the copyright holders.
+ *
+ */
+
+/**
+ * @file
+ */
+
+#ifndef OONF_JOB_H_
+#define OONF_JOB_H_
+
+#include "common/common_types.h"
+#include "common/list.h"
+
+/*! subsystem identifier */
+#define OONF_JOB_SUBSYSTEM "job"
+
+/*! maximum time in milliseconds jobs run before the scheduler handles I/O again */
+#define OONF_JOB_SLICE 10ull
+
+struct oonf_job_instance;
+
+/**
+ * This struct defines a class of jobs which share the same
+ * step callback. A job is a long running calculation that is
+ * split into small steps, which are executed by the scheduler
+ * in bounded time slices between socket and timer events.
+ */
+struct oonf_job_class {
+  /*! node of job class list */
+  struct list_entity _node;
+
+  /*! name of this job class */
+  const char *name;
+
+  /**
+   * Callback to run one step of a job. A step should only do
+   * a small amount of work, the scheduler will call it again
+   * until the time slice is used up.
+   * @param job pointer to job instance
+   * @return true if the job is finished, false if it needs
+   *   further steps
+   */
+  bool (*step) (struct oonf_job_instance *job);
+
+  /*! Stats, number of running jobs */
+  uint32_t usage;
+
+  /*! Stats, number of finished jobs */
+  uint32_t runs;
+
+  /*! Stats, number of executed steps */
+  uint64_t steps;
+
+  /*! pointer to job currently in callback */
+  struct oonf_job_instance *_job_in_callback;
+
+  /*! set to true if the current running job has been stopped */
+  bool _job_stopped;
+};
+
+/**
+ * A single job instance of a job class
+ */
+struct oonf_job_instance {
+  /*! node of queue of running jobs */
+  struct list_entity _node;
+
+  /*! backpointer to job class */
+  struct oonf_job_class *class;
+};
+
+EXPORT void oonf_job_add(struct oonf_job_class *);
+EXPORT void oonf_job_remove(struct oonf_job_class *);
+
+EXPORT void oonf_job_start(struct oonf_job_instance *);
+EXPORT void oonf_job_stop(struct oonf_job_instance *);
+
+EXPORT void oonf_job_run_slice(void);
+EXPORT bool oonf_job_is_pending(void);
+
+EXPORT struct list_entity *oonf_job_get_list(void);
+
+/**
+ * @param job pointer to job
+ * @return true if the job is running, false otherwise
+ */
+static INLINE bool
+oonf_job_is_active(struct oonf_job_instance *job) {
+  return list_is_node_added(&job->_node);
+}
+
+#endif /* OONF_JOB_H_ */
@@ -44,6 +44,7 @@
  */
 
 #include <errno.h>
+#include <stdlib.h>
 
 #include "common/common_types.h"
 #include "common/list.h"
@@ -78,6 +79,20 @@ static int _apply_managed_socket(struct oonf_packet_managed *managed,
 static void _cb_packet_event_unicast(struct oonf_socket_entry *);
 static void _cb_packet_event_multicast(struct oonf_socket_entry *);
 static void _cb_packet_event(struct oonf_socket_entry *, bool mc);
+static void _receive_single(struct oonf_packet_socket *, bool mc);
+static bool _receive_batch(struct oonf_packet_socket *, bool mc, bool *failed);
+static void _handle_received_packet(struct oonf_packet_socket *,
+    union netaddr_socket *from, uint8_t *buf, ssize_t length, bool mc);
+static bool _send_single(struct oonf_packet_socket *);
+static bool _send_batch(struct oonf_packet_socket *);
+static int _send_burst(struct oonf_packet_socket *, union netaddr_socket *remote,
+    const struct oonf_packet_burst_entry *pkts, size_t count);
+static bool _is_segmentable(const struct oonf_packet_burst_entry *pkts,
+    size_t count);
+static void _count_batch(struct oonf_packet_batch_stats *, int count);
+static int _queue_packet(struct oonf_packet_socket *,
+    union netaddr_socket *remote, const void *data, size_t length);
+static void _dequeue_packets(struct oonf_packet_socket *, uint32_t count);
 static int _cb_interface_listener(struct os_interface_listener *l);
 
 /* subsystem definition */
@@ -142,6 +157,10 @@ oonf_packet_add(struct oonf_packet_socket *pktsocket,
   }
 
   _packet_add(pktsocket, local, os_if);
+
+  /* raw sockets cannot use UDP segmentation offload */
+  pktsocket->_segmentation =
+      os_fd_supports_segments(&pktsocket->scheduler_entry.fd);
   return 0;
 }
 
@@ -174,11 +193,11 @@ _packet_add(struct oonf_packet_socket *pktsocket,
     union netaddr_socket *local, struct os_interface *interf) {
   pktsocket->os_if = interf;
   pktsocket->scheduler_entry.process = _cb_packet_event_unicast;
+  pktsocket->scheduler_entry.name = "packet socket";
 
   oonf_socket_add(&pktsocket->scheduler_entry);
   oonf_socket_set_read(&pktsocket->scheduler_entry, true);
 
-  abuf_init(&pktsocket->out);
   list_add_tail(&_packet_sockets, &pktsocket->node);
   memcpy(&pktsocket->local_socket, local, sizeof(pktsocket->local_socket));
 
@@ -186,6 +205,37 @@ _packet_add(struct oonf_packet_socket *pktsocket,
     pktsocket->config.input_buffer = _input_buffer;
     pktsocket->config.input_buffer_length = sizeof(_input_buffer);
   }
+
+  if (pktsocket->config.queue_length == 0) {
+    pktsocket->config.queue_length = OONF_PACKET_DEFAULT_QUEUE_LENGTH;
+  }
+  if (pktsocket->config.queue_packet_size == 0) {
+    pktsocket->config.queue_packet_size = OONF_PACKET_DEFAULT_QUEUE_PACKET_SIZE;
+  }
+  pktsocket->_queue = NULL;
+  pktsocket->_queue_head = 0;
+  pktsocket->_queue_count = 0;
+
+  memset(&pktsocket->rx_stats, 0, sizeof(pktsocket->rx_stats));
+  memset(&pktsocket->tx_stats, 0, sizeof(pktsocket->tx_stats));
+  memset(&pktsocket->queue_stats, 0, sizeof(pktsocket->queue_stats));
+  memset(&pktsocket->burst_stats, 0, sizeof(pktsocket->burst_stats));
+  pktsocket->_segmentation = false;
+
+  if (pktsocket->config.batch_size > OS_FD_MMSG_MAX) {
+    pktsocket->config.batch_size = OS_FD_MMSG_MAX;
+  }
+  if (pktsocket->config.batch_size > 1) {
+    pktsocket->_batch_buffer = calloc(pktsocket->config.batch_size,
+        pktsocket->config.input_buffer_length);
+    if (pktsocket->_batch_buffer == NULL) {
+      OONF_WARN(LOG_PACKET, "Not enough memory for batched packet reception");
+    }
+    else {
+      /* batched reception drains the socket, so edge triggered events are enough */
+      oonf_socket_set_edge_triggered(&pktsocket->scheduler_entry, true);
+    }
+  }
 }
 
 /**
@@ -201,7 +251,13 @@ oonf_packet_remove(struct oonf_packet_socket *pktsocket,
   if (list_is_node_added(&pktsocket->node)) {
     oonf_socket_remove(&pktsocket->scheduler_entry);
     os_fd_close(&pktsocket->scheduler_entry.fd);
-    abuf_free(&pktsocket->out);
+
+    free(pktsocket->_queue);
+    pktsocket->_queue = NULL;
+    pktsocket->_queue_count = 0;
+
+    free(pktsocket->_batch_buffer);
+    pktsocket->_batch_buffer = NULL;
 
     list_remove(&pktsocket->node);
   }
@@ -222,12 +278,14 @@ oonf_packet_send(struct oonf_packet_socket *pktsocket, union netaddr_socket *rem
   int result;
   struct netaddr_str buf;
 
-  if (abuf_getlen(&pktsocket->out) == 0) {
+  if (pktsocket->_queue_count == 0) {
     /* no backlog of outgoing packets, try to send directly */
     result = os_fd_sendto(&pktsocket->scheduler_entry.fd, data, length, remote,
         pktsocket->config.dont_route);
     if (result > 0) {
       /* successful */
+      _count_batch(&pktsocket->tx_stats, 1);
+
       OONF_DEBUG(LOG_PACKET, "Sent %d bytes to %s %s",
           result, netaddr_socket_to_string(&buf, remote),
           pktsocket->os_if != NULL ? pktsocket->os_if->name : "");
@@ -241,20 +299,56 @@ oonf_packet_send(struct oonf_packet_socket *pktsocket, union netaddr_socket *rem
     }
   }
 
-  /* append destination */
-  abuf_memcpy(&pktsocket->out, remote, sizeof(*remote));
-
-  /* append data length */
-  abuf_append_uint16(&pktsocket->out, length);
-
-  /* append data */
-  abuf_memcpy(&pktsocket->out, data, length);
+  if (_queue_packet(pktsocket, remote, data, length)) {
+    return -1;
+  }
 
   /* activate outgoing socket scheduler */
   oonf_socket_set_write(&pktsocket->scheduler_entry, true);
   return 0;
 }
 
+/**
+ * Send a burst of packets to a single destination through a packet
+ * socket. The packets are handed to the kernel as a single segmented
+ * UDP send call if the kernel supports it and all packets but the last
+ * have the same length, otherwise with a single sendmmsg call. Packets
+ * the kernel did not accept are put into the outgoing queue.
+ * @param pktsocket pointer to packet socket
+ * @param remote ip/address to send packets to
+ * @param pkts array of packets
+ * @param count number of packets
+ * @return -1 if an error happened, 0 otherwise
+ */
+int
+oonf_packet_send_burst(struct oonf_packet_socket *pktsocket,
+    union netaddr_socket *remote,
+    const struct oonf_packet_burst_entry *pkts, size_t count) {
+  size_t chunk;
+
+  if (count == 1) {
+    return oonf_packet_send(pktsocket, remote, pkts[0].data, pkts[0].length);
+  }
+
+  while (count > 0) {
+    chunk = count > OS_FD_MMSG_MAX ? OS_FD_MMSG_MAX : count;
+    if (_send_burst(pktsocket, remote, pkts, chunk)) {
+      return -1;
+    }
+    pkts += chunk;
+    count -= chunk;
+  }
+  return 0;
+}
+
+/**
+ * @return list of all active packet sockets
+ */
+struct list_entity *
+oonf_packet_get_list(void) {
+  return &_packet_sockets;
+}
+
 /**
  * Initialize a new managed packet socket
  * @param managed pointer to packet socket
@@ -387,6 +481,67 @@ oonf_packet_send_managed_multicast(struct oonf_packet_managed *managed,
   return 1;
 }
 
+/**
+ * Send a burst of packets out over one of the managed sockets,
+ * depending on the address family type of the remote address
+ * @param managed pointer to managed packet socket
+ * @param remote pointer to remote socket
+ * @param pkts array of packets
+ * @param count number of packets
+ * @return -1 if an error happened, 0 if packets were sent
+ */
+int
+oonf_packet_send_managed_burst(struct oonf_packet_managed *managed,
+    union netaddr_socket *remote,
+    const struct oonf_packet_burst_entry *pkts, size_t count) {
+#ifdef OONF_LOG_DEBUG_INFO
+  struct netaddr_str buf;
+#endif
+
+  if (netaddr_socket_get_addressfamily(remote) == AF_UNSPEC) {
+    return 0;
+  }
+
+  if (list_is_node_added(&managed->socket_v4.scheduler_entry._node)
+      && netaddr_socket_get_addressfamily(remote) == AF_INET) {
+    return oonf_packet_send_burst(&managed->socket_v4, remote, pkts, count);
+  }
+  if (list_is_node_added(&managed->socket_v6.scheduler_entry._node)
+      && netaddr_socket_get_addressfamily(remote) == AF_INET6) {
+    return oonf_packet_send_burst(&managed->socket_v6, remote, pkts, count);
+  }
+  errno = 0;
+  OONF_DEBUG(LOG_PACKET,
+      "Managed socket did not sent packets to %s because socket was not active",
+      netaddr_socket_to_string(&buf, remote));
+
+  return 0;
+}
+
+/**
+ * Send a burst of multicast packets out over one of the managed sockets
+ * @param managed pointer to managed packet socket
+ * @param pkts array of packets
+ * @param count number of packets
+ * @param af_type address family to send multicast
+ * @return -1 if an error happened, 0 if packets were sent, 1 if this
+ *    type of address was switched off
+ */
+int
+oonf_packet_send_managed_multicast_burst(struct oonf_packet_managed *managed,
+    const struct oonf_packet_burst_entry *pkts, size_t count, int af_type) {
+  if (af_type == AF_INET) {
+    return oonf_packet_send_managed_burst(managed,
+        &managed->multicast_v4.local_socket, pkts, count);
+  }
+  else if (af_type == AF_INET6) {
+    return oonf_packet_send_managed_burst(managed,
+        &managed->multicast_v6.local_socket, pkts, count);
+  }
+  errno = 0;
+  return 1;
+}
+
 /**
  * Returns true if the socket for IPv4/6 is active to send data.
  * @param managed pointer to managed UDP socket
@@ -406,6 +561,78 @@ oonf_packet_managed_is_active(
   }
 }
 
+/**
+ * Change the outgoing queue settings of a packet socket. Packets
+ * that are already queued are moved into the new queue, the drop
+ * policy decides which ones are kept if the new queue is smaller.
+ * @param pktsocket packet socket
+ * @param length number of packets in queue, 0 for default
+ * @param packet_size maximum size of a queued packet, 0 for default
+ * @param policy handling of outgoing packets if the queue is full
+ */
+void
+oonf_packet_set_queue(struct oonf_packet_socket *pktsocket,
+    uint32_t length, uint32_t packet_size, enum oonf_packet_drop_policy policy) {
+  struct oonf_packet_queue_slot *old_queue, *slot;
+  uint32_t old_head, old_count, old_length, i;
+  uint64_t queued;
+
+  if (length == 0) {
+    length = OONF_PACKET_DEFAULT_QUEUE_LENGTH;
+  }
+  if (packet_size == 0) {
+    packet_size = OONF_PACKET_DEFAULT_QUEUE_PACKET_SIZE;
+  }
+
+  pktsocket->config.drop_policy = policy;
+  if (pktsocket->config.queue_length == length
+      && pktsocket->config.queue_packet_size == packet_size) {
+    return;
+  }
+
+  old_queue = pktsocket->_queue;
+  old_head = pktsocket->_queue_head;
+  old_count = pktsocket->_queue_count;
+  old_length = pktsocket->config.queue_length;
+
+  /* new queue is allocated with the next queued packet */
+  pktsocket->_queue = NULL;
+  pktsocket->_queue_head = 0;
+  pktsocket->_queue_count = 0;
+  pktsocket->config.queue_length = length;
+  pktsocket->config.queue_packet_size = packet_size;
+
+  /* move waiting packets, they have been counted as queued before */
+  queued = pktsocket->queue_stats.queued;
+  for (i=0; i<old_count; i++) {
+    slot = &old_queue[(old_head + i) % old_length];
+    _queue_packet(pktsocket, &slot->dst, slot->data, slot->length);
+  }
+  pktsocket->queue_stats.queued = queued;
+
+  free(old_queue);
+}
+
+/**
+ * Change the outgoing queue settings of all sockets of a managed socket
+ * @param managed pointer to managed packet socket
+ * @param length number of packets in queue, 0 for default
+ * @param packet_size maximum size of a queued packet, 0 for default
+ * @param policy handling of outgoing packets if the queue is full
+ */
+void
+oonf_packet_set_managed_queue(struct oonf_packet_managed *managed,
+    uint32_t length, uint32_t packet_size, enum oonf_packet_drop_policy policy) {
+  managed->config.queue_length = length;
+  managed->config.queue_packet_size = packet_size;
+  managed->config.drop_policy = policy;
+
+  oonf_packet_set_queue(&managed->socket_v4, length, packet_size, policy);
+  oonf_packet_set_queue(&managed->multicast_v4, length, packet_size, policy);
+  oonf_packet_set_queue(&managed->socket_v6, length, packet_size, policy);
+  oonf_packet_set_queue(&managed->multicast_v6, length, packet_size, policy);
+}
+
 /**
  * copies a packet managed configuration object
  * @param dst Destination
@@ -568,6 +795,7 @@ _apply_managed_socketpair(int af_type, struct oonf_packet_managed *managed,
       *changed = true;
 
       mc_sock->scheduler_entry.process = _cb_packet_event_multicast;
+      mc_sock->scheduler_entry.name = "multicast packet socket";
 
       /* join multicast group */
       os_fd_join_mcast_recv(&mc_sock->scheduler_entry.fd,
@@ -704,107 +932,505 @@ _cb_packet_event_multicast(struct oonf_socket_entry *entry) {
 
 /**
  * Callback to handle data from the olsr socket scheduler
- * @param fd filedescriptor to read data from
- * @param data custom data pointer
- * @param event_read true if read-event is incoming
- * @param event_write true if write-event is incoming
+ * @param entry socket entry
+ * @param multicast true if socket is a multicast socket
  */
 static void
-_cb_packet_event(struct oonf_socket_entry *entry,
-    bool multicast __attribute__((unused))) {
+_cb_packet_event(struct oonf_socket_entry *entry, bool multicast) {
   struct oonf_packet_socket *pktsocket;
+
+  pktsocket = container_of(entry, typeof(*pktsocket), scheduler_entry);
+
+  if (oonf_socket_is_read(entry)) {
+    if (pktsocket->_batch_buffer) {
+      bool failed = false;
+
+      /* read until the socket is empty (edge triggered events) */
+      while (_receive_batch(pktsocket, multicast, &failed)) {
+        if (!oonf_packet_is_active(pktsocket)) {
+          return;
+        }
+      }
+    }
+    else {
+      _receive_single(pktsocket, multicast);
+    }
+  }
+
+  if (oonf_socket_is_write(entry)) {
+    /* write until the queue is empty or the socket is full (edge triggered events) */
+    while (pktsocket->_queue_count > 0) {
+      if (pktsocket->config.batch_size > 1) {
+        if (!_send_batch(pktsocket)) {
+          break;
+        }
+      }
+      else if (!_send_single(pktsocket)) {
+        break;
+      }
+    }
+  }
+
+  if (pktsocket->_queue_count == 0) {
+    /* nothing left to send, disable outgoing events */
+    oonf_socket_set_write(&pktsocket->scheduler_entry, false);
+  }
+}
+
+/**
+ * Read a single packet from a packet socket
+ * @param pktsocket packet socket
+ * @param multicast true if socket is a multicast socket
+ */
+static void
+_receive_single(struct oonf_packet_socket *pktsocket, bool multicast) {
   union netaddr_socket sock;
-  uint16_t length;
-  char *pkt;
+  struct netaddr_str netbuf;
   ssize_t result;
+
+  /* clear recvfrom memory */
+  memset(&sock, 0, sizeof(sock));
+
+  result = os_fd_recvfrom(&pktsocket->scheduler_entry.fd,
+      pktsocket->config.input_buffer, pktsocket->config.input_buffer_length-1,
+      &sock, pktsocket->os_if);
+  if (result > 0) {
+    _count_batch(&pktsocket->rx_stats, 1);
+    _handle_received_packet(pktsocket, &sock,
+        pktsocket->config.input_buffer, result, multicast);
+  }
+  else if (result < 0 && (errno != EINTR && errno != EAGAIN && errno != EWOULDBLOCK)) {
+    OONF_WARN(LOG_PACKET, "Cannot read packet from socket %s: %s (%d)",
+        netaddr_socket_to_string(&netbuf, &pktsocket->local_socket), strerror(errno), errno);
+  }
+}
+
+/**
+ * Read up to batch_size packets from a packet socket with
+ * a single system call
+ * @param pktsocket packet socket
+ * @param multicast true if socket is a multicast socket
+ * @param failed pointer to flag if the last call returned an error,
+ *   will be updated by this call
+ * @return true if there might be more packets waiting in the socket
+ */
+static bool
+_receive_batch(struct oonf_packet_socket *pktsocket, bool multicast, bool *failed) {
+  struct os_fd_mmsg msgs[OS_FD_MMSG_MAX];
   struct netaddr_str netbuf;
+  int i, count;
 
-#ifdef OONF_LOG_DEBUG_INFO
-  const char *interf = "";
+  memset(msgs, 0, sizeof(msgs[0]) * pktsocket->config.batch_size);
+  for (i=0; i<(int)pktsocket->config.batch_size; i++) {
+    msgs[i].buf = pktsocket->_batch_buffer + i * pktsocket->config.input_buffer_length;
+    msgs[i].length = pktsocket->config.input_buffer_length - 1;
+  }
+
+  count = os_fd_recvmmsg(&pktsocket->scheduler_entry.fd,
+      msgs, pktsocket->config.batch_size);
+  if (count < 0) {
+    if (errno == EINTR) {
+      return true;
+    }
+#if EAGAIN == EWOULDBLOCK
+    if (errno == EAGAIN) {
+#else
+    if (errno == EAGAIN || errno == EWOULDBLOCK) {
 #endif
+      /* socket is empty */
+      return false;
+    }
 
-  pktsocket = container_of(entry, typeof(*pktsocket), scheduler_entry);
+    OONF_WARN(LOG_PACKET, "Cannot read packets from socket %s: %s (%d)",
+        netaddr_socket_to_string(&netbuf, &pktsocket->local_socket), strerror(errno), errno);
 
-#ifdef OONF_LOG_DEBUG_INFO
-  if (pktsocket->os_if) {
-    interf = pktsocket->os_if->name;
+    /*
+     * a pending socket error (e.g. ICMP unreachable) is reported only once,
+     * keep draining the socket unless the error repeats
+     */
+    if (*failed) {
+      return false;
+    }
+    *failed = true;
+    return true;
+  }
+
+  *failed = false;
+
+  _count_batch(&pktsocket->rx_stats, count);
+
+  for (i=0; i<count; i++) {
+    if (!oonf_packet_is_active(pktsocket)) {
+      /* socket (and batch buffer) was removed by a receive callback */
+      return false;
+    }
+    if (msgs[i].length > 0) {
+      _handle_received_packet(pktsocket, &msgs[i].addr,
+          msgs[i].buf, msgs[i].length, multicast);
+    }
+  }
+
+  /* a full batch means there might be more packets waiting */
+  return count == (int)pktsocket->config.batch_size;
+}
+
+/**
+ * Handle a received packet and give it to the receive callback
+ * @param pktsocket packet socket
+ * @param from source of packet
+ * @param buf pointer to packet, must have space for an additional
+ *   zero byte after the packet
+ * @param length length of packet
+ * @param multicast true if socket is a multicast socket
+ */
+static void
+_handle_received_packet(struct oonf_packet_socket *pktsocket,
+    union netaddr_socket *from, uint8_t *buf, ssize_t length,
+    bool multicast __attribute__((unused))) {
+  struct netaddr_str netbuf;
+
+  if (pktsocket->config.receive_data == NULL) {
+    return;
+  }
+
+  /* handle raw socket */
+  if (pktsocket->protocol) {
+    buf = os_fd_skip_rawsocket_prefix(buf, &length, pktsocket->local_socket.std.sa_family);
+    if (!buf) {
+      OONF_WARN(LOG_PACKET, "Error while skipping IP header for socket %s:",
+          netaddr_socket_to_string(&netbuf, &pktsocket->local_socket));
+      return;
+    }
+  }
+  /* null terminate it */
+  buf[length] = 0;
+
+  /* received valid packet */
+  OONF_DEBUG(LOG_PACKET, "Received %"PRINTF_SSIZE_T_SPECIFIER" bytes from %s %s (%s)",
+      length, netaddr_socket_to_string(&netbuf, from),
+      pktsocket->os_if != NULL ? pktsocket->os_if->name : "",
+      multicast ? "multicast" : "unicast");
+  pktsocket->config.receive_data(pktsocket, from, buf, length);
+}
+
+/**
+ * Send the oldest packet of the outgoing queue
+ * @param pktsocket packet socket
+ * @return false if the socket could block, true otherwise
+ */
+static bool
+_send_single(struct oonf_packet_socket *pktsocket) {
+  struct oonf_packet_queue_slot *slot;
+  ssize_t result;
+  struct netaddr_str netbuf;
+
+  slot = &pktsocket->_queue[pktsocket->_queue_head];
+
+  /* try to send packet */
+  result = os_fd_sendto(&pktsocket->scheduler_entry.fd, slot->data, slot->length,
+      &slot->dst, pktsocket->config.dont_route);
+  if (result < 0 && errno == EINTR) {
+    /* try again */
+    return true;
   }
+#if EAGAIN == EWOULDBLOCK
+  if (result < 0 && errno == EAGAIN) {
+#else
+  if (result < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
 #endif
+    /* try again later */
+    OONF_DEBUG(LOG_PACKET, "Sending to %s %s could block, try again later",
+        netaddr_socket_to_string(&netbuf, &slot->dst),
+        pktsocket->os_if != NULL ? pktsocket->os_if->name : "");
+    return false;
+  }
 
-  if (oonf_socket_is_read(entry)) {
-    uint8_t *buf;
-
-    /* clear recvfrom memory */
-    memset(&sock, 0, sizeof(sock));
-
-    /* handle incoming data */
-    buf = pktsocket->config.input_buffer;
-
-    result = os_fd_recvfrom(&entry->fd,
-        buf, pktsocket->config.input_buffer_length-1, &sock,
-        pktsocket->os_if);
-    if (result > 0 && pktsocket->config.receive_data != NULL) {
-      /* handle raw socket */
-      if (pktsocket->protocol) {
-        buf = os_fd_skip_rawsocket_prefix(buf, &result, pktsocket->local_socket.std.sa_family);
-        if (!buf) {
-          OONF_WARN(LOG_PACKET, "Error while skipping IP header for socket %s:",
-              netaddr_socket_to_string(&netbuf, &pktsocket->local_socket));
-          return;
-        }
+  if (result < 0) {
+    /* display error message */
+    OONF_WARN(LOG_PACKET, "Cannot send UDP packet to %s: %s (%d)",
+        netaddr_socket_to_string(&netbuf, &slot->dst), strerror(errno), errno);
+  }
+  else {
+    _count_batch(&pktsocket->tx_stats, 1);
+
+    OONF_DEBUG(LOG_PACKET, "Sent %"PRINTF_SSIZE_T_SPECIFIER" bytes to %s %s",
+        result, netaddr_socket_to_string(&netbuf, &slot->dst),
+        pktsocket->os_if != NULL ? pktsocket->os_if->name : "");
+  }
+  /* remove packet from outgoing queue (both for success and for final error */
+  _dequeue_packets(pktsocket, 1);
+  return true;
+}
+
+/**
+ * Send up to batch_size packets of the outgoing queue with
+ * a single system call
+ * @param pktsocket packet socket
+ * @return false if the socket could block, true otherwise
+ */
+static bool
+_send_batch(struct oonf_packet_socket *pktsocket) {
+  struct os_fd_mmsg msgs[OS_FD_MMSG_MAX];
+  struct oonf_packet_queue_slot *slot;
+  struct netaddr_str netbuf;
+  uint32_t idx, count;
+  int result;
+
+  /* collect packets from outgoing queue */
+  idx = pktsocket->_queue_head;
+  for (count = 0; count < pktsocket->config.batch_size
+      && count < pktsocket->_queue_count; count++) {
+    slot = &pktsocket->_queue[idx];
+
+    memcpy(&msgs[count].addr, &slot->dst, sizeof(msgs[count].addr));
+    msgs[count].buf = slot->data;
+    msgs[count].length = slot->length;
+
+    idx = (idx + 1) % pktsocket->config.queue_length;
+  }
+
+  result = os_fd_sendmmsg(&pktsocket->scheduler_entry.fd,
+      msgs, count, pktsocket->config.dont_route);
+  if (result < 0 && errno == EINTR) {
+    /* try again */
+    return true;
+  }
+#if EAGAIN == EWOULDBLOCK
+  if (result < 0 && errno == EAGAIN) {
+#else
+  if (result < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+#endif
+    /* try again later */
+    OONF_DEBUG(LOG_PACKET, "Sending %u packets on %s could block, try again later",
+        count, pktsocket->os_if != NULL ? pktsocket->os_if->name : "");
+    return false;
+  }
+
+  if (result < 0) {
+    /* display error message and drop the first packet */
+    OONF_WARN(LOG_PACKET, "Cannot send UDP packet to %s: %s (%d)",
+        netaddr_socket_to_string(&netbuf, &msgs[0].addr), strerror(errno), errno);
+    result = 1;
+  }
+  else {
+    _count_batch(&pktsocket->tx_stats, result);
+
+    OONF_DEBUG(LOG_PACKET, "Sent %d of %u packets %s",
+        result, count, pktsocket->os_if != NULL ? pktsocket->os_if->name : "");
+  }
+
+  /* remove processed packets from outgoing queue */
+  _dequeue_packets(pktsocket, result);
+  return true;
+}
+
+/**
+ * Send a burst of at most OS_FD_MMSG_MAX packets to a single destination
+ * with one system call, queue the packets the kernel did not accept.
+ * @param pktsocket packet socket
+ * @param remote destination of packets
+ * @param pkts array of packets
+ * @param count number of packets
+ * @return -1 if an error happened, 0 otherwise
+ */
+static int
+_send_burst(struct oonf_packet_socket *pktsocket, union netaddr_socket *remote,
+    const struct oonf_packet_burst_entry *pkts, size_t count) {
+  struct os_fd_mmsg msgs[OS_FD_MMSG_MAX];
+  struct netaddr_str buf;
+  ssize_t result;
+  size_t i, sent;
+  bool segmented;
+
+  sent = 0;
+  if (pktsocket->_queue_count == 0) {
+    /* no backlog of outgoing packets, try to send directly */
+    for (i=0; i<count; i++) {
+      memcpy(&msgs[i].addr, remote, sizeof(msgs[i].addr));
+      msgs[i].buf = (void *)pkts[i].data;
+      msgs[i].length = pkts[i].length;
+    }
+
+    segmented = pktsocket->_segmentation && _is_segmentable(pkts, count);
+    if (segmented) {
+      result = os_fd_sendsegments(&pktsocket->scheduler_entry.fd, remote,
+          msgs, count, pktsocket->config.dont_route);
+      if (result >= 0) {
+        sent = count;
+        pktsocket->burst_stats.segmented++;
+      }
+      else if (errno != EINTR && errno != EAGAIN && errno != EWOULDBLOCK) {
+        /* kernel or interface refused segmentation, use sendmmsg from now on */
+        OONF_INFO(LOG_PACKET, "UDP segmentation offload failed for %s: %s (%d)",
+            netaddr_socket_to_string(&buf, remote), strerror(errno), errno);
+        pktsocket->_segmentation = false;
+        segmented = false;
+      }
+    }
+    if (!segmented) {
+      result = os_fd_sendmmsg(&pktsocket->scheduler_entry.fd,
+          msgs, count, pktsocket->config.dont_route);
+      if (result > 0) {
+        sent = result;
+        pktsocket->burst_stats.batched++;
       }
-      /* null terminate it */
-      buf[result] = 0;
-
-      /* received valid packet */
-      OONF_DEBUG(LOG_PACKET, "Received %"PRINTF_SSIZE_T_SPECIFIER" bytes from %s %s (%s)",
-          result, netaddr_socket_to_string(&netbuf, &sock),
-          interf, multicast ? "multicast" : "unicast");
-      pktsocket->config.receive_data(pktsocket, &sock, buf, result);
     }
-    else if (result < 0 && (errno != EINTR && errno != EAGAIN && errno != EWOULDBLOCK)) {
-      OONF_WARN(LOG_PACKET, "Cannot read packet from socket %s: %s (%d)",
-          netaddr_socket_to_string(&netbuf, &pktsocket->local_socket), strerror(errno), errno);
+
+    if (sent > 0) {
+      _count_batch(&pktsocket->tx_stats, sent);
+      pktsocket->burst_stats.saved += sent - 1;
+
+      OONF_DEBUG(LOG_PACKET, "Sent %"PRINTF_SIZE_T_SPECIFIER" of %"
+          PRINTF_SIZE_T_SPECIFIER" packets to %s %s",
+          sent, count, netaddr_socket_to_string(&buf, remote),
+          pktsocket->os_if != NULL ? pktsocket->os_if->name : "");
+    }
+    else if (errno != EINTR && errno != EAGAIN && errno != EWOULDBLOCK) {
+      OONF_WARN(LOG_PACKET, "Cannot send UDP packets to %s: %s (%d)",
+          netaddr_socket_to_string(&buf, remote), strerror(errno), errno);
+      return -1;
+    }
+  }
+
+  if (sent == count) {
+    return 0;
+  }
+
+  for (i=sent; i<count; i++) {
+    if (_queue_packet(pktsocket, remote, pkts[i].data, pkts[i].length)) {
+      return -1;
     }
   }
 
-  if (oonf_socket_is_write(entry) && abuf_getlen(&pktsocket->out) > 0) {
-    /* handle outgoing data */
-    pkt = abuf_getptr(&pktsocket->out);
+  /* activate outgoing socket scheduler */
+  oonf_socket_set_write(&pktsocket->scheduler_entry, true);
+  return 0;
+}
 
-    /* copy remote socket */
-    memcpy(&sock, pkt, sizeof(sock));
-    pkt += sizeof(sock);
+/**
+ * Check if a burst of packets can be handed to the kernel as a single
+ * segmented UDP send call
+ * @param pkts array of packets
+ * @param count number of packets
+ * @return true if all packets but the last have the same length,
+ *   the last packet is not longer and the total fits into one call
+ */
+static bool
+_is_segmentable(const struct oonf_packet_burst_entry *pkts, size_t count) {
+  size_t i, total;
 
-    /* copy length */
-    memcpy(&length, pkt, 2);
-    pkt += 2;
+  if (count < 2 || pkts[count-1].length > pkts[0].length) {
+    return false;
+  }
 
-    /* try to send packet */
-    result = os_fd_sendto(&entry->fd, pkt, length, &sock, pktsocket->config.dont_route);
-    if (result < 0 && (errno == EINTR || errno == EAGAIN || errno == EWOULDBLOCK)) {
-      /* try again later */
-      OONF_DEBUG(LOG_PACKET, "Sending to %s %s could block, try again later",
-          netaddr_socket_to_string(&netbuf, &sock), interf);
-      return;
+  total = pkts[count-1].length;
+  for (i=0; i<count-1; i++) {
+    if (pkts[i].length != pkts[0].length) {
+      return false;
     }
+    total += pkts[i].length;
+  }
+  return total <= OS_FD_SEGMENTS_MAX_LENGTH;
+}
 
-    if (result < 0) {
-      /* display error message */
-      OONF_WARN(LOG_PACKET, "Cannot send UDP packet to %s: %s (%d)",
-          netaddr_socket_to_string(&netbuf, &sock), strerror(errno), errno);
+/**
+ * Put a packet into the outgoing queue of a packet socket.
+ * The queue memory is allocated when the first packet is queued.
+ * @param pktsocket packet socket
+ * @param remote destination of packet
+ * @param data pointer to packet data
+ * @param length length of packet
+ * @return -1 if the packet was dropped, 0 otherwise
+ */
+static int
+_queue_packet(struct oonf_packet_socket *pktsocket,
+    union netaddr_socket *remote, const void *data, size_t length) {
+  struct oonf_packet_queue_slot *slot;
+  struct netaddr_str buf;
+  uint8_t *ptr;
+  uint32_t i;
+
+  if (length > pktsocket->config.queue_packet_size) {
+    OONF_WARN(LOG_PACKET, "Cannot queue UDP packet to %s, packet size %"
+        PRINTF_SIZE_T_SPECIFIER" is larger than %u",
+        netaddr_socket_to_string(&buf, remote), length,
+        pktsocket->config.queue_packet_size);
+    pktsocket->queue_stats.dropped++;
+    return -1;
+  }
+
+  if (pktsocket->_queue == NULL) {
+    /* allocate slots and packet buffers with a single allocation */
+    pktsocket->_queue = calloc(pktsocket->config.queue_length,
+        sizeof(*slot) + pktsocket->config.queue_packet_size);
+    if (pktsocket->_queue == NULL) {
+      OONF_WARN(LOG_PACKET, "Not enough memory for outgoing packet queue");
+      pktsocket->queue_stats.dropped++;
+      return -1;
     }
-    else {
-      OONF_DEBUG(LOG_PACKET, "Sent %"PRINTF_SSIZE_T_SPECIFIER" bytes to %s %s",
-          result, netaddr_socket_to_string(&netbuf, &sock), interf);
+
+    ptr = (uint8_t *)(&pktsocket->_queue[pktsocket->config.queue_length]);
+    for (i=0; i<pktsocket->config.queue_length; i++) {
+      pktsocket->_queue[i].data = ptr + i * pktsocket->config.queue_packet_size;
     }
-    /* remove data from outgoing buffer (both for success and for final error */
-    abuf_pull(&pktsocket->out, sizeof(sock) + 2 + length);
+    pktsocket->_queue_head = 0;
+    pktsocket->_queue_count = 0;
   }
 
-  if (abuf_getlen(&pktsocket->out) == 0) {
-    /* nothing left to send, disable outgoing events */
-    oonf_socket_set_write(&pktsocket->scheduler_entry, false);
+  if (pktsocket->_queue_count == pktsocket->config.queue_length) {
+    pktsocket->queue_stats.dropped++;
+
+    if (pktsocket->config.drop_policy == OONF_PACKET_DROP_TAIL) {
+      OONF_DEBUG(LOG_PACKET, "Outgoing queue full, drop packet to %s",
+          netaddr_socket_to_string(&buf, remote));
+      return -1;
+    }
+
+    OONF_DEBUG(LOG_PACKET, "Outgoing queue full, drop oldest packet");
+    _dequeue_packets(pktsocket, 1);
+  }
+
+  slot = &pktsocket->_queue[(pktsocket->_queue_head + pktsocket->_queue_count)
+                            % pktsocket->config.queue_length];
+  memcpy(&slot->dst, remote, sizeof(slot->dst));
+  memcpy(slot->data, data, length);
+  slot->length = length;
+
+  pktsocket->_queue_count++;
+  pktsocket->queue_stats.queued++;
+  if (pktsocket->queue_stats.max_depth < pktsocket->_queue_count) {
+    pktsocket->queue_stats.max_depth = pktsocket->_queue_count;
+  }
+  return 0;
+}
+
+/**
+ * Remove the oldest packets from the outgoing queue of a packet socket
+ * @param pktsocket packet socket
+ * @param count number of packets to remove
+ */
+static void
+_dequeue_packets(struct oonf_packet_socket *pktsocket, uint32_t count) {
+  if (count > pktsocket->_queue_count) {
+    count = pktsocket->_queue_count;
+  }
+
+  pktsocket->_queue_head = (pktsocket->_queue_head + count)
+      % pktsocket->config.queue_length;
+  pktsocket->_queue_count -= count;
+}
+
+/**
+ * Update the batch statistics of a packet socket
+ * @param stats pointer to statistics
+ * @param count number of packets handled by a single system call
+ */
+static void
+_count_batch(struct oonf_packet_batch_stats *stats, int count) {
+  stats->calls++;
+  stats->packets += count;
+  if (stats->max_batch < (uint32_t)count) {
+    stats->max_batch = count;
   }
 }
 
@@ -61,8 +61,25 @@
 /*! subsystem identifier */
 #define OONF_PACKET_SUBSYSTEM "packet_socket"
 
+/*! default number of packets in the outgoing queue of a socket */
+#define OONF_PACKET_DEFAULT_QUEUE_LENGTH      64
+
+/*! default maximum size of a packet in the outgoing queue of a socket */
+#define OONF_PACKET_DEFAULT_QUEUE_PACKET_SIZE 1500
+
 struct oonf_packet_socket;
 
+/**
+ * Handling of outgoing packets when the queue of a socket is full
+ */
+enum oonf_packet_drop_policy {
+  /*! drop the new packet */
+  OONF_PACKET_DROP_TAIL,
+
+  /*! drop the oldest packet in the queue */
+  OONF_PACKET_DROP_HEAD,
+};
+
 /**
  * Configuraten of a packet socket
  */
@@ -86,10 +103,92 @@ struct oonf_packet_config {
   /*! true if the outgoing UDP traffic should not be routed */
   bool dont_route;
 
+  /**
+   * maximum number of packets received or sent with a single
+   * system call, 0 or 1 to disable batching
+   */
+  uint32_t batch_size;
+
+  /*! number of packets in the outgoing queue, 0 for default */
+  uint32_t queue_length;
+
+  /*! maximum size of a packet in the outgoing queue, 0 for default */
+  uint32_t queue_packet_size;
+
+  /*! handling of outgoing packets if the queue is full */
+  enum oonf_packet_drop_policy drop_policy;
+
   /*! user defined pointer */
   void *user;
 };
 
+/**
+ * Counters for batched packet handling of a packet socket
+ */
+struct oonf_packet_batch_stats {
+  /*! number of system calls */
+  uint64_t calls;
+
+  /*! number of packets handled by the system calls */
+  uint64_t packets;
+
+  /*! largest number of packets handled by a single system call */
+  uint32_t max_batch;
+};
+
+/**
+ * Counters for the outgoing queue of a packet socket
+ */
+struct oonf_packet_queue_stats {
+  /*! number of packets put into the outgoing queue */
+  uint64_t queued;
+
+  /*! number of packets dropped because of the outgoing queue */
+  uint64_t dropped;
+
+  /*! largest number of packets in the outgoing queue */
+  uint32_t max_depth;
+};
+
+/**
+ * Counters for bursts of packets sent to a single destination
+ */
+struct oonf_packet_burst_stats {
+  /*! number of bursts sent with a single segmented (GSO) system call */
+  uint64_t segmented;
+
+  /*! number of bursts sent with a single sendmmsg system call */
+  uint64_t batched;
+
+  /*! number of system calls saved compared to one call per packet */
+  uint64_t saved;
+};
+
+/**
+ * Single packet of a burst sent to one destination
+ */
+struct oonf_packet_burst_entry {
+  /*! pointer to packet data */
+  const void *data;
+
+  /*! length of packet */
+  size_t length;
+};
+
+/**
+ * Slot for a packet in the outgoing queue of a packet socket
+ */
+struct oonf_packet_queue_slot {
+  /*! destination of packet */
+  union netaddr_socket dst;
+
+  /*! pointer to packet data */
+  uint8_t *data;
+
+  /*! length of packet */
+  size_t length;
+};
+
 /**
  * Definition of a packet socket
  */
@@ -106,14 +205,38 @@ struct oonf_packet_socket {
   /*! IP protocol number for raw sockets */
   int protocol;
 
-  /*! outgoing buffer */
-  struct autobuf out;
-
   /*! interface data the socket is bound to */
   struct os_interface *os_if;
 
   /*! configuration of packet socket */
   struct oonf_packet_config config;
+
+  /*! statistics for incoming packets */
+  struct oonf_packet_batch_stats rx_stats;
+
+  /*! statistics for outgoing packets */
+  struct oonf_packet_batch_stats tx_stats;
+
+  /*! statistics for the outgoing queue */
+  struct oonf_packet_queue_stats queue_stats;
+
+  /*! statistics for bursts of outgoing packets */
+  struct oonf_packet_burst_stats burst_stats;
+
+  /*! ring of outgoing packets, NULL until first packet had to be queued */
+  struct oonf_packet_queue_slot *_queue;
+
+  /*! index of the oldest packet in the outgoing queue */
+  uint32_t _queue_head;
+
+  /*! number of packets in the outgoing queue */
+  uint32_t _queue_count;
+
+  /*! buffer for batched packet reception, NULL if not used */
+  uint8_t *_batch_buffer;
+
+  /*! true if the kernel supports UDP segmentation offload for the socket */
+  bool _segmentation;
 };
 
 /**
@@ -211,18 +334,33 @@ EXPORT int oonf_packet_send_managed(struct oonf_packet_managed *,
 EXPORT int oonf_packet_send_managed_multicast(
     struct oonf_packet_managed *managed,
     const void *data, size_t length, int af_type);
+EXPORT int oonf_packet_send_burst(struct oonf_packet_socket *,
+    union netaddr_socket *remote,
+    const struct oonf_packet_burst_entry *pkts, size_t count);
+EXPORT int oonf_packet_send_managed_burst(struct oonf_packet_managed *,
+    union netaddr_socket *remote,
+    const struct oonf_packet_burst_entry *pkts, size_t count);
+EXPORT int oonf_packet_send_managed_multicast_burst(
+    struct oonf_packet_managed *managed,
+    const struct oonf_packet_burst_entry *pkts, size_t count, int af_type);
 EXPORT void oonf_packet_add_managed(struct oonf_packet_managed *);
 EXPORT int oonf_packet_apply_managed(struct oonf_packet_managed *,
     const struct oonf_packet_managed_config *);
 EXPORT void oonf_packet_remove_managed(struct oonf_packet_managed *, bool force);
 EXPORT bool oonf_packet_managed_is_active(
     struct oonf_packet_managed *managed, int af_type);
+EXPORT void oonf_packet_set_queue(struct oonf_packet_socket *,
+    uint32_t length, uint32_t packet_size, enum oonf_packet_drop_policy policy);
+EXPORT void oonf_packet_set_managed_queue(struct oonf_packet_managed *,
+    uint32_t length, uint32_t packet_size, enum oonf_packet_drop_policy policy);
 EXPORT void oonf_packet_copy_managed_config(
     struct oonf_packet_managed_config *dst,
     const struct oonf_packet_managed_config *src);
 EXPORT void oonf_packet_free_managed_config(
     struct oonf_packet_managed_config *config);
 
+EXPORT struct list_entity *oonf_packet_get_list(void);
+
 /**
  * @param sock pointer to packet socket
  * @return true if the socket is active to send data, false otherwise
@@ -232,4 +370,13 @@ oonf_packet_is_active(struct oonf_packet_socket *sock) {
   return list_is_node_added(&sock->node);
 }
 
+/**
+ * @param sock pointer to packet socket
+ * @return number of packets in the outgoing queue
+ */
+static INLINE uint32_t
+oonf_packet_get_queue_depth(struct oonf_packet_socket *sock) {
+  return sock->_queue_count;
+}
+
 #endif /* OONF_PACKET_SOCKET_H_ */
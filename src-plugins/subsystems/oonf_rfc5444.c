@@ -46,6 +46,7 @@
 #include "common/common_types.h"
 #include "common/avl.h"
 #include "common/avl_comp.h"
+#include "common/prng.h"
 #include "config/cfg_db.h"
 #include "config/cfg_schema.h"
 #include "rfc5444/rfc5444_iana.h"
@@ -80,6 +81,15 @@ struct _rfc5444_config {
    * RFC5444 messages on the same target
    */
   uint64_t aggregation_interval;
+
+  /*! number of packets in the outgoing queue of a socket */
+  int32_t queue_length;
+
+  /*! maximum size of a packet in the outgoing queue of a socket */
+  int32_t queue_packet_size;
+
+  /*! handling of outgoing packets if the queue is full */
+  int queue_drop;
 };
 
 /* prototypes */
@@ -100,16 +110,18 @@ static void _cb_forward_message(struct rfc5444_reader_tlvblock_context *context,
     uint8_t *buffer, size_t length);
 static void _cb_forwarding_notifier(struct rfc5444_writer_target *);
 
+static void _begin_burst(void);
+static void _end_burst(void);
+static void _send_packet(struct oonf_rfc5444_target *t,
+    union netaddr_socket *sock, bool multicast, void *ptr, size_t len);
+static void _flush_burst(void);
+
 static bool _cb_single_target_selector(struct rfc5444_writer *, struct rfc5444_writer_target *, void *);
 static bool _cb_filtered_targets_selector(struct rfc5444_writer *writer,
     struct rfc5444_writer_target *rfc5444_target, void *ptr);
 
-static struct rfc5444_reader_addrblock_entry *_alloc_addrblock_entry(void);
-static struct rfc5444_reader_tlvblock_entry *_alloc_tlvblock_entry(void);
 static struct rfc5444_writer_address *_alloc_address_entry(void);
 static struct rfc5444_writer_addrtlv *_alloc_addrtlv_entry(void);
-static void _free_addrblock_entry(struct rfc5444_reader_addrblock_entry* addrblock);
-static void _free_tlvblock_entry(struct rfc5444_reader_tlvblock_entry *tlvblock);
 static void _free_address_entry(struct rfc5444_writer_address *);
 static void _free_addrtlv_entry(struct rfc5444_writer_addrtlv *);
 
@@ -136,18 +148,6 @@ static struct oonf_class _target_memcookie = {
   .size = sizeof(struct oonf_rfc5444_target),
 };
 
-static struct oonf_class _tlvblock_memcookie = {
-  .name = "RFC5444 TLVblock",
-  .size = sizeof(struct rfc5444_reader_tlvblock_entry),
-  .min_free_count = 32,
-};
-
-static struct oonf_class _addrblock_memcookie = {
-  .name = "RFC5444 Addrblock",
-  .size = sizeof(struct rfc5444_reader_addrblock_entry),
-  .min_free_count = 32,
-};
-
 static struct oonf_class _address_memcookie = {
   .name = "RFC5444 Address",
   .size = sizeof(struct rfc5444_writer_address),
@@ -166,6 +166,12 @@ static struct oonf_timer_class _aggregation_timer = {
   .callback = _cb_aggregation_event,
 };
 
+/* names of the drop policies of the outgoing packet queue */
+static const char *_QUEUE_DROP_POLICY[] = {
+  [OONF_PACKET_DROP_TAIL] = "tail",
+  [OONF_PACKET_DROP_HEAD] = "head",
+};
+
 /* configuration settings for handler */
 static struct cfg_schema_entry _rfc5444_entries[] = {
   CFG_MAP_INT32_MINMAX(_rfc5444_config, port, "port", RFC5444_MANET_UDP_PORT_TXT,
@@ -174,6 +180,13 @@ static struct cfg_schema_entry _rfc5444_entries[] = {
     "IP protocol for RFC5444 interface", 0, false, 1, 255),
   CFG_MAP_CLOCK(_rfc5444_config, aggregation_interval, "agregation_interval", "0.100",
     "Interval in seconds for message aggregation"),
+  CFG_MAP_INT32_MINMAX(_rfc5444_config, queue_length, "queue_length", "64",
+    "Number of packets in the outgoing queue of a RFC5444 socket", 0, false, 1, 65535),
+  CFG_MAP_INT32_MINMAX(_rfc5444_config, queue_packet_size, "queue_packet_size", "1500",
+    "Maximum size of a packet in the outgoing queue of a RFC5444 socket", 0, false, 576, 65535),
+  CFG_MAP_CHOICE(_rfc5444_config, queue_drop, "queue_drop", "tail",
+    "Packet to drop if the outgoing queue is full, the new one (tail)"
+    " or the oldest queued one (head)", _QUEUE_DROP_POLICY),
 };
 
 static struct cfg_schema_section _rfc5444_section = {
@@ -214,10 +227,6 @@ static uint64_t _aggregation_interval;
 /* rfc5444 handling */
 static const struct rfc5444_reader _reader_template = {
   .forward_message = _cb_forward_message,
-  .malloc_addrblock_entry = _alloc_addrblock_entry,
-  .malloc_tlvblock_entry = _alloc_tlvblock_entry,
-  .free_addrblock_entry = _free_addrblock_entry,
-  .free_tlvblock_entry = _free_tlvblock_entry,
 };
 static const struct rfc5444_writer _writer_template = {
   .malloc_address_entry = _alloc_address_entry,
@@ -232,12 +241,7 @@ static const struct rfc5444_writer _writer_template = {
 static struct autobuf _printer_buffer;
 static struct rfc5444_print_session _printer_session;
 
-static struct rfc5444_reader _printer = {
-  .malloc_addrblock_entry = _alloc_addrblock_entry,
-  .malloc_tlvblock_entry = _alloc_tlvblock_entry,
-  .free_addrblock_entry = _free_addrblock_entry,
-  .free_tlvblock_entry = _free_tlvblock_entry,
-};
+static struct rfc5444_reader _printer;
 
 /* configuration for RFC5444 socket */
 static uint8_t _incoming_buffer[RFC5444_MAX_PACKET_SIZE];
@@ -246,6 +250,7 @@ static struct oonf_packet_config _socket_config = {
   .input_buffer = _incoming_buffer,
   .input_buffer_length = sizeof(_incoming_buffer),
   .receive_data = _cb_receive_data,
+  .batch_size = RFC5444_SOCKET_BATCH_SIZE,
 };
 
 /* tree of active rfc5444 protocols */
@@ -255,6 +260,9 @@ static struct avl_tree _protocol_tree;
 static struct oonf_rfc5444_protocol *_rfc5444_protocol = NULL;
 static struct oonf_rfc5444_interface *_rfc5444_unicast = NULL;
 
+/* generator for initial sequence numbers */
+static struct prng_state _prng;
+
 static const struct const_strarray _unicast_bindto_acl_value =
     STRARRAY_INIT("0.0.0.0\0::");
 
@@ -279,6 +287,17 @@ DECLARE_OONF_PLUGIN(_oonf_rfc5444_subsystem);
 /* static blocking of RFC5444 output */
 static bool _block_output = false;
 
+/* packets for a single target collected during a writer call */
+static uint8_t _burst_buffer[RFC5444_BURST_LENGTH][RFC5444_MAX_PACKET_SIZE];
+static struct oonf_packet_burst_entry _burst[RFC5444_BURST_LENGTH];
+static size_t _burst_count = 0;
+static struct oonf_rfc5444_target *_burst_target = NULL;
+static union netaddr_socket _burst_dst;
+static bool _burst_multicast;
+
+/* nesting level of writer calls collecting packets */
+static int _burst_depth = 0;
+
 /* additional logging targets */
 enum oonf_log_source LOG_RFC5444_R, LOG_RFC5444_W;
 
@@ -288,12 +307,18 @@ enum oonf_log_source LOG_RFC5444_R, LOG_RFC5444_W;
  */
 static int
 _init(void) {
+  uint64_t seed;
+
+  if (os_core_get_random(&seed, sizeof(seed))) {
+    OONF_WARN(LOG_RFC5444, "Could not get random data");
+    seed = 0;
+  }
+  prng_seed(&_prng, seed);
+
   avl_init(&_protocol_tree, avl_comp_strcasecmp, false);
 
   oonf_class_add(&_protocol_memcookie);
   oonf_class_add(&_target_memcookie);
-  oonf_class_add(&_addrblock_memcookie);
-  oonf_class_add(&_tlvblock_memcookie);
   oonf_class_add(&_address_memcookie);
   oonf_class_add(&_addrtlv_memcookie);
 
@@ -368,8 +393,6 @@ _cleanup(void) {
   oonf_class_remove(&_protocol_memcookie);
   oonf_class_remove(&_interface_memcookie);
   oonf_class_remove(&_target_memcookie);
-  oonf_class_remove(&_tlvblock_memcookie);
-  oonf_class_remove(&_addrblock_memcookie);
   oonf_class_remove(&_address_memcookie);
   oonf_class_remove(&_addrtlv_memcookie);
   return;
@@ -383,6 +406,7 @@ _cleanup(void) {
  */
 enum rfc5444_result oonf_rfc5444_send_if(
     struct oonf_rfc5444_target *target, uint8_t msgid) {
+  enum rfc5444_result result;
   uint8_t addr_len;
 
   #ifdef OONF_LOG_INFO
@@ -405,8 +429,12 @@ enum rfc5444_result oonf_rfc5444_send_if(
       target->interface->name);
 
   addr_len = netaddr_get_address_family(&target->dst) == AF_INET ? 4 : 16;
-  return rfc5444_writer_create_message(&target->interface->protocol->writer,
+
+  _begin_burst();
+  result = rfc5444_writer_create_message(&target->interface->protocol->writer,
       msgid, addr_len, _cb_single_target_selector, target);
+  _end_burst();
+  return result;
 }
 
 /**
@@ -420,11 +448,16 @@ enum rfc5444_result oonf_rfc5444_send_if(
 enum rfc5444_result
 oonf_rfc5444_send_all(struct oonf_rfc5444_protocol *protocol,
     uint8_t msgid, uint8_t addr_len, rfc5444_writer_targetselector useIf) {
+  enum rfc5444_result result;
+
   /* create message */
   OONF_INFO(LOG_RFC5444, "Create message id %d", msgid);
 
-  return rfc5444_writer_create_message(&protocol->writer,
+  _begin_burst();
+  result = rfc5444_writer_create_message(&protocol->writer,
       msgid, addr_len, _cb_filtered_targets_selector, useIf);
+  _end_burst();
+  return result;
 }
 
 /**
@@ -570,10 +603,7 @@ oonf_rfc5444_add_interface(struct oonf_rfc5444_protocol *protocol,
 
   interf = oonf_rfc5444_get_interface(protocol, name);
   if (interf == NULL) {
-    if (os_core_get_random(&rnd, sizeof(rnd))) {
-      OONF_WARN(LOG_RFC5444, "Could not get random data");
-      return NULL;
-    }
+    rnd = prng_next32(&_prng);
 
     interf = oonf_class_malloc(&_interface_memcookie);
     if (interf == NULL) {
@@ -904,6 +934,20 @@ oonf_rfc5444_block_output(bool block) {
   _block_output = block;
 }
 
+/**
+ * Flush a target and send out the message/packet immediately
+ * @param target rfc5444 target
+ * @param force true to force an empty packet if necessary, false will only
+ *   flush if a message is in the buffer
+ */
+void
+oonf_rfc5444_flush_target(struct oonf_rfc5444_target *target, bool force) {
+  _begin_burst();
+  rfc5444_writer_flush(&target->interface->protocol->writer,
+      &target->rfc5444_target, force);
+  _end_burst();
+}
+
 /**
  * Create a new rfc5444 target
  * @param interf rfc5444 interface
@@ -917,10 +961,7 @@ _create_target(struct oonf_rfc5444_interface *interf,
   static struct oonf_rfc5444_target *target;
   uint16_t rnd;
 
-  if (os_core_get_random(&rnd, sizeof(rnd))) {
-    OONF_WARN(LOG_RFC5444, "Could not get random data");
-    return NULL;
-  }
+  rnd = prng_next32(&_prng);
 
   target = oonf_class_malloc(&_target_memcookie);
   if (target == NULL) {
@@ -964,6 +1005,11 @@ _create_target(struct oonf_rfc5444_interface *interf,
  */
 static void
 _destroy_target(struct oonf_rfc5444_target *target) {
+  if (_burst_target == target) {
+    /* send collected packets while the interface socket still exists */
+    _flush_burst();
+  }
+
   /* cleanup interface */
   rfc5444_writer_unregister_target(
       &target->interface->protocol->writer, &target->rfc5444_target);
@@ -1097,8 +1143,7 @@ _cb_send_multicast_packet(struct rfc5444_writer *writer __attribute__((unused)),
     OONF_DEBUG(LOG_RFC5444, "Output blocked");
     return;
   }
-  oonf_packet_send_managed_multicast(&t->interface->_socket,
-      ptr, len, netaddr_get_address_family(&t->dst));
+  _send_packet(t, &sock, true, ptr, len);
 }
 
 /**
@@ -1130,7 +1175,96 @@ _cb_send_unicast_packet(struct rfc5444_writer *writer __attribute__((unused)),
     return;
   }
 
-  oonf_packet_send_managed(&t->interface->_socket, &sock, ptr, len);
+  _send_packet(t, &sock, false, ptr, len);
+}
+
+/**
+ * Start collecting the packets generated by a writer call,
+ * calls can be nested.
+ */
+static void
+_begin_burst(void) {
+  _burst_depth++;
+}
+
+/**
+ * Stop collecting the packets generated by a writer call and
+ * send them out when the outermost call is finished.
+ */
+static void
+_end_burst(void) {
+  if (--_burst_depth == 0) {
+    _flush_burst();
+  }
+}
+
+/**
+ * Hand an outgoing packet to the packet socket, or collect it
+ * together with the other packets for the same target if a writer
+ * call is in progress.
+ * @param t rfc5444 target
+ * @param sock destination socket of packet
+ * @param multicast true if packet should be sent to the
+ *   multicast address of the interface
+ * @param ptr pointer to outgoing buffer
+ * @param len length of buffer
+ */
+static void
+_send_packet(struct oonf_rfc5444_target *t,
+    union netaddr_socket *sock, bool multicast, void *ptr, size_t len) {
+  if (_burst_depth == 0 || len > sizeof(_burst_buffer[0])) {
+    /* keep order of packets */
+    _flush_burst();
+
+    if (multicast) {
+      oonf_packet_send_managed_multicast(&t->interface->_socket,
+          ptr, len, netaddr_get_address_family(&t->dst));
+    }
+    else {
+      oonf_packet_send_managed(&t->interface->_socket, sock, ptr, len);
+    }
+    return;
+  }
+
+  if (_burst_count > 0
+      && (_burst_target != t || _burst_count == RFC5444_BURST_LENGTH)) {
+    _flush_burst();
+  }
+
+  _burst_target = t;
+  _burst_multicast = multicast;
+  memcpy(&_burst_dst, sock, sizeof(_burst_dst));
+
+  memcpy(_burst_buffer[_burst_count], ptr, len);
+  _burst[_burst_count].data = _burst_buffer[_burst_count];
+  _burst[_burst_count].length = len;
+  _burst_count++;
+}
+
+/**
+ * Send all collected packets of a target with a single call
+ * to the packet socket.
+ */
+static void
+_flush_burst(void) {
+  struct oonf_rfc5444_target *t;
+
+  if (_burst_count == 0) {
+    return;
+  }
+
+  t = _burst_target;
+  if (_burst_multicast) {
+    oonf_packet_send_managed_multicast_burst(&t->interface->_socket,
+        _burst, _burst_count, netaddr_get_address_family(&t->dst));
+  }
+  else {
+    oonf_packet_send_managed_burst(&t->interface->_socket,
+        &_burst_dst, _burst, _burst_count);
+  }
+
+  _burst_count = 0;
+  _burst_target = NULL;
 }
 
 /**
@@ -1152,7 +1286,9 @@ _cb_forward_message(
   /* forward message */
   OONF_INFO(LOG_RFC5444, "Forwarding message type %u", context->msg_type);
 
+  _begin_burst();
   result = rfc5444_writer_forward_msg(&protocol->writer, context, buffer, length);
+  _end_burst();
   if (result != RFC5444_OKAY && result != RFC5444_NO_MSGCREATOR) {
     OONF_WARN(LOG_RFC5444, "Error while forwarding message: %s (%d)",
         rfc5444_strerror(result), result);
@@ -1227,24 +1363,6 @@ _cb_filtered_targets_selector(struct rfc5444_writer *writer,
   return true;
 }
 
-/**
- * Internal memory allocation function for addrblock
- * @return pointer to cleared addrblock
- */
-static struct rfc5444_reader_addrblock_entry *
-_alloc_addrblock_entry(void) {
-  return oonf_class_malloc(&_addrblock_memcookie);
-}
-
-/**
- * Internal memory allocation function for rfc5444_reader_tlvblock_entry
- * @return pointer to cleared rfc5444_reader_tlvblock_entry
- */
-static struct rfc5444_reader_tlvblock_entry *
-_alloc_tlvblock_entry(void) {
-  return oonf_class_malloc(&_tlvblock_memcookie);
-}
-
 /**
  * Internal memory allocation function for rfc5444_writer_address
  * @return pointer to cleared rfc5444_writer_address
@@ -1263,24 +1381,6 @@ _alloc_addrtlv_entry(void) {
   return oonf_class_malloc(&_addrtlv_memcookie);
 }
 
-/**
- * Free an addrblock entry
- * @param pointer to addrblock
- */
-static void
-_free_addrblock_entry(struct rfc5444_reader_addrblock_entry* addrblock) {
-  oonf_class_free(&_addrblock_memcookie, addrblock);
-}
-
-/**
- * Free a tlvblock entry
- * @param pointer to tlvblock
- */
-static void
-_free_tlvblock_entry(struct rfc5444_reader_tlvblock_entry *tlvblock) {
-  oonf_class_free(&_tlvblock_memcookie, tlvblock);
-}
-
 /**
  * Free a tlvblock entry
  * @param pointer to tlvblock
@@ -1331,8 +1431,7 @@ _cb_aggregation_event (struct oonf_timer_instance *ptr) {
 
   target = container_of(ptr, struct oonf_rfc5444_target, _aggregation);
 
-  rfc5444_writer_flush(
-      &target->interface->protocol->writer, &target->rfc5444_target, false);
+  oonf_rfc5444_flush_target(target, false);
 }
 
 /**
@@ -1341,6 +1440,8 @@ _cb_aggregation_event (struct oonf_timer_instance *ptr) {
 static void
 _cb_cfg_rfc5444_changed(void) {
   struct _rfc5444_config config;
+  struct oonf_rfc5444_protocol *protocol;
+  struct oonf_rfc5444_interface *interf;
   int result;
 
   memset(&config, 0, sizeof(config));
@@ -1354,6 +1455,17 @@ _cb_cfg_rfc5444_changed(void) {
   }
 
   /* apply values */
+  _socket_config.queue_length = config.queue_length;
+  _socket_config.queue_packet_size = config.queue_packet_size;
+  _socket_config.drop_policy = config.queue_drop;
+
+  avl_for_each_element(&_protocol_tree, protocol, _node) {
+    avl_for_each_element(&protocol->_interface_tree, interf, _node) {
+      oonf_packet_set_managed_queue(&interf->_socket, config.queue_length,
+          config.queue_packet_size, config.queue_drop);
+    }
+  }
+
   oonf_rfc5444_reconfigure_protocol(_rfc5444_protocol,
       config.port, config.ip_proto);
   _aggregation_interval = config.aggregation_interval;
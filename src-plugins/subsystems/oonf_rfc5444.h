@@ -86,6 +86,15 @@ enum {
 
   /*! Maximum buffer size for address TLVs before splitting */
   RFC5444_ADDRTLV_BUFFER = 65536,
+
+  /*! Maximum number of packets received/sent with a single system call */
+  RFC5444_SOCKET_BATCH_SIZE = 16,
+
+  /**
+   * Maximum number of packets for a single target collected during
+   * one writer call before they are handed to the socket together
+   */
+  RFC5444_BURST_LENGTH = 8,
 };
 
 /*! Interface name for unicast targets */
@@ -283,6 +292,8 @@ EXPORT enum rfc5444_result oonf_rfc5444_send_all(
     uint8_t msgid, uint8_t addr_len, rfc5444_writer_targetselector useIf);
 
 EXPORT void oonf_rfc5444_block_output(bool block);
+EXPORT void oonf_rfc5444_flush_target(
+    struct oonf_rfc5444_target *target, bool force);
 
 /**
  * @param protocol RFC5444 protocol
@@ -296,17 +307,6 @@ oonf_rfc5444_get_interface(
   return avl_find_element(&protocol->_interface_tree, name, interf, _node);
 }
 
-/**
- * Flush a target and send out the message/packet immediately
- * @param target rfc5444 target
- * @param force true to force an empty packet if necessary, false will only
- *   flush if a message is in the buffer
- */
-static INLINE void
-oonf_rfc5444_flush_target(struct oonf_rfc5444_target *target, bool force) {
-  rfc5444_writer_flush(&target->interface->protocol->writer, &target->rfc5444_target, force);
-}
-
 /**
  * @param writer pointer to rfc5444 writer
  * @return pointer to rfc5444 target used by message
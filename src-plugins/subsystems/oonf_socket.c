@@ -55,6 +55,7 @@
 #include "core/oonf_logging.h"
 #include "core/oonf_main.h"
 #include "core/oonf_subsystem.h"
+#include "subsystems/oonf_job.h"
 #include "subsystems/oonf_timer.h"
 #include "subsystems/os_fd.h"
 #include "subsystems/os_clock.h"
@@ -80,9 +81,13 @@ static struct list_entity _socket_head;
 /* socket event scheduler */
 struct os_fd_select _socket_events;
 
+/* socket entry currently in process callback, NULL if it has been removed */
+static struct oonf_socket_entry *_socket_in_callback;
+
 /* subsystem definition */
 static const char *_dependencies[] = {
   OONF_TIMER_SUBSYSTEM,
+  OONF_JOB_SUBSYSTEM,
   OONF_OS_FD_SUBSYSTEM,
 };
 
@@ -149,6 +154,8 @@ oonf_socket_add(struct oonf_socket_entry *entry)
   OONF_DEBUG(LOG_SOCKET, "Adding socket entry %d to scheduler\n",
       os_fd_get_fd(&entry->fd));
 
+  histogram_reset(&entry->latency);
+
   list_add_before(&_socket_head, &entry->_node);
   os_fd_event_socket_add(&_socket_events, &entry->fd);
 }
@@ -167,6 +174,10 @@ oonf_socket_remove(struct oonf_socket_entry *entry)
     list_remove(&entry->_node);
     os_fd_event_socket_remove(&_socket_events, &entry->fd);
   }
+  if (_socket_in_callback == entry) {
+    /* entry might be freed after the callback */
+    _socket_in_callback = NULL;
+  }
 }
 
 void
@@ -179,6 +190,25 @@ oonf_socket_set_write(struct oonf_socket_entry *entry, bool event_write) {
   os_fd_event_socket_write(&_socket_events, &entry->fd, event_write);
 }
 
+/**
+ * Switch a socket to edge triggered events. The process callback
+ * of the socket must read until the socket would block.
+ * @param entry pointer to socket entry
+ * @param edge_triggered true for edge triggered, false for level triggered
+ */
+void
+oonf_socket_set_edge_triggered(struct oonf_socket_entry *entry, bool edge_triggered) {
+  os_fd_event_socket_edge_triggered(&_socket_events, &entry->fd, edge_triggered);
+}
+
+/**
+ * @return list of all sockets in the scheduler
+ */
+struct list_entity *
+oonf_socket_get_list(void) {
+  return &_socket_head;
+}
+
 static bool
 _shall_end_scheduler(void) {
   return _scheduler_time_limit == ~0ull && oonf_main_shall_stop_scheduler();
@@ -213,7 +243,22 @@ _handle_scheduling(void)
       return 0;
     }
 
-    next_event = oonf_timer_getNextEvent();
+    if (oonf_job_is_pending()) {
+      /* run one slice of the pending jobs between the I/O events */
+      oonf_job_run_slice();
+
+      if (oonf_clock_update()) {
+        return -1;
+      }
+    }
+
+    if (oonf_job_is_pending()) {
+      /* only poll the sockets, the jobs need further slices */
+      next_event = oonf_clock_getNow();
+    }
+    else {
+      next_event = oonf_timer_getNextEvent();
+    }
     if (next_event > _scheduler_time_limit) {
       next_event = _scheduler_time_limit;
     }
@@ -260,13 +305,23 @@ _handle_scheduling(void)
             os_fd_event_is_read(sock) ? "true" : "false",
             os_fd_event_is_write(sock) ? "true" : "false");
 
-        os_clock_gettime64(&start_time);
+        _socket_in_callback = sock_entry;
+
+        os_clock_gettime64_ns(&start_time);
         sock_entry->process(sock_entry);
-        os_clock_gettime64(&end_time);
+        os_clock_gettime64_ns(&end_time);
+
+        if (_socket_in_callback == NULL) {
+          /* socket has been removed during callback */
+          continue;
+        }
+        _socket_in_callback = NULL;
+
+        histogram_add(&sock_entry->latency, end_time - start_time);
 
-        if (end_time - start_time > OONF_TIMER_SLICE) {
+        if (end_time - start_time > OONF_TIMER_SLICE * 1000000ull) {
           OONF_WARN(LOG_SOCKET, "Socket %d scheduling took %"PRIu64" ms",
-              os_fd_get_fd(&sock_entry->fd), end_time - start_time);
+              os_fd_get_fd(&sock_entry->fd), (end_time - start_time) / 1000000);
         }
       }
     }
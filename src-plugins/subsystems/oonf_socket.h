@@ -49,6 +49,7 @@
 #include "common/common_types.h"
 #include "common/list.h"
 #include "common/avl.h"
+#include "common/histogram.h"
 #include "common/netaddr_acl.h"
 #include "subsystems/os_fd.h"
 
@@ -68,6 +69,12 @@ struct oonf_socket_entry {
    */
   void (*process) (struct oonf_socket_entry *entry);
 
+  /*! name of socket for statistics, NULL if unnamed */
+  const char *name;
+
+  /*! runtime of process callback in nanoseconds */
+  struct histogram latency;
+
   /*! list of socket handlers */
   struct list_entity _node;
 };
@@ -78,6 +85,9 @@ EXPORT void oonf_socket_set_read(
     struct oonf_socket_entry *entry, bool event_read);
 EXPORT void oonf_socket_set_write(
     struct oonf_socket_entry *entry, bool event_write);
+EXPORT void oonf_socket_set_edge_triggered(
+    struct oonf_socket_entry *entry, bool edge_triggered);
+EXPORT struct list_entity *oonf_socket_get_list(void);
 
 static INLINE bool
 oonf_socket_is_read(struct oonf_socket_entry *entry) {
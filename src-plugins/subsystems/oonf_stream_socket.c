@@ -180,6 +180,7 @@ oonf_stream_add(struct oonf_stream_socket *stream_socket,
     }
 
     stream_socket->scheduler_entry.process = _cb_parse_request;
+    stream_socket->scheduler_entry.name = "stream listener";
 
     oonf_socket_add(&stream_socket->scheduler_entry);
     oonf_socket_set_read(&stream_socket->scheduler_entry, true);
@@ -638,6 +639,7 @@ _create_session(struct oonf_stream_socket *stream_socket,
 
   os_fd_copy(&session->scheduler_entry.fd, sock);
   session->scheduler_entry.process = _cb_parse_connection;
+  session->scheduler_entry.name = "stream session";
   oonf_socket_add(&session->scheduler_entry);
   oonf_socket_set_read(&session->scheduler_entry, true);
   oonf_socket_set_write(&session->scheduler_entry, true);
@@ -50,6 +50,7 @@
 
 #include "common/avl.h"
 #include "common/common_types.h"
+#include "common/prng.h"
 #include "core/oonf_logging.h"
 #include "core/oonf_subsystem.h"
 #include "core/os_core.h"
@@ -66,10 +67,48 @@ static int _init(void);
 static void _cleanup(void);
 
 static void _calc_clock(struct oonf_timer_instance *timer, uint64_t rel_time);
+
+static void _init_timers(void);
+static void _insert_timer(struct oonf_timer_instance *timer);
+static void _remove_timer(struct oonf_timer_instance *timer);
+static void _stop_class_timers(struct oonf_timer_class *info);
+static struct oonf_timer_instance *_get_due_timer(uint64_t now);
+static uint64_t _get_first_clock(void);
+
+#ifdef OONF_TIMER_WHEEL
+/* number of bits of the timeslice counter handled by each wheel level */
+#define TIMER_WHEEL_BITS   6
+
+/* number of slots of each wheel level */
+#define TIMER_WHEEL_SIZE   (1u << TIMER_WHEEL_BITS)
+
+/* bitmask to calculate the slot index within a wheel level */
+#define TIMER_WHEEL_MASK   (TIMER_WHEEL_SIZE - 1)
+
+/* number of wheel levels, timers beyond them are stored in an overflow list */
+#define TIMER_WHEEL_LEVELS 4
+
+static void _wheel_cascade(void);
+static bool _wheel_find_slot(unsigned level, unsigned start, unsigned *distance);
+static uint64_t _wheel_get_next_tick(void);
+
+/* hierarchical timer wheel, each slot is a list of timers */
+static struct list_entity _timer_wheel[TIMER_WHEEL_LEVELS][TIMER_WHEEL_SIZE];
+
+/* bitmaps of (potentially) used slots for each wheel level */
+static uint64_t _timer_wheel_used[TIMER_WHEEL_LEVELS];
+
+/* timers that are too far in the future for the wheel */
+static struct list_entity _timer_overflow;
+
+/* number of the next timeslice the wheel has not been processed yet */
+static uint64_t _timer_wheel_base;
+#else
 static int _avlcomp_timer(const void *p1, const void *p2);
 
 /* tree of all timers */
 static struct avl_tree _timer_tree;
+#endif
 
 /* true if scheduler is active */
 static bool _scheduling_now;
@@ -77,6 +116,12 @@ static bool _scheduling_now;
 /* List of timer classes */
 static struct list_entity _timer_info_list;
 
+/* generator for timer jitter, seeded once during initialization */
+static struct prng_state _jitter_prng;
+
+/* statistics of timer walker */
+static struct oonf_timer_statistics _timer_stats;
+
 /* subsystem definition */
 static const char *_dependencies[] = {
   OONF_CLOCK_SUBSYSTEM,
@@ -98,12 +143,21 @@ DECLARE_OONF_PLUGIN(_oonf_timer_subsystem);
 int
 _init(void)
 {
+  uint64_t seed;
+
   OONF_INFO(LOG_TIMER, "Initializing timer scheduler.\n");
 
-  avl_init(&_timer_tree, _avlcomp_timer, true);
+  _init_timers();
   _scheduling_now = false;
 
+  if (os_core_get_random(&seed, sizeof(seed))) {
+    OONF_WARN(LOG_TIMER, "Could not get random data");
+    seed = 0;
+  }
+  prng_seed(&_jitter_prng, seed);
+
   list_init_head(&_timer_info_list);
+  oonf_timer_reset_statistics();
   return 0;
 }
 
@@ -129,6 +183,7 @@ void
 oonf_timer_add(struct oonf_timer_class *ti) {
   assert (ti->callback);
   assert (ti->name);
+  histogram_reset(&ti->latency);
   list_add_tail(&_timer_info_list, &ti->_node);
 }
 
@@ -139,18 +194,12 @@ oonf_timer_add(struct oonf_timer_class *ti) {
  */
 void
 oonf_timer_remove(struct oonf_timer_class *info) {
-  struct oonf_timer_instance *timer, *iterator;
-
   if (!list_is_node_added(&info->_node)) {
 	  /* only free node if its hooked to the timer core */
 	return;
   }
 
-  avl_for_each_element_safe(&_timer_tree, timer, _node, iterator) {
-    if (timer->class == info) {
-      oonf_timer_stop(timer);
-    }
-  }
+  _stop_class_timers(info);
 
   list_remove(&info->_node);
 }
@@ -172,10 +221,9 @@ oonf_timer_start_ext(struct oonf_timer_instance *timer, uint64_t first, uint64_t
   assert(timer->jitter_pct <= 100);
 
   if (timer->_clock) {
-    avl_remove(&_timer_tree, &timer->_node);
+    _remove_timer(timer);
   }
   else {
-    timer->_node.key = timer;
     timer->class->usage++;
   }
   timer->class->changes++;
@@ -184,10 +232,7 @@ oonf_timer_start_ext(struct oonf_timer_instance *timer, uint64_t first, uint64_t
    * Compute random numbers only once.
    */
   if (!timer->_random) {
-    if (os_core_get_random(&timer->_random, sizeof(timer->_random))) {
-      OONF_WARN(LOG_TIMER, "Could not get random data");
-      timer->_random = 0;
-    }
+    timer->_random = prng_next32(&_jitter_prng);
   }
 
   /* Fill entry */
@@ -196,8 +241,8 @@ oonf_timer_start_ext(struct oonf_timer_instance *timer, uint64_t first, uint64_t
   /* Singleshot or periodical timer ? */
   timer->_period = timer->class->periodic ? interval : 0;
 
-  /* insert into tree */
-  avl_insert(&_timer_tree, &timer->_node);
+  /* insert into timer storage */
+  _insert_timer(timer);
 
   OONF_DEBUG(LOG_TIMER, "TIMER: start timer '%s' firing in %s (%"PRIu64")\n",
       timer->class->name,
@@ -217,8 +262,8 @@ oonf_timer_stop(struct oonf_timer_instance *timer)
 
   OONF_DEBUG(LOG_TIMER, "TIMER: stop %s\n", timer->class->name);
 
-  /* remove timer from tree */
-  avl_remove(&_timer_tree, &timer->_node);
+  /* remove timer from timer storage */
+  _remove_timer(timer);
   timer->_clock = 0;
   timer->_random = 0;
   timer->class->usage--;
@@ -261,16 +306,13 @@ oonf_timer_walk(void)
   struct oonf_timer_instance *timer;
   struct oonf_timer_class *info;
   uint64_t start_time, end_time;
+  bool fired;
 
   _scheduling_now = true;
+  _timer_stats.walks++;
+  fired = false;
 
-  while (!avl_is_empty(&_timer_tree)) {
-    timer = avl_first_element(&_timer_tree, timer, _node);
-
-    if (timer->_clock > oonf_clock_getNow()) {
-      break;
-    }
-
+  while ((timer = _get_due_timer(oonf_clock_getNow())) != NULL) {
     OONF_DEBUG(LOG_TIMER, "TIMER: fire '%s' at clocktick %" PRIu64 "\n",
                   timer->class->name, timer->_clock);
 
@@ -280,6 +322,7 @@ oonf_timer_walk(void)
     info = timer->class;
     info->_timer_in_callback = timer;
     info->_timer_stopped = false;
+    fired = true;
 
     /* update statistics */
     info->changes++;
@@ -290,13 +333,15 @@ oonf_timer_walk(void)
     }
 
     /* This timer is expired, call into the provided callback function */
-    os_clock_gettime64(&start_time);
+    os_clock_gettime64_ns(&start_time);
     timer->class->callback(timer);
-    os_clock_gettime64(&end_time);
+    os_clock_gettime64_ns(&end_time);
+
+    histogram_add(&info->latency, end_time - start_time);
 
-    if (end_time - start_time > OONF_TIMER_SLICE) {
+    if (end_time - start_time > OONF_TIMER_SLICE * 1000000ull) {
       OONF_WARN(LOG_TIMER, "Timer %s scheduling took %"PRIu64" ms",
-          timer->class->name, end_time - start_time);
+          info->name, (end_time - start_time) / 1000000);
     }
 
     /*
@@ -308,30 +353,26 @@ oonf_timer_walk(void)
        * Timer has been not been stopped, so its periodic.
        * rehash the random number and restart.
        */
-      if (os_core_get_random(&timer->_random, sizeof(timer->_random))) {
-        OONF_WARN(LOG_TIMER, "Could not get random data");
-        timer->_random = 0;
-      }
+      timer->_random = prng_next32(&_jitter_prng);
       oonf_timer_start(timer, timer->_period);
     }
   }
 
+  if (fired) {
+    _timer_stats.wakeups++;
+  }
   _scheduling_now = false;
 }
 
 /**
+ * The timer wheel might report a timestamp before the next timer
+ * fires for timers in its upper levels, which only results in an
+ * additional walk through the timers.
  * @return timestamp when next timer will fire
  */
 uint64_t
 oonf_timer_getNextEvent(void) {
-  struct oonf_timer_instance *first;
-
-  if (avl_is_empty(&_timer_tree)) {
-    return UINT64_MAX;
-  }
-
-  first = avl_first_element(&_timer_tree, first, _node);
-  return first->_clock;
+  return _get_first_clock();
 }
 
 /**
@@ -343,6 +384,23 @@ oonf_timer_get_list(void) {
   return &_timer_info_list;
 }
 
+/**
+ * @return statistics of timer walker
+ */
+const struct oonf_timer_statistics *
+oonf_timer_get_statistics(void) {
+  return &_timer_stats;
+}
+
+/**
+ * Reset statistics of timer walker
+ */
+void
+oonf_timer_reset_statistics(void) {
+  memset(&_timer_stats, 0, sizeof(_timer_stats));
+  _timer_stats.start = oonf_clock_getNow();
+}
+
 /**
  * Decrement a relative timer by a random number range.
  * @param the relative timer expressed in units of milliseconds.
@@ -353,7 +411,7 @@ oonf_timer_get_list(void) {
 static void
 _calc_clock(struct oonf_timer_instance *timer, uint64_t rel_time)
 {
-  uint64_t t = 0;
+  uint64_t t = 0, granularity;
   unsigned random_jitter;
 
   if (timer->jitter_pct) {
@@ -374,6 +432,326 @@ _calc_clock(struct oonf_timer_instance *timer, uint64_t rel_time)
   /* round up to next timeslice */
   timer->_clock += OONF_TIMER_SLICE;
   timer->_clock -= (timer->_clock % OONF_TIMER_SLICE);
+
+  if (timer->class->slack >= 2 * OONF_TIMER_SLICE) {
+    /*
+     * round up to the largest power-of-two multiple of the timeslice
+     * within the slack, so timers of different classes share wakeups
+     */
+    granularity = OONF_TIMER_SLICE
+        << (63 - __builtin_clzll(timer->class->slack / OONF_TIMER_SLICE));
+    timer->_clock = ((timer->_clock + granularity - 1) / granularity) * granularity;
+  }
+}
+
+#ifdef OONF_TIMER_WHEEL
+/**
+ * Initialize the timer wheel
+ */
+static void
+_init_timers(void) {
+  unsigned level, idx;
+
+  for (level = 0; level < TIMER_WHEEL_LEVELS; level++) {
+    for (idx = 0; idx < TIMER_WHEEL_SIZE; idx++) {
+      list_init_head(&_timer_wheel[level][idx]);
+    }
+    _timer_wheel_used[level] = 0;
+  }
+  list_init_head(&_timer_overflow);
+
+  _timer_wheel_base = oonf_clock_getNow() / OONF_TIMER_SLICE;
+}
+
+/**
+ * Add a timer into the lowest wheel level that can store
+ * its timeslice relative to the current wheel position.
+ * @param timer timer instance with calculated clock
+ */
+static void
+_insert_timer(struct oonf_timer_instance *timer) {
+  uint64_t tick;
+  unsigned level, shift, idx;
+
+  tick = timer->_clock / OONF_TIMER_SLICE;
+  if (tick < _timer_wheel_base) {
+    /* timer is already due, fire it with the next processed timeslice */
+    tick = _timer_wheel_base;
+  }
+
+  for (level = 0; level < TIMER_WHEEL_LEVELS; level++) {
+    shift = level * TIMER_WHEEL_BITS;
+    if ((tick >> shift) - (_timer_wheel_base >> shift) < TIMER_WHEEL_SIZE) {
+      idx = (tick >> shift) & TIMER_WHEEL_MASK;
+
+      list_add_tail(&_timer_wheel[level][idx], &timer->_node);
+      _timer_wheel_used[level] |= (1ull << idx);
+      return;
+    }
+  }
+
+  list_add_tail(&_timer_overflow, &timer->_node);
+}
+
+/**
+ * Remove a timer from the timer wheel. The bitmap of used slots
+ * is cleaned up lazily by _wheel_find_slot().
+ * @param timer timer instance
+ */
+static void
+_remove_timer(struct oonf_timer_instance *timer) {
+  list_remove(&timer->_node);
+}
+
+/**
+ * Stop all timers of a timer class
+ * @param info timer class
+ */
+static void
+_stop_class_timers(struct oonf_timer_class *info) {
+  struct oonf_timer_instance *timer, *iterator;
+  unsigned level, idx;
+
+  for (level = 0; level < TIMER_WHEEL_LEVELS; level++) {
+    for (idx = 0; idx < TIMER_WHEEL_SIZE; idx++) {
+      list_for_each_element_safe(&_timer_wheel[level][idx], timer, _node, iterator) {
+        if (timer->class == info) {
+          oonf_timer_stop(timer);
+        }
+      }
+    }
+  }
+  list_for_each_element_safe(&_timer_overflow, timer, _node, iterator) {
+    if (timer->class == info) {
+      oonf_timer_stop(timer);
+    }
+  }
+}
+
+/**
+ * Advance the timer wheel up to the current time until a
+ * timeslice with timers is found.
+ * @param now current time
+ * @return first timer of the next due timeslice, NULL if no
+ *   timer is due
+ */
+static struct oonf_timer_instance *
+_get_due_timer(uint64_t now) {
+  struct oonf_timer_instance *timer;
+  struct list_entity *slot;
+  uint64_t now_tick, next_tick;
+
+  now_tick = now / OONF_TIMER_SLICE;
+
+  while (_timer_wheel_base <= now_tick) {
+    slot = &_timer_wheel[0][_timer_wheel_base & TIMER_WHEEL_MASK];
+    if (!list_is_empty(slot)) {
+      return list_first_element(slot, timer, _node);
+    }
+
+    /* skip all timeslices without timers */
+    next_tick = _wheel_get_next_tick();
+    if (next_tick > now_tick + 1) {
+      next_tick = now_tick + 1;
+    }
+
+    _timer_wheel_base = next_tick;
+    _wheel_cascade();
+  }
+  return NULL;
+}
+
+/**
+ * @return timestamp of the next timeslice which might contain
+ *   a timer, UINT64_MAX if there is no timer
+ */
+static uint64_t
+_get_first_clock(void) {
+  uint64_t tick;
+
+  tick = _wheel_get_next_tick();
+  if (tick == UINT64_MAX) {
+    return UINT64_MAX;
+  }
+  return tick * OONF_TIMER_SLICE;
+}
+
+/**
+ * Move the timers of the current slot of all upper wheel levels
+ * (and the overflow list) that just started into the lower levels.
+ * Must be called each time the wheel base crosses the border
+ * of a used upper level slot.
+ */
+static void
+_wheel_cascade(void) {
+  struct oonf_timer_instance *timer;
+  struct list_entity cascade;
+  unsigned level, shift, idx;
+
+  list_init_head(&cascade);
+
+  shift = (TIMER_WHEEL_LEVELS - 1) * TIMER_WHEEL_BITS;
+  if ((_timer_wheel_base & ((1ull << shift) - 1)) == 0) {
+    list_merge(&cascade, &_timer_overflow);
+  }
+
+  /* start with the highest level, it might cascade into the current slot of lower ones */
+  for (level = TIMER_WHEEL_LEVELS - 1; level > 0; level--) {
+    shift = level * TIMER_WHEEL_BITS;
+    if ((_timer_wheel_base & ((1ull << shift) - 1)) != 0) {
+      continue;
+    }
+
+    idx = (_timer_wheel_base >> shift) & TIMER_WHEEL_MASK;
+    list_merge(&cascade, &_timer_wheel[level][idx]);
+
+    while (!list_is_empty(&cascade)) {
+      timer = list_first_element(&cascade, timer, _node);
+      list_remove(&timer->_node);
+      _insert_timer(timer);
+    }
+  }
+}
+
+/**
+ * Look for the first non-empty slot of a wheel level and clean up
+ * the bits of empty slots on the way.
+ * @param level wheel level
+ * @param start slot index to start searching
+ * @param distance pointer to store the distance of the first used slot
+ *   to the start index
+ * @return true if a used slot was found, false otherwise
+ */
+static bool
+_wheel_find_slot(unsigned level, unsigned start, unsigned *distance) {
+  uint64_t used;
+  unsigned idx;
+
+  while ((used = _timer_wheel_used[level]) != 0) {
+    if (start) {
+      used = (used >> start) | (used << (TIMER_WHEEL_SIZE - start));
+    }
+    *distance = __builtin_ctzll(used);
+    idx = (start + *distance) & TIMER_WHEEL_MASK;
+
+    if (!list_is_empty(&_timer_wheel[level][idx])) {
+      return true;
+    }
+    _timer_wheel_used[level] &= ~(1ull << idx);
+  }
+  return false;
+}
+
+/**
+ * Calculate the next timeslice the wheel has to process. This is
+ * exact for the lowest level and the beginning of the first used
+ * slot for all upper levels.
+ * @return timeslice number, UINT64_MAX if no timer is running
+ */
+static uint64_t
+_wheel_get_next_tick(void) {
+  uint64_t tick, next;
+  unsigned level, shift, distance;
+
+  next = UINT64_MAX;
+  if (_wheel_find_slot(0, _timer_wheel_base & TIMER_WHEEL_MASK, &distance)) {
+    next = _timer_wheel_base + distance;
+  }
+
+  for (level = 1; level < TIMER_WHEEL_LEVELS; level++) {
+    shift = level * TIMER_WHEEL_BITS;
+    if (_wheel_find_slot(level, (_timer_wheel_base >> shift) & TIMER_WHEEL_MASK, &distance)) {
+      tick = ((_timer_wheel_base >> shift) + distance) << shift;
+      if (tick < next) {
+        next = tick;
+      }
+    }
+  }
+
+  if (!list_is_empty(&_timer_overflow)) {
+    shift = (TIMER_WHEEL_LEVELS - 1) * TIMER_WHEEL_BITS;
+    tick = ((_timer_wheel_base >> shift) + 1) << shift;
+    if (tick < next) {
+      next = tick;
+    }
+  }
+  return next;
+}
+#else
+/**
+ * Initialize the timer tree
+ */
+static void
+_init_timers(void) {
+  avl_init(&_timer_tree, _avlcomp_timer, true);
+}
+
+/**
+ * Add a timer to the timer tree
+ * @param timer timer instance with calculated clock
+ */
+static void
+_insert_timer(struct oonf_timer_instance *timer) {
+  timer->_node.key = timer;
+  avl_insert(&_timer_tree, &timer->_node);
+}
+
+/**
+ * Remove a timer from the timer tree
+ * @param timer timer instance
+ */
+static void
+_remove_timer(struct oonf_timer_instance *timer) {
+  avl_remove(&_timer_tree, &timer->_node);
+}
+
+/**
+ * Stop all timers of a timer class
+ * @param info timer class
+ */
+static void
+_stop_class_timers(struct oonf_timer_class *info) {
+  struct oonf_timer_instance *timer, *iterator;
+
+  avl_for_each_element_safe(&_timer_tree, timer, _node, iterator) {
+    if (timer->class == info) {
+      oonf_timer_stop(timer);
+    }
+  }
+}
+
+/**
+ * @param now current time
+ * @return first timer that is due, NULL if no timer is due
+ */
+static struct oonf_timer_instance *
+_get_due_timer(uint64_t now) {
+  struct oonf_timer_instance *timer;
+
+  if (avl_is_empty(&_timer_tree)) {
+    return NULL;
+  }
+
+  timer = avl_first_element(&_timer_tree, timer, _node);
+  if (timer->_clock > now) {
+    return NULL;
+  }
+  return timer;
+}
+
+/**
+ * @return timestamp of first timer, UINT64_MAX if no timer is running
+ */
+static uint64_t
+_get_first_clock(void) {
+  struct oonf_timer_instance *first;
+
+  if (avl_is_empty(&_timer_tree)) {
+    return UINT64_MAX;
+  }
+
+  first = avl_first_element(&_timer_tree, first, _node);
+  return first->_clock;
 }
 
 /**
@@ -397,3 +775,4 @@ _avlcomp_timer(const void *p1, const void *p2) {
   }
   return 0;
 }
+#endif
@@ -47,6 +47,7 @@
 #define OONF_TIMER_H_
 
 #include "common/common_types.h"
+#include "common/histogram.h"
 #include "common/list.h"
 #include "common/avl.h"
 
@@ -80,12 +81,23 @@ struct oonf_timer_class {
   /*! true if this is a class of periodic timers */
   bool periodic;
 
+  /**
+   * maximum time in milliseconds a timer of this class might fire
+   * later than requested, 0 if the timer should fire in the
+   * next timeslice. Timers with slack are aligned to a common
+   * grid to reduce the number of scheduler wakeups.
+   */
+  uint64_t slack;
+
   /*! Stats, resource usage */
   uint32_t usage;
 
   /*! Stats, resource churn */
   uint32_t changes;
 
+  /*! Stats, runtime of callbacks in nanoseconds */
+  struct histogram latency;
+
   /*! pointer to timer currently in callback */
   struct oonf_timer_instance *_timer_in_callback;
 
@@ -93,12 +105,31 @@ struct oonf_timer_class {
   bool _timer_stopped;
 };
 
+/**
+ * Statistics of the timer scheduler
+ */
+struct oonf_timer_statistics {
+  /*! number of calls to the timer walker */
+  uint64_t walks;
+
+  /*! number of timer walks that fired at least one timer */
+  uint64_t wakeups;
+
+  /*! timestamp when statistics were started */
+  uint64_t start;
+};
+
 /**
  * A single timer instance of a timer class
  */
 struct oonf_timer_instance {
+#ifdef OONF_TIMER_WHEEL
+  /*! node of timer wheel slot */
+  struct list_entity _node;
+#else
   /*! node of timer class tree of instances */
   struct avl_node _node;
+#endif
 
   /*! backpointer to timer class */
   struct oonf_timer_class *class;
@@ -109,7 +140,7 @@ struct oonf_timer_instance {
   /*! timeperiod between two timer events for periodical timers */
   uint64_t _period;
 
-  /*! cache random() result for performance reasons */
+  /*! cached pseudo random number for jitter calculation */
   unsigned int _random;
 
   /*! absolute timestamp when timer will fire */
@@ -129,6 +160,8 @@ EXPORT void oonf_timer_stop(struct oonf_timer_instance *);
 EXPORT uint64_t oonf_timer_getNextEvent(void);
 
 EXPORT struct list_entity *oonf_timer_get_list(void);
+EXPORT const struct oonf_timer_statistics *oonf_timer_get_statistics(void);
+EXPORT void oonf_timer_reset_statistics(void);
 
 /**
  * @param timer pointer to timer
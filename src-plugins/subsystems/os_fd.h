@@ -64,6 +64,23 @@
 struct os_fd;
 struct os_fd_select;
 
+/**
+ * Description of a single packet for batched send/receive calls
+ */
+struct os_fd_mmsg {
+  /*! source (receive) or destination (send) of the packet */
+  union netaddr_socket addr;
+
+  /*! pointer to packet buffer */
+  void *buf;
+
+  /**
+   * length of packet (send) or length of buffer (receive),
+   * will be overwritten by the length of a received packet
+   */
+  size_t length;
+};
+
 /* pre-declare inlines */
 static INLINE int os_fd_init(struct os_fd *, int fd);
 static INLINE int os_fd_copy(struct os_fd *dst, struct os_fd *from);
@@ -83,6 +100,8 @@ static INLINE int os_fd_event_is_read(struct os_fd *);
 static INLINE int os_fd_event_socket_write(struct os_fd_select *,
     struct os_fd *, bool want_write);
 static INLINE int os_fd_event_is_write(struct os_fd *);
+static INLINE int os_fd_event_socket_edge_triggered(struct os_fd_select *,
+    struct os_fd *, bool edge_triggered);
 static INLINE int os_fd_event_socket_remove(struct os_fd_select *, struct os_fd *);
 static INLINE int os_fd_event_set_deadline(struct os_fd_select *, uint64_t deadline);
 static INLINE uint64_t os_fd_event_get_deadline(struct os_fd_select *);
@@ -98,6 +117,12 @@ static INLINE ssize_t os_fd_sendto(struct os_fd *, const void *buf, size_t lengt
     const union netaddr_socket *dst, bool dont_route);
 static INLINE ssize_t os_fd_recvfrom(struct os_fd *, void *buf, size_t length,
     union netaddr_socket *source, const struct os_interface *);
+static INLINE int os_fd_recvmmsg(struct os_fd *, struct os_fd_mmsg *msgs, size_t count);
+static INLINE int os_fd_sendmmsg(struct os_fd *, struct os_fd_mmsg *msgs, size_t count,
+    bool dont_route);
+static INLINE bool os_fd_supports_segments(struct os_fd *);
+static INLINE ssize_t os_fd_sendsegments(struct os_fd *, const union netaddr_socket *dst,
+    struct os_fd_mmsg *msgs, size_t count, bool dont_route);
 static INLINE const char *os_fd_get_loopback_name(void);
 static INLINE ssize_t os_fd_sendfile(struct os_fd *, struct os_fd *,
     size_t offset, size_t count);
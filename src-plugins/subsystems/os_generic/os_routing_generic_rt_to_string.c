@@ -70,9 +70,11 @@ os_routing_generic_rt_to_string(
     struct os_route_str *buf, const struct os_route_parameter *route_parameter) {
   struct netaddr_str buf1, buf2, buf3, buf4;
   char ifbuf[IF_NAMESIZE];
-  int result;
+  int result, len;
+  unsigned i;
+
   result = snprintf(buf->buf, sizeof(*buf),
-      "'src-ip %s gw %s dst %s %s src-prefix %s metric %d table %u protocol %u if %s (%u)'",
+      "'src-ip %s gw %s dst %s %s src-prefix %s metric %d table %u protocol %u if %s (%u)",
       netaddr_to_string(&buf1, &route_parameter->src_ip),
       netaddr_to_string(&buf2, &route_parameter->gw),
       _route_types[route_parameter->type],
@@ -83,9 +85,34 @@ os_routing_generic_rt_to_string(
       (unsigned int)(route_parameter->protocol),
       if_indextoname(route_parameter->if_index, ifbuf),
       route_parameter->if_index);
-
   if (result < 0 || result > (int)sizeof(*buf)) {
     return NULL;
   }
+  len = result;
+
+  if (route_parameter->nexthop_id) {
+    result = snprintf(&buf->buf[len], sizeof(*buf) - len, " nh %u",
+        route_parameter->nexthop_id);
+    if (result < 0 || len + result > (int)sizeof(*buf)) {
+      return NULL;
+    }
+    len += result;
+  }
+
+  for (i=0; route_parameter->nexthop_count > 1
+      && i < route_parameter->nexthop_count && i < OS_ROUTE_MAX_NEXTHOPS; i++) {
+    result = snprintf(&buf->buf[len], sizeof(*buf) - len, " via %s (%u)",
+        netaddr_to_string(&buf1, &route_parameter->nexthops[i].gw),
+        route_parameter->nexthops[i].if_index);
+    if (result < 0 || len + result > (int)sizeof(*buf)) {
+      return NULL;
+    }
+    len += result;
+  }
+
+  result = snprintf(&buf->buf[len], sizeof(*buf) - len, "'");
+  if (result < 0 || len + result > (int)sizeof(*buf)) {
+    return NULL;
+  }
   return buf->buf;
 }
@@ -43,10 +43,21 @@
  * @file
  */
 
+#define _GNU_SOURCE
+
+/* must be first include because of _GNU_SOURCE */
+#include <sys/socket.h>
+
 #include <net/if.h>
 #include <netinet/in.h>
+#include <netinet/udp.h>
 #include <sys/ioctl.h>
 #include <errno.h>
+#include <stdlib.h>
+
+#ifdef OONF_TIMERFD_DEADLINE
+#include <sys/timerfd.h>
+#endif
 
 #include "common/common_types.h"
 #include "core/oonf_logging.h"
@@ -58,10 +69,24 @@
 /* Defintions */
 #define LOG_OS_SOCKET _oonf_os_fd_subsystem.logging
 
+#ifndef SOL_UDP
+#define SOL_UDP 17
+#endif
+
+#ifndef UDP_SEGMENT
+/* UDP segmentation offload, available since linux 4.18 */
+#define UDP_SEGMENT 103
+#endif
+
 /* prototypes */
 static int _init(void);
 static void _cleanup(void);
 
+static void _grow_event_array(struct os_fd_select *sel);
+#ifdef OONF_TIMERFD_DEADLINE
+static int _arm_deadline(struct os_fd_select *sel);
+#endif
+
 /* subsystem definition */
 static const char *_dependencies[] = {
   OONF_CLOCK_SUBSYSTEM,
@@ -92,6 +117,50 @@ static void
 _cleanup(void) {
 }
 
+/**
+ * Initialize a socket selector set
+ * @param sel empty socket selector set
+ * @return -1 if an error happened, 0 otherwise
+ */
+int
+os_fd_linux_event_add(struct os_fd_select *sel) {
+#ifdef OONF_TIMERFD_DEADLINE
+  struct epoll_event event;
+  int fd;
+#endif
+
+  memset (sel, 0, sizeof(*sel));
+  sel->_events = sel->_default_events;
+  sel->_event_size = OS_FD_EVENTS_DEFAULT;
+  sel->_epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+  if (sel->_epoll_fd < 0) {
+    return -1;
+  }
+
+#ifdef OONF_TIMERFD_DEADLINE
+  fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+  if (fd < 0) {
+    OONF_WARN(LOG_OS_SOCKET, "Could not create timerfd: %s (%d)",
+        strerror(errno), errno);
+    close(sel->_epoll_fd);
+    return -1;
+  }
+  os_fd_init(&sel->_deadline_fd, fd);
+
+  memset(&event, 0, sizeof(event));
+  event.events = EPOLLIN;
+  event.data.ptr = &sel->_deadline_fd;
+  if (epoll_ctl(sel->_epoll_fd, EPOLL_CTL_ADD, fd, &event)) {
+    OONF_WARN(LOG_OS_SOCKET, "Could not add timerfd to epoll: %s (%d)",
+        strerror(errno), errno);
+    close(fd);
+    close(sel->_epoll_fd);
+    return -1;
+  }
+#endif
+  return 0;
+}
+
 /**
  * wait for a network event on multiple sockets
  * @param sel socket selector set
@@ -100,22 +169,51 @@ _cleanup(void) {
 int
 os_fd_linux_event_wait(struct os_fd_select *sel) {
   struct os_fd *sock;
+#ifndef OONF_TIMERFD_DEADLINE
   uint64_t maxdelay;
+#endif
+  int timeout;
   int i;
 
+  if (sel->_socket_count > sel->_event_size) {
+    _grow_event_array(sel);
+  }
+
+#ifdef OONF_TIMERFD_DEADLINE
+  timeout = _arm_deadline(sel);
+#else
   maxdelay = oonf_clock_get_relative(sel->deadline);
   if (maxdelay > INT32_MAX) {
     maxdelay = INT32_MAX;
   }
+  timeout = maxdelay;
+#endif
 
   sel->_event_count = epoll_wait(sel->_epoll_fd, sel->_events,
-      ARRAYSIZE(sel->_events), maxdelay);
+      sel->_event_size, timeout);
 
-  OONF_DEBUG(LOG_OS_SOCKET, "epoll_wait(maxdelay = %"PRIu64"): %d",
-      maxdelay, sel->_event_count);
+  OONF_DEBUG(LOG_OS_SOCKET, "epoll_wait(timeout = %d): %d",
+      timeout, sel->_event_count);
 
   for (i=0; i<sel->_event_count; i++) {
     sock = os_fd_event_get(sel, i);
+#ifdef OONF_TIMERFD_DEADLINE
+    if (sock == &sel->_deadline_fd) {
+      uint64_t expirations;
+
+      /* deadline reached, hide timerfd event from the caller */
+      if (read(os_fd_get_fd(sock), &expirations, sizeof(expirations)) < 0) {
+        OONF_DEBUG(LOG_OS_SOCKET, "Could not read timerfd: %s (%d)",
+            strerror(errno), errno);
+      }
+      sel->_armed_deadline = 0;
+
+      sel->_event_count--;
+      sel->_events[i] = sel->_events[sel->_event_count];
+      i--;
+      continue;
+    }
+#endif
     sock->received_events = sel->_events[i].events;
 
     OONF_DEBUG(LOG_OS_SOCKET, "event %d: %x", i, sock->received_events);
@@ -123,6 +221,24 @@ os_fd_linux_event_wait(struct os_fd_select *sel) {
   return sel->_event_count;
 }
 
+/**
+ * Cleans up a socket selector set
+ * @param sel socket selector set
+ * @return -1 if an error happened, 0 otherwise
+ */
+int
+os_fd_linux_event_remove(struct os_fd_select *sel) {
+#ifdef OONF_TIMERFD_DEADLINE
+  os_fd_close(&sel->_deadline_fd);
+#endif
+  if (sel->_events != sel->_default_events) {
+    free(sel->_events);
+    sel->_events = sel->_default_events;
+    sel->_event_size = OS_FD_EVENTS_DEFAULT;
+  }
+  return close(sel->_epoll_fd);
+}
+
 /**
  * Move the wanted events of a socket into a selector set
  * @param sel socket selector set
@@ -137,6 +253,9 @@ os_fd_linux_event_socket_modify(struct os_fd_select *sel,
   memset(&event,0,sizeof(event));
 
   event.events = sock->wanted_events;
+  if (sock->_flags & OS_FD_EDGE_TRIGGERED) {
+    event.events |= EPOLLET;
+  }
   event.data.ptr = sock;
 
   OONF_DEBUG(LOG_OS_SOCKET, "Modify socket %d to events 0x%x",
@@ -167,3 +286,216 @@ os_fd_linux_skip_rawsocket_prefix(uint8_t *ptr, ssize_t *len, int af_type) {
   *len -= header_size;
   return ptr + header_size;
 }
+
+/**
+ * Receive multiple packets from a socket with a single recvmmsg() call
+ * without blocking.
+ * @param sock socket representation
+ * @param msgs array of packet buffers, the length of the received
+ *   packets and their source are stored in the array
+ * @param count number of packet buffers
+ * @return number of received packets, -1 if an error happened
+ */
+int
+os_fd_linux_recvmmsg(struct os_fd *sock,
+    struct os_fd_mmsg *msgs, size_t count) {
+  struct mmsghdr hdr[OS_FD_MMSG_MAX];
+  struct iovec iov[OS_FD_MMSG_MAX];
+  size_t i;
+  int result;
+
+  if (count > OS_FD_MMSG_MAX) {
+    count = OS_FD_MMSG_MAX;
+  }
+
+  memset(hdr, 0, sizeof(hdr[0]) * count);
+  for (i=0; i<count; i++) {
+    iov[i].iov_base = msgs[i].buf;
+    iov[i].iov_len = msgs[i].length;
+
+    hdr[i].msg_hdr.msg_name = &msgs[i].addr.std;
+    hdr[i].msg_hdr.msg_namelen = sizeof(msgs[i].addr);
+    hdr[i].msg_hdr.msg_iov = &iov[i];
+    hdr[i].msg_hdr.msg_iovlen = 1;
+  }
+
+  result = recvmmsg(sock->fd, hdr, count, MSG_DONTWAIT, NULL);
+  for (i=0; result > 0 && i<(size_t)result; i++) {
+    msgs[i].length = hdr[i].msg_len;
+  }
+  return result;
+}
+
+/**
+ * Send multiple packets through a socket with a single sendmmsg() call.
+ * @param sock socket representation
+ * @param msgs array of packets
+ * @param count number of packets
+ * @param dont_route true to suppress routing of data
+ * @return number of sent packets, -1 if an error happened
+ */
+int
+os_fd_linux_sendmmsg(struct os_fd *sock,
+    struct os_fd_mmsg *msgs, size_t count, bool dont_route) {
+  struct mmsghdr hdr[OS_FD_MMSG_MAX];
+  struct iovec iov[OS_FD_MMSG_MAX];
+  size_t i;
+
+  if (count > OS_FD_MMSG_MAX) {
+    count = OS_FD_MMSG_MAX;
+  }
+
+  memset(hdr, 0, sizeof(hdr[0]) * count);
+  for (i=0; i<count; i++) {
+    iov[i].iov_base = msgs[i].buf;
+    iov[i].iov_len = msgs[i].length;
+
+    hdr[i].msg_hdr.msg_name = &msgs[i].addr.std;
+    hdr[i].msg_hdr.msg_namelen = sizeof(msgs[i].addr);
+    hdr[i].msg_hdr.msg_iov = &iov[i];
+    hdr[i].msg_hdr.msg_iovlen = 1;
+  }
+
+  return sendmmsg(sock->fd, hdr, count, dont_route ? MSG_DONTROUTE : 0);
+}
+
+/**
+ * Check if the kernel supports UDP segmentation offload for a socket.
+ * Kernels without support reject the socket option, while they would
+ * silently ignore the control message of a segmented send call.
+ * @param sock socket representation
+ * @return true if segmented send calls can be used
+ */
+bool
+os_fd_linux_supports_segments(struct os_fd *sock) {
+  int value = 0;
+  socklen_t len = sizeof(value);
+
+  return getsockopt(sock->fd, SOL_UDP, UDP_SEGMENT, &value, &len) == 0;
+}
+
+/**
+ * Send multiple packets to the same destination with a single
+ * sendmsg() call, the kernel splits the data into UDP packets
+ * with the length of the first packet.
+ * @param sock socket representation
+ * @param dst destination of all packets
+ * @param msgs array of packets, all but the last one must have
+ *   the same length, the last one must not be longer
+ * @param count number of packets
+ * @param dont_route true to suppress routing of data
+ * @return number of bytes sent, -1 if an error happened
+ */
+ssize_t
+os_fd_linux_sendsegments(struct os_fd *sock, const union netaddr_socket *dst,
+    struct os_fd_mmsg *msgs, size_t count, bool dont_route) {
+  char control[CMSG_SPACE(sizeof(uint16_t))];
+  struct iovec iov[OS_FD_MMSG_MAX];
+  struct cmsghdr *cmsg;
+  struct msghdr hdr;
+  uint16_t segment;
+  size_t i;
+
+  if (count > OS_FD_MMSG_MAX) {
+    count = OS_FD_MMSG_MAX;
+  }
+
+  for (i=0; i<count; i++) {
+    iov[i].iov_base = msgs[i].buf;
+    iov[i].iov_len = msgs[i].length;
+  }
+
+  memset(&hdr, 0, sizeof(hdr));
+  memset(control, 0, sizeof(control));
+  hdr.msg_name = (void *)&dst->std;
+  hdr.msg_namelen = sizeof(*dst);
+  hdr.msg_iov = iov;
+  hdr.msg_iovlen = count;
+  hdr.msg_control = control;
+  hdr.msg_controllen = sizeof(control);
+
+  segment = msgs[0].length;
+  cmsg = CMSG_FIRSTHDR(&hdr);
+  cmsg->cmsg_level = SOL_UDP;
+  cmsg->cmsg_type = UDP_SEGMENT;
+  cmsg->cmsg_len = CMSG_LEN(sizeof(segment));
+  memcpy(CMSG_DATA(cmsg), &segment, sizeof(segment));
+
+  return sendmsg(sock->fd, &hdr, dont_route ? MSG_DONTROUTE : 0);
+}
+
+/**
+ * Resize the event array of a selector set so a single epoll
+ * call can report events for all registered sockets.
+ * Keeps the old array if there is not enough memory.
+ * @param sel socket selector set
+ */
+static void
+_grow_event_array(struct os_fd_select *sel) {
+  struct epoll_event *events;
+  int size;
+
+  size = sel->_event_size;
+  while (size < sel->_socket_count) {
+    size *= 2;
+  }
+
+  if (sel->_events == sel->_default_events) {
+    events = malloc(sizeof(*events) * size);
+  }
+  else {
+    events = realloc(sel->_events, sizeof(*events) * size);
+  }
+  if (events == NULL) {
+    OONF_WARN(LOG_OS_SOCKET, "Not enough memory for %d epoll events", size);
+    return;
+  }
+
+  OONF_DEBUG(LOG_OS_SOCKET, "Resize epoll event array to %d events", size);
+  sel->_events = events;
+  sel->_event_size = size;
+}
+
+#ifdef OONF_TIMERFD_DEADLINE
+/**
+ * Arm the timerfd of a selector set with the nanosecond delay
+ * until its deadline.
+ * @param sel socket selector set
+ * @return timeout for epoll_wait() in milliseconds,
+ *   -1 if the timerfd will end the wait
+ */
+static int
+_arm_deadline(struct os_fd_select *sel) {
+  struct itimerspec its;
+  int64_t delay;
+
+  if (sel->deadline > oonf_clock_getNow() + INT32_MAX) {
+    /* no deadline in the near future */
+    return INT32_MAX;
+  }
+
+  delay = oonf_clock_get_relative_ns(sel->deadline);
+  if (delay <= 0) {
+    return 0;
+  }
+  if (sel->deadline == sel->_armed_deadline) {
+    /* timerfd is already running */
+    return -1;
+  }
+
+  memset(&its, 0, sizeof(its));
+  its.it_value.tv_sec = delay / 1000000000ll;
+  its.it_value.tv_nsec = delay % 1000000000ll;
+
+  if (timerfd_settime(os_fd_get_fd(&sel->_deadline_fd), 0, &its, NULL)) {
+    OONF_WARN(LOG_OS_SOCKET, "Could not set timerfd: %s (%d)",
+        strerror(errno), errno);
+
+    /* fall back to millisecond timeout */
+    sel->_armed_deadline = 0;
+    return delay / 1000000ll + 1;
+  }
+  sel->_armed_deadline = sel->deadline;
+  return -1;
+}
+#endif
@@ -63,8 +63,20 @@
 /*! name of the loopback interface */
 #define IF_LOOPBACK_NAME "lo"
 
+/*! maximum number of packets handled by a single recvmmsg/sendmmsg call */
+#define OS_FD_MMSG_MAX 32
+
+/*! maximum UDP payload handed to the kernel with a single segmented send call */
+#define OS_FD_SEGMENTS_MAX_LENGTH 65507
+
+/*! initial size of the epoll event array */
+#define OS_FD_EVENTS_DEFAULT 16
+
 enum os_fd_flags {
   OS_FD_ACTIVE = 1,
+
+  /*! socket uses edge triggered events */
+  OS_FD_EDGE_TRIGGERED = 2,
 };
 
 /*! linux specific socket definition */
@@ -84,19 +96,49 @@ struct os_fd {
 
 /*! linux specific socket select definition */
 struct os_fd_select {
-  struct epoll_event _events[16];
+  /*! array for epoll events, grows with the number of sockets */
+  struct epoll_event *_events;
+
+  /*! number of elements in event array */
+  int _event_size;
+
+  /*! number of events reported by last epoll call */
   int _event_count;
 
+  /*! number of sockets registered in epoll */
+  int _socket_count;
+
+  /*! initial event array */
+  struct epoll_event _default_events[OS_FD_EVENTS_DEFAULT];
+
   int _epoll_fd;
 
   uint64_t deadline;
+
+#ifdef OONF_TIMERFD_DEADLINE
+  /*! timerfd for the deadline, registered in the epoll set */
+  struct os_fd _deadline_fd;
+
+  /*! deadline the timerfd is armed for, 0 if not armed */
+  uint64_t _armed_deadline;
+#endif
 };
 
 /** declare non-inline linux-specific functions */
+EXPORT int os_fd_linux_event_add(struct os_fd_select *);
 EXPORT int os_fd_linux_event_wait(struct os_fd_select *);
+EXPORT int os_fd_linux_event_remove(struct os_fd_select *);
 EXPORT int os_fd_linux_event_socket_modify(struct os_fd_select *sel,
     struct os_fd *sock);
 EXPORT uint8_t *os_fd_linux_skip_rawsocket_prefix(uint8_t *ptr, ssize_t *len, int af_type);
+EXPORT int os_fd_linux_recvmmsg(struct os_fd *sock,
+    struct os_fd_mmsg *msgs, size_t count);
+EXPORT int os_fd_linux_sendmmsg(struct os_fd *sock,
+    struct os_fd_mmsg *msgs, size_t count, bool dont_route);
+EXPORT bool os_fd_linux_supports_segments(struct os_fd *sock);
+EXPORT ssize_t os_fd_linux_sendsegments(struct os_fd *sock,
+    const union netaddr_socket *dst, struct os_fd_mmsg *msgs, size_t count,
+    bool dont_route);
 
 /**
  * Redirect to linux specific event wait call
@@ -313,9 +355,7 @@ os_fd_listen(struct os_fd *sock, int n) {
  */
 static INLINE int
 os_fd_event_add(struct os_fd_select *sel) {
-  memset (sel, 0, sizeof(*sel));
-  sel->_epoll_fd = epoll_create1(EPOLL_CLOEXEC);
-  return sel->_epoll_fd < 0 ? -1 : 0;
+  return os_fd_linux_event_add(sel);
 }
 
 /**
@@ -342,7 +382,11 @@ os_fd_event_socket_add(struct os_fd_select *sel, struct os_fd *sock) {
   memset(&event,0,sizeof(event));
 
   event.data.ptr = sock;
-  return epoll_ctl(sel->_epoll_fd, EPOLL_CTL_ADD, sock->fd, &event);
+  if (epoll_ctl(sel->_epoll_fd, EPOLL_CTL_ADD, sock->fd, &event)) {
+    return -1;
+  }
+  sel->_socket_count++;
+  return 0;
 }
 
 /**
@@ -395,6 +439,28 @@ os_fd_event_socket_write(struct os_fd_select *sel,
   return os_fd_linux_event_socket_modify(sel, sock);
 }
 
+/**
+ * Switch a socket between level triggered (default) and edge
+ * triggered events. The event handler of an edge triggered socket
+ * must read/write until the socket would block.
+ * @param sel socket event handler
+ * @param sock socket representation
+ * @param edge_triggered true for edge triggered events,
+ *   false for level triggered events
+ * @return -1 if an error happened, 0 otherwise
+ */
+static INLINE int
+os_fd_event_socket_edge_triggered(struct os_fd_select *sel,
+    struct os_fd *sock, bool edge_triggered) {
+  if (edge_triggered) {
+    sock->_flags |= OS_FD_EDGE_TRIGGERED;
+  }
+  else {
+    sock->_flags &= ~OS_FD_EDGE_TRIGGERED;
+  }
+  return os_fd_linux_event_socket_modify(sel, sock);
+}
+
 /**
  * Check if a socket triggered a write event
  * @param sock socket representation
@@ -413,7 +479,11 @@ os_fd_event_is_write(struct os_fd *sock) {
  */
 static INLINE int
 os_fd_event_socket_remove(struct os_fd_select *sel, struct os_fd *sock) {
-  return epoll_ctl(sel->_epoll_fd, EPOLL_CTL_DEL, sock->fd, NULL);
+  if (epoll_ctl(sel->_epoll_fd, EPOLL_CTL_DEL, sock->fd, NULL)) {
+    return -1;
+  }
+  sel->_socket_count--;
+  return 0;
 }
 
 /**
@@ -444,7 +514,7 @@ os_fd_event_get_deadline(struct os_fd_select *sel) {
  */
 static INLINE int
 os_fd_event_remove(struct os_fd_select *sel) {
-  return close(sel->_epoll_fd);
+  return os_fd_linux_event_remove(sel);
 }
 
 /**
@@ -521,6 +591,60 @@ os_fd_recvfrom(struct os_fd *sock, void *buf, size_t length, union netaddr_socke
   return recvfrom(sock->fd, buf, length, 0, &source->std, &len);
 }
 
+/**
+ * Redirect to linux specific recvmmsg call
+ * @param sock socket representation
+ * @param msgs array of packet buffers
+ * @param count number of packet buffers, at most OS_FD_MMSG_MAX
+ *   will be used
+ * @return number of received packets, -1 if an error happened
+ */
+static INLINE int
+os_fd_recvmmsg(struct os_fd *sock, struct os_fd_mmsg *msgs, size_t count) {
+  return os_fd_linux_recvmmsg(sock, msgs, count);
+}
+
+/**
+ * Redirect to linux specific sendmmsg call
+ * @param sock socket representation
+ * @param msgs array of packets
+ * @param count number of packets, at most OS_FD_MMSG_MAX will be sent
+ * @param dont_route true to suppress routing of data
+ * @return number of sent packets, -1 if an error happened
+ */
+static INLINE int
+os_fd_sendmmsg(struct os_fd *sock, struct os_fd_mmsg *msgs, size_t count,
+    bool dont_route) {
+  return os_fd_linux_sendmmsg(sock, msgs, count, dont_route);
+}
+
+/**
+ * Redirect to linux specific check for UDP segmentation offload
+ * @param sock socket representation
+ * @return true if the kernel can split a single send call
+ *   into multiple UDP packets for this socket
+ */
+static INLINE bool
+os_fd_supports_segments(struct os_fd *sock) {
+  return os_fd_linux_supports_segments(sock);
+}
+
+/**
+ * Redirect to linux specific segmented send call
+ * @param sock socket representation
+ * @param dst destination of all packets
+ * @param msgs array of packets, all but the last one must have
+ *   the same length, the last one must not be longer
+ * @param count number of packets, at most OS_FD_MMSG_MAX will be sent
+ * @param dont_route true to suppress routing of data
+ * @return number of bytes sent, -1 if an error happened
+ */
+static INLINE ssize_t
+os_fd_sendsegments(struct os_fd *sock, const union netaddr_socket *dst,
+    struct os_fd_mmsg *msgs, size_t count, bool dont_route) {
+  return os_fd_linux_sendsegments(sock, dst, msgs, count, dont_route);
+}
+
 /**
  * Binds a socket to a certain interface
  * @param sock filedescriptor of socket
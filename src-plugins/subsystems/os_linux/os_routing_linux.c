@@ -48,6 +48,7 @@
 
 /* and now the rest of the includes */
 #include <linux/netlink.h>
+#include <linux/nexthop.h>
 #include <linux/rtnetlink.h>
 #include <sys/uio.h>
 
@@ -78,10 +79,14 @@ struct route_type_translation {
 static int _init(void);
 static void _cleanup(void);
 
+static int _routing_add_multipath(struct nlmsghdr *msg, struct os_route *route);
+static void _routing_parse_multipath(struct os_route *route,
+    struct rtattr *rt_attr, unsigned char family);
 static int _routing_set(struct nlmsghdr *msg, struct os_route *route,
     unsigned char rt_scope);
 
 static void _routing_finished(struct os_route *route, int error);
+static void _nexthop_finished(struct os_nexthop *nexthop, int error);
 static void _cb_rtnetlink_message(struct nlmsghdr *);
 static void _cb_rtnetlink_event_message(struct nlmsghdr *);
 static void _cb_rtnetlink_error(uint32_t seq, int err);
@@ -127,6 +132,7 @@ static struct os_system_netlink _rtnetlink_socket = {
   .cb_error = _cb_rtnetlink_error,
   .cb_done = _cb_rtnetlink_done,
   .cb_timeout = _cb_rtnetlink_timeout,
+  .max_buffers_in_transit = OONF_NETLINK_ROUTING_WINDOW,
 };
 
 static struct os_system_netlink _rtnetlink_event_socket = {
@@ -136,6 +142,7 @@ static struct os_system_netlink _rtnetlink_event_socket = {
 };
 
 static struct avl_tree _rtnetlink_feedback;
+static struct avl_tree _nexthop_feedback;
 static struct list_entity _rtnetlink_listener;
 
 /* default wildcard route */
@@ -156,6 +163,7 @@ static const struct os_route_parameter OS_ROUTE_WILDCARD = {
 
 /* kernel version check */
 static bool _is_kernel_3_11_0_or_better;
+static bool _is_kernel_5_3_0_or_better;
 
 /**
  * Initialize routing subsystem
@@ -178,9 +186,11 @@ _init(void) {
     return -1;
   }
   avl_init(&_rtnetlink_feedback, avl_comp_uint32, false);
+  avl_init(&_nexthop_feedback, avl_comp_uint32, false);
   list_init_head(&_rtnetlink_listener);
 
   _is_kernel_3_11_0_or_better = os_system_linux_is_minimal_kernel(3,11,0);
+  _is_kernel_5_3_0_or_better = os_system_linux_is_minimal_kernel(5,3,0);
   return 0;
 }
 
@@ -190,10 +200,14 @@ _init(void) {
 static void
 _cleanup(void) {
   struct os_route *rt, *rt_it;
+  struct os_nexthop *nh, *nh_it;
 
   avl_for_each_element_safe(&_rtnetlink_feedback, rt, _internal._node, rt_it) {
     _routing_finished(rt, 1);
   }
+  avl_for_each_element_safe(&_nexthop_feedback, nh, _internal._node, nh_it) {
+    _nexthop_finished(nh, 1);
+  }
 
   os_system_linux_netlink_remove(&_rtnetlink_socket);
   os_system_linux_netlink_remove(&_rtnetlink_event_socket);
@@ -261,16 +275,25 @@ os_routing_linux_set(struct os_route *route, bool set, bool del_similar) {
     os_rt.p.protocol = 0;
     netaddr_invalidate(&os_rt.p.src_ip);
 
+    if (os_rt.p.nexthop_count > 1) {
+      /* remove all nexthops of a multipath route */
+      os_rt.p.nexthop_count = 0;
+      netaddr_invalidate(&os_rt.p.gw);
+      os_rt.p.if_index = 0;
+    }
+
     if (del_similar) {
       /* no interface necessary */
       os_rt.p.if_index = 0;
+      os_rt.p.nexthop_id = 0;
 
       /* as wildcard for fuzzy deletion */
       scope = RT_SCOPE_NOWHERE;
     }
   }
 
-  if (netaddr_is_unspec(&os_rt.p.gw)
+  if (netaddr_is_unspec(&os_rt.p.gw) && os_rt.p.nexthop_count <= 1
+      && os_rt.p.nexthop_id == 0
       && netaddr_get_address_family(&os_rt.p.key.dst) == AF_INET
       && netaddr_get_prefix_length(&os_rt.p.key.dst) == netaddr_get_maxprefix(&os_rt.p.key.dst)) {
     /* use destination as gateway, to 'force' linux kernel to do proper source address selection */
@@ -356,6 +379,100 @@ os_routing_linux_is_in_progress(struct os_route *route) {
   return avl_is_node_added(&route->_internal._node);
 }
 
+/**
+ * @return true if kernel supports nexthop objects
+ */
+bool
+os_routing_linux_supports_nexthop_objects(void) {
+  return _is_kernel_5_3_0_or_better;
+}
+
+/**
+ * Update a kernel nexthop object. Removing a nexthop object
+ * removes all routes using it.
+ * @param nexthop data of nexthop to be set/removed
+ * @param set true if nexthop should be set, false if it should be removed
+ * @return -1 if an error happened, 0 otherwise
+ */
+int
+os_routing_linux_set_nexthop(struct os_nexthop *nexthop, bool set) {
+  uint8_t buffer[UIO_MAXIOV];
+  struct nlmsghdr *msg;
+  struct nhmsg *nh_msg;
+  uint32_t if_index;
+  int seq;
+
+  if (nexthop->id == 0) {
+    return -1;
+  }
+
+  memset(buffer, 0, sizeof(buffer));
+
+  /* get pointers for netlink message */
+  msg = (void *)&buffer[0];
+  nh_msg = NLMSG_DATA(msg);
+
+  msg->nlmsg_flags = NLM_F_REQUEST;
+  msg->nlmsg_len = NLMSG_LENGTH(sizeof(*nh_msg));
+
+  if (set) {
+    if (netaddr_get_address_family(&nexthop->gw) != AF_INET
+        && netaddr_get_address_family(&nexthop->gw) != AF_INET6) {
+      return -1;
+    }
+
+    msg->nlmsg_flags |= NLM_F_CREATE | NLM_F_REPLACE;
+    msg->nlmsg_type = RTM_NEWNEXTHOP;
+
+    nh_msg->nh_family = netaddr_get_address_family(&nexthop->gw);
+    nh_msg->nh_protocol = nexthop->protocol;
+    nh_msg->nh_flags = RTNH_F_ONLINK;
+  }
+  else {
+    msg->nlmsg_type = RTM_DELNEXTHOP;
+    nh_msg->nh_family = AF_UNSPEC;
+  }
+
+  if (os_system_linux_netlink_addreq(&_rtnetlink_socket,
+      msg, NHA_ID, &nexthop->id, sizeof(nexthop->id))) {
+    return -1;
+  }
+
+  if (set) {
+    if_index = nexthop->if_index;
+    if (os_system_linux_netlink_addreq(&_rtnetlink_socket,
+        msg, NHA_OIF, &if_index, sizeof(if_index))) {
+      return -1;
+    }
+    if (os_system_linux_netlink_addnetaddr(&_rtnetlink_socket,
+        msg, NHA_GATEWAY, &nexthop->gw)) {
+      return -1;
+    }
+  }
+
+  seq = os_system_linux_netlink_send(&_rtnetlink_socket, msg);
+
+  if (nexthop->cb_finished) {
+    nexthop->_internal.nl_seq = seq;
+    nexthop->_internal._node.key = &nexthop->_internal.nl_seq;
+
+    assert (!avl_is_node_added(&nexthop->_internal._node));
+    avl_insert(&_nexthop_feedback, &nexthop->_internal._node);
+  }
+  return 0;
+}
+
+/**
+ * Stop processing of a nexthop command
+ * @param nexthop pointer to os_nexthop
+ */
+void
+os_routing_linux_interrupt_nexthop(struct os_nexthop *nexthop) {
+  if (avl_is_node_added(&nexthop->_internal._node)) {
+    _nexthop_finished(nexthop, -1);
+  }
+}
+
 /**
  * Add routing change listener
  * @param listener routing change listener
@@ -401,6 +518,22 @@ _routing_finished(struct os_route *route, int error) {
   }
 }
 
+/**
+ * Stop processing of a nexthop command and set error code
+ * for callback
+ * @param nexthop pointer to os_nexthop
+ * @param error error code, 0 if no error
+ */
+static void
+_nexthop_finished(struct os_nexthop *nexthop, int error) {
+  /* remove first to prevent any kind of recursive cleanup */
+  avl_remove(&_nexthop_feedback, &nexthop->_internal._node);
+
+  if (nexthop->cb_finished) {
+    nexthop->cb_finished(nexthop, error);
+  }
+}
+
 /**
  * Initiatize the an netlink routing message
  * @param msg pointer to netlink message header
@@ -464,7 +597,20 @@ _routing_set(struct nlmsghdr *msg, struct os_route *route,
     }
   }
 
-  if (netaddr_get_address_family(&route->p.gw) != AF_UNSPEC) {
+  if (route->p.nexthop_id) {
+    /* reference nexthop object instead of gateway and interface */
+    if (os_system_linux_netlink_addreq(&_rtnetlink_event_socket,
+        msg, RTA_NH_ID, &route->p.nexthop_id, sizeof(route->p.nexthop_id))) {
+      return -1;
+    }
+  }
+  else if (route->p.nexthop_count > 1) {
+    /* add nexthops instead of gateway and interface */
+    if (_routing_add_multipath(msg, route)) {
+      return -1;
+    }
+  }
+  else if (netaddr_get_address_family(&route->p.gw) != AF_UNSPEC) {
     rt_msg->rtm_flags |= RTNH_F_ONLINK;
 
     /* add gateway */
@@ -503,7 +649,7 @@ _routing_set(struct nlmsghdr *msg, struct os_route *route,
     }
   }
 
-  if (route->p.if_index) {
+  if (route->p.if_index && route->p.nexthop_count <= 1 && route->p.nexthop_id == 0) {
     /* add interface*/
     if (os_system_linux_netlink_addreq(&_rtnetlink_event_socket,
         msg, RTA_OIF, &route->p.if_index, sizeof(route->p.if_index))) {
@@ -513,6 +659,96 @@ _routing_set(struct nlmsghdr *msg, struct os_route *route,
   return 0;
 }
 
+/**
+ * Add the nexthops of a multipath route to a netlink message
+ * @param msg pointer to netlink message header
+ * @param route multipath route
+ * @return -1 if an error happened, 0 otherwise
+ */
+static int
+_routing_add_multipath(struct nlmsghdr *msg, struct os_route *route) {
+  uint8_t buffer[OS_ROUTE_MAX_NEXTHOPS
+                 * (RTNH_ALIGN(sizeof(struct rtnexthop)) + RTA_SPACE(16))];
+  const struct os_route_nexthop *nexthop;
+  struct rtnexthop *rtnh;
+  struct rtattr *rta;
+  size_t i, len, addr_len;
+  struct netaddr_str nbuf;
+
+  memset(buffer, 0, sizeof(buffer));
+  len = 0;
+
+  for (i=0; i<route->p.nexthop_count && i<OS_ROUTE_MAX_NEXTHOPS; i++) {
+    nexthop = &route->p.nexthops[i];
+    if (netaddr_get_address_family(&nexthop->gw) != route->p.family) {
+      OONF_WARN(LOG_OS_ROUTING, "Skip nexthop %s with wrong address family",
+          netaddr_to_string(&nbuf, &nexthop->gw));
+      continue;
+    }
+    addr_len = netaddr_get_maxprefix(&nexthop->gw) / 8;
+
+    rtnh = (struct rtnexthop *)(&buffer[len]);
+    rtnh->rtnh_flags = RTNH_F_ONLINK;
+    rtnh->rtnh_ifindex = nexthop->if_index;
+
+    rta = RTNH_DATA(rtnh);
+    rta->rta_type = RTA_GATEWAY;
+    rta->rta_len = RTA_LENGTH(addr_len);
+    memcpy(RTA_DATA(rta), netaddr_get_binptr(&nexthop->gw), addr_len);
+
+    rtnh->rtnh_len = RTNH_LENGTH(RTA_SPACE(addr_len));
+    len += RTNH_ALIGN(rtnh->rtnh_len);
+  }
+
+  if (len == 0) {
+    /* no usable nexthop left */
+    return -1;
+  }
+
+  return os_system_linux_netlink_addreq(&_rtnetlink_event_socket,
+      msg, RTA_MULTIPATH, buffer, len);
+}
+
+/**
+ * Parse the nexthops of a multipath route
+ * @param route route to store nexthops in
+ * @param rt_attr multipath netlink attribute
+ * @param family address family of route
+ */
+static void
+_routing_parse_multipath(struct os_route *route,
+    struct rtattr *rt_attr, unsigned char family) {
+  struct os_route_nexthop *nexthop;
+  struct rtnexthop *rtnh;
+  struct rtattr *rta;
+  int len, rta_len;
+
+  rtnh = RTA_DATA(rt_attr);
+  len = RTA_PAYLOAD(rt_attr);
+
+  route->p.nexthop_count = 0;
+  while (RTNH_OK(rtnh, len) && route->p.nexthop_count < OS_ROUTE_MAX_NEXTHOPS) {
+    nexthop = &route->p.nexthops[route->p.nexthop_count++];
+    nexthop->if_index = rtnh->rtnh_ifindex;
+
+    rta_len = rtnh->rtnh_len - RTNH_LENGTH(0);
+    for (rta = RTNH_DATA(rtnh); RTA_OK(rta, rta_len); rta = RTA_NEXT(rta, rta_len)) {
+      if (rta->rta_type == RTA_GATEWAY) {
+        netaddr_from_binary(&nexthop->gw, RTA_DATA(rta), RTA_PAYLOAD(rta), family);
+      }
+    }
+
+    len -= RTNH_ALIGN(rtnh->rtnh_len);
+    rtnh = RTNH_NEXT(rtnh);
+  }
+
+  if (route->p.nexthop_count > 0 && route->p.if_index == 0) {
+    /* report first nexthop as gateway */
+    memcpy(&route->p.gw, &route->p.nexthops[0].gw, sizeof(route->p.gw));
+    route->p.if_index = route->p.nexthops[0].if_index;
+  }
+}
+
 /**
  * Parse a rtnetlink header into a os_route object
  * @param route pointer to target os_route
@@ -582,6 +818,12 @@ _routing_parse_nlmsg(struct os_route *route, struct nlmsghdr *msg) {
       case RTA_OIF:
         memcpy(&route->p.if_index, RTA_DATA(rt_attr), sizeof(route->p.if_index));
         break;
+      case RTA_MULTIPATH:
+        _routing_parse_multipath(route, rt_attr, rt_msg->rtm_family);
+        break;
+      case RTA_NH_ID:
+        memcpy(&route->p.nexthop_id, RTA_DATA(rt_attr), sizeof(route->p.nexthop_id));
+        break;
       default:
         break;
     }
@@ -706,6 +948,7 @@ _cb_rtnetlink_event_message(struct nlmsghdr *msg) {
 static void
 _cb_rtnetlink_error(uint32_t seq, int err) {
   struct os_route *route;
+  struct os_nexthop *nexthop;
 #ifdef OONF_LOG_DEBUG_INFO
   struct os_route_str rbuf;
 #endif
@@ -719,6 +962,12 @@ _cb_rtnetlink_error(uint32_t seq, int err) {
 
     _routing_finished(route, err);
   }
+  else if ((nexthop = avl_find_element(&_nexthop_feedback, &seq, nexthop, _internal._node))) {
+    OONF_DEBUG(LOG_OS_ROUTING, "Nexthop %u with seqno %u failed: %s (%d)",
+        nexthop->id, seq, strerror(err), err);
+
+    _nexthop_finished(nexthop, err);
+  }
   else {
     OONF_DEBUG(LOG_OS_ROUTING, "Unknown route with seqno %u failed: %s (%d)",
         seq, strerror(err), err);
@@ -731,12 +980,16 @@ _cb_rtnetlink_error(uint32_t seq, int err) {
 static void
 _cb_rtnetlink_timeout(void) {
   struct os_route *route, *rt_it;
+  struct os_nexthop *nexthop, *nh_it;
 
   OONF_WARN(LOG_OS_ROUTING, "Netlink timeout for routing");
 
   avl_for_each_element_safe(&_rtnetlink_feedback, route, _internal._node, rt_it) {
     _routing_finished(route, -1);
   }
+  avl_for_each_element_safe(&_nexthop_feedback, nexthop, _internal._node, nh_it) {
+    _nexthop_finished(nexthop, -1);
+  }
 }
 
 /**
@@ -746,6 +999,7 @@ _cb_rtnetlink_timeout(void) {
 static void
 _cb_rtnetlink_done(uint32_t seq) {
   struct os_route *route;
+  struct os_nexthop *nexthop;
 #ifdef OONF_LOG_DEBUG_INFO
   struct os_route_str rbuf;
 #endif
@@ -757,5 +1011,12 @@ _cb_rtnetlink_done(uint32_t seq) {
     OONF_DEBUG(LOG_OS_ROUTING, "Route %s with seqno %u done",
         os_routing_to_string(&rbuf, &route->p), seq);
     _routing_finished(route, 0);
+    return;
+  }
+
+  nexthop = avl_find_element(&_nexthop_feedback, &seq, nexthop, _internal._node);
+  if (nexthop) {
+    OONF_DEBUG(LOG_OS_ROUTING, "Nexthop %u with seqno %u done", nexthop->id, seq);
+    _nexthop_finished(nexthop, 0);
   }
 }
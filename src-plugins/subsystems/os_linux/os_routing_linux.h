@@ -78,6 +78,10 @@ EXPORT int os_routing_linux_query(struct os_route *);
 EXPORT void os_routing_linux_interrupt(struct os_route *);
 EXPORT bool os_routing_linux_is_in_progress(struct os_route *);
 
+EXPORT bool os_routing_linux_supports_nexthop_objects(void);
+EXPORT int os_routing_linux_set_nexthop(struct os_nexthop *, bool set);
+EXPORT void os_routing_linux_interrupt_nexthop(struct os_nexthop *);
+
 EXPORT void os_routing_linux_listener_add(struct os_route_listener *);
 EXPORT void os_routing_linux_listener_remove(struct os_route_listener *);
 
@@ -141,6 +145,35 @@ os_routing_is_in_progress(struct os_route *route) {
   return os_routing_linux_is_in_progress(route);
 }
 
+/**
+ * @return true if kernel supports nexthop objects
+ */
+static INLINE bool
+os_routing_supports_nexthop_objects(void) {
+  return os_routing_linux_supports_nexthop_objects();
+}
+
+/**
+ * Update a kernel nexthop object. Removing a nexthop object
+ * removes all routes using it.
+ * @param nexthop data of nexthop to be set/removed
+ * @param set true if nexthop should be set, false if it should be removed
+ * @return -1 if an error happened, 0 otherwise
+ */
+static INLINE int
+os_routing_set_nexthop(struct os_nexthop *nexthop, bool set) {
+  return os_routing_linux_set_nexthop(nexthop, set);
+}
+
+/**
+ * Stop processing of a nexthop command
+ * @param nexthop pointer to os_nexthop
+ */
+static INLINE void
+os_routing_interrupt_nexthop(struct os_nexthop *nexthop) {
+  os_routing_linux_interrupt_nexthop(nexthop);
+}
+
 /**
  * Add routing change listener
  * @param listener routing change listener
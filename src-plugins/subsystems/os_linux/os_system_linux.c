@@ -88,6 +88,10 @@ static void _netlink_handler(struct oonf_socket_entry *entry);
 static void _enqueue_netlink_buffer(struct os_system_netlink *nl);
 static void _handle_nl_err(struct os_system_netlink *, struct nlmsghdr *);
 static void _flush_netlink_buffer(struct os_system_netlink *nl);
+static void _report_netlink_buffer(struct os_system_netlink *nl,
+    struct os_system_netlink_buffer *buffer, int error);
+static void _reduce_netlink_acks(struct os_system_netlink_buffer *buffer);
+static void _netlink_job_finished(struct os_system_netlink *nl, uint32_t seq);
 
 /* static buffers for receiving/sending a netlink message */
 static struct sockaddr_nl _netlink_nladdr = {
@@ -328,12 +332,15 @@ os_system_linux_netlink_add(struct os_system_netlink *nl, int protocol) {
   }
 
   nl->socket.process = _netlink_handler;
+  nl->socket.name = nl->name;
   oonf_socket_add(&nl->socket);
   oonf_socket_set_read(&nl->socket, true);
 
   nl->timeout.class = &_netlink_timer;
 
   list_init_head(&nl->buffered);
+  list_init_head(&nl->in_transit);
+  nl->buffers_in_transit = 0;
   return 0;
 
 os_add_netlink_fail:
@@ -351,6 +358,19 @@ os_add_netlink_fail:
  */
 void
 os_system_linux_netlink_remove(struct os_system_netlink *nl) {
+  struct os_system_netlink_buffer *buffer, *buf_it;
+
+  oonf_timer_stop(&nl->timeout);
+  list_for_each_element_safe(&nl->in_transit, buffer, _node, buf_it) {
+    list_remove(&buffer->_node);
+    free(buffer);
+  }
+  list_for_each_element_safe(&nl->buffered, buffer, _node, buf_it) {
+    list_remove(&buffer->_node);
+    free(buffer);
+  }
+  nl->buffers_in_transit = 0;
+
   oonf_socket_remove(&nl->socket);
 
   os_fd_close(&nl->socket.fd);
@@ -370,6 +390,7 @@ _enqueue_netlink_buffer(struct os_system_netlink *nl) {
   bufptr = (struct os_system_netlink_buffer *)abuf_getptr(&nl->out);
   bufptr->total = abuf_getlen(&nl->out) - sizeof(*bufptr);
   bufptr->messages = nl->out_messages;
+  _reduce_netlink_acks(bufptr);
 
   /* append to end of queue */
   list_add_tail(&nl->buffered, &bufptr->_node);
@@ -503,17 +524,160 @@ os_system_linux_netlink_addreq(struct os_system_netlink *nl,
 static void
 _cb_handle_netlink_timeout(struct oonf_timer_instance *ptr) {
   struct os_system_netlink *nl;
+  struct os_system_netlink_buffer *buffer, *buf_it;
 
   nl = container_of(ptr, struct os_system_netlink, timeout);
 
+  /* the timeout callback finishes all messages without feedback */
+  list_for_each_element_safe(&nl->in_transit, buffer, _node, buf_it) {
+    list_remove(&buffer->_node);
+    free(buffer);
+  }
+  nl->buffers_in_transit = 0;
+
   if (nl->cb_timeout) {
     nl->cb_timeout();
   }
   nl->msg_in_transit = 0;
+
+  if (!list_is_empty(&nl->buffered) || nl->out_messages > 0) {
+    oonf_socket_set_write(&nl->socket, true);
+  }
 }
 
 /**
- * Send all netlink messages in the outgoing queue to the kernel
+ * @param nl pointer to netlink handler
+ * @return maximum number of buffers in transit to the kernel
+ */
+static uint32_t
+_get_window(struct os_system_netlink *nl) {
+  return nl->max_buffers_in_transit > 0 ? nl->max_buffers_in_transit : 1;
+}
+
+/**
+ * @param buffer pointer to netlink buffer
+ * @return pointer to first netlink message in buffer
+ */
+static struct nlmsghdr *
+_get_buffer_data(struct os_system_netlink_buffer *buffer) {
+  return (struct nlmsghdr *)((char *)(buffer) + sizeof(*buffer));
+}
+
+/**
+ * Report an error for all messages of a buffer that got no
+ * feedback from the kernel yet
+ * @param nl pointer to netlink handler
+ * @param buffer pointer to netlink buffer, must not be in a list anymore
+ * @param error error code
+ */
+static void
+_report_netlink_buffer(struct os_system_netlink *nl,
+    struct os_system_netlink_buffer *buffer, int error) {
+  struct nlmsghdr *nh;
+  size_t len;
+
+  len = buffer->total;
+  for (nh = _get_buffer_data(buffer); NLMSG_OK(nh, len); nh = NLMSG_NEXT(nh, len)) {
+    if (nh->nlmsg_type == NLMSG_NOOP) {
+      /* already got feedback */
+      continue;
+    }
+
+    OONF_DEBUG(nl->used_by->logging, "netlink '%s' message %u failed: %s (%d)",
+        nl->name, nh->nlmsg_seq, strerror(error), error);
+    if (nl->cb_error) {
+      nl->cb_error(nh->nlmsg_seq, error);
+    }
+  }
+}
+
+/**
+ * @param nh pointer to netlink message
+ * @return true if message is a dump request
+ */
+static bool
+_is_netlink_dump(struct nlmsghdr *nh) {
+  return (nh->nlmsg_flags & NLM_F_DUMP) == NLM_F_DUMP;
+}
+
+/**
+ * Only request an explicit ack for the last message of a buffer. The
+ * kernel processes the messages of a buffer in order and always
+ * reports errors, so the ack of a later message implies the success
+ * of all earlier messages without an error. Dump requests keep their
+ * flags because their result arrives asynchronously.
+ * @param buffer pointer to netlink buffer
+ */
+static void
+_reduce_netlink_acks(struct os_system_netlink_buffer *buffer) {
+  struct nlmsghdr *nh, *last = NULL;
+  size_t len;
+
+  len = buffer->total;
+  for (nh = _get_buffer_data(buffer); NLMSG_OK(nh, len); nh = NLMSG_NEXT(nh, len)) {
+    if (!_is_netlink_dump(nh)) {
+      nh->nlmsg_flags &= ~NLM_F_ACK;
+      last = nh;
+    }
+  }
+  if (last) {
+    last->nlmsg_flags |= NLM_F_ACK;
+  }
+}
+
+/**
+ * Mark a message of a buffer in transit as finished. All earlier
+ * messages of the buffer without an explicit ack are finished too.
+ * @param nl pointer to netlink handler
+ * @param buffer pointer to netlink buffer
+ * @param seq sequence number of finished message
+ * @return true if the message was in the buffer and had no
+ *   feedback yet, false otherwise
+ */
+static bool
+_finish_netlink_message(struct os_system_netlink *nl,
+    struct os_system_netlink_buffer *buffer, uint32_t seq) {
+  struct nlmsghdr *nh;
+  size_t len;
+
+  /* look for the message first */
+  len = buffer->total;
+  for (nh = _get_buffer_data(buffer); NLMSG_OK(nh, len); nh = NLMSG_NEXT(nh, len)) {
+    if (nh->nlmsg_seq == seq) {
+      break;
+    }
+  }
+  if (!NLMSG_OK(nh, len) || nh->nlmsg_type == NLMSG_NOOP) {
+    /* not in this buffer or duplicate feedback */
+    return false;
+  }
+
+  len = buffer->total;
+  for (nh = _get_buffer_data(buffer); NLMSG_OK(nh, len); nh = NLMSG_NEXT(nh, len)) {
+    if (nh->nlmsg_seq == seq) {
+      /* the sent copy is not needed anymore, use the type as a marker */
+      nh->nlmsg_type = NLMSG_NOOP;
+      buffer->messages--;
+      break;
+    }
+
+    if (nh->nlmsg_type != NLMSG_NOOP
+        && (nh->nlmsg_flags & NLM_F_ACK) == 0 && !_is_netlink_dump(nh)) {
+      /* no error reported before a later message, so it was successful */
+      nh->nlmsg_type = NLMSG_NOOP;
+      buffer->messages--;
+
+      if (nl->cb_done) {
+        nl->cb_done(nh->nlmsg_seq);
+      }
+    }
+  }
+  return true;
+}
+
+/**
+ * Send netlink buffers of the outgoing queue to the kernel until
+ * the queue is empty or the window of buffers in transit is full
  * @param nl pointer to netlink handler
  */
 static void
@@ -522,82 +686,101 @@ _flush_netlink_buffer(struct os_system_netlink *nl) {
   ssize_t ret;
   int err;
 
-  if (nl->msg_in_transit > 0) {
-    return;
-  }
-
-  if (list_is_empty(&nl->buffered)) {
-    if (abuf_getlen(&nl->out) > sizeof(struct os_system_netlink_buffer)) {
+  while (nl->buffers_in_transit < _get_window(nl)) {
+    if (list_is_empty(&nl->buffered)) {
+      if (abuf_getlen(&nl->out) <= sizeof(struct os_system_netlink_buffer)) {
+        break;
+      }
       _enqueue_netlink_buffer(nl);
     }
-    else {
-      oonf_socket_set_write(&nl->socket, false);
-      return;
-    }
-  }
 
-  /* get first buffer */
-  buffer = list_first_element(&nl->buffered, buffer, _node);
+    /* get first buffer */
+    buffer = list_first_element(&nl->buffered, buffer, _node);
 
-  /* send outgoing message */
-  _netlink_send_iov[0].iov_base = (char *)(buffer) + sizeof(*buffer);
-  _netlink_send_iov[0].iov_len = buffer->total;
+    /* send outgoing message */
+    _netlink_send_iov[0].iov_base = _get_buffer_data(buffer);
+    _netlink_send_iov[0].iov_len = buffer->total;
 
-  if ((ret = sendmsg(os_fd_get_fd(&nl->socket.fd),
-        &_netlink_send_msg, MSG_DONTWAIT)) <= 0) {
-    err = errno;
+    if ((ret = sendmsg(os_fd_get_fd(&nl->socket.fd),
+          &_netlink_send_msg, MSG_DONTWAIT)) <= 0) {
+      err = errno;
 #if EAGAIN == EWOULDBLOCK
-    if (err != EAGAIN) {
+      if (err == EAGAIN) {
 #else
-    if (err != EAGAIN && err != EWOULDBLOCK) {
+      if (err == EAGAIN || err == EWOULDBLOCK) {
 #endif
-      OONF_WARN(nl->used_by->logging,
-          "Cannot send data (%"PRINTF_SIZE_T_SPECIFIER" bytes)"
-          " to netlink socket %s: %s (%d)",
-          abuf_getlen(&nl->out), nl->name, strerror(err), err);
+        /* try again when socket is writable */
+        oonf_socket_set_write(&nl->socket, true);
+        return;
+      }
 
-      /* remove netlink message from internal queue */
-      nl->cb_error(nl->in->nlmsg_seq, err);
-      return;
+      OONF_WARN(nl->used_by->logging,
+          "Cannot send data (%u bytes) to netlink socket %s: %s (%d)",
+          buffer->total, nl->name, strerror(err), err);
+
+      /* remove netlink messages from internal queue */
+      list_remove(&buffer->_node);
+      _report_netlink_buffer(nl, buffer, err);
+      free(buffer);
+      continue;
     }
-  }
-  else {
+
     nl->msg_in_transit += buffer->messages;
 
+    /* keep buffer until the kernel reported back for all messages */
+    list_remove(&buffer->_node);
+    list_add_tail(&nl->in_transit, &buffer->_node);
+    nl->buffers_in_transit++;
+
     OONF_DEBUG(nl->used_by->logging,
-        "netlink %s: Sent %u bytes (%u messages in transit)",
-        nl->name, buffer->total, nl->msg_in_transit);
+        "netlink %s: Sent %u bytes (%u buffers, %d messages in transit)",
+        nl->name, buffer->total, nl->buffers_in_transit, nl->msg_in_transit);
 
-    list_remove(&buffer->_node);
-    free(buffer);
+    /* start feedback timer */
+    oonf_timer_set(&nl->timeout, OS_SYSTEM_NETLINK_TIMEOUT);
   }
 
-  oonf_socket_set_write(&nl->socket, !list_is_empty(&nl->buffered));
-
-  /* start feedback timer */
-  oonf_timer_set(&nl->timeout, OS_SYSTEM_NETLINK_TIMEOUT);
+  oonf_socket_set_write(&nl->socket,
+      nl->buffers_in_transit < _get_window(nl)
+      && (!list_is_empty(&nl->buffered) || nl->out_messages > 0));
 }
 
 /**
- * Cleanup netlink handler because all outstanding jobs
- * are finished
+ * Account for kernel feedback of a single netlink message
+ * and open the transmission window if its buffer is finished
  * @param nl pointer to os_system_netlink handler
+ * @param seq sequence number of finished message
  */
 static void
-_netlink_job_finished(struct os_system_netlink *nl) {
-  if (nl->msg_in_transit > 0) {
-    nl->msg_in_transit--;
-  }
-  if (nl->msg_in_transit == 0) {
-    oonf_timer_stop(&nl->timeout);
+_netlink_job_finished(struct os_system_netlink *nl, uint32_t seq) {
+  struct os_system_netlink_buffer *buffer;
+  uint32_t messages;
 
-    if (!list_is_empty(&nl->buffered)
-        || nl->out_messages > 0) {
-      oonf_socket_set_write(&nl->socket, true);
+  list_for_each_element(&nl->in_transit, buffer, _node) {
+    messages = buffer->messages;
+    if (!_finish_netlink_message(nl, buffer, seq)) {
+      continue;
     }
+
+    nl->msg_in_transit -= messages - buffer->messages;
+    if (buffer->messages == 0) {
+      list_remove(&buffer->_node);
+      free(buffer);
+      nl->buffers_in_transit--;
+
+      if (!list_is_empty(&nl->buffered)
+          || nl->out_messages > 0) {
+        oonf_socket_set_write(&nl->socket, true);
+      }
+    }
+    break;
   }
-  OONF_DEBUG(nl->used_by->logging, "netlink '%s' finished: %d still in transit",
-      nl->name, nl->msg_in_transit);
+
+  if (list_is_empty(&nl->in_transit)) {
+    oonf_timer_stop(&nl->timeout);
+  }
+  OONF_DEBUG(nl->used_by->logging, "netlink '%s' finished %u: %d still in transit",
+      nl->name, seq, nl->msg_in_transit);
 }
 
 /**
@@ -692,16 +875,14 @@ netlink_rcv_retry:
         "Netlink '%s' message received: type %d seq %u\n",
         nl->name, nh->nlmsg_type, nh->nlmsg_seq);
 
-    if (nh == nl->in) {
-      current_seq = nh->nlmsg_seq;
-    }
-
     if (current_seq != nh->nlmsg_seq && trigger_is_done) {
+      _netlink_job_finished(nl, current_seq);
       if (nl->cb_done) {
         nl->cb_done(current_seq);
       }
       trigger_is_done = false;
     }
+    current_seq = nh->nlmsg_seq;
 
     switch (nh->nlmsg_type) {
       case NLMSG_NOOP:
@@ -727,11 +908,10 @@ netlink_rcv_retry:
   }
 
   if (trigger_is_done) {
-    oonf_timer_stop(&nl->timeout);
+    _netlink_job_finished(nl, current_seq);
     if (nl->cb_done) {
       nl->cb_done(current_seq);
     }
-    _netlink_job_finished(nl);
   }
 
   /* reset timeout if necessary */
@@ -755,6 +935,9 @@ _handle_nl_err(struct os_system_netlink *nl, struct nlmsghdr *nh) {
       "Received netlink '%s' seq %u feedback (%u bytes): %s (%d)",
       nl->name, nh->nlmsg_seq, nh->nlmsg_len, strerror(-err->error), -err->error);
 
+  /* finish all earlier messages of the buffer first */
+  _netlink_job_finished(nl, err->msg.nlmsg_seq);
+
   if (err->error) {
     if (nl->cb_error) {
       nl->cb_error(err->msg.nlmsg_seq, -err->error);
@@ -765,6 +948,4 @@ _handle_nl_err(struct os_system_netlink *nl, struct nlmsghdr *nh) {
       nl->cb_done(err->msg.nlmsg_seq);
     }
   }
-
-  _netlink_job_finished(nl);
 }
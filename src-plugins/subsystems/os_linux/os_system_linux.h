@@ -57,6 +57,11 @@
 /*! default timeout for netlink messages */
 #define OS_SYSTEM_NETLINK_TIMEOUT 1000
 
+#ifndef OONF_NETLINK_ROUTING_WINDOW
+/*! number of buffers the routing netlink socket sends without waiting for feedback */
+#define OONF_NETLINK_ROUTING_WINDOW 8
+#endif
+
 /**
  * A buffer for transmitting netlink commands to the operation system
  */
@@ -67,7 +72,10 @@ struct os_system_netlink_buffer {
   /*! total number of bytes in buffer */
   uint32_t total;
 
-  /*! total number of messages in buffer */
+  /**
+   * total number of messages in buffer, after the buffer has been sent
+   * this is the number of messages still waiting for kernel feedback
+   */
   uint32_t messages;
 };
 
@@ -90,6 +98,18 @@ struct os_system_netlink {
   /*! link of data buffers to transmit */
   struct list_entity buffered;
 
+  /*! list of sent data buffers waiting for kernel feedback */
+  struct list_entity in_transit;
+
+  /*! number of buffers in in_transit list */
+  uint32_t buffers_in_transit;
+
+  /**
+   * maximum number of buffers sent to the kernel without feedback,
+   * 0 means only a single buffer
+   */
+  uint32_t max_buffers_in_transit;
+
   /*! subsystem that uses this netlink handler */
   struct oonf_subsystem *used_by;
 
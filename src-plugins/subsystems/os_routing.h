@@ -61,8 +61,12 @@
 
 struct os_route;
 struct os_route_listener;
+struct os_nexthop;
 struct os_route_str;
 
+/*! maximum number of nexthops of a multipath route */
+#define OS_ROUTE_MAX_NEXTHOPS 4
+
 /* make sure default values for routing are there */
 #ifndef RTPROT_UNSPEC
 /*! unspecified routing protocol */
@@ -94,6 +98,10 @@ struct os_route_str {
            /* table, protocol */
            +6+4 +9+4
            +3 + IF_NAMESIZE + 2 + 10 + 2
+           /* nexthop object */
+           + 4 + 10
+           /* multipath nexthops */
+           + OS_ROUTE_MAX_NEXTHOPS * (5 + sizeof(struct netaddr_str) + 2 + 10 + 1)
            /* footer and 0-byte */
            + 2];
 };
@@ -125,6 +133,17 @@ struct os_route_key {
   struct netaddr src;
 };
 
+/**
+ * nexthop of a multipath route
+ */
+struct os_route_nexthop {
+  /*! gateway of nexthop */
+  struct netaddr gw;
+
+  /*! index of outgoing interface of nexthop */
+  unsigned int if_index;
+};
+
 struct os_route_parameter {
   /*! address family */
   unsigned char family;
@@ -152,6 +171,15 @@ struct os_route_parameter {
 
   /*! index of outgoing interface */
   unsigned int if_index;
+
+  /*! number of multipath nexthops, gw and if_index are ignored if larger than 1 */
+  unsigned char nexthop_count;
+
+  /*! nexthops of a multipath route */
+  struct os_route_nexthop nexthops[OS_ROUTE_MAX_NEXTHOPS];
+
+  /*! id of kernel nexthop object used by route, 0 to use gw and if_index */
+  uint32_t nexthop_id;
 };
 
 /* include os-specific headers */
@@ -188,6 +216,34 @@ struct os_route {
   void (*cb_get)(struct os_route *filter, struct os_route *route);
 };
 
+/**
+ * Handler for changing a kernel nexthop object, which can be shared
+ * by multiple routes through their nexthop_id
+ */
+struct os_nexthop {
+  /*! id of the nexthop object, must not be 0 */
+  uint32_t id;
+
+  /*! routing protocol */
+  unsigned char protocol;
+
+  /*! gateway of nexthop */
+  struct netaddr gw;
+
+  /*! index of outgoing interface */
+  unsigned int if_index;
+
+  /*! used for delivering feedback about netlink commands */
+  struct os_route_internal _internal;
+
+  /**
+   * Callback triggered when the nexthop has been set
+   * @param nexthop this nexthop object
+   * @param error -1 if an error happened, 0 otherwise
+   */
+  void (*cb_finished)(struct os_nexthop *nexthop, int error);
+};
+
 /**
  * Listener for kernel route changes
  */
@@ -211,6 +267,10 @@ static INLINE int os_routing_query(struct os_route *);
 static INLINE void os_routing_interrupt(struct os_route *);
 static INLINE bool os_routing_is_in_progress(struct os_route *);
 
+static INLINE bool os_routing_supports_nexthop_objects(void);
+static INLINE int os_routing_set_nexthop(struct os_nexthop *, bool set);
+static INLINE void os_routing_interrupt_nexthop(struct os_nexthop *);
+
 static INLINE void os_routing_listener_add(struct os_route_listener *);
 static INLINE void os_routing_listener_remove(struct os_route_listener *);
 
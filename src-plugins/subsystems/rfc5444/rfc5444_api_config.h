@@ -55,4 +55,7 @@
 /*! clear buffers for packet generation after usage */
 #define DEBUG_CLEANUP                  false
 
+/*! size of the memory chunks used by the reader arena */
+#define READER_ARENA_CHUNK_SIZE        4096
+
 #endif /* RFC5444_API_CONFIG_H_ */
@@ -43,6 +43,7 @@
  * @file
  */
 #include <assert.h>
+#include <stddef.h>
 #include <stdlib.h>
 #include <string.h>
 
@@ -64,14 +65,30 @@
 #define RFC5444_CONSUMER_DROP_ONLY(value, def) (value)
 #endif
 
+/**
+ * Alignment of a type, used to place entries into the arena
+ * @param type data type
+ */
+#define RFC5444_ARENA_ALIGNOF(type) offsetof(struct { char c; type t; }, t)
+
+/**
+ * position inside the reader arena to rewind to
+ */
+struct _arena_mark {
+  /*! current chunk of the arena */
+  struct rfc5444_reader_arena_chunk *chunk;
+
+  /*! number of used bytes in current chunk */
+  size_t used;
+};
+
 static int _consumer_avl_comp(const void *k1, const void *k2);
 static uint16_t _calc_tlvconsumer_intorder(struct rfc5444_reader_tlvblock_consumer_entry *entry);
 static uint16_t _calc_tlvblock_intorder(struct rfc5444_reader_tlvblock_entry *entry);
-static int _compare_tlvtypes(struct rfc5444_reader_tlvblock_entry *tlv,
-    struct rfc5444_reader_tlvblock_consumer_entry *entry);
+static struct rfc5444_reader_tlvblock_consumer_entry *_get_consumer_entry(
+    struct rfc5444_reader_tlvblock_consumer *consumer, struct rfc5444_reader_tlvblock_entry *tlv);
 static uint8_t _rfc5444_get_u8(uint8_t **ptr, uint8_t *end, enum rfc5444_result *result);
 static uint16_t _rfc5444_get_u16(uint8_t **ptr, uint8_t *end, enum rfc5444_result *result);
-static void _free_tlvblock(struct rfc5444_reader *parser, struct avl_tree *entries);
 static int _parse_tlv(struct rfc5444_reader_tlvblock_entry *entry, uint8_t **ptr,
     uint8_t *eob, uint8_t addr_count);
 static int _parse_tlvblock(struct rfc5444_reader *parser,
@@ -87,10 +104,13 @@ static struct rfc5444_reader_tlvblock_consumer *_add_consumer(
     struct rfc5444_reader_tlvblock_consumer_entry *entries, int entrycount);
 static void _free_consumer(struct avl_tree *consumer_tree,
     struct rfc5444_reader_tlvblock_consumer *consumer);
-static struct rfc5444_reader_addrblock_entry *_malloc_addrblock_entry(void);
-static struct rfc5444_reader_tlvblock_entry *_malloc_tlvblock_entry(void);
-static void _free_addrblock_entry(struct rfc5444_reader_addrblock_entry *entry);
-static void _free_tlvblock_entry(struct rfc5444_reader_tlvblock_entry *entry);
+static void _compile_msg_dispatch(struct rfc5444_reader *parser);
+static struct rfc5444_reader_tlvblock_consumer *_next_msg_consumer(
+    struct rfc5444_reader_tlvblock_consumer **specific,
+    struct rfc5444_reader_tlvblock_consumer **dflt);
+static void *_arena_alloc(struct rfc5444_reader_arena *arena, size_t size, size_t align);
+static void _arena_mark(struct rfc5444_reader_arena *arena, struct _arena_mark *mark);
+static void _arena_rewind(struct rfc5444_reader_arena *arena, struct _arena_mark *mark);
 
 static uint8_t rfc5444_get_pktversion(uint8_t v);
 
@@ -103,15 +123,9 @@ rfc5444_reader_init(struct rfc5444_reader *context) {
   avl_init(&context->packet_consumer, _consumer_avl_comp, true);
   avl_init(&context->message_consumer, _consumer_avl_comp, true);
 
-  if (context->malloc_addrblock_entry == NULL)
-    context->malloc_addrblock_entry = _malloc_addrblock_entry;
-  if (context->malloc_tlvblock_entry == NULL)
-    context->malloc_tlvblock_entry = _malloc_tlvblock_entry;
-
-  if (context->free_addrblock_entry == NULL)
-    context->free_addrblock_entry = _free_addrblock_entry;
-  if (context->free_tlvblock_entry == NULL)
-    context->free_tlvblock_entry = _free_tlvblock_entry;
+  memset(context->_msg_dispatch, 0, sizeof(context->_msg_dispatch));
+  context->_default_dispatch = NULL;
+  memset(&context->_arena, 0, sizeof(context->_arena));
 }
 
 /**
@@ -121,8 +135,16 @@ rfc5444_reader_init(struct rfc5444_reader *context) {
  */
 void
 rfc5444_reader_cleanup(struct rfc5444_reader *context) {
+  struct rfc5444_reader_arena_chunk *chunk, *next;
+
+  for (chunk = context->_arena.first; chunk != NULL; chunk = next) {
+    next = chunk->next;
+    free(chunk);
+  }
+
   memset(&context->packet_consumer, 0, sizeof(context->packet_consumer));
   memset(&context->message_consumer, 0, sizeof(context->message_consumer));
+  memset(&context->_arena, 0, sizeof(context->_arena));
 }
 
 /**
@@ -137,6 +159,7 @@ rfc5444_reader_handle_packet(struct rfc5444_reader *parser, uint8_t *buffer, siz
   struct rfc5444_reader_tlvblock_context context;
   struct avl_tree entries;
   struct rfc5444_reader_tlvblock_consumer *consumer, *last_started;
+  struct _arena_mark mark;
   uint8_t *ptr, *eob;
   bool has_tlv;
   uint8_t first_byte;
@@ -186,6 +209,9 @@ rfc5444_reader_handle_packet(struct rfc5444_reader *parser, uint8_t *buffer, siz
   avl_init(&entries, avl_comp_uint32, true);
   last_started = NULL;
 
+  /* all entries of this packet are allocated after this point */
+  _arena_mark(&parser->_arena, &mark);
+
   /* check for packet tlv */
   has_tlv = (context.pkt_flags & RFC5444_PKT_FLAG_TLV) != 0;
   if (has_tlv) {
@@ -193,8 +219,9 @@ rfc5444_reader_handle_packet(struct rfc5444_reader *parser, uint8_t *buffer, siz
     if (result != RFC5444_OKAY) {
       /*
        * error while parsing TLV block, do not jump to cleanup_parse packet because
-       * we have not allocated any resources at this point
+       * no consumer has been started at this point
        */
+      _arena_rewind(&parser->_arena, &mark);
       return result;
     }
   }
@@ -252,7 +279,9 @@ cleanup_parse_packet:
       }
     }
   }
-  _free_tlvblock(parser, &entries);
+
+  /* release all entries of the packet at once */
+  _arena_rewind(&parser->_arena, &mark);
 
   /* do not tell caller about packet drop */
 #if DISALLOW_CONSUMER_CONTEXT_DROP == false
@@ -290,6 +319,7 @@ rfc5444_reader_add_message_consumer(struct rfc5444_reader *parser,
     struct rfc5444_reader_tlvblock_consumer *consumer,
     struct rfc5444_reader_tlvblock_consumer_entry *entries, size_t entrycount) {
   _add_consumer(consumer, &parser->message_consumer, entries, entrycount);
+  _compile_msg_dispatch(parser);
 }
 
 /**
@@ -313,6 +343,7 @@ void
 rfc5444_reader_remove_message_consumer(struct rfc5444_reader *parser,
     struct rfc5444_reader_tlvblock_consumer *consumer) {
   _free_consumer(&parser->message_consumer, consumer);
+  _compile_msg_dispatch(parser);
 }
 
 /**
@@ -360,28 +391,35 @@ _calc_tlvblock_intorder(struct rfc5444_reader_tlvblock_entry *entry) {
 }
 
 /**
- * Checks if two internal types have the same tlv type
- * @param int_type1 first internal type
- * @param int_type2 second internal type
- * @param match_ext true if extension type is relevant
- * @return <0 if type1<type2, ==0 if type1==type2, >0 if type1>type2
+ * Look up the consumer entry for a TLV in the dispatch table of a consumer
+ * @param consumer pointer to tlvblock consumer
+ * @param tlv pointer to tlvblock entry
+ * @return first consumer entry (in sorted order) matching the TLV,
+ *   NULL if no entry matches
  */
-static int
-_compare_tlvtypes(struct rfc5444_reader_tlvblock_entry *tlv, struct rfc5444_reader_tlvblock_consumer_entry *entry) {
-  if (entry == NULL) {
-    if (tlv == NULL) {
-      return 0;
-    }
-    return -1;
-  }
-  if (tlv == NULL) {
-    return 1;
+static struct rfc5444_reader_tlvblock_consumer_entry *
+_get_consumer_entry(struct rfc5444_reader_tlvblock_consumer *consumer,
+    struct rfc5444_reader_tlvblock_entry *tlv) {
+  struct rfc5444_reader_tlvblock_consumer_entry *cons_entry;
+  uint8_t first;
+
+  first = consumer->_type_table[tlv->type];
+  if (first == 0) {
+    return NULL;
   }
 
-  if (entry->match_type_ext) {
-    return (int)tlv->_order - _calc_tlvconsumer_intorder(entry);
+  /* entries with the same type are neighbors in the sorted list */
+  cons_entry = &consumer->_entries[first - 1];
+  while (cons_entry->match_type_ext && cons_entry->type_ext != tlv->type_ext) {
+    if (list_is_last(&consumer->_consumer_list, &cons_entry->_node)) {
+      return NULL;
+    }
+    cons_entry = list_next_element(cons_entry, _node);
+    if (cons_entry->type != tlv->type) {
+      return NULL;
+    }
   }
-  return (int)tlv->type - (int)entry->type;
+  return cons_entry;
 }
 
 /**
@@ -424,19 +462,6 @@ _rfc5444_get_u16(uint8_t **ptr, uint8_t *end, enum rfc5444_result *error) {
       | (uint16_t)_rfc5444_get_u8(ptr, end, error);
 }
 
-/**
- * free a list of linked tlv_block entries
- * @param entries avl_tree of tlv_block entries
- */
-static void
-_free_tlvblock(struct rfc5444_reader *parser, struct avl_tree *entries) {
-  struct rfc5444_reader_tlvblock_entry *tlv, *ptr;
-
-  avl_remove_all_elements(entries, tlv, node, ptr) {
-    parser->free_tlvblock_entry(tlv);
-  }
-}
-
 /**
  * parse a TLV into a rfc5444_reader_tlvblock_entry and advance the data stream pointer
  * @param entry pointer to rfc5444_reader_tlvblock_entry
@@ -582,7 +607,8 @@ _parse_tlvblock(struct rfc5444_reader *parser,
     }
 
     /* get memory to store TLV block entry */
-    tlv1 = parser->malloc_tlvblock_entry();
+    tlv1 = _arena_alloc(&parser->_arena, sizeof(*tlv1),
+        RFC5444_ARENA_ALIGNOF(struct rfc5444_reader_tlvblock_entry));
     if (tlv1 == NULL) {
       /* not enough memory left ! */
       result = RFC5444_OUT_OF_MEMORY;
@@ -598,7 +624,7 @@ _parse_tlvblock(struct rfc5444_reader *parser,
   }
 cleanup_parse_tlvblock:
   if (result != RFC5444_OKAY) {
-    _free_tlvblock(parser, tlvblock);
+    /* entries are released when the caller rewinds the arena */
     *ptr = eob;
   }
   return result;
@@ -618,45 +644,22 @@ cleanup_parse_tlvblock:
 static enum rfc5444_result
 _schedule_tlvblock(struct rfc5444_reader_tlvblock_consumer *consumer, struct rfc5444_reader_tlvblock_context *context,
     struct avl_tree *entries, uint8_t idx) {
-  struct rfc5444_reader_tlvblock_entry *tlv = NULL, *nexttlv = NULL;
+  struct rfc5444_reader_tlvblock_entry *tlv, *nexttlv;
   struct rfc5444_reader_tlvblock_consumer_entry *cons_entry;
-  bool constraints_failed;
+  bool constraints_failed, index_match;
   enum rfc5444_result result = RFC5444_OKAY;
+  size_t i;
 
   constraints_failed = false;
 
-  /* initialize tlv pointers, there must be TLVs */
-  if (avl_is_empty(entries)) {
-    tlv = NULL;
-  }
-  else {
-    tlv = avl_first_element(entries, tlv, node);
-  }
-
-  /* initialize consumer pointer */
-  if (list_is_empty(&consumer->_consumer_list)) {
-    cons_entry = NULL;
-  }
-  else {
-    cons_entry = list_first_element(&consumer->_consumer_list, cons_entry, _node);
-    cons_entry->tlv = NULL;
+  for (i = 0; i < consumer->_entry_count; i++) {
+    consumer->_entries[i].tlv = NULL;
   }
 
-  /* we are running in parallel through two sorted lists */
-  while (cons_entry != NULL || tlv != NULL) {
-    bool match = false;
-    bool index_match = false;
-
-    if (tlv) {
-      index_match = RFC5444_CONSUMER_DROP_ONLY(!bitmap256_get(&tlv->int_drop_tlv, idx), true)
-          && idx >= tlv->index1 && idx <= tlv->index2;
-    }
-
-    /* check index for address blocks */
-    if (tlv != NULL && cons_entry != NULL && index_match) {
-      /* calculate match between tlv and consumer */
-      match = _compare_tlvtypes(tlv, cons_entry) == 0;
-    }
+  /* look up the consumer entry of each TLV in the dispatch table */
+  avl_for_each_element(entries, tlv, node) {
+    index_match = RFC5444_CONSUMER_DROP_ONLY(!bitmap256_get(&tlv->int_drop_tlv, idx), true)
+        && idx >= tlv->index1 && idx <= tlv->index2;
 
     if (index_match && tlv->_multivalue_tlv) {
       size_t offset;
@@ -678,7 +681,7 @@ _schedule_tlvblock(struct rfc5444_reader_tlvblock_consumer *consumer, struct rfc
       if (result == RFC5444_DROP_TLV) {
         /* mark dropped tlv */
         bitmap256_set(&tlv->int_drop_tlv, idx);
-        match = false;
+        index_match = false;
         /* do not propagate result */
         result = RFC5444_OKAY;
       }
@@ -689,65 +692,53 @@ _schedule_tlvblock(struct rfc5444_reader_tlvblock_consumer *consumer, struct rfc
 #endif
     }
 
-    /* run through both sorted lists until finding a match */
-    if (_compare_tlvtypes(tlv, cons_entry) >= 0) {
-      constraints_failed |= cons_entry->mandatory && !match;
+    cons_entry = _get_consumer_entry(consumer, tlv);
+    if (cons_entry == NULL) {
+      continue;
+    }
 
-      if (match) {
-        if (cons_entry->match_length &&
-            (tlv->length < cons_entry->min_length
-                || tlv->length > cons_entry->max_length)) {
-          constraints_failed = true;
-        }
+    if (!index_match) {
+      /* mandatory TLV type that does not apply to this index */
+      constraints_failed |= cons_entry->mandatory;
+      continue;
+    }
 
-        /* this is the last TLV that fits the description... for now */
-        tlv->next_entry = NULL;
+    if (cons_entry->match_length &&
+        (tlv->length < cons_entry->min_length
+            || tlv->length > cons_entry->max_length)) {
+      constraints_failed = true;
+    }
 
-        if (cons_entry->tlv == NULL) {
-          /* it is also the first one we find */
-          cons_entry->tlv = tlv;
+    /* this is the last TLV that fits the description... for now */
+    tlv->next_entry = NULL;
 
-          if (cons_entry->copy_value != NULL && tlv->length > 0) {
-            /* copy value into private buffer */
-            uint16_t len = cons_entry->max_length;
+    if (cons_entry->tlv == NULL) {
+      /* it is also the first one we find */
+      cons_entry->tlv = tlv;
 
-            if (tlv->length < len) {
-              len = tlv->length;
-            }
-            memcpy(cons_entry->copy_value, tlv->single_value, len);
-          }
-        }
-        else {
-          /* its one of many, put it at the end of the list */
-          nexttlv = cons_entry->tlv;
-          while (nexttlv->next_entry) {
-            nexttlv = nexttlv->next_entry;
-          }
-          nexttlv->next_entry = tlv;
+      if (cons_entry->copy_value != NULL && tlv->length > 0) {
+        /* copy value into private buffer */
+        uint16_t len = cons_entry->max_length;
+
+        if (tlv->length < len) {
+          len = tlv->length;
         }
+        memcpy(cons_entry->copy_value, tlv->single_value, len);
       }
     }
-    if (tlv != NULL && _compare_tlvtypes(tlv, cons_entry) <= 0) {
-      /* advance tlv pointer */
-      if (avl_is_last(entries, &tlv->node)) {
-        tlv = NULL;
-      }
-      else {
-        tlv = avl_next_element(tlv, node);
+    else {
+      /* its one of many, put it at the end of the list */
+      nexttlv = cons_entry->tlv;
+      while (nexttlv->next_entry) {
+        nexttlv = nexttlv->next_entry;
       }
+      nexttlv->next_entry = tlv;
     }
-    if (_compare_tlvtypes(tlv, cons_entry) > 0) {
-      constraints_failed |= cons_entry->mandatory && !match;
+  }
 
-      /* advance consumer pointer */
-      if (list_is_last(&consumer->_consumer_list, &cons_entry->_node)) {
-        cons_entry = NULL;
-      }
-      else {
-        cons_entry = list_next_element(cons_entry, _node);
-        cons_entry->tlv = NULL;
-      }
-    }
+  /* check for missing mandatory TLVs */
+  for (i = 0; i < consumer->_entry_count; i++) {
+    constraints_failed |= consumer->_entries[i].mandatory && consumer->_entries[i].tlv == NULL;
   }
 
   /* call consumer for tlvblock */
@@ -1066,8 +1057,10 @@ _handle_message(struct rfc5444_reader *parser,
     struct rfc5444_reader_tlvblock_context *tlv_context, uint8_t **ptr, uint8_t *eob) {
   struct avl_tree tlv_entries;
   struct rfc5444_reader_tlvblock_consumer *consumer, *same_order[2];
+  struct rfc5444_reader_tlvblock_consumer *specific, *dflt;
   struct list_entity addr_head;
-  struct rfc5444_reader_addrblock_entry *addr, *safe;
+  struct rfc5444_reader_addrblock_entry *addr;
+  struct _arena_mark mark;
   uint8_t *start, *end = NULL;
   uint8_t flags;
   uint16_t size;
@@ -1081,6 +1074,9 @@ _handle_message(struct rfc5444_reader *parser,
   list_init_head(&addr_head);
   tlv_context->_do_not_forward = false;
 
+  /* all entries of this message are allocated after this point */
+  _arena_mark(&parser->_arena, &mark);
+
   /* remember start of message */
   start = *ptr;
 
@@ -1142,25 +1138,25 @@ _handle_message(struct rfc5444_reader *parser,
   /* parse rest of message */
   while (*ptr < end) {
     /* get memory for storing the address block entry */
-    addr = parser->malloc_addrblock_entry();
+    addr = _arena_alloc(&parser->_arena, sizeof(*addr),
+        RFC5444_ARENA_ALIGNOF(struct rfc5444_reader_addrblock_entry));
     if (addr == NULL) {
       result = RFC5444_OUT_OF_MEMORY;
       goto cleanup_parse_message;
     }
+    memset(addr, 0, sizeof(*addr));
 
     /* initialize avl_tree */
     avl_init(&addr->tlvblock, avl_comp_uint16, true);
 
     /* parse address block... */
     if ((result = _parse_addrblock(addr, tlv_context, ptr, end)) != RFC5444_OKAY) {
-      parser->free_addrblock_entry(addr);
       goto cleanup_parse_message;
     }
 
     /* ... and corresponding tlvblock */
     result = _parse_tlvblock(parser, &addr->tlvblock, ptr, end, addr->num_addr);
     if (result != RFC5444_OKAY) {
-      parser->free_addrblock_entry(addr);
       goto cleanup_parse_message;
     }
 
@@ -1174,13 +1170,10 @@ _handle_message(struct rfc5444_reader *parser,
   tlv_context->msg_buffer = start;
   tlv_context->msg_size = size;
 
-  /* loop through list of message/address consumers */
-  avl_for_each_element(&parser->message_consumer, consumer, _node) {
-    if (!consumer->default_msg_consumer && consumer->msg_id != tlv_context->msg_type) {
-      /* wrong type of message, continue... */
-      continue;
-    }
-
+  /* loop through message/address consumers for this message type */
+  specific = parser->_msg_dispatch[tlv_context->msg_type];
+  dflt = parser->_default_dispatch;
+  while ((consumer = _next_msg_consumer(&specific, &dflt)) != NULL) {
     /* remember range of consumers with same order to call end_message() callbacks */
     if (same_order[0] != NULL && consumer->order > same_order[1]->order) {
 #if DISALLOW_CONSUMER_CONTEXT_DROP == false
@@ -1253,14 +1246,8 @@ cleanup_parse_message:
     }
   }
 
-  /* free address tlvblocks */
-  list_for_each_element_safe(&addr_head, addr, list_node, safe) {
-    _free_tlvblock(parser, &addr->tlvblock);
-    parser->free_addrblock_entry(addr);
-  }
-
-  /* free message tlvblock */
-  _free_tlvblock(parser, &tlv_entries);
+  /* free message tlvblock, address blocks and their tlvblocks */
+  _arena_rewind(&parser->_arena, &mark);
   *ptr = end;
 #if DISALLOW_CONSUMER_CONTEXT_DROP == false
   if (result > RFC5444_OKAY && result != RFC5444_DROP_PACKET) {
@@ -1317,6 +1304,15 @@ _add_consumer(struct rfc5444_reader_tlvblock_consumer *consumer, struct avl_tree
     }
   }
 
+  /* compile dispatch table for TLV types, first entry in sorted order wins */
+  assert(entrycount < 256);
+  consumer->_entries = entries;
+  consumer->_entry_count = entrycount;
+  memset(consumer->_type_table, 0, sizeof(consumer->_type_table));
+  list_for_each_element_reverse(&consumer->_consumer_list, e, _node) {
+    consumer->_type_table[e->type] = (e - entries) + 1;
+  }
+
   /* insert into global list of consumers */
   consumer->_node.key = consumer;
   avl_insert(consumer_tree, &consumer->_node);
@@ -1339,39 +1335,127 @@ _free_consumer(struct avl_tree *consumer_tree,
 }
 
 /**
- * Internal memory allocation function for addrblock
- * @return pointer to cleared addrblock
+ * Rebuild the lists of message/address consumers for each message type.
+ * Consumers for all message types are kept in a separate list, both
+ * lists are merged while parsing a message.
+ * @param parser pointer to parser context
+ */
+static void
+_compile_msg_dispatch(struct rfc5444_reader *parser) {
+  struct rfc5444_reader_tlvblock_consumer *consumer, **head;
+  uint32_t position;
+
+  memset(parser->_msg_dispatch, 0, sizeof(parser->_msg_dispatch));
+  parser->_default_dispatch = NULL;
+
+  position = parser->message_consumer.count;
+  avl_for_each_element_reverse(&parser->message_consumer, consumer, _node) {
+    if (consumer->default_msg_consumer) {
+      head = &parser->_default_dispatch;
+    }
+    else {
+      head = &parser->_msg_dispatch[consumer->msg_id];
+    }
+
+    consumer->_dispatch_position = --position;
+    consumer->_next_dispatch = *head;
+    *head = consumer;
+  }
+}
+
+/**
+ * Get the next message/address consumer of a message, keeping the
+ * order of the message consumer tree.
+ * @param specific pointer to list of consumers for the message type,
+ *   will be advanced if the result is taken from this list
+ * @param dflt pointer to list of consumers for all message types,
+ *   will be advanced if the result is taken from this list
+ * @return next consumer, NULL if no consumer is left
  */
-static struct rfc5444_reader_addrblock_entry *
-_malloc_addrblock_entry(void) {
-  return calloc(1, sizeof(struct rfc5444_reader_addrblock_entry));
+static struct rfc5444_reader_tlvblock_consumer *
+_next_msg_consumer(struct rfc5444_reader_tlvblock_consumer **specific,
+    struct rfc5444_reader_tlvblock_consumer **dflt) {
+  struct rfc5444_reader_tlvblock_consumer **head, *consumer;
+
+  if (*dflt == NULL
+      || (*specific != NULL && (*specific)->_dispatch_position < (*dflt)->_dispatch_position)) {
+    head = specific;
+  }
+  else {
+    head = dflt;
+  }
+
+  consumer = *head;
+  if (consumer != NULL) {
+    *head = consumer->_next_dispatch;
+  }
+  return consumer;
 }
 
 /**
- * Internal memory allocation function for rfc5444_reader_tlvblock_entry
- * @return pointer to cleared rfc5444_reader_tlvblock_entry
+ * Allocate memory from the reader arena. The memory is NOT cleared.
+ * @param arena pointer to reader arena
+ * @param size number of bytes
+ * @param align alignment of the allocated memory
+ * @return pointer to allocated memory, NULL if out of memory
  */
-static struct rfc5444_reader_tlvblock_entry *
-_malloc_tlvblock_entry(void) {
-  return calloc(1, sizeof(struct rfc5444_reader_tlvblock_entry));
+static void *
+_arena_alloc(struct rfc5444_reader_arena *arena, size_t size, size_t align) {
+  struct rfc5444_reader_arena_chunk *chunk, *next;
+  size_t offset;
+
+  chunk = arena->current;
+  offset = (arena->used + align - 1) & ~(align - 1);
+
+  if (chunk == NULL || offset + size > READER_ARENA_CHUNK_SIZE) {
+    /* continue with the next chunk, allocate it if necessary */
+    next = chunk != NULL ? chunk->next : arena->first;
+    if (next == NULL) {
+      next = malloc(READER_ARENA_CHUNK_SIZE);
+      if (next == NULL) {
+        return NULL;
+      }
+      next->next = NULL;
+
+      if (chunk != NULL) {
+        chunk->next = next;
+      }
+      else {
+        arena->first = next;
+      }
+    }
+
+    chunk = next;
+    offset = (sizeof(*chunk) + align - 1) & ~(align - 1);
+    assert(offset + size <= READER_ARENA_CHUNK_SIZE);
+  }
+
+  arena->current = chunk;
+  arena->used = offset + size;
+  return ((uint8_t *)chunk) + offset;
 }
 
 /**
- * Free an addressblock entry
- * @param entry addressblock entry
+ * Remember the current position of the reader arena
+ * @param arena pointer to reader arena
+ * @param mark pointer to arena mark
  */
 static void
-_free_addrblock_entry(struct rfc5444_reader_addrblock_entry *entry) {
-  free(entry);
+_arena_mark(struct rfc5444_reader_arena *arena, struct _arena_mark *mark) {
+  mark->chunk = arena->current;
+  mark->used = arena->used;
 }
 
 /**
- * Free an tlvblock entry
- * @param entry tlvblock entry
+ * Release all memory allocated from the reader arena since a mark
+ * has been set. The chunks of the arena are kept for reuse.
+ * @param arena pointer to reader arena
+ * @param mark pointer to arena mark
  */
 static void
-_free_tlvblock_entry(struct rfc5444_reader_tlvblock_entry *entry) {
-  free(entry);
+_arena_rewind(struct rfc5444_reader_arena *arena, struct _arena_mark *mark) {
+  arena->current = mark->chunk;
+  arena->used = mark->used;
 }
 
 /**
@@ -326,6 +326,24 @@ struct rfc5444_reader_tlvblock_consumer {
   /*! List of sorted consumer entries */
   struct list_entity _consumer_list;
 
+  /*! array of consumer entries */
+  struct rfc5444_reader_tlvblock_consumer_entry *_entries;
+
+  /*! number of consumer entries */
+  size_t _entry_count;
+
+  /**
+   * first consumer entry (index + 1 in _entries) in sorted order
+   * for each TLV type, 0 if the consumer has no entry for this type
+   */
+  uint8_t _type_table[256];
+
+  /*! next message consumer for the same message type */
+  struct rfc5444_reader_tlvblock_consumer *_next_dispatch;
+
+  /*! position of the message consumer in the sorted tree */
+  uint32_t _dispatch_position;
+
   /* consumer for TLVblock context start and end*/
   /**
    * Callback triggered at the start of this context
@@ -369,6 +387,31 @@ struct rfc5444_reader_tlvblock_consumer {
       struct rfc5444_reader_tlvblock_context *context);
 };
 
+/**
+ * Header of a memory chunk of the reader arena, the entries
+ * are stored in the rest of the chunk.
+ */
+struct rfc5444_reader_arena_chunk {
+  /*! next chunk of the arena, NULL if this is the last one */
+  struct rfc5444_reader_arena_chunk *next;
+};
+
+/**
+ * Bump pointer allocator for the tlvblock and addressblock entries
+ * of a packet. The arena is rewound after each message and packet,
+ * its chunks are kept until the reader is cleaned up.
+ */
+struct rfc5444_reader_arena {
+  /*! first chunk of the arena */
+  struct rfc5444_reader_arena_chunk *first;
+
+  /*! chunk used for the next allocation, NULL if the arena is empty */
+  struct rfc5444_reader_arena_chunk *current;
+
+  /*! number of bytes used in the current chunk */
+  size_t used;
+};
+
 /**
  * representation of the internal state of a rfc5444 parser
  */
@@ -379,6 +422,12 @@ struct rfc5444_reader {
   /*! sorted tree of message/addr consumers */
   struct avl_tree message_consumer;
 
+  /*! message/addr consumers for each message type, sorted like message_consumer */
+  struct rfc5444_reader_tlvblock_consumer *_msg_dispatch[256];
+
+  /*! message/addr consumers for all message types, sorted like message_consumer */
+  struct rfc5444_reader_tlvblock_consumer *_default_dispatch;
+
   /**
    * Callback triggered when a message should be forwarded
    * @param context message context
@@ -388,29 +437,8 @@ struct rfc5444_reader {
   void (*forward_message)(struct rfc5444_reader_tlvblock_context *context,
       uint8_t *buffer, size_t length);
 
-  /**
-   * Callback to allocate a tlvblock entry
-   * @return tlvblock entry, NULL if out of memory
-   */
-  struct rfc5444_reader_tlvblock_entry* (*malloc_tlvblock_entry)(void);
-
-  /**
-   * Callback to allocate an addressblock entry
-   * @return addressblock entry, NULL if out of memory
-   */
-  struct rfc5444_reader_addrblock_entry* (*malloc_addrblock_entry)(void);
-
-  /**
-   * Free a tlvblock entry
-   * @param entry tlvblock entry to free
-   */
-  void (*free_tlvblock_entry)(struct rfc5444_reader_tlvblock_entry *entry);
-
-  /**
-   * Free an addressblock entry
-   * @param entry addressblock entry to free
-   */
-  void (*free_addrblock_entry)(struct rfc5444_reader_addrblock_entry *entry);
+  /*! arena for the tlvblock and addressblock entries of the current packet */
+  struct rfc5444_reader_arena _arena;
 };
 
 EXPORT void rfc5444_reader_init(struct rfc5444_reader *);
@@ -0,0 +1,242 @@
+
+/*
+ * The olsr.org Optimized Link-State Routing daemon version 2 (olsrd2)
+ * Copyright (c) 2004-2015, the olsr.org team - see HISTORY file
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in
+ *   the documentation and/or other materials provided with the
+ *   distribution.
+ * * Neither the name of olsr.org, olsrd nor the names of its
+ *   contributors may be used to endorse or promote products derived
+ *   from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Visit http://www.olsr.org for more information.
+ *
+ * If you find this software useful feel free to make a donation
+ * to the project. For more information see the website or contact
+ * the copyright holders.
+ *
+ */
+
+/**
+ * @file
+ *
+ * Measures how late the socket event handler wakes up after its
+ * deadline, compared with an epoll loop using the millisecond
+ * timeout the event handler used before the timerfd deadline mode.
+ * The event handler uses the timerfd deadline if the tree was
+ * configured with OONF_TIMERFD_DEADLINE.
+ *
+ * usage: benchmark_deadline [<rounds> [<max delay in ms>]]
+ */
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <unistd.h>
+
+#include "common/common_types.h"
+#include "core/oonf_subsystem.h"
+#include "subsystems/oonf_clock.h"
+#include "subsystems/os_clock.h"
+#include "subsystems/os_fd.h"
+
+/**
+ * Initialize a subsystem linked into the benchmark
+ * @param name name of subsystem
+ * @return -1 if an error happened, 0 otherwise
+ */
+static int
+_init_subsystem(const char *name) {
+  struct oonf_subsystem *subsystem;
+
+  subsystem = oonf_subsystem_get(name);
+  if (subsystem == NULL) {
+    fprintf(stderr, "Subsystem %s not linked\n", name);
+    return -1;
+  }
+  if (subsystem->init != NULL && subsystem->init()) {
+    fprintf(stderr, "Could not initialize subsystem %s\n", name);
+    return -1;
+  }
+  return 0;
+}
+
+/**
+ * Comparator for sorting latencies
+ * @param p1 pointer to first latency
+ * @param p2 pointer to second latency
+ * @return -1, 0 or 1
+ */
+static int
+_cmp_latency(const void *p1, const void *p2) {
+  const int64_t *l1 = p1, *l2 = p2;
+
+  if (*l1 < *l2) {
+    return -1;
+  }
+  return *l1 > *l2 ? 1 : 0;
+}
+
+/**
+ * Update the clock like the scheduler does before each wait
+ */
+static void
+_update_clock(void) {
+  if (oonf_clock_update()) {
+    fprintf(stderr, "Clock update failed\n");
+    exit(1);
+  }
+}
+
+/**
+ * Print statistics of the measured wakeup latencies
+ * @param name name of the method
+ * @param latency array of latencies in nanoseconds
+ * @param rounds number of latencies
+ * @param waits total number of wait calls
+ */
+static void
+_print_result(const char *name, int64_t *latency, int rounds, uint64_t waits) {
+  int64_t sum;
+  int i;
+
+  sum = 0;
+  for (i=0; i<rounds; i++) {
+    sum += latency[i];
+  }
+  qsort(latency, rounds, sizeof(*latency), _cmp_latency);
+
+  printf("  %-22s avg %7.1f us, p50 %7.1f us, p99 %7.1f us, max %7.1f us, %.2f waits/deadline\n",
+      name, (double)sum / rounds / 1000.0,
+      latency[rounds / 2] / 1000.0, latency[rounds * 99 / 100] / 1000.0,
+      latency[rounds - 1] / 1000.0, (double)waits / rounds);
+}
+
+/**
+ * Wait for deadlines with the socket event handler
+ * @param latency array to store the latencies in nanoseconds
+ * @param rounds number of deadlines
+ * @param max_delay maximum delay of a deadline in milliseconds
+ */
+static void
+_bench_os_fd(int64_t *latency, int rounds, int max_delay) {
+  struct os_fd_select sel;
+  uint64_t deadline, waits;
+  int r;
+
+  if (os_fd_event_add(&sel)) {
+    fprintf(stderr, "Could not create socket event handler\n");
+    exit(1);
+  }
+
+  waits = 0;
+  for (r=0; r<rounds; r++) {
+    _update_clock();
+    deadline = oonf_clock_get_absolute(1 + rand() % max_delay);
+
+    while (oonf_clock_getNow() < deadline) {
+      os_fd_event_set_deadline(&sel, deadline);
+      os_fd_event_wait(&sel);
+      waits++;
+      _update_clock();
+    }
+    latency[r] = -oonf_clock_get_relative_ns(deadline);
+  }
+
+#ifdef OONF_TIMERFD_DEADLINE
+  _print_result("os_fd (timerfd):", latency, rounds, waits);
+#else
+  _print_result("os_fd (epoll timeout):", latency, rounds, waits);
+#endif
+  os_fd_event_remove(&sel);
+}
+
+/**
+ * Wait for deadlines with a millisecond epoll timeout
+ * @param latency array to store the latencies in nanoseconds
+ * @param rounds number of deadlines
+ * @param max_delay maximum delay of a deadline in milliseconds
+ */
+static void
+_bench_epoll_ms(int64_t *latency, int rounds, int max_delay) {
+  struct epoll_event event;
+  uint64_t deadline, waits;
+  int r, epoll_fd;
+
+  epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+
+  waits = 0;
+  for (r=0; r<rounds; r++) {
+    _update_clock();
+    deadline = oonf_clock_get_absolute(1 + rand() % max_delay);
+
+    while (oonf_clock_getNow() < deadline) {
+      epoll_wait(epoll_fd, &event, 1, oonf_clock_get_relative(deadline));
+      waits++;
+      _update_clock();
+    }
+    latency[r] = -oonf_clock_get_relative_ns(deadline);
+  }
+
+  _print_result("epoll ms timeout:", latency, rounds, waits);
+  close(epoll_fd);
+}
+
+int
+main(int argc, char **argv) {
+  int64_t *latency;
+  int rounds, max_delay;
+
+  rounds = argc > 1 ? atoi(argv[1]) : 500;
+  max_delay = argc > 2 ? atoi(argv[2]) : 20;
+
+  if (rounds < 1 || max_delay < 1) {
+    fprintf(stderr, "Rounds and maximum delay must be positive\n");
+    return 1;
+  }
+
+  if (_init_subsystem(OONF_OS_CLOCK_SUBSYSTEM)
+      || _init_subsystem(OONF_CLOCK_SUBSYSTEM)
+      || _init_subsystem(OONF_OS_FD_SUBSYSTEM)) {
+    return 1;
+  }
+
+  latency = calloc(rounds, sizeof(*latency));
+  if (latency == NULL) {
+    fprintf(stderr, "Not enough memory for %d rounds\n", rounds);
+    return 1;
+  }
+
+  srand(1);
+  printf("%d deadlines, 1-%d ms in the future, latency after deadline\n",
+      rounds, max_delay);
+  _bench_epoll_ms(latency, rounds, max_delay);
+  _bench_os_fd(latency, rounds, max_delay);
+
+  free(latency);
+  return 0;
+}
@@ -0,0 +1,348 @@
+
+/*
+ * The olsr.org Optimized Link-State Routing daemon version 2 (olsrd2)
+ * Copyright (c) 2004-2015, the olsr.org team - see HISTORY file
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in
+ *   the documentation and/or other materials provided with the
+ *   distribution.
+ * * Neither the name of olsr.org, olsrd nor the names of its
+ *   contributors may be used to endorse or promote products derived
+ *   from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Visit http://www.olsr.org for more information.
+ *
+ * If you find this software useful feel free to make a donation
+ * to the project. For more information see the website or contact
+ * the copyright holders.
+ *
+ */
+
+
+/**
+ * @file
+ *
+ * Compares the working queue of the shortest path tree (pairing heap
+ * with decrease-key) with the AVL tree queue the routing code used
+ * before, on random mesh-like graphs.
+ *
+ * usage: benchmark_dijkstra [<number of nodes> [<edges per node> [<runs>]]]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "common/avl.h"
+#include "common/avl_comp.h"
+#include "common/common_types.h"
+#include "common/dijkstra.h"
+#include "common/heap.h"
+#include "common/prng.h"
+
+struct bench_node {
+  /*! node for pairing heap based dijkstra */
+  struct dijkstra_node spf;
+
+  /*! node for avl based dijkstra */
+  struct avl_node avl;
+
+  /*! node for heap based dijkstra */
+  struct heap_node heap;
+
+  /*! path cost of avl/heap based dijkstra */
+  uint32_t cost;
+
+  /*! true if avl/heap based dijkstra has processed the node */
+  bool done;
+};
+
+struct bench_edge {
+  uint32_t dst;
+  uint32_t cost;
+};
+
+/* graph in compressed sparse row format, node 0 is the root */
+static struct bench_node *_nodes;
+static struct bench_edge *_edges;
+static uint32_t *_first_edge;
+static uint32_t _node_count;
+
+static struct dijkstra_tree _tree;
+
+/**
+ * @return monotonic timestamp in nanoseconds
+ */
+static uint64_t
+_get_ns(void) {
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+/**
+ * @param dnode node of shortest path tree
+ * @return index of node in graph
+ */
+static uint32_t
+_get_index(struct dijkstra_node *dnode) {
+  if (dnode == &_tree.root) {
+    return 0;
+  }
+  return container_of(dnode, struct bench_node, spf) - _nodes;
+}
+
+/**
+ * @param index index of node in graph
+ * @return node of shortest path tree
+ */
+static struct dijkstra_node *
+_get_spf_node(uint32_t index) {
+  return index == 0 ? &_tree.root : &_nodes[index].spf;
+}
+
+static void
+_cb_expand(struct dijkstra_tree *tree, struct dijkstra_node *dnode) {
+  uint32_t i, idx;
+
+  idx = _get_index(dnode);
+  for (i = _first_edge[idx]; i < _first_edge[idx+1]; i++) {
+    dijkstra_relax(tree, dnode, _get_spf_node(_edges[i].dst), _edges[i].cost);
+  }
+}
+
+/**
+ * Create a random graph. Each node is connected to nodes with
+ * a nearby index to get a mesh with long paths, some edges
+ * go to random nodes.
+ * @param prng random number generator
+ * @param edges_per_node number of outgoing edges of each node
+ * @return -1 if out of memory, 0 otherwise
+ */
+static int
+_create_graph(struct prng_state *prng, uint32_t edges_per_node) {
+  uint32_t i, j, e, dst;
+
+  _nodes = calloc(_node_count, sizeof(*_nodes));
+  _edges = calloc((size_t)_node_count * edges_per_node, sizeof(*_edges));
+  _first_edge = calloc(_node_count + 1, sizeof(*_first_edge));
+  if (_nodes == NULL || _edges == NULL || _first_edge == NULL) {
+    return -1;
+  }
+
+  e = 0;
+  for (i = 0; i < _node_count; i++) {
+    _first_edge[i] = e;
+    for (j = 0; j < edges_per_node; j++) {
+      if (j == 0) {
+        /* keep the graph connected */
+        dst = (i + 1) % _node_count;
+      }
+      else if (j < edges_per_node - 1) {
+        dst = (i + _node_count - 16 + prng_next32(prng) % 32) % _node_count;
+      }
+      else {
+        dst = prng_next32(prng) % _node_count;
+      }
+      if (dst == i || dst == 0) {
+        continue;
+      }
+
+      _edges[e].dst = dst;
+      _edges[e].cost = 256 + prng_next32(prng) % 4096;
+      e++;
+    }
+  }
+  _first_edge[_node_count] = e;
+  return 0;
+}
+
+/**
+ * Calculate shortest paths with an AVL tree as working queue,
+ * removing and inserting a node for each better path.
+ * @param queue avl tree
+ * @return number of reached nodes
+ */
+static uint32_t
+_run_avl_dijkstra(struct avl_tree *queue) {
+  struct bench_node *node, *dst;
+  uint32_t i, idx, cost, reached;
+
+  for (i = 0; i < _node_count; i++) {
+    _nodes[i].cost = UINT32_MAX;
+    _nodes[i].done = false;
+    _nodes[i].avl.key = &_nodes[i].cost;
+  }
+
+  _nodes[0].cost = 0;
+  avl_insert(queue, &_nodes[0].avl);
+
+  reached = 0;
+  while (!avl_is_empty(queue)) {
+    node = avl_first_element(queue, node, avl);
+    avl_remove(queue, &node->avl);
+    node->done = true;
+    reached++;
+
+    idx = node - _nodes;
+    for (i = _first_edge[idx]; i < _first_edge[idx+1]; i++) {
+      dst = &_nodes[_edges[i].dst];
+      cost = node->cost + _edges[i].cost;
+
+      if (dst->done || dst->cost <= cost) {
+        continue;
+      }
+      if (avl_is_node_added(&dst->avl)) {
+        avl_remove(queue, &dst->avl);
+      }
+      dst->cost = cost;
+      avl_insert(queue, &dst->avl);
+    }
+  }
+  return reached;
+}
+
+/**
+ * Calculate shortest paths with a pairing heap as working queue,
+ * decreasing the key of a node for each better path.
+ * @param queue heap
+ * @return number of reached nodes
+ */
+static uint32_t
+_run_heap_dijkstra(struct heap *queue) {
+  struct bench_node *node, *dst;
+  uint32_t i, idx, cost, reached;
+
+  for (i = 0; i < _node_count; i++) {
+    _nodes[i].cost = UINT32_MAX;
+    _nodes[i].done = false;
+  }
+
+  _nodes[0].cost = 0;
+  heap_insert(queue, &_nodes[0].heap, 0);
+
+  reached = 0;
+  while (!heap_is_empty(queue)) {
+    node = container_of(heap_extract_min(queue), struct bench_node, heap);
+    node->done = true;
+    reached++;
+
+    idx = node - _nodes;
+    for (i = _first_edge[idx]; i < _first_edge[idx+1]; i++) {
+      dst = &_nodes[_edges[i].dst];
+      cost = node->cost + _edges[i].cost;
+
+      if (dst->done || dst->cost <= cost) {
+        continue;
+      }
+      if (dst->cost == UINT32_MAX) {
+        heap_insert(queue, &dst->heap, cost);
+      }
+      else {
+        heap_decrease_key(queue, &dst->heap, cost);
+      }
+      dst->cost = cost;
+    }
+  }
+  return reached;
+}
+
+int
+main(int argc, char **argv) {
+  struct prng_state prng;
+  struct avl_tree avl_queue;
+  struct heap heap_queue;
+  uint64_t start, avl_ns, heap_ns, spf_ns;
+  uint32_t edges_per_node, runs, r, i, avl_reached, heap_reached;
+
+  _node_count = argc > 1 ? (uint32_t)atoi(argv[1]) : 10000;
+  edges_per_node = argc > 2 ? (uint32_t)atoi(argv[2]) : 6;
+  runs = argc > 3 ? (uint32_t)atoi(argv[3]) : 20;
+
+  if (_node_count < 2 || edges_per_node < 2 || runs == 0) {
+    fprintf(stderr, "usage: %s [<number of nodes> [<edges per node> [<runs>]]]\n", argv[0]);
+    return 1;
+  }
+
+  prng_seed(&prng, _node_count);
+  if (_create_graph(&prng, edges_per_node)) {
+    fprintf(stderr, "Not enough memory for %u nodes\n", _node_count);
+    return 1;
+  }
+
+  avl_init(&avl_queue, avl_comp_uint32, true);
+  heap_init(&heap_queue);
+
+  dijkstra_init(&_tree);
+  _tree.expand = _cb_expand;
+
+  avl_reached = 0;
+  start = _get_ns();
+  for (r = 0; r < runs; r++) {
+    avl_reached = _run_avl_dijkstra(&avl_queue);
+  }
+  avl_ns = _get_ns() - start;
+
+  heap_reached = 0;
+  start = _get_ns();
+  for (r = 0; r < runs; r++) {
+    heap_reached = _run_heap_dijkstra(&heap_queue);
+  }
+  heap_ns = _get_ns() - start;
+
+  start = _get_ns();
+  for (r = 0; r < runs; r++) {
+    /* no change reporting, every run starts from scratch */
+    dijkstra_invalidate(&_tree);
+    dijkstra_calculate(&_tree);
+  }
+  spf_ns = _get_ns() - start;
+
+  /* all calculations must produce the same path costs */
+  for (i = 1; i < _node_count; i++) {
+    if (_nodes[i].cost != (dijkstra_is_reached(&_nodes[i].spf) ? _nodes[i].spf.cost : UINT32_MAX)) {
+      fprintf(stderr, "Path cost of node %u differs: %u != %u\n",
+          i, _nodes[i].cost, _nodes[i].spf.cost);
+      return 1;
+    }
+  }
+  if (avl_reached != heap_reached) {
+    fprintf(stderr, "Number of reached nodes differs: %u != %u\n",
+        avl_reached, heap_reached);
+    return 1;
+  }
+
+  printf("dijkstra: %u nodes, %u edges, %u runs, %u nodes reached\n",
+      _node_count, _first_edge[_node_count], runs, heap_reached);
+  printf("  avl queue:          %8.3f ms/run\n", (double)avl_ns / runs / 1000000.0);
+  printf("  pairing heap:       %8.3f ms/run (speedup %.2f)\n",
+      (double)heap_ns / runs / 1000000.0, heap_ns ? (double)avl_ns / heap_ns : 0.0);
+  printf("  dijkstra_calculate: %8.3f ms/run\n", (double)spf_ns / runs / 1000000.0);
+
+  free(_nodes);
+  free(_edges);
+  free(_first_edge);
+  return 0;
+}
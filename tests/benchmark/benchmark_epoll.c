@@ -0,0 +1,281 @@
+
+/*
+ * The olsr.org Optimized Link-State Routing daemon version 2 (olsrd2)
+ * Copyright (c) 2004-2015, the olsr.org team - see HISTORY file
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in
+ *   the documentation and/or other materials provided with the
+ *   distribution.
+ * * Neither the name of olsr.org, olsrd nor the names of its
+ *   contributors may be used to endorse or promote products derived
+ *   from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Visit http://www.olsr.org for more information.
+ *
+ * If you find this software useful feel free to make a donation
+ * to the project. For more information see the website or contact
+ * the copyright holders.
+ *
+ */
+
+/**
+ * @file
+ *
+ * Measures how long it takes to collect and handle the events of
+ * a large number of readable sockets with the socket event handler,
+ * both with level and edge triggered events, and compares it with
+ * an epoll loop using a fixed array of 16 events.
+ *
+ * usage: benchmark_epoll [<number of sockets> [<rounds>]]
+ */
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "common/common_types.h"
+#include "core/oonf_subsystem.h"
+#include "subsystems/oonf_clock.h"
+#include "subsystems/os_clock.h"
+#include "subsystems/os_fd.h"
+
+/*! size of the event array of the old socket event handler */
+#define FIXED_EVENT_COUNT 16
+
+/**
+ * pair of connected datagram sockets
+ */
+struct _socket_pair {
+  /*! socket that is monitored for events */
+  struct os_fd rx;
+
+  /*! socket to trigger events */
+  int tx;
+};
+
+static struct _socket_pair *_pairs;
+static size_t _pair_count;
+
+/**
+ * @return monotonic timestamp in nanoseconds
+ */
+static uint64_t
+_get_ns(void) {
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+/**
+ * Initialize a subsystem linked into the benchmark
+ * @param name name of subsystem
+ * @return -1 if an error happened, 0 otherwise
+ */
+static int
+_init_subsystem(const char *name) {
+  struct oonf_subsystem *subsystem;
+
+  subsystem = oonf_subsystem_get(name);
+  if (subsystem == NULL) {
+    fprintf(stderr, "Subsystem %s not linked\n", name);
+    return -1;
+  }
+  if (subsystem->init != NULL && subsystem->init()) {
+    fprintf(stderr, "Could not initialize subsystem %s\n", name);
+    return -1;
+  }
+  return 0;
+}
+
+/**
+ * Send a datagram into every socket pair
+ */
+static void
+_trigger_all(void) {
+  size_t i;
+  char c = 0;
+
+  for (i=0; i<_pair_count; i++) {
+    if (send(_pairs[i].tx, &c, 1, 0) != 1) {
+      fprintf(stderr, "Could not trigger socket: %s\n", strerror(errno));
+      exit(1);
+    }
+  }
+}
+
+/**
+ * Read a socket until it would block
+ * @param fd file descriptor
+ */
+static void
+_drain(int fd) {
+  char buf[16];
+
+  while (recv(fd, buf, sizeof(buf), MSG_DONTWAIT) > 0);
+}
+
+/**
+ * Handle all events with the socket event handler
+ * @param edge_triggered true to use edge triggered events
+ * @param rounds number of rounds
+ */
+static void
+_bench_os_fd(bool edge_triggered, int rounds) {
+  struct os_fd_select sel;
+  uint64_t start, ns, calls;
+  size_t i, handled;
+  int r, n, j;
+
+  if (os_fd_event_add(&sel)) {
+    fprintf(stderr, "Could not create socket event handler\n");
+    exit(1);
+  }
+  for (i=0; i<_pair_count; i++) {
+    os_fd_event_socket_add(&sel, &_pairs[i].rx);
+    os_fd_event_socket_edge_triggered(&sel, &_pairs[i].rx, edge_triggered);
+    os_fd_event_socket_read(&sel, &_pairs[i].rx, true);
+  }
+
+  ns = 0;
+  calls = 0;
+  for (r=0; r<rounds; r++) {
+    _trigger_all();
+
+    start = _get_ns();
+    handled = 0;
+    while (handled < _pair_count) {
+      os_fd_event_set_deadline(&sel, oonf_clock_getNow());
+      n = os_fd_event_wait(&sel);
+      calls++;
+      for (j=0; j<n; j++) {
+        _drain(os_fd_get_fd(os_fd_event_get(&sel, j)));
+      }
+      handled += n;
+    }
+    ns += _get_ns() - start;
+  }
+
+  printf("  os_fd %s triggered: %8.1f epoll calls/round, %8.1f us/round\n",
+      edge_triggered ? "edge " : "level",
+      (double)calls / rounds, (double)ns / rounds / 1000.0);
+
+  for (i=0; i<_pair_count; i++) {
+    os_fd_event_socket_remove(&sel, &_pairs[i].rx);
+  }
+  os_fd_event_remove(&sel);
+}
+
+/**
+ * Handle all events with a fixed size epoll event array
+ * @param rounds number of rounds
+ */
+static void
+_bench_fixed(int rounds) {
+  struct epoll_event events[FIXED_EVENT_COUNT], event;
+  uint64_t start, ns, calls;
+  size_t i, handled;
+  int r, n, j, epoll_fd;
+
+  epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+  for (i=0; i<_pair_count; i++) {
+    memset(&event, 0, sizeof(event));
+    event.events = EPOLLIN;
+    event.data.fd = os_fd_get_fd(&_pairs[i].rx);
+    epoll_ctl(epoll_fd, EPOLL_CTL_ADD, event.data.fd, &event);
+  }
+
+  ns = 0;
+  calls = 0;
+  for (r=0; r<rounds; r++) {
+    _trigger_all();
+
+    start = _get_ns();
+    handled = 0;
+    while (handled < _pair_count) {
+      n = epoll_wait(epoll_fd, events, FIXED_EVENT_COUNT, 0);
+      calls++;
+      for (j=0; j<n; j++) {
+        _drain(events[j].data.fd);
+      }
+      handled += n;
+    }
+    ns += _get_ns() - start;
+  }
+
+  printf("  fixed %d events:       %8.1f epoll calls/round, %8.1f us/round\n",
+      FIXED_EVENT_COUNT, (double)calls / rounds, (double)ns / rounds / 1000.0);
+  close(epoll_fd);
+}
+
+int
+main(int argc, char **argv) {
+  int fds[2];
+  size_t i;
+  int rounds;
+
+  _pair_count = argc > 1 ? (size_t)atoi(argv[1]) : 400;
+  rounds = argc > 2 ? atoi(argv[2]) : 1000;
+
+  if (_init_subsystem(OONF_OS_CLOCK_SUBSYSTEM)
+      || _init_subsystem(OONF_CLOCK_SUBSYSTEM)
+      || _init_subsystem(OONF_OS_FD_SUBSYSTEM)) {
+    return 1;
+  }
+
+  _pairs = calloc(_pair_count, sizeof(*_pairs));
+  if (_pairs == NULL) {
+    fprintf(stderr, "Not enough memory for %"PRINTF_SIZE_T_SPECIFIER" sockets\n",
+        _pair_count);
+    return 1;
+  }
+
+  for (i=0; i<_pair_count; i++) {
+    if (socketpair(AF_UNIX, SOCK_DGRAM | SOCK_NONBLOCK, 0, fds)) {
+      fprintf(stderr, "Could not create socket pair %"PRINTF_SIZE_T_SPECIFIER": %s\n",
+          i, strerror(errno));
+      return 1;
+    }
+    os_fd_init(&_pairs[i].rx, fds[0]);
+    _pairs[i].tx = fds[1];
+  }
+
+  printf("%"PRINTF_SIZE_T_SPECIFIER" readable sockets, %d rounds\n",
+      _pair_count, rounds);
+  _bench_fixed(rounds);
+  _bench_os_fd(false, rounds);
+  _bench_os_fd(true, rounds);
+
+  for (i=0; i<_pair_count; i++) {
+    os_fd_close(&_pairs[i].rx);
+    close(_pairs[i].tx);
+  }
+  free(_pairs);
+  return 0;
+}
@@ -0,0 +1,368 @@
+
+/*
+ * The olsr.org Optimized Link-State Routing daemon version 2 (olsrd2)
+ * Copyright (c) 2004-2015, the olsr.org team - see HISTORY file
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in
+ *   the documentation and/or other materials provided with the
+ *   distribution.
+ * * Neither the name of olsr.org, olsrd nor the names of its
+ *   contributors may be used to endorse or promote products derived
+ *   from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Visit http://www.olsr.org for more information.
+ *
+ * If you find this software useful feel free to make a donation
+ * to the project. For more information see the website or contact
+ * the copyright holders.
+ *
+ */
+
+/**
+ * @file
+ *
+ * Measures how long it takes to install and remove a large number
+ * of IPv4 host routes through the netlink handler of the os_system
+ * subsystem with different numbers of buffers in transit. Every
+ * 100th route uses an unreachable gateway and must be reported as
+ * failed with its own sequence number.
+ *
+ * The benchmark moves itself into a new network namespace with a
+ * dummy interface (or its loopback interface if the kernel has no
+ * dummy support), so it needs root privileges and the ip tool.
+ *
+ * usage: benchmark_netlink_routes [<number of routes> [<window>]]
+ */
+
+#define _GNU_SOURCE
+
+#include <errno.h>
+#include <net/if.h>
+#include <poll.h>
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <arpa/inet.h>
+
+#include "common/common_types.h"
+#include "core/oonf_subsystem.h"
+#include "subsystems/oonf_clock.h"
+#include "subsystems/oonf_job.h"
+#include "subsystems/oonf_socket.h"
+#include "subsystems/oonf_timer.h"
+#include "subsystems/os_clock.h"
+#include "subsystems/os_fd.h"
+#include "subsystems/os_system.h"
+#include "subsystems/os_linux/os_system_linux.h"
+
+/*! name of the dummy interface inside the namespace */
+#define BENCH_INTERFACE "bench0"
+
+/*! every n-th route gets a gateway that is not on-link */
+#define BENCH_FAILURE_INTERVAL 100
+
+static void _cb_error(uint32_t seq, int error);
+static void _cb_done(uint32_t seq);
+static void _cb_timeout(void);
+
+static struct oonf_subsystem _benchmark_subsystem = {
+  .name = "benchmark",
+};
+
+static struct os_system_netlink _netlink = {
+  .name = "benchmark routes",
+  .used_by = &_benchmark_subsystem,
+  .cb_error = _cb_error,
+  .cb_done = _cb_done,
+  .cb_timeout = _cb_timeout,
+};
+
+/* sequence number of first route of current run */
+static uint32_t _first_seq;
+static size_t _route_count;
+
+static size_t _pending;
+static size_t _failed;
+static size_t _misattributed;
+static bool _timeout;
+
+/**
+ * @return monotonic timestamp in nanoseconds
+ */
+static uint64_t
+_get_ns(void) {
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+/**
+ * Initialize a subsystem linked into the benchmark
+ * @param name name of subsystem
+ * @return -1 if an error happened, 0 otherwise
+ */
+static int
+_init_subsystem(const char *name) {
+  struct oonf_subsystem *subsystem;
+
+  subsystem = oonf_subsystem_get(name);
+  if (subsystem == NULL) {
+    fprintf(stderr, "Subsystem %s not linked\n", name);
+    return -1;
+  }
+  if (subsystem->init != NULL && subsystem->init()) {
+    fprintf(stderr, "Could not initialize subsystem %s\n", name);
+    return -1;
+  }
+  return 0;
+}
+
+/**
+ * @param seq netlink sequence number
+ * @return true if the route with this sequence number should fail
+ */
+static bool
+_is_failing(uint32_t seq) {
+  size_t idx;
+
+  idx = (seq - _first_seq) & INT32_MAX;
+  return idx < _route_count && (idx % BENCH_FAILURE_INTERVAL) == BENCH_FAILURE_INTERVAL - 1;
+}
+
+static void
+_cb_error(uint32_t seq, int error __attribute__((unused))) {
+  if (!_is_failing(seq)) {
+    _misattributed++;
+  }
+  _failed++;
+  _pending--;
+}
+
+static void
+_cb_done(uint32_t seq) {
+  if (_is_failing(seq)) {
+    _misattributed++;
+  }
+  _pending--;
+}
+
+static void
+_cb_timeout(void) {
+  _timeout = true;
+}
+
+/**
+ * Queue a route change for a /32 destination
+ * @param set true to add route, false to remove it
+ * @param if_index interface index of dummy interface
+ * @param idx index of route
+ * @return sequence number of netlink message
+ */
+static int
+_send_route(bool set, int if_index, size_t idx) {
+  uint8_t buffer[256];
+  struct nlmsghdr *msg;
+  struct rtmsg *rt_msg;
+  uint32_t dst, gw;
+
+  memset(buffer, 0, sizeof(buffer));
+  msg = (void *)&buffer[0];
+  rt_msg = NLMSG_DATA(msg);
+
+  msg->nlmsg_len = NLMSG_LENGTH(sizeof(*rt_msg));
+  msg->nlmsg_flags = NLM_F_REQUEST;
+  if (set) {
+    msg->nlmsg_flags |= NLM_F_CREATE | NLM_F_REPLACE;
+    msg->nlmsg_type = RTM_NEWROUTE;
+  }
+  else {
+    msg->nlmsg_type = RTM_DELROUTE;
+  }
+
+  rt_msg->rtm_family = AF_INET;
+  rt_msg->rtm_dst_len = 32;
+  rt_msg->rtm_table = RT_TABLE_MAIN;
+  rt_msg->rtm_protocol = RTPROT_STATIC;
+  rt_msg->rtm_scope = RT_SCOPE_UNIVERSE;
+  rt_msg->rtm_type = RTN_UNICAST;
+
+  /* 11.0.0.0/8 destinations, gateway inside or outside the dummy subnet */
+  dst = htonl(0x0b000000 + idx + 1);
+  if ((idx % BENCH_FAILURE_INTERVAL) == BENCH_FAILURE_INTERVAL - 1) {
+    gw = htonl(0xc0a8ff01);
+  }
+  else {
+    gw = htonl(0x0a000002);
+  }
+
+  if (os_system_linux_netlink_addreq(&_netlink, msg, RTA_DST, &dst, sizeof(dst))
+      || os_system_linux_netlink_addreq(&_netlink, msg, RTA_GATEWAY, &gw, sizeof(gw))
+      || os_system_linux_netlink_addreq(&_netlink, msg, RTA_OIF, &if_index, sizeof(if_index))) {
+    return -1;
+  }
+  return os_system_linux_netlink_send(&_netlink, msg);
+}
+
+/**
+ * Run the netlink socket until all route changes got feedback
+ * @return -1 if an error happened, 0 otherwise
+ */
+static int
+_wait_for_feedback(void) {
+  struct pollfd pfd;
+
+  while (_pending > 0 && !_timeout) {
+    if (oonf_clock_update()) {
+      return -1;
+    }
+    oonf_timer_walk();
+
+    pfd.fd = os_fd_get_fd(&_netlink.socket.fd);
+    pfd.events = _netlink.socket.fd.wanted_events & (POLLIN | POLLOUT);
+    pfd.revents = 0;
+    if (poll(&pfd, 1, 100) < 0 && errno != EINTR) {
+      fprintf(stderr, "poll error: %s\n", strerror(errno));
+      return -1;
+    }
+
+    _netlink.socket.fd.received_events = pfd.revents;
+    if (pfd.revents) {
+      _netlink.socket.process(&_netlink.socket);
+    }
+  }
+  return _timeout ? -1 : 0;
+}
+
+/**
+ * Install and remove all routes with a given window
+ * @param if_index interface index of dummy interface
+ * @param window number of netlink buffers in transit
+ * @return -1 if an error happened, 0 otherwise
+ */
+static int
+_bench_window(int if_index, uint32_t window) {
+  uint64_t start, set_ns, remove_ns;
+  size_t i, set_failed;
+  int pass, seq;
+
+  _netlink.max_buffers_in_transit = window;
+
+  set_ns = remove_ns = 0;
+  set_failed = 0;
+  for (pass = 0; pass < 2; pass++) {
+    _failed = 0;
+    _pending = _route_count;
+
+    start = _get_ns();
+    for (i=0; i<_route_count; i++) {
+      seq = _send_route(pass == 0, if_index, i);
+      if (seq < 0) {
+        fprintf(stderr, "Could not generate route message\n");
+        return -1;
+      }
+      if (i == 0) {
+        _first_seq = seq;
+      }
+    }
+    if (_wait_for_feedback()) {
+      fprintf(stderr, "Netlink feedback timed out (window %u)\n", window);
+      return -1;
+    }
+
+    if (pass == 0) {
+      set_ns = _get_ns() - start;
+      set_failed = _failed;
+    }
+    else {
+      remove_ns = _get_ns() - start;
+    }
+  }
+
+  printf("  window %3u: add %8.2f ms (%8.0f routes/s, %"PRINTF_SIZE_T_SPECIFIER" failed),"
+      " remove %8.2f ms (%"PRINTF_SIZE_T_SPECIFIER" failed)\n",
+      window, set_ns / 1000000.0, _route_count * 1000000000.0 / set_ns,
+      set_failed, remove_ns / 1000000.0, _failed);
+  return 0;
+}
+
+int
+main(int argc, char **argv) {
+  const char *if_name;
+  char cmd[128];
+  uint32_t window, w;
+  int if_index;
+
+  _route_count = argc > 1 ? (size_t)atoi(argv[1]) : 10000;
+  window = argc > 2 ? (uint32_t)atoi(argv[2]) : 16;
+
+  if (unshare(CLONE_NEWNET)) {
+    fprintf(stderr, "Could not create network namespace: %s\n", strerror(errno));
+    return 1;
+  }
+  if_name = BENCH_INTERFACE;
+  if (system("ip link add " BENCH_INTERFACE " type dummy 2>/dev/null")) {
+    /* kernel without dummy interfaces, the loopback of the namespace works too */
+    printf("no dummy interface support, using loopback\n");
+    if_name = "lo";
+  }
+  snprintf(cmd, sizeof(cmd), "ip link set %s up && ip addr add 10.0.0.1/8 dev %s",
+      if_name, if_name);
+  if (system(cmd)) {
+    fprintf(stderr, "Could not setup interface %s\n", if_name);
+    return 1;
+  }
+  if_index = if_nametoindex(if_name);
+
+  if (_init_subsystem(OONF_OS_CLOCK_SUBSYSTEM)
+      || _init_subsystem(OONF_CLOCK_SUBSYSTEM)
+      || _init_subsystem(OONF_TIMER_SUBSYSTEM)
+      || _init_subsystem(OONF_JOB_SUBSYSTEM)
+      || _init_subsystem(OONF_OS_FD_SUBSYSTEM)
+      || _init_subsystem(OONF_SOCKET_SUBSYSTEM)
+      || _init_subsystem(OONF_OS_SYSTEM_SUBSYSTEM)) {
+    return 1;
+  }
+
+  if (os_system_linux_netlink_add(&_netlink, NETLINK_ROUTE)) {
+    return 1;
+  }
+
+  printf("netlink routes: %"PRINTF_SIZE_T_SPECIFIER" routes\n", _route_count);
+  for (w = 1; w <= window; w *= 2) {
+    if (_bench_window(if_index, w)) {
+      return 1;
+    }
+  }
+  if (_misattributed) {
+    printf("  %"PRINTF_SIZE_T_SPECIFIER" results attributed to the wrong route\n",
+        _misattributed);
+    return 1;
+  }
+
+  os_system_linux_netlink_remove(&_netlink);
+  return 0;
+}
@@ -0,0 +1,898 @@
+
+/*
+ * The olsr.org Optimized Link-State Routing daemon version 2 (olsrd2)
+ * Copyright (c) 2004-2015, the olsr.org team - see HISTORY file
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in
+ *   the documentation and/or other materials provided with the
+ *   distribution.
+ * * Neither the name of olsr.org, olsrd nor the names of its
+ *   contributors may be used to endorse or promote products derived
+ *   from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Visit http://www.olsr.org for more information.
+ *
+ * If you find this software useful feel free to make a donation
+ * to the project. For more information see the website or contact
+ * the copyright holders.
+ *
+ */
+
+
+/**
+ * @file
+ *
+ * Measures the olsrv2 routing pipeline on synthetic topologies. The
+ * TC database is filled through the olsrv2_tc API with random
+ * geometric, grid and scale-free graphs, each node announces one
+ * attached network. A percentage of the nodes can be source-specific
+ * gateways, which also announce a default route for their attached
+ * network as source prefix. NHDP, the originator set and the kernel routing
+ * layer are replaced by stubs, the kernel accepts every route at
+ * the end of a calculation.
+ *
+ * Each calculation is split into three phases:
+ * - spf: shortest path trees and routing entries
+ * - diff: post-processing of the changed routing entries
+ * - queue: building the kernel route queue
+ *
+ * Three calculations are measured: the initial one, a full one
+ * without topology changes and an incremental one after changing
+ * the cost of some edges. Every topology size runs in its own
+ * process to get its peak memory. The output is one CSV line
+ * per calculation, including the cache misses of the calculation
+ * if the kernel allows to count them (-1 otherwise).
+ *
+ * benchmark_olsrv2_routing_tcdb is the same benchmark with the
+ * shortest path calculation walking the tc database instead of
+ * the compact graph.
+ *
+ * usage: benchmark_olsrv2_routing [<max nodes> [<changed edges> [<runs> [<ss percent>]]]]
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <sys/wait.h>
+
+#include "common/avl.h"
+#include "common/avl_comp.h"
+#include "common/common_types.h"
+#include "common/list.h"
+#include "common/netaddr.h"
+#include "common/prng.h"
+#include "core/oonf_subsystem.h"
+#include "subsystems/oonf_class.h"
+#include "subsystems/oonf_clock.h"
+#include "subsystems/oonf_job.h"
+#include "subsystems/oonf_timer.h"
+#include "subsystems/os_clock.h"
+#include "subsystems/os_routing.h"
+
+#include "nhdp/nhdp_db.h"
+#include "nhdp/nhdp_domain.h"
+#include "nhdp/nhdp_interfaces.h"
+
+#include "olsrv2/olsrv2.h"
+#include "olsrv2/olsrv2_lan.h"
+#include "olsrv2/olsrv2_originator.h"
+#include "olsrv2/olsrv2_routing.h"
+#include "olsrv2/olsrv2_tc.h"
+
+/*! average number of links per node of random geometric graphs */
+#define BENCH_GEOMETRIC_DEGREE 8
+
+/*! links of each new node of scale-free graphs */
+#define BENCH_SCALEFREE_LINKS 2
+
+/*! validity time of tc nodes, longer than the benchmark */
+#define BENCH_VTIME 3600000
+
+#ifdef OLSRV2_NO_SPF_GRAPH
+#define BENCH_GRAPH "tcdb"
+#else
+#define BENCH_GRAPH "csr"
+#endif
+
+enum bench_topology {
+  BENCH_GEOMETRIC,
+  BENCH_GRID,
+  BENCH_SCALEFREE,
+};
+
+static const char *_topology_names[] = {
+  [BENCH_GEOMETRIC] = "geometric",
+  [BENCH_GRID] = "grid",
+  [BENCH_SCALEFREE] = "scalefree",
+};
+
+static const uint32_t _sizes[] = { 100, 1000, 10000, 50000 };
+
+static struct oonf_class _neighbor_class = {
+  .name = NHDP_CLASS_NEIGHBOR,
+  .size = sizeof(struct nhdp_neighbor),
+};
+
+static bool _cb_filter(struct nhdp_domain *, struct os_route_parameter *, bool);
+
+static struct olsrv2_routing_filter _filter = {
+  .filter = _cb_filter,
+};
+
+/* stubbed NHDP database with a single domain */
+static struct nhdp_domain _domain;
+static struct list_entity _domain_list;
+static struct list_entity _neigh_list;
+static struct avl_tree _neigh_originator_tree;
+static struct avl_tree _interface_address_tree;
+static struct nhdp_link *_links;
+
+static struct os_interface _os_if = {
+  .name = "bench0",
+};
+static struct nhdp_interface _nhdp_if;
+
+/* stubbed olsrv2 originator and lan database */
+static struct netaddr _originator;
+static struct avl_tree _originator_tree;
+static struct avl_tree _lan_tree;
+
+/* synthetic topology */
+static struct netaddr *_addresses;
+static struct olsrv2_tc_node **_tc_nodes;
+static struct olsrv2_tc_edge **_tc_edges;
+static uint32_t _node_count, _edge_count, _edge_size;
+
+/* percentage of source-specific nodes */
+static uint32_t _ss_percent;
+
+/* routes handed to the stubbed kernel during the current calculation */
+static struct os_route **_kernel_routes;
+static size_t _kernel_count, _kernel_size;
+
+/* hardware counter for cache misses, -1 if not available */
+static int _cache_miss_fd = -1;
+
+/* timestamps of the phases of the current calculation */
+static uint64_t _first_filter_ns, _first_kernel_ns;
+static size_t _filtered;
+
+/**
+ * @return monotonic timestamp in nanoseconds
+ */
+static uint64_t
+_get_ns(void) {
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+/**
+ * Open a hardware counter for the cache misses of the benchmark
+ */
+static void
+_open_cache_miss_counter(void) {
+  struct perf_event_attr attr;
+
+  memset(&attr, 0, sizeof(attr));
+  attr.type = PERF_TYPE_HARDWARE;
+  attr.size = sizeof(attr);
+  attr.config = PERF_COUNT_HW_CACHE_MISSES;
+  attr.disabled = 1;
+  attr.exclude_kernel = 1;
+  attr.exclude_hv = 1;
+
+  _cache_miss_fd = (int)syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+}
+
+/**
+ * Start counting cache misses
+ */
+static void
+_start_cache_miss_counter(void) {
+  if (_cache_miss_fd != -1) {
+    ioctl(_cache_miss_fd, PERF_EVENT_IOC_RESET, 0);
+    ioctl(_cache_miss_fd, PERF_EVENT_IOC_ENABLE, 0);
+  }
+}
+
+/**
+ * Stop counting cache misses
+ * @return number of cache misses since start, -1 if not available
+ */
+static int64_t
+_stop_cache_miss_counter(void) {
+  uint64_t count;
+
+  if (_cache_miss_fd == -1) {
+    return -1;
+  }
+
+  ioctl(_cache_miss_fd, PERF_EVENT_IOC_DISABLE, 0);
+  if (read(_cache_miss_fd, &count, sizeof(count)) != sizeof(count)) {
+    return -1;
+  }
+  return (int64_t)count;
+}
+
+/**
+ * Initialize a subsystem linked into the benchmark
+ * @param name name of subsystem
+ * @return -1 if an error happened, 0 otherwise
+ */
+static int
+_init_subsystem(const char *name) {
+  struct oonf_subsystem *subsystem;
+
+  subsystem = oonf_subsystem_get(name);
+  if (subsystem == NULL) {
+    fprintf(stderr, "Subsystem %s not linked\n", name);
+    return -1;
+  }
+  if (subsystem->init != NULL && subsystem->init()) {
+    fprintf(stderr, "Could not initialize subsystem %s\n", name);
+    return -1;
+  }
+  return 0;
+}
+
+/*
+ * stubs for the NHDP, olsrv2 and kernel functions used by the routing code
+ */
+
+struct list_entity *
+nhdp_db_get_neigh_list(void) {
+  return &_neigh_list;
+}
+
+struct avl_tree *
+nhdp_db_get_neigh_originator_tree(void) {
+  return &_neigh_originator_tree;
+}
+
+struct list_entity *
+nhdp_domain_get_list(void) {
+  return &_domain_list;
+}
+
+void
+nhdp_domain_listener_add(struct nhdp_domain_listener *listener __attribute__((unused))) {
+}
+
+void
+nhdp_domain_listener_remove(struct nhdp_domain_listener *listener __attribute__((unused))) {
+}
+
+struct avl_tree *
+nhdp_interface_get_address_tree(void) {
+  return &_interface_address_tree;
+}
+
+bool
+olsrv2_is_routable(struct netaddr *addr __attribute__((unused))) {
+  return true;
+}
+
+bool
+olsrv2_is_nhdp_routable(struct netaddr *addr __attribute__((unused))) {
+  return true;
+}
+
+struct avl_tree *
+olsrv2_lan_get_tree(void) {
+  return &_lan_tree;
+}
+
+const struct netaddr *
+olsrv2_originator_get(int af_type) {
+  return af_type == AF_INET ? &_originator : &NETADDR_UNSPEC;
+}
+
+bool
+olsrv2_originator_is_local(const struct netaddr *addr) {
+  return netaddr_cmp(addr, &_originator) == 0;
+}
+
+struct avl_tree *
+olsrv2_originator_get_tree(void) {
+  return &_originator_tree;
+}
+
+bool
+os_routing_linux_supports_nexthop_objects(void) {
+  return false;
+}
+
+int
+os_routing_linux_set(struct os_route *route,
+    bool set __attribute__((unused)), bool del_similar __attribute__((unused))) {
+  struct os_route **routes;
+
+  if (_kernel_count == 0) {
+    _first_kernel_ns = _get_ns();
+  }
+  if (_kernel_count == _kernel_size) {
+    routes = realloc(_kernel_routes, sizeof(*routes) * (_kernel_size + 1024) * 2);
+    if (routes == NULL) {
+      return -1;
+    }
+    _kernel_routes = routes;
+    _kernel_size = (_kernel_size + 1024) * 2;
+  }
+  _kernel_routes[_kernel_count++] = route;
+  return 0;
+}
+
+int
+os_routing_linux_query(struct os_route *route __attribute__((unused))) {
+  return -1;
+}
+
+void
+os_routing_linux_interrupt(struct os_route *route __attribute__((unused))) {
+}
+
+bool
+os_routing_linux_is_in_progress(struct os_route *route __attribute__((unused))) {
+  return false;
+}
+
+void
+os_routing_linux_init_wildcard_route(struct os_route *route) {
+  memset(route, 0, sizeof(*route));
+}
+
+int
+os_routing_linux_set_nexthop(struct os_nexthop *nexthop __attribute__((unused)),
+    bool set __attribute__((unused))) {
+  return -1;
+}
+
+void
+os_routing_linux_interrupt_nexthop(struct os_nexthop *nexthop __attribute__((unused))) {
+}
+
+/**
+ * Routing filter that marks the start of the post-processing
+ */
+static bool
+_cb_filter(struct nhdp_domain *domain __attribute__((unused)),
+    struct os_route_parameter *route_param __attribute__((unused)),
+    bool set __attribute__((unused))) {
+  if (_filtered++ == 0) {
+    _first_filter_ns = _get_ns();
+  }
+  return true;
+}
+
+/**
+ * Remember an undirected link of the synthetic topology
+ * @param prng random number generator for link cost
+ * @param n1 index of first node
+ * @param n2 index of second node
+ * @return -1 if out of memory, 0 otherwise
+ */
+static int
+_add_link(struct prng_state *prng, uint32_t n1, uint32_t n2) {
+  struct olsrv2_tc_edge **edges, *edge;
+  uint32_t i, cost;
+
+  if (n1 == n2 || avl_find(&_tc_nodes[n1]->_edges, &_addresses[n2]) != NULL) {
+    /* no loops and no double links */
+    return 0;
+  }
+
+  if (_edge_count + 2 > _edge_size) {
+    edges = realloc(_tc_edges, sizeof(*edges) * (_edge_size + 1024) * 2);
+    if (edges == NULL) {
+      return -1;
+    }
+    _tc_edges = edges;
+    _edge_size = (_edge_size + 1024) * 2;
+  }
+
+  cost = 1024 + prng_next32(prng) % 4096;
+  for (i = 0; i < 2; i++) {
+    edge = olsrv2_tc_edge_add(_tc_nodes[i == 0 ? n1 : n2], &_addresses[i == 0 ? n2 : n1]);
+    if (edge == NULL) {
+      return -1;
+    }
+    edge->cost[_domain.index] = cost;
+    _tc_edges[_edge_count++] = edge;
+  }
+  return 0;
+}
+
+/**
+ * Create a random geometric graph, nodes in the unit square are
+ * linked if they are closer than a radius
+ * @param prng random number generator
+ * @return -1 if out of memory, 0 otherwise
+ */
+static int
+_create_geometric(struct prng_state *prng) {
+  uint32_t *cell_first, *cell_next;
+  double *x, *y, radius, dx, dy;
+  uint32_t cells, i, j, cx, cy, c;
+  int ox, oy, result;
+
+  radius = sqrt((double)BENCH_GEOMETRIC_DEGREE / (M_PI * _node_count));
+  cells = (uint32_t)(1.0 / radius);
+  if (cells == 0) {
+    cells = 1;
+  }
+
+  x = calloc(_node_count, sizeof(*x));
+  y = calloc(_node_count, sizeof(*y));
+  cell_first = malloc(sizeof(*cell_first) * cells * cells);
+  cell_next = calloc(_node_count, sizeof(*cell_next));
+
+  result = -1;
+  if (x == NULL || y == NULL || cell_first == NULL || cell_next == NULL) {
+    goto geometric_cleanup;
+  }
+
+  /* sort nodes into cells with the size of the radius */
+  memset(cell_first, 0xff, sizeof(*cell_first) * cells * cells);
+  for (i = 0; i < _node_count; i++) {
+    x[i] = prng_next32(prng) / (double)UINT32_MAX;
+    y[i] = prng_next32(prng) / (double)UINT32_MAX;
+
+    c = (uint32_t)(y[i] * (cells - 1)) * cells + (uint32_t)(x[i] * (cells - 1));
+    cell_next[i] = cell_first[c];
+    cell_first[c] = i;
+  }
+
+  for (i = 0; i < _node_count; i++) {
+    cx = (uint32_t)(x[i] * (cells - 1));
+    cy = (uint32_t)(y[i] * (cells - 1));
+
+    for (oy = -1; oy <= 1; oy++) {
+      for (ox = -1; ox <= 1; ox++) {
+        if ((int)cx + ox < 0 || (int)cx + ox >= (int)cells
+            || (int)cy + oy < 0 || (int)cy + oy >= (int)cells) {
+          continue;
+        }
+
+        c = (cy + oy) * cells + cx + ox;
+        for (j = cell_first[c]; j != UINT32_MAX; j = cell_next[j]) {
+          dx = x[i] - x[j];
+          dy = y[i] - y[j];
+          if (j > i && dx*dx + dy*dy <= radius * radius
+              && _add_link(prng, i, j)) {
+            goto geometric_cleanup;
+          }
+        }
+      }
+    }
+  }
+  result = 0;
+
+geometric_cleanup:
+  free(x);
+  free(y);
+  free(cell_first);
+  free(cell_next);
+  return result;
+}
+
+/**
+ * Create a square grid graph
+ * @param prng random number generator
+ * @return -1 if out of memory, 0 otherwise
+ */
+static int
+_create_grid(struct prng_state *prng) {
+  uint32_t width, i;
+  double side;
+
+  side = ceil(sqrt(_node_count));
+  width = (uint32_t)side;
+  for (i = 0; i < _node_count; i++) {
+    if ((i % width) + 1 < width && i + 1 < _node_count
+        && _add_link(prng, i, i + 1)) {
+      return -1;
+    }
+    if (i + width < _node_count && _add_link(prng, i, i + width)) {
+      return -1;
+    }
+  }
+  return 0;
+}
+
+/**
+ * Create a scale-free graph by preferential attachment, each new
+ * node links to existing nodes with a probability proportional
+ * to their number of links
+ * @param prng random number generator
+ * @return -1 if out of memory, 0 otherwise
+ */
+static int
+_create_scalefree(struct prng_state *prng) {
+  uint32_t *endpoints, count, i, j, dst;
+  int result;
+
+  endpoints = calloc((size_t)_node_count * BENCH_SCALEFREE_LINKS * 2 + 2, sizeof(*endpoints));
+  if (endpoints == NULL) {
+    return -1;
+  }
+
+  result = -1;
+  if (_add_link(prng, 0, 1)) {
+    goto scalefree_cleanup;
+  }
+  endpoints[0] = 0;
+  endpoints[1] = 1;
+  count = 2;
+
+  for (i = 2; i < _node_count; i++) {
+    for (j = 0; j < BENCH_SCALEFREE_LINKS; j++) {
+      dst = endpoints[prng_next32(prng) % count];
+      if (avl_find(&_tc_nodes[i]->_edges, &_addresses[dst]) != NULL) {
+        continue;
+      }
+      if (_add_link(prng, i, dst)) {
+        goto scalefree_cleanup;
+      }
+      endpoints[count++] = i;
+      endpoints[count++] = dst;
+    }
+  }
+  result = 0;
+
+scalefree_cleanup:
+  free(endpoints);
+  return result;
+}
+
+/**
+ * Create the synthetic topology in the TC database and the
+ * NHDP neighbors of node 0, which is the local node
+ * @param topology type of topology
+ * @param prng random number generator
+ * @return -1 if out of memory, 0 otherwise
+ */
+static int
+_create_topology(enum bench_topology topology, struct prng_state *prng) {
+  struct nhdp_neighbor_domaindata *neighdata;
+  struct olsrv2_tc_attachment *attached;
+  struct nhdp_neighbor *neigh;
+  struct olsrv2_tc_edge *edge;
+  struct os_route_key key;
+  struct netaddr prefix;
+  uint32_t i, addr;
+  int result;
+
+  _addresses = calloc(_node_count, sizeof(*_addresses));
+  _tc_nodes = calloc(_node_count, sizeof(*_tc_nodes));
+  if (_addresses == NULL || _tc_nodes == NULL) {
+    return -1;
+  }
+
+  for (i = 0; i < _node_count; i++) {
+    /* originators are 10.0.0.0/8, attached networks 64.0.0.0/24 ... */
+    addr = htonl(0x0a000001 + i);
+    netaddr_from_binary(&_addresses[i], &addr, 4, AF_INET);
+
+    _tc_nodes[i] = olsrv2_tc_node_add(&_addresses[i], BENCH_VTIME, 0);
+    if (_tc_nodes[i] == NULL) {
+      return -1;
+    }
+
+    addr = htonl(0x40000000 + (i << 8));
+    netaddr_from_binary_prefix(&prefix, &addr, 4, AF_INET, 24);
+    os_routing_init_sourcespec_prefix(&key, &prefix);
+
+    attached = olsrv2_tc_endpoint_add(_tc_nodes[i], &key, false);
+    if (attached == NULL) {
+      return -1;
+    }
+    attached->cost[_domain.index] = 1;
+
+    if (i % 100 >= _ss_percent) {
+      continue;
+    }
+
+    /* source-specific gateway for its attached network */
+    os_routing_init_sourcespec_src_prefix(&key, &prefix);
+
+    attached = olsrv2_tc_endpoint_add(_tc_nodes[i], &key, false);
+    if (attached == NULL) {
+      return -1;
+    }
+    attached->cost[_domain.index] = 1;
+
+    _tc_nodes[i]->source_specific = true;
+    _tc_nodes[i]->ss_attached_networks[_domain.index] = true;
+  }
+  memcpy(&_originator, &_addresses[0], sizeof(_originator));
+
+  switch (topology) {
+    case BENCH_GEOMETRIC:
+      result = _create_geometric(prng);
+      break;
+    case BENCH_GRID:
+      result = _create_grid(prng);
+      break;
+    case BENCH_SCALEFREE:
+    default:
+      result = _create_scalefree(prng);
+      break;
+  }
+  if (result) {
+    return -1;
+  }
+
+  _links = calloc(_tc_nodes[0]->_edges.count, sizeof(*_links));
+  if (_links == NULL && _tc_nodes[0]->_edges.count > 0) {
+    return -1;
+  }
+
+  /* the edges of the local node are its symmetric NHDP neighbors */
+  i = 0;
+  avl_for_each_element(&_tc_nodes[0]->_edges, edge, _node) {
+    neigh = oonf_class_malloc(&_neighbor_class);
+    if (neigh == NULL) {
+      return -1;
+    }
+
+    memcpy(&neigh->originator, &edge->dst->target.prefix.dst, sizeof(neigh->originator));
+    neigh->symmetric = 1;
+    list_init_head(&neigh->_links);
+    avl_init(&neigh->_neigh_addresses, avl_comp_netaddr, false);
+    avl_init(&neigh->_link_addresses, avl_comp_netaddr, false);
+
+    memcpy(&_links[i].if_addr, &neigh->originator, sizeof(_links[i].if_addr));
+    _links[i].local_if = &_nhdp_if;
+    _links[i].neigh = neigh;
+
+    neighdata = nhdp_domain_get_neighbordata(&_domain, neigh);
+    neighdata->metric.in = edge->cost[_domain.index];
+    neighdata->metric.out = edge->cost[_domain.index];
+    neighdata->best_link = &_links[i];
+    neighdata->best_link_ifindex = 1;
+
+    list_add_tail(&_neigh_list, &neigh->_global_node);
+    neigh->_originator_node.key = &neigh->originator;
+    avl_insert(&_neigh_originator_tree, &neigh->_originator_node);
+    i++;
+  }
+  return 0;
+}
+
+/**
+ * Run a routing calculation and hand the kernel routes back as
+ * successfully set
+ * @param label name of calculation
+ * @param topology name of topology
+ * @param runs number of calculations
+ * @param prepare callback to change the topology before each run, NULL for none
+ * @param prng random number generator for callback
+ * @param changed number of edges changed before each run
+ */
+static void
+_run_calculation(const char *label, const char *topology, uint32_t runs,
+    void (*prepare)(struct prng_state *, uint32_t), struct prng_state *prng, uint32_t changed) {
+  uint64_t start, end, spf_ns, diff_ns, queue_ns;
+  int64_t misses, cache_misses;
+  size_t i, routes, entries;
+  struct rusage usage;
+  uint32_t r;
+
+  spf_ns = diff_ns = queue_ns = 0;
+  routes = 0;
+  cache_misses = 0;
+
+  for (r = 0; r < runs; r++) {
+    if (prepare) {
+      prepare(prng, changed);
+    }
+
+    _kernel_count = 0;
+    _filtered = 0;
+
+    _start_cache_miss_counter();
+    start = _get_ns();
+    olsrv2_routing_force_update(true);
+    while (oonf_job_is_pending()) {
+      oonf_job_run_slice();
+    }
+    end = _get_ns();
+
+    misses = _stop_cache_miss_counter();
+    if (misses < 0 || cache_misses < 0) {
+      cache_misses = -1;
+    }
+    else {
+      cache_misses += misses;
+    }
+
+    if (_kernel_count == 0) {
+      _first_kernel_ns = end;
+    }
+    if (_filtered == 0) {
+      _first_filter_ns = _first_kernel_ns;
+    }
+
+    spf_ns += _first_filter_ns - start;
+    diff_ns += _first_kernel_ns - _first_filter_ns;
+    queue_ns += end - _first_kernel_ns;
+    routes += _kernel_count;
+
+    /* kernel accepts all routes */
+    for (i = 0; i < _kernel_count; i++) {
+      _kernel_routes[i]->cb_finished(_kernel_routes[i], 0);
+    }
+  }
+
+  entries = olsrv2_routing_get_tree(&_domain)->count;
+  getrusage(RUSAGE_SELF, &usage);
+
+  printf("%s,%s,%u,%u,%u,%s,%u,%.1f,%.1f,%.1f,%.1f,%.1f,%"PRINTF_SIZE_T_SPECIFIER",%"PRINTF_SIZE_T_SPECIFIER",%ld\n",
+      BENCH_GRAPH, topology, _node_count, _edge_count / 2, _ss_percent, label, runs,
+      (double)spf_ns / runs / _node_count,
+      (double)diff_ns / runs / _node_count,
+      (double)queue_ns / runs / _node_count,
+      (double)(spf_ns + diff_ns + queue_ns) / runs / _node_count,
+      cache_misses < 0 ? -1.0 : (double)cache_misses / runs / _node_count,
+      entries, routes / runs, usage.ru_maxrss);
+  fflush(stdout);
+}
+
+/**
+ * Pretend the local originator set changed, which makes the
+ * next calculation start from scratch
+ * @param prng unused
+ * @param changed unused
+ */
+static void
+_prepare_full(struct prng_state *prng __attribute__((unused)),
+    uint32_t changed __attribute__((unused))) {
+  _originator_tree.count ^= 1;
+}
+
+/**
+ * Change the cost of random edges
+ * @param prng random number generator
+ * @param changed number of edges to change
+ */
+static void
+_prepare_incremental(struct prng_state *prng, uint32_t changed) {
+  struct olsrv2_tc_edge *edge;
+  uint32_t i;
+
+  for (i = 0; i < changed && _edge_count > 0; i++) {
+    edge = _tc_edges[prng_next32(prng) % _edge_count];
+    edge->cost[_domain.index] = 1024 + prng_next32(prng) % 4096;
+    olsrv2_tc_trigger_change(edge->src);
+  }
+}
+
+/**
+ * Measure one topology, runs in its own process
+ * @param topology type of topology
+ * @param changed number of edges changed for incremental calculations
+ * @param runs number of calculations
+ * @return -1 if an error happened, 0 otherwise
+ */
+static int
+_bench_topology(enum bench_topology topology, uint32_t changed, uint32_t runs) {
+  struct olsrv2_routing_domain parameter;
+  struct prng_state prng;
+
+  if (_init_subsystem(OONF_OS_CLOCK_SUBSYSTEM)
+      || _init_subsystem(OONF_CLOCK_SUBSYSTEM)
+      || _init_subsystem(OONF_CLASS_SUBSYSTEM)
+      || _init_subsystem(OONF_TIMER_SUBSYSTEM)
+      || _init_subsystem(OONF_JOB_SUBSYSTEM)) {
+    return -1;
+  }
+
+  list_init_head(&_domain_list);
+  list_init_head(&_neigh_list);
+  avl_init(&_neigh_originator_tree, avl_comp_netaddr, false);
+  avl_init(&_interface_address_tree, avl_comp_netaddr, false);
+  avl_init(&_originator_tree, avl_comp_netaddr, false);
+  avl_init(&_lan_tree, os_routing_avl_cmp_route_key, false);
+  _nhdp_if.os_if_listener.data = &_os_if;
+
+  list_add_tail(&_domain_list, &_domain._node);
+  oonf_class_add(&_neighbor_class);
+
+  olsrv2_tc_init();
+  olsrv2_routing_init();
+  olsrv2_routing_filter_add(&_filter);
+
+  memset(&parameter, 0, sizeof(parameter));
+  parameter.protocol = 100;
+  parameter.table = 254;
+  parameter.distance = 2;
+  parameter.multipath = 1;
+  olsrv2_routing_set_domain_parameter(&_domain, &parameter);
+
+  _open_cache_miss_counter();
+
+  prng_seed(&prng, _node_count * 3 + topology);
+  if (_create_topology(topology, &prng)) {
+    fprintf(stderr, "Not enough memory for %u nodes\n", _node_count);
+    return -1;
+  }
+
+  _run_calculation("initial", _topology_names[topology], 1, NULL, NULL, 0);
+  _run_calculation("full", _topology_names[topology], runs, _prepare_full, NULL, 0);
+  _run_calculation("incremental", _topology_names[topology], runs,
+      _prepare_incremental, &prng, changed);
+  return 0;
+}
+
+int
+main(int argc, char **argv) {
+  uint32_t max_nodes, changed, runs, s;
+  enum bench_topology topology;
+  int status;
+  pid_t pid;
+
+  max_nodes = argc > 1 ? (uint32_t)atoi(argv[1]) : 10000;
+  changed = argc > 2 ? (uint32_t)atoi(argv[2]) : 16;
+  runs = argc > 3 ? (uint32_t)atoi(argv[3]) : 10;
+  _ss_percent = argc > 4 ? (uint32_t)atoi(argv[4]) : 0;
+
+  if (max_nodes < _sizes[0] || runs == 0 || _ss_percent > 100) {
+    fprintf(stderr, "usage: %s [<max nodes> [<changed edges> [<runs> [<ss percent>]]]]\n", argv[0]);
+    return 1;
+  }
+
+  printf("graph,topology,nodes,links,ss_percent,calculation,runs,spf_ns_per_node,diff_ns_per_node,"
+      "queue_ns_per_node,total_ns_per_node,cache_misses_per_node,routing_entries,"
+      "kernel_routes_per_run,peak_rss_kb\n");
+  fflush(stdout);
+
+  for (topology = BENCH_GEOMETRIC; topology <= BENCH_SCALEFREE; topology++) {
+    for (s = 0; s < ARRAYSIZE(_sizes) && _sizes[s] <= max_nodes; s++) {
+      pid = fork();
+      if (pid < 0) {
+        return 1;
+      }
+      if (pid == 0) {
+        _node_count = _sizes[s];
+        exit(_bench_topology(topology, changed, runs) ? 1 : 0);
+      }
+
+      if (waitpid(pid, &status, 0) < 0 || !WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+        fprintf(stderr, "Benchmark of %s topology with %u nodes failed\n",
+            _topology_names[topology], _sizes[s]);
+        return 1;
+      }
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,389 @@
+
+/*
+ * The olsr.org Optimized Link-State Routing daemon version 2 (olsrd2)
+ * Copyright (c) 2004-2015, the olsr.org team - see HISTORY file
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in
+ *   the documentation and/or other materials provided with the
+ *   distribution.
+ * * Neither the name of olsr.org, olsrd nor the names of its
+ *   contributors may be used to endorse or promote products derived
+ *   from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Visit http://www.olsr.org for more information.
+ *
+ * If you find this software useful feel free to make a donation
+ * to the project. For more information see the website or contact
+ * the copyright holders.
+ *
+ */
+
+
+/**
+ * @file
+ *
+ * Measures how many packets per second the rfc5444 reader parses.
+ * The packets contain TC-like messages with three message TLVs
+ * and large address blocks, each address has a link metric,
+ * an address type and some addresses are gateways. One message
+ * consumer and one address consumer process the messages.
+ *
+ * usage: benchmark_rfc5444_reader [<addresses per message> [<messages per packet> [<packets>]]]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "common/common_types.h"
+#include "rfc5444/rfc5444_context.h"
+#include "rfc5444/rfc5444_reader.h"
+
+/* message and TLV types of the synthetic messages */
+enum {
+  BENCH_MSGTYPE_TC        = 1,
+
+  BENCH_MSGTLV_INTERVAL   = 0,
+  BENCH_MSGTLV_VALIDITY   = 1,
+  BENCH_MSGTLV_CONT_SEQNO = 5,
+
+  BENCH_ADDRTLV_METRIC    = 7,
+  BENCH_ADDRTLV_ADDR_TYPE = 8,
+  BENCH_ADDRTLV_GATEWAY   = 9,
+};
+
+/* indices of the consumer entries */
+enum {
+  IDX_MSGTLV_INTERVAL,
+  IDX_MSGTLV_VALIDITY,
+  IDX_MSGTLV_CONT_SEQNO,
+};
+
+enum {
+  IDX_ADDRTLV_METRIC,
+  IDX_ADDRTLV_ADDR_TYPE,
+  IDX_ADDRTLV_GATEWAY,
+};
+
+/* maximum number of addresses in one address block with a 3 byte head */
+#define BENCH_MAX_BLOCK_ADDR 255
+
+static enum rfc5444_result _cb_message(struct rfc5444_reader_tlvblock_context *context);
+static enum rfc5444_result _cb_address(struct rfc5444_reader_tlvblock_context *context);
+
+static struct rfc5444_reader _reader;
+
+static struct rfc5444_reader_tlvblock_consumer_entry _msg_tlvs[] = {
+  [IDX_MSGTLV_INTERVAL] = { .type = BENCH_MSGTLV_INTERVAL },
+  [IDX_MSGTLV_VALIDITY] = { .type = BENCH_MSGTLV_VALIDITY, .mandatory = true },
+  [IDX_MSGTLV_CONT_SEQNO] = { .type = BENCH_MSGTLV_CONT_SEQNO, .match_type_ext = true,
+      .min_length = 2, .max_length = 2, .match_length = true },
+};
+
+static struct rfc5444_reader_tlvblock_consumer_entry _addr_tlvs[] = {
+  [IDX_ADDRTLV_METRIC] = { .type = BENCH_ADDRTLV_METRIC, .match_type_ext = true,
+      .min_length = 2, .max_length = 2, .match_length = true },
+  [IDX_ADDRTLV_ADDR_TYPE] = { .type = BENCH_ADDRTLV_ADDR_TYPE, .mandatory = true },
+  [IDX_ADDRTLV_GATEWAY] = { .type = BENCH_ADDRTLV_GATEWAY },
+};
+
+static struct rfc5444_reader_tlvblock_consumer _msg_consumer = {
+  .msg_id = BENCH_MSGTYPE_TC,
+  .block_callback = _cb_message,
+};
+
+static struct rfc5444_reader_tlvblock_consumer _addr_consumer = {
+  .msg_id = BENCH_MSGTYPE_TC,
+  .addrblock_consumer = true,
+  .block_callback = _cb_address,
+};
+
+/* synthetic packet */
+static uint8_t _packet[65535];
+static size_t _packet_size;
+
+/* statistics of the consumers */
+static uint32_t _message_count;
+static uint32_t _address_count;
+static uint32_t _gateway_count;
+static uint64_t _metric_sum;
+
+/**
+ * @return monotonic timestamp in nanoseconds
+ */
+static uint64_t
+_get_ns(void) {
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+static enum rfc5444_result
+_cb_message(struct rfc5444_reader_tlvblock_context *context __attribute__((unused))) {
+  if (_msg_tlvs[IDX_MSGTLV_CONT_SEQNO].tlv == NULL) {
+    return RFC5444_DROP_MESSAGE;
+  }
+  _message_count++;
+  return RFC5444_OKAY;
+}
+
+static enum rfc5444_result
+_cb_address(struct rfc5444_reader_tlvblock_context *context __attribute__((unused))) {
+  struct rfc5444_reader_tlvblock_entry *tlv;
+
+  tlv = _addr_tlvs[IDX_ADDRTLV_METRIC].tlv;
+  if (tlv != NULL) {
+    _metric_sum += ((uint16_t)tlv->single_value[0] << 8) | tlv->single_value[1];
+  }
+  if (_addr_tlvs[IDX_ADDRTLV_GATEWAY].tlv != NULL) {
+    _gateway_count++;
+  }
+  _address_count++;
+  return RFC5444_OKAY;
+}
+
+/**
+ * Write a byte into the packet buffer
+ * @param ptr pointer to write position, will be incremented
+ * @param value byte
+ */
+static void
+_put_u8(uint8_t **ptr, uint8_t value) {
+  **ptr = value;
+  *ptr += 1;
+}
+
+/**
+ * Write a word in network byte order into the packet buffer
+ * @param ptr pointer to write position, will be incremented
+ * @param value word
+ */
+static void
+_put_u16(uint8_t **ptr, uint16_t value) {
+  _put_u8(ptr, value >> 8);
+  _put_u8(ptr, value & 255);
+}
+
+/**
+ * Fill in the length of a TLV block or message
+ * @param field pointer to 16 bit length field
+ * @param length length
+ */
+static void
+_set_u16(uint8_t *field, size_t length) {
+  field[0] = length >> 8;
+  field[1] = length & 255;
+}
+
+/**
+ * Append an address block with its TLV block
+ * @param ptr pointer to write position, will be incremented
+ * @param msg index of message
+ * @param block index of address block within message
+ * @param count number of addresses
+ */
+static void
+_write_addrblock(uint8_t **ptr, uint32_t msg, uint32_t block, uint32_t count) {
+  uint8_t *tlvblock;
+  uint32_t i;
+
+  /* 10.<msg>.<block>.x, the head is shared by all addresses */
+  _put_u8(ptr, count);
+  _put_u8(ptr, RFC5444_ADDR_FLAG_HEAD);
+  _put_u8(ptr, 3);
+  _put_u8(ptr, 10);
+  _put_u8(ptr, msg & 255);
+  _put_u8(ptr, block & 255);
+  for (i = 0; i < count; i++) {
+    _put_u8(ptr, i);
+  }
+
+  tlvblock = *ptr;
+  *ptr += 2;
+
+  /* one link metric for each address */
+  _put_u8(ptr, BENCH_ADDRTLV_METRIC);
+  _put_u8(ptr, RFC5444_TLV_FLAG_TYPEEXT | RFC5444_TLV_FLAG_VALUE
+      | RFC5444_TLV_FLAG_EXTVALUE | RFC5444_TLV_FLAG_MULTIVALUE);
+  _put_u8(ptr, 0);
+  _put_u16(ptr, count * 2);
+  for (i = 0; i < count; i++) {
+    _put_u16(ptr, 256 + i);
+  }
+
+  /* same address type for all addresses */
+  _put_u8(ptr, BENCH_ADDRTLV_ADDR_TYPE);
+  _put_u8(ptr, RFC5444_TLV_FLAG_VALUE);
+  _put_u8(ptr, 1);
+  _put_u8(ptr, 1);
+
+  /* first address of each block is a gateway */
+  _put_u8(ptr, BENCH_ADDRTLV_GATEWAY);
+  _put_u8(ptr, RFC5444_TLV_FLAG_SINGLE_IDX | RFC5444_TLV_FLAG_VALUE);
+  _put_u8(ptr, 0);
+  _put_u8(ptr, 1);
+  _put_u8(ptr, 1);
+
+  _set_u16(tlvblock, *ptr - tlvblock - 2);
+}
+
+/**
+ * Create the synthetic packet
+ * @param addr_count number of addresses per message
+ * @param msg_count number of messages per packet
+ * @return -1 if the packet would be too large, 0 otherwise
+ */
+static int
+_create_packet(uint32_t addr_count, uint32_t msg_count) {
+  uint8_t *ptr, *msg, *tlvblock;
+  uint32_t m, a, block;
+
+  /* 3 bytes per address and 16 bytes per address block are enough */
+  if (1 + (size_t)msg_count * (32 + addr_count * 3
+      + (addr_count / BENCH_MAX_BLOCK_ADDR + 1) * 16) > sizeof(_packet)
+      || msg_count * (size_t)addr_count * 3 > 65535 - 32) {
+    return -1;
+  }
+
+  ptr = _packet;
+
+  /* packet header without sequence number and TLVs */
+  _put_u8(&ptr, 0);
+
+  for (m = 0; m < msg_count; m++) {
+    msg = ptr;
+
+    _put_u8(&ptr, BENCH_MSGTYPE_TC);
+    _put_u8(&ptr, RFC5444_MSG_FLAG_ORIGINATOR | RFC5444_MSG_FLAG_HOPLIMIT
+        | RFC5444_MSG_FLAG_HOPCOUNT | RFC5444_MSG_FLAG_SEQNO | (4-1));
+    ptr += 2;
+
+    /* originator 10.255.<m>.1, hoplimit, hopcount and sequence number */
+    _put_u8(&ptr, 10);
+    _put_u8(&ptr, 255);
+    _put_u8(&ptr, m & 255);
+    _put_u8(&ptr, 1);
+    _put_u8(&ptr, 255);
+    _put_u8(&ptr, 1);
+    _put_u16(&ptr, m);
+
+    /* message TLVs */
+    tlvblock = ptr;
+    ptr += 2;
+
+    _put_u8(&ptr, BENCH_MSGTLV_INTERVAL);
+    _put_u8(&ptr, RFC5444_TLV_FLAG_VALUE);
+    _put_u8(&ptr, 1);
+    _put_u8(&ptr, 0x50);
+
+    _put_u8(&ptr, BENCH_MSGTLV_VALIDITY);
+    _put_u8(&ptr, RFC5444_TLV_FLAG_VALUE);
+    _put_u8(&ptr, 1);
+    _put_u8(&ptr, 0x70);
+
+    _put_u8(&ptr, BENCH_MSGTLV_CONT_SEQNO);
+    _put_u8(&ptr, RFC5444_TLV_FLAG_TYPEEXT | RFC5444_TLV_FLAG_VALUE);
+    _put_u8(&ptr, 0);
+    _put_u8(&ptr, 2);
+    _put_u16(&ptr, 4711);
+
+    _set_u16(tlvblock, ptr - tlvblock - 2);
+
+    for (a = 0, block = 0; a < addr_count; a += BENCH_MAX_BLOCK_ADDR, block++) {
+      _write_addrblock(&ptr, m, block,
+          addr_count - a > BENCH_MAX_BLOCK_ADDR ? BENCH_MAX_BLOCK_ADDR : addr_count - a);
+    }
+
+    _set_u16(msg + 2, ptr - msg);
+  }
+
+  _packet_size = ptr - _packet;
+  return 0;
+}
+
+int
+main(int argc, char **argv) {
+  uint32_t addr_count, msg_count, packets, p, gateways;
+  uint64_t start, ns, metric_sum;
+  uint32_t a;
+
+  addr_count = argc > 1 ? (uint32_t)atoi(argv[1]) : 1000;
+  msg_count = argc > 2 ? (uint32_t)atoi(argv[2]) : 1;
+  packets = argc > 3 ? (uint32_t)atoi(argv[3]) : 20000;
+
+  if (addr_count == 0 || msg_count == 0 || packets == 0) {
+    fprintf(stderr, "usage: %s [<addresses per message> [<messages per packet> [<packets>]]]\n",
+        argv[0]);
+    return 1;
+  }
+
+  if (_create_packet(addr_count, msg_count)) {
+    fprintf(stderr, "Packet with %u messages of %u addresses is too large\n",
+        msg_count, addr_count);
+    return 1;
+  }
+
+  rfc5444_reader_init(&_reader);
+  rfc5444_reader_add_message_consumer(&_reader, &_msg_consumer,
+      _msg_tlvs, ARRAYSIZE(_msg_tlvs));
+  rfc5444_reader_add_message_consumer(&_reader, &_addr_consumer,
+      _addr_tlvs, ARRAYSIZE(_addr_tlvs));
+
+  start = _get_ns();
+  for (p = 0; p < packets; p++) {
+    if (rfc5444_reader_handle_packet(&_reader, _packet, _packet_size) != RFC5444_OKAY) {
+      fprintf(stderr, "Could not parse packet\n");
+      return 1;
+    }
+  }
+  ns = _get_ns() - start;
+
+  /* every address must have been seen with its TLVs */
+  gateways = (addr_count + BENCH_MAX_BLOCK_ADDR - 1) / BENCH_MAX_BLOCK_ADDR;
+  metric_sum = 0;
+  for (a = 0; a < addr_count; a++) {
+    metric_sum += 256 + a % BENCH_MAX_BLOCK_ADDR;
+  }
+  if (_message_count != packets * msg_count
+      || _address_count != (uint64_t)packets * msg_count * addr_count
+      || _gateway_count != (uint64_t)packets * msg_count * gateways
+      || _metric_sum != (uint64_t)packets * msg_count * metric_sum) {
+    fprintf(stderr, "Consumers saw %u messages, %u addresses and %u gateways\n",
+        _message_count, _address_count, _gateway_count);
+    return 1;
+  }
+
+  printf("rfc5444 reader: %u messages/packet, %u addresses/message, %"PRINTF_SIZE_T_SPECIFIER" bytes/packet, %u packets\n",
+      msg_count, addr_count, _packet_size, packets);
+  printf("  %10.0f packets/s\n", ns ? (double)packets * 1000000000.0 / ns : 0.0);
+  printf("  %10.1f ns/packet\n", (double)ns / packets);
+  printf("  %10.1f ns/address\n", (double)ns / packets / msg_count / addr_count);
+
+  rfc5444_reader_remove_message_consumer(&_reader, &_addr_consumer);
+  rfc5444_reader_remove_message_consumer(&_reader, &_msg_consumer);
+  rfc5444_reader_cleanup(&_reader);
+  return 0;
+}
@@ -0,0 +1,213 @@
+
+/*
+ * The olsr.org Optimized Link-State Routing daemon version 2 (olsrd2)
+ * Copyright (c) 2004-2015, the olsr.org team - see HISTORY file
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in
+ *   the documentation and/or other materials provided with the
+ *   distribution.
+ * * Neither the name of olsr.org, olsrd nor the names of its
+ *   contributors may be used to endorse or promote products derived
+ *   from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Visit http://www.olsr.org for more information.
+ *
+ * If you find this software useful feel free to make a donation
+ * to the project. For more information see the website or contact
+ * the copyright holders.
+ *
+ */
+
+/**
+ * @file
+ *
+ * Measures the cost of walking through a large number of periodic
+ * timers with jitter and compares the cost of the two sources of
+ * random numbers for the jitter calculation.
+ *
+ * usage: benchmark_timer_jitter [<number of timers> [<runtime in s>]]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "common/common_types.h"
+#include "common/prng.h"
+#include "core/oonf_subsystem.h"
+#include "core/os_core.h"
+#include "subsystems/oonf_clock.h"
+#include "subsystems/oonf_timer.h"
+#include "subsystems/os_clock.h"
+
+static void _cb_timer(struct oonf_timer_instance *);
+
+static struct oonf_timer_class _timer_class = {
+  .name = "benchmark",
+  .callback = _cb_timer,
+  .periodic = true,
+};
+
+static uint64_t _fired;
+
+static void
+_cb_timer(struct oonf_timer_instance *timer __attribute__((unused))) {
+  _fired++;
+}
+
+/**
+ * @return monotonic timestamp in nanoseconds
+ */
+static uint64_t
+_get_ns(void) {
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+/**
+ * Initialize a subsystem linked into the benchmark
+ * @param name name of subsystem
+ * @return -1 if an error happened, 0 otherwise
+ */
+static int
+_init_subsystem(const char *name) {
+  struct oonf_subsystem *subsystem;
+
+  subsystem = oonf_subsystem_get(name);
+  if (subsystem == NULL) {
+    fprintf(stderr, "Subsystem %s not linked\n", name);
+    return -1;
+  }
+  if (subsystem->init != NULL && subsystem->init()) {
+    fprintf(stderr, "Could not initialize subsystem %s\n", name);
+    return -1;
+  }
+  return 0;
+}
+
+/**
+ * Measure the cost of a single call to both random number sources
+ * @param count number of calls
+ */
+static void
+_bench_random(size_t count) {
+  struct prng_state prng;
+  uint64_t start, os_ns, prng_ns;
+  uint32_t rnd, sum;
+  size_t i;
+
+  sum = 0;
+  start = _get_ns();
+  for (i=0; i<count; i++) {
+    if (os_core_get_random(&rnd, sizeof(rnd))) {
+      fprintf(stderr, "Could not get random data\n");
+      return;
+    }
+    sum += rnd;
+  }
+  os_ns = _get_ns() - start;
+
+  prng_seed(&prng, sum);
+  start = _get_ns();
+  for (i=0; i<count; i++) {
+    sum += prng_next32(&prng);
+  }
+  prng_ns = _get_ns() - start;
+
+  printf("random numbers: %"PRINTF_SIZE_T_SPECIFIER" calls (checksum %u)\n",
+      count, sum);
+  printf("  os_core_get_random: %8.1f ns/call\n", (double)os_ns / count);
+  printf("  prng_next32:        %8.1f ns/call\n", (double)prng_ns / count);
+}
+
+int
+main(int argc, char **argv) {
+  struct oonf_timer_instance *timers;
+  uint64_t start, walk_ns, walks, end, next;
+  size_t count, i;
+  int runtime;
+
+  count = argc > 1 ? (size_t)atoi(argv[1]) : 50000;
+  runtime = argc > 2 ? atoi(argv[2]) : 5;
+
+  if (_init_subsystem(OONF_OS_CLOCK_SUBSYSTEM)
+      || _init_subsystem(OONF_CLOCK_SUBSYSTEM)
+      || _init_subsystem(OONF_TIMER_SUBSYSTEM)) {
+    return 1;
+  }
+
+  timers = calloc(count, sizeof(*timers));
+  if (timers == NULL) {
+    fprintf(stderr, "Not enough memory for %"PRINTF_SIZE_T_SPECIFIER" timers\n",
+        count);
+    return 1;
+  }
+
+  oonf_timer_add(&_timer_class);
+
+  /* spread periodic timers with 1s interval over the first second */
+  for (i=0; i<count; i++) {
+    timers[i].class = &_timer_class;
+    timers[i].jitter_pct = 10;
+    oonf_timer_start_ext(&timers[i], 1 + (i * 1000) / count, 1000);
+  }
+
+  walk_ns = 0;
+  walks = 0;
+  end = oonf_clock_getNow() + runtime * 1000ull;
+  while (oonf_clock_getNow() < end) {
+    next = oonf_timer_getNextEvent();
+    if (next > oonf_clock_getNow()) {
+      usleep((next - oonf_clock_getNow()) * 1000);
+    }
+    if (oonf_clock_update()) {
+      fprintf(stderr, "Could not update clock\n");
+      return 1;
+    }
+
+    start = _get_ns();
+    oonf_timer_walk();
+    walk_ns += _get_ns() - start;
+    walks++;
+  }
+
+  printf("timer walk: %"PRINTF_SIZE_T_SPECIFIER" periodic timers, %d s\n",
+      count, runtime);
+  printf("  %"PRIu64" walks, %"PRIu64" timer events\n", walks, _fired);
+  printf("  %8.1f ns/event, %8.3f ms/walk\n",
+      _fired ? (double)walk_ns / _fired : 0.0,
+      walks ? (double)walk_ns / walks / 1000000.0 : 0.0);
+
+  _bench_random(count);
+
+  for (i=0; i<count; i++) {
+    oonf_timer_stop(&timers[i]);
+  }
+  oonf_timer_remove(&_timer_class);
+  free(timers);
+  return 0;
+}
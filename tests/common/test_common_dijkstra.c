@@ -0,0 +1,303 @@
+
+/*
+ * The olsr.org Optimized Link-State Routing daemon version 2 (olsrd2)
+ * Copyright (c) 2004-2015, the olsr.org team - see HISTORY file
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in
+ *   the documentation and/or other materials provided with the
+ *   distribution.
+ * * Neither the name of olsr.org, olsrd nor the names of its
+ *   contributors may be used to endorse or promote products derived
+ *   from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Visit http://www.olsr.org for more information.
+ *
+ * If you find this software useful feel free to make a donation
+ * to the project. For more information see the website or contact
+ * the copyright holders.
+ *
+ */
+
+
+/**
+ * @file
+ */
+
+#include <string.h>
+
+#include "common/common_types.h"
+#include "common/container_of.h"
+#include "common/dijkstra.h"
+#include "common/prng.h"
+
+#include "cunit/cunit.h"
+
+#define NODE_COUNT 40
+
+struct test_node {
+  struct dijkstra_node spf;
+  int index;
+};
+
+struct test_graph {
+  struct dijkstra_tree tree;
+  struct test_node nodes[NODE_COUNT];
+};
+
+/* edge costs, 0 if no edge, index 0 is the root */
+static uint32_t _edges[NODE_COUNT][NODE_COUNT];
+static bool _removed[NODE_COUNT];
+
+static struct test_graph _incremental, _reference;
+
+static struct dijkstra_node *
+_get_node(struct dijkstra_tree *tree, int i) {
+  struct test_graph *graph;
+
+  graph = container_of(tree, struct test_graph, tree);
+  return i == 0 ? &tree->root : &graph->nodes[i].spf;
+}
+
+static int
+_get_index(const struct dijkstra_node *node) {
+  const struct test_node *t;
+
+  if (node->parent == NULL && node->state == DIJKSTRA_DONE) {
+    /* only the root has no parent in the tree */
+    return 0;
+  }
+  t = container_of(node, struct test_node, spf);
+  return t->index;
+}
+
+static void
+_cb_expand(struct dijkstra_tree *tree, struct dijkstra_node *node) {
+  int i, from;
+
+  from = _get_index(node);
+  for (i=1; i<NODE_COUNT; i++) {
+    if (_edges[from][i] && !_removed[i]) {
+      dijkstra_relax(tree, node, _get_node(tree, i), _edges[from][i]);
+    }
+  }
+}
+
+static void
+_cb_expand_incoming(struct dijkstra_tree *tree, struct dijkstra_node *node) {
+  int i, to;
+
+  to = _get_index(node);
+  for (i=0; i<NODE_COUNT; i++) {
+    if (_edges[i][to] && !_removed[i]) {
+      dijkstra_relax(tree, _get_node(tree, i), node, _edges[i][to]);
+    }
+  }
+}
+
+static int
+_cb_compare(struct dijkstra_tree *tree __attribute__((unused)),
+    const struct dijkstra_node *n1, const struct dijkstra_node *n2) {
+  return _get_index(n1) - _get_index(n2);
+}
+
+static void
+_init_graph(struct test_graph *graph) {
+  int i;
+
+  dijkstra_init(&graph->tree);
+  graph->tree.expand = _cb_expand;
+  graph->tree.expand_incoming = _cb_expand_incoming;
+  graph->tree.compare = _cb_compare;
+
+  memset(graph->nodes, 0, sizeof(graph->nodes));
+  for (i=0; i<NODE_COUNT; i++) {
+    graph->nodes[i].index = i;
+  }
+}
+
+static void
+clear_elements(void) {
+  memset(_edges, 0, sizeof(_edges));
+  memset(_removed, 0, sizeof(_removed));
+
+  _init_graph(&_incremental);
+  _init_graph(&_reference);
+}
+
+static int
+_index_or_none(const struct dijkstra_node *node) {
+  return node == NULL ? -1 : _get_index(node);
+}
+
+static bool
+_compare_trees(void) {
+  struct dijkstra_node *inc, *ref;
+  int i;
+
+  _init_graph(&_reference);
+  dijkstra_calculate(&_reference.tree);
+
+  for (i=1; i<NODE_COUNT; i++) {
+    if (_removed[i]) {
+      continue;
+    }
+    inc = &_incremental.nodes[i].spf;
+    ref = &_reference.nodes[i].spf;
+
+    if (dijkstra_is_reached(inc) != dijkstra_is_reached(ref)) {
+      return false;
+    }
+    if (!dijkstra_is_reached(inc)) {
+      continue;
+    }
+    if (inc->cost != ref->cost || inc->hops != ref->hops
+        || _index_or_none(inc->parent) != _index_or_none(ref->parent)
+        || _index_or_none(inc->first_hop) != _index_or_none(ref->first_hop)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+static void
+test_dijkstra_tiebreak(void) {
+  struct dijkstra_node *n;
+
+  START_TEST();
+
+  /* two paths with the same cost and number of hops to node 4 */
+  _edges[0][2] = 10;
+  _edges[0][1] = 10;
+  _edges[2][4] = 5;
+  _edges[1][4] = 5;
+  _edges[0][3] = 15;
+  _edges[3][4] = 1;
+
+  dijkstra_calculate(&_incremental.tree);
+
+  n = &_incremental.nodes[4].spf;
+  CHECK_TRUE(dijkstra_is_reached(n), "node 4 reached");
+  CHECK_TRUE(n->cost == 15, "cost is %u", n->cost);
+  CHECK_TRUE(n->hops == 2, "hops is %u", n->hops);
+  CHECK_TRUE(_index_or_none(n->first_hop) == 1, "first hop is %d", _index_or_none(n->first_hop));
+  CHECK_TRUE(_index_or_none(n->parent) == 1, "parent is %d", _index_or_none(n->parent));
+  CHECK_TRUE(!dijkstra_is_reached(&_incremental.nodes[5].spf), "node 5 not reached");
+
+  /* remove the preferred path */
+  _edges[1][4] = 0;
+  dijkstra_edge_changed(&_incremental.tree, &_incremental.nodes[1].spf, n);
+  dijkstra_calculate(&_incremental.tree);
+
+  CHECK_TRUE(_incremental.tree.incremental, "calculation was incremental");
+  CHECK_TRUE(_index_or_none(n->first_hop) == 2, "first hop is %d", _index_or_none(n->first_hop));
+  CHECK_TRUE(_compare_trees(), "incremental tree differs from full calculation");
+
+  END_TEST();
+}
+
+static void
+test_dijkstra_random(void) {
+  struct prng_state prng;
+  int run, change, from, to, i;
+  bool success = true;
+
+  START_TEST();
+
+  prng_seed(&prng, 42);
+
+  for (run = 0; run < 20 && success; run++) {
+    clear_elements();
+
+    for (from = 0; from < NODE_COUNT; from++) {
+      for (to = 1; to < NODE_COUNT; to++) {
+        if (from != to && prng_next32(&prng) % 8 == 0) {
+          /* small costs to get lots of equal paths */
+          _edges[from][to] = 1 + prng_next32(&prng) % 4;
+        }
+      }
+    }
+    dijkstra_calculate(&_incremental.tree);
+    success = _compare_trees();
+
+    for (change = 0; change < 200 && success; change++) {
+      from = prng_next32(&prng) % NODE_COUNT;
+      to = 1 + prng_next32(&prng) % (NODE_COUNT - 1);
+
+      if (change % 25 == 24 && from != 0 && !_removed[from]) {
+        /* remove a node with all its edges */
+        _removed[from] = true;
+        for (i = 0; i < NODE_COUNT; i++) {
+          _edges[from][i] = 0;
+          _edges[i][from] = 0;
+        }
+        dijkstra_remove_node(&_incremental.tree, _get_node(&_incremental.tree, from));
+      }
+      else if (from != to && !_removed[from] && !_removed[to]) {
+        _edges[from][to] = prng_next32(&prng) % 2 ? 0 : 1 + prng_next32(&prng) % 4;
+        dijkstra_edge_changed(&_incremental.tree,
+            _get_node(&_incremental.tree, from), _get_node(&_incremental.tree, to));
+      }
+
+      if (change % 3 == 0) {
+        /* recalculate after multiple changes */
+        continue;
+      }
+
+      if (change % 5 == 0) {
+        /* change the graph during a running calculation */
+        dijkstra_start(&_incremental.tree);
+        dijkstra_step(&_incremental.tree, 2);
+
+        from = prng_next32(&prng) % NODE_COUNT;
+        to = 1 + prng_next32(&prng) % (NODE_COUNT - 1);
+        if (from != to && !_removed[from] && !_removed[to]) {
+          _edges[from][to] = 1 + prng_next32(&prng) % 4;
+          dijkstra_edge_changed(&_incremental.tree,
+              _get_node(&_incremental.tree, from), _get_node(&_incremental.tree, to));
+        }
+        while (!dijkstra_step(&_incremental.tree, 2)) {}
+      }
+      else {
+        dijkstra_calculate(&_incremental.tree);
+      }
+      success = _compare_trees();
+    }
+  }
+
+  CHECK_TRUE(success, "incremental tree differs from full calculation (run %d, change %d)", run, change);
+  CHECK_TRUE(_incremental.tree.full_runs == 1,
+      "full calculations: %"PRIu64, _incremental.tree.full_runs);
+
+  END_TEST();
+}
+
+int
+main(int argc __attribute__ ((unused)), char **argv __attribute__ ((unused))) {
+  BEGIN_TESTING(clear_elements);
+
+  test_dijkstra_tiebreak();
+  test_dijkstra_random();
+
+  return FINISH_TESTING();
+}
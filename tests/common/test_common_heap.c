@@ -0,0 +1,164 @@
+
+/*
+ * The olsr.org Optimized Link-State Routing daemon version 2 (olsrd2)
+ * Copyright (c) 2004-2015, the olsr.org team - see HISTORY file
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in
+ *   the documentation and/or other materials provided with the
+ *   distribution.
+ * * Neither the name of olsr.org, olsrd nor the names of its
+ *   contributors may be used to endorse or promote products derived
+ *   from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Visit http://www.olsr.org for more information.
+ *
+ * If you find this software useful feel free to make a donation
+ * to the project. For more information see the website or contact
+ * the copyright holders.
+ *
+ */
+
+
+/**
+ * @file
+ */
+
+#include <string.h>
+
+#include "common/common_types.h"
+#include "common/heap.h"
+#include "common/prng.h"
+
+#include "cunit/cunit.h"
+
+#define ELEMENT_COUNT 1000
+
+struct element {
+  struct heap_node node;
+  bool added;
+};
+
+static struct heap _heap;
+static struct element _elements[ELEMENT_COUNT];
+
+static void
+clear_elements(void) {
+  heap_init(&_heap);
+  memset(_elements, 0, sizeof(_elements));
+}
+
+static void
+test_heap_order(void) {
+  struct element *e;
+  uint64_t last;
+  int i;
+
+  START_TEST();
+
+  for (i=0; i<ELEMENT_COUNT; i++) {
+    heap_insert(&_heap, &_elements[i].node, (i * 7919) % ELEMENT_COUNT);
+  }
+  CHECK_TRUE(_heap.count == ELEMENT_COUNT, "count is %u", _heap.count);
+
+  last = 0;
+  for (i=0; i<ELEMENT_COUNT; i++) {
+    e = heap_min_element(&_heap, e, node);
+    if (e == NULL || e->node.key < last) {
+      break;
+    }
+    last = e->node.key;
+    heap_extract_min(&_heap);
+  }
+  CHECK_TRUE(i == ELEMENT_COUNT, "%d elements extracted in order", i);
+  CHECK_TRUE(heap_is_empty(&_heap), "heap is empty");
+  CHECK_TRUE(heap_extract_min(&_heap) == NULL, "no element in empty heap");
+
+  END_TEST();
+}
+
+static void
+test_heap_random(void) {
+  struct prng_state prng;
+  struct element *e;
+  uint64_t min;
+  uint32_t count;
+  int i, j, op;
+  bool success = true;
+
+  START_TEST();
+
+  prng_seed(&prng, 1);
+  count = 0;
+
+  for (i=0; i<100000 && success; i++) {
+    j = prng_next32(&prng) % ELEMENT_COUNT;
+    e = &_elements[j];
+    op = prng_next32(&prng) % 4;
+
+    if (!e->added) {
+      heap_insert(&_heap, &e->node, prng_next32(&prng) % 10000);
+      e->added = true;
+      count++;
+    }
+    else if (op == 0) {
+      heap_remove(&_heap, &e->node);
+      e->added = false;
+      count--;
+    }
+    else if (op == 1 && e->node.key > 0) {
+      heap_decrease_key(&_heap, &e->node, prng_next32(&prng) % e->node.key);
+    }
+    else if (op == 2) {
+      e = heap_min_element(&_heap, e, node);
+      heap_extract_min(&_heap);
+      e->added = false;
+      count--;
+    }
+
+    /* compare minimum with a linear search */
+    min = UINT64_MAX;
+    for (j=0; j<ELEMENT_COUNT; j++) {
+      if (_elements[j].added && _elements[j].node.key < min) {
+        min = _elements[j].node.key;
+      }
+    }
+
+    success = _heap.count == count
+        && (count == 0 ? heap_is_empty(&_heap) : heap_get_min(&_heap)->key == min);
+  }
+
+  CHECK_TRUE(success, "heap consistent after %d operations", i);
+
+  END_TEST();
+}
+
+int
+main(int argc __attribute__ ((unused)), char **argv __attribute__ ((unused))) {
+  BEGIN_TESTING(clear_elements);
+
+  test_heap_order();
+  test_heap_random();
+
+  return FINISH_TESTING();
+}
@@ -0,0 +1,125 @@
+
+/*
+ * The olsr.org Optimized Link-State Routing daemon version 2 (olsrd2)
+ * Copyright (c) 2004-2015, the olsr.org team - see HISTORY file
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in
+ *   the documentation and/or other materials provided with the
+ *   distribution.
+ * * Neither the name of olsr.org, olsrd nor the names of its
+ *   contributors may be used to endorse or promote products derived
+ *   from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Visit http://www.olsr.org for more information.
+ *
+ * If you find this software useful feel free to make a donation
+ * to the project. For more information see the website or contact
+ * the copyright holders.
+ *
+ */
+
+/**
+ * @file
+ */
+
+#include "common/common_types.h"
+#include "common/histogram.h"
+
+#include "cunit/cunit.h"
+
+static void
+clear_elements(void) {
+}
+
+static void
+test_histogram_buckets(void) {
+  struct histogram h;
+
+  START_TEST();
+
+  histogram_reset(&h);
+  histogram_add(&h, 0);
+  histogram_add(&h, 1023);
+  histogram_add(&h, 1024);
+  histogram_add(&h, 2047);
+  histogram_add(&h, 2048);
+  histogram_add(&h, UINT64_MAX);
+
+  CHECK_TRUE(h.count == 6, "count is %"PRIu64, h.count);
+  CHECK_TRUE(h.max == UINT64_MAX, "max is %"PRIu64, h.max);
+  CHECK_TRUE(h.bucket[0] == 2, "bucket 0 is %"PRIu64, h.bucket[0]);
+  CHECK_TRUE(h.bucket[1] == 2, "bucket 1 is %"PRIu64, h.bucket[1]);
+  CHECK_TRUE(h.bucket[2] == 1, "bucket 2 is %"PRIu64, h.bucket[2]);
+  CHECK_TRUE(h.bucket[HISTOGRAM_BUCKETS-1] == 1, "last bucket is %"PRIu64,
+      h.bucket[HISTOGRAM_BUCKETS-1]);
+
+  CHECK_TRUE(histogram_get_bucket_limit(0) == 1024, "limit of bucket 0");
+  CHECK_TRUE(histogram_get_bucket_limit(1) == 2048, "limit of bucket 1");
+  CHECK_TRUE(histogram_get_bucket_limit(HISTOGRAM_BUCKETS-1) == UINT64_MAX,
+      "limit of last bucket");
+
+  histogram_reset(&h);
+  CHECK_TRUE(h.count == 0 && h.max == 0 && h.bucket[0] == 0, "reset histogram");
+
+  END_TEST();
+}
+
+static void
+test_histogram_percentile(void) {
+  struct histogram h;
+  uint64_t p;
+  int i;
+
+  START_TEST();
+
+  histogram_reset(&h);
+  CHECK_TRUE(histogram_get_percentile(&h, 99) == 0, "empty histogram");
+
+  for (i=0; i<99; i++) {
+    histogram_add(&h, 500);
+  }
+  histogram_add(&h, 5000);
+
+  p = histogram_get_percentile(&h, 99);
+  CHECK_TRUE(p == 1024, "p99 is %"PRIu64, p);
+
+  p = histogram_get_percentile(&h, 100);
+  CHECK_TRUE(p == 5000, "p100 is %"PRIu64, p);
+
+  histogram_add(&h, 5000);
+  p = histogram_get_percentile(&h, 99);
+  CHECK_TRUE(p == 5000, "p99 is %"PRIu64, p);
+
+  END_TEST();
+}
+
+int
+main(int argc __attribute__ ((unused)), char **argv __attribute__ ((unused))) {
+  BEGIN_TESTING(clear_elements);
+
+  test_histogram_buckets();
+  test_histogram_percentile();
+
+  return FINISH_TESTING();
+}
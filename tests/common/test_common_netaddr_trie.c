@@ -0,0 +1,183 @@
+
+/*
+ * The olsr.org Optimized Link-State Routing daemon version 2 (olsrd2)
+ * Copyright (c) 2004-2015, the olsr.org team - see HISTORY file
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in
+ *   the documentation and/or other materials provided with the
+ *   distribution.
+ * * Neither the name of olsr.org, olsrd nor the names of its
+ *   contributors may be used to endorse or promote products derived
+ *   from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Visit http://www.olsr.org for more information.
+ *
+ * If you find this software useful feel free to make a donation
+ * to the project. For more information see the website or contact
+ * the copyright holders.
+ *
+ */
+
+
+/**
+ * @file
+ */
+
+#include <string.h>
+
+#include "common/common_types.h"
+#include "common/netaddr.h"
+#include "common/netaddr_trie.h"
+#include "common/prng.h"
+
+#include "cunit/cunit.h"
+
+#define PREFIX_COUNT 200
+
+static struct netaddr_trie _trie;
+static struct netaddr _prefixes[PREFIX_COUNT];
+static int _removed;
+
+static void
+clear_elements(void) {
+  netaddr_trie_init(&_trie, AF_INET);
+  _removed = 0;
+}
+
+static void
+_cb_remove(void *value __attribute__((unused))) {
+  _removed++;
+}
+
+static void
+_make_prefix(struct netaddr *prefix, uint32_t addr, uint8_t len) {
+  addr = htonl(addr);
+  netaddr_from_binary_prefix(prefix, &addr, 4, AF_INET, len);
+}
+
+static void
+test_trie_longest_match(void) {
+  struct netaddr p8, p16, p24, p32, addr;
+  struct netaddr_str nbuf;
+  char v8, v16, v24, v32;
+
+  START_TEST();
+
+  _make_prefix(&p8, 0x0a000000, 8);
+  _make_prefix(&p16, 0x0a010000, 16);
+  _make_prefix(&p24, 0x0a010200, 24);
+  _make_prefix(&p32, 0x0a010203, 32);
+
+  CHECK_TRUE(netaddr_trie_insert(&_trie, &p16, &v16) == 0, "insert 10.1.0.0/16");
+  CHECK_TRUE(netaddr_trie_insert(&_trie, &p8, &v8) == 0, "insert 10.0.0.0/8");
+  CHECK_TRUE(netaddr_trie_insert(&_trie, &p24, &v24) == 0, "insert 10.1.2.0/24");
+  CHECK_TRUE(netaddr_trie_insert(&_trie, &p32, &v32) == 0, "insert 10.1.2.3/32");
+  CHECK_TRUE(_trie.count == 4, "count is %u", _trie.count);
+
+  CHECK_TRUE(netaddr_trie_get(&_trie, &p16) == &v16, "get 10.1.0.0/16");
+  _make_prefix(&addr, 0x0a010000, 17);
+  CHECK_TRUE(netaddr_trie_get(&_trie, &addr) == NULL, "no exact match for %s",
+      netaddr_to_string(&nbuf, &addr));
+
+  _make_prefix(&addr, 0x0a010203, 32);
+  CHECK_TRUE(netaddr_trie_lookup(&_trie, &addr) == &v32, "10.1.2.3 matches /32");
+  _make_prefix(&addr, 0x0a010204, 32);
+  CHECK_TRUE(netaddr_trie_lookup(&_trie, &addr) == &v24, "10.1.2.4 matches /24");
+  _make_prefix(&addr, 0x0a01ff00, 24);
+  CHECK_TRUE(netaddr_trie_lookup(&_trie, &addr) == &v16, "10.1.255.0/24 matches /16");
+  _make_prefix(&addr, 0x0a010203, 8);
+  CHECK_TRUE(netaddr_trie_lookup(&_trie, &addr) == &v32,
+      "prefix length of %s is ignored", netaddr_to_string(&nbuf, &addr));
+  _make_prefix(&addr, 0x0b000000, 32);
+  CHECK_TRUE(netaddr_trie_lookup(&_trie, &addr) == NULL, "11.0.0.0 has no match");
+
+  CHECK_TRUE(netaddr_trie_insert(&_trie, &NETADDR_IPV6_ANY, &v8) != 0, "IPv6 prefix rejected");
+  CHECK_TRUE(netaddr_trie_lookup(&_trie, &NETADDR_IPV6_ANY) == NULL, "IPv6 address has no match");
+
+  _make_prefix(&addr, 0, 0);
+  CHECK_TRUE(netaddr_trie_insert(&_trie, &addr, &v8) == 0, "insert 0.0.0.0/0");
+  _make_prefix(&addr, 0x0b000000, 32);
+  CHECK_TRUE(netaddr_trie_lookup(&_trie, &addr) == &v8, "11.0.0.0 matches /0");
+
+  netaddr_trie_clear(&_trie, _cb_remove);
+  CHECK_TRUE(_removed == 5, "%d values removed", _removed);
+  CHECK_TRUE(_trie.count == 0, "trie is empty");
+  CHECK_TRUE(netaddr_trie_lookup(&_trie, &addr) == NULL, "no match after clear");
+
+  END_TEST();
+}
+
+static void
+test_trie_random(void) {
+  struct prng_state prng;
+  struct netaddr addr;
+  void *expected;
+  int i, j, best;
+  bool success = true;
+
+  START_TEST();
+
+  prng_seed(&prng, 1);
+
+  /* short random prefixes inside 10.0.0.0/8 to get many nested ones */
+  for (i=0; i<PREFIX_COUNT; i++) {
+    _make_prefix(&_prefixes[i], 0x0a000000 | (prng_next32(&prng) & 0x00ffffff),
+        8 + prng_next32(&prng) % 17);
+    if (netaddr_trie_get(&_trie, &_prefixes[i]) == NULL) {
+      netaddr_trie_insert(&_trie, &_prefixes[i], &_prefixes[i]);
+    }
+  }
+
+  for (i=0; i<100000 && success; i++) {
+    _make_prefix(&addr, 0x0a000000 | (prng_next32(&prng) & 0x00ffffff), 32);
+
+    /* compare with a linear search */
+    best = -1;
+    for (j=0; j<PREFIX_COUNT; j++) {
+      if (netaddr_is_in_subnet(&_prefixes[j], &addr)
+          && (best == -1 || netaddr_get_prefix_length(&_prefixes[j])
+              > netaddr_get_prefix_length(&_prefixes[best]))) {
+        best = j;
+      }
+    }
+    expected = best == -1 ? NULL : netaddr_trie_get(&_trie, &_prefixes[best]);
+    success = netaddr_trie_lookup(&_trie, &addr) == expected;
+  }
+
+  CHECK_TRUE(success, "trie matches linear search after %d lookups", i);
+
+  netaddr_trie_clear(&_trie, NULL);
+
+  END_TEST();
+}
+
+int
+main(int argc __attribute__ ((unused)), char **argv __attribute__ ((unused))) {
+  BEGIN_TESTING(clear_elements);
+
+  test_trie_longest_match();
+  test_trie_random();
+
+  return FINISH_TESTING();
+}
@@ -0,0 +1,136 @@
+
+/*
+ * The olsr.org Optimized Link-State Routing daemon version 2 (olsrd2)
+ * Copyright (c) 2004-2015, the olsr.org team - see HISTORY file
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in
+ *   the documentation and/or other materials provided with the
+ *   distribution.
+ * * Neither the name of olsr.org, olsrd nor the names of its
+ *   contributors may be used to endorse or promote products derived
+ *   from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Visit http://www.olsr.org for more information.
+ *
+ * If you find this software useful feel free to make a donation
+ * to the project. For more information see the website or contact
+ * the copyright holders.
+ *
+ */
+
+/**
+ * @file
+ */
+
+#include <string.h>
+
+#include "common/common_types.h"
+#include "common/prng.h"
+
+#include "cunit/cunit.h"
+
+static void
+clear_elements(void) {
+}
+
+static void
+test_prng_reference(void) {
+  static const uint64_t results[] = {
+    11520ull, 0ull, 1509978240ull,
+  };
+  struct prng_state state = { .s = { 1, 2, 3, 4 } };
+  uint64_t rnd;
+  size_t i;
+
+  START_TEST();
+
+  for (i=0; i<ARRAYSIZE(results); i++) {
+    rnd = prng_next(&state);
+    CHECK_TRUE(rnd == results[i], "prng_next() %"PRINTF_SIZE_T_SPECIFIER
+        " = %"PRIu64" should be %"PRIu64, i, rnd, results[i]);
+  }
+
+  END_TEST();
+}
+
+static void
+test_prng_seed(void) {
+  struct prng_state state;
+  uint64_t rnd;
+
+  START_TEST();
+
+  prng_seed(&state, 0);
+  CHECK_TRUE(state.s[0] == 0xe220a8397b1dcdafull,
+      "state after seed 0 is %"PRIx64, state.s[0]);
+
+  rnd = prng_next(&state);
+  CHECK_TRUE(rnd == 0x99ec5f36cb75f2b4ull,
+      "prng_next() after seed 0 = %"PRIx64, rnd);
+
+  prng_seed(&state, 42);
+  rnd = prng_next(&state);
+  CHECK_TRUE(rnd == 0x15780b2e0c2ec716ull,
+      "prng_next() after seed 42 = %"PRIx64, rnd);
+
+  END_TEST();
+}
+
+static void
+test_prng_bytes(void) {
+  struct prng_state state1, state2;
+  uint8_t buf[19];
+  uint64_t rnd;
+
+  START_TEST();
+
+  prng_seed(&state1, 42);
+  prng_seed(&state2, 42);
+
+  memset(buf, 0, sizeof(buf));
+  prng_get_bytes(&state1, buf, sizeof(buf));
+
+  rnd = prng_next(&state2);
+  CHECK_TRUE(memcmp(&buf[0], &rnd, sizeof(rnd)) == 0, "first block of bytes");
+  rnd = prng_next(&state2);
+  CHECK_TRUE(memcmp(&buf[8], &rnd, sizeof(rnd)) == 0, "second block of bytes");
+  rnd = prng_next(&state2);
+  CHECK_TRUE(memcmp(&buf[16], &rnd, 3) == 0, "partial block of bytes");
+
+  /* both generators must have consumed the same amount of data */
+  CHECK_TRUE(prng_next(&state1) == prng_next(&state2), "generators in sync");
+
+  END_TEST();
+}
+
+int
+main(int argc __attribute__ ((unused)), char **argv __attribute__ ((unused))) {
+  BEGIN_TESTING(clear_elements);
+
+  test_prng_reference();
+  test_prng_seed();
+  test_prng_bytes();
+
+  return FINISH_TESTING();
+}
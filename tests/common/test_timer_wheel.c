@@ -0,0 +1,320 @@
+
+/*
+ * The olsr.org Optimized Link-State Routing daemon version 2 (olsrd2)
+ * Copyright (c) 2004-2015, the olsr.org team - see HISTORY file
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in
+ *   the documentation and/or other materials provided with the
+ *   distribution.
+ * * Neither the name of olsr.org, olsrd nor the names of its
+ *   contributors may be used to endorse or promote products derived
+ *   from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Visit http://www.olsr.org for more information.
+ *
+ * If you find this software useful feel free to make a donation
+ * to the project. For more information see the website or contact
+ * the copyright holders.
+ *
+ */
+
+/**
+ * @file
+ *
+ * Tests the timer wheel backend of the timer subsystem with a
+ * simulated clock, including cascading between the wheel levels
+ * and timers beyond the range of the wheel.
+ */
+
+#include <string.h>
+
+#include "common/common_types.h"
+#include "common/isonumber.h"
+#include "common/prng.h"
+#include "core/oonf_subsystem.h"
+#include "subsystems/oonf_clock.h"
+#include "subsystems/oonf_timer.h"
+
+#include "cunit/cunit.h"
+
+#define TIMER_COUNT 1000
+
+/* range of the wheel: 4 levels of 64 slots */
+#define WHEEL_RANGE (64ull * 64 * 64 * 64 * OONF_TIMER_SLICE)
+
+struct test_timer {
+  struct oonf_timer_instance timer;
+
+  /* clock of the timer when it was started */
+  uint64_t expected;
+
+  /* time of the last callback */
+  uint64_t fired_at;
+
+  /* number of callbacks */
+  int fired;
+};
+
+static void _cb_timer(struct oonf_timer_instance *);
+
+static struct oonf_timer_class _timer_class = {
+  .name = "test",
+  .callback = _cb_timer,
+};
+
+static struct oonf_timer_class _periodic_class = {
+  .name = "test periodic",
+  .callback = _cb_timer,
+  .periodic = true,
+};
+
+static struct test_timer _timers[TIMER_COUNT];
+
+/* simulated clock */
+static uint64_t _now = 1000000;
+
+/* timer to stop during the callback of another timer */
+static struct test_timer *_stop_in_callback;
+
+/* true if the clock of fired timers went backwards */
+static bool _order_broken;
+static uint64_t _last_expected;
+
+/* lowest clock of the timers fired during the last walk */
+static uint64_t _walk_first;
+
+uint64_t
+oonf_clock_getNow(void) {
+  return _now;
+}
+
+const char *
+oonf_clock_toClockString(struct isonumber_str *buf, uint64_t clk __attribute__((unused))) {
+  buf->buf[0] = 0;
+  return buf->buf;
+}
+
+static void
+_cb_timer(struct oonf_timer_instance *ptr) {
+  struct test_timer *t;
+
+  t = container_of(ptr, struct test_timer, timer);
+  t->fired++;
+  t->fired_at = _now;
+
+  if (t->expected < _last_expected) {
+    _order_broken = true;
+  }
+  _last_expected = t->expected;
+  if (t->expected < _walk_first) {
+    _walk_first = t->expected;
+  }
+
+  if (_stop_in_callback) {
+    oonf_timer_stop(&_stop_in_callback->timer);
+    _stop_in_callback = NULL;
+  }
+}
+
+static void
+clear_elements(void) {
+  int i;
+
+  oonf_timer_remove(&_timer_class);
+  oonf_timer_remove(&_periodic_class);
+  oonf_timer_add(&_timer_class);
+  oonf_timer_add(&_periodic_class);
+
+  memset(_timers, 0, sizeof(_timers));
+  for (i=0; i<TIMER_COUNT; i++) {
+    _timers[i].timer.class = &_timer_class;
+  }
+
+  _stop_in_callback = NULL;
+  _order_broken = false;
+  _last_expected = 0;
+}
+
+static void
+_start_timer(struct test_timer *t, uint64_t rel_time) {
+  oonf_timer_start(&t->timer, rel_time);
+  t->expected = t->timer._clock;
+}
+
+/**
+ * Advance the simulated clock and walk through the timers
+ * @param end time to stop
+ * @param step time between two walks
+ */
+static void
+_run_until(uint64_t end, uint64_t step) {
+  while (_now < end) {
+    _now += step;
+    oonf_timer_walk();
+  }
+}
+
+static void
+test_timer_cascade(void) {
+  struct prng_state prng;
+  uint64_t max_delay, next_event, end;
+  int i, wrong, late, missed;
+  bool early_event = false;
+
+  START_TEST();
+
+  /* spread timers over the first three wheel levels */
+  max_delay = 64ull * 64 * 16 * OONF_TIMER_SLICE;
+  prng_seed(&prng, 1);
+  for (i=0; i<TIMER_COUNT; i++) {
+    _start_timer(&_timers[i], 1 + prng_next32(&prng) % max_delay);
+  }
+
+  end = _now + max_delay + 2 * OONF_TIMER_SLICE;
+  while (_now < end) {
+    next_event = oonf_timer_getNextEvent();
+    _walk_first = UINT64_MAX;
+    _now += OONF_TIMER_SLICE;
+    oonf_timer_walk();
+
+    /* timers must not fire before the reported next event */
+    if (_walk_first < next_event) {
+      early_event = true;
+    }
+  }
+
+  wrong = late = missed = 0;
+  for (i=0; i<TIMER_COUNT; i++) {
+    if (_timers[i].fired == 0) {
+      missed++;
+    }
+    else if (_timers[i].fired > 1 || _timers[i].fired_at < _timers[i].expected) {
+      wrong++;
+    }
+    else if (_timers[i].fired_at - _timers[i].expected >= OONF_TIMER_SLICE) {
+      late++;
+    }
+  }
+
+  CHECK_TRUE(missed == 0, "%d timers did not fire", missed);
+  CHECK_TRUE(wrong == 0, "%d timers fired early or twice", wrong);
+  CHECK_TRUE(late == 0, "%d timers fired late", late);
+  CHECK_TRUE(!_order_broken, "timers fired in order");
+  CHECK_TRUE(!early_event, "next event not later than the first timer");
+
+  END_TEST();
+}
+
+static void
+test_timer_overflow(void) {
+  struct test_timer *far, *near;
+  uint64_t start;
+
+  START_TEST();
+
+  far = &_timers[0];
+  near = &_timers[1];
+
+  /* beyond the range of the wheel and just inside of it */
+  start = _now;
+  _start_timer(far, WHEEL_RANGE + 7 * 3600000ull);
+  _start_timer(near, WHEEL_RANGE - 3600000ull);
+
+  CHECK_TRUE(oonf_timer_getNextEvent() <= near->expected,
+      "next event %"PRIu64" not later than %"PRIu64,
+      oonf_timer_getNextEvent(), near->expected);
+
+  /* jump through the time in steps of one hour */
+  _run_until(start + WHEEL_RANGE + 8 * 3600000ull, 3600000ull);
+
+  CHECK_TRUE(near->fired == 1, "near timer fired %d times", near->fired);
+  CHECK_TRUE(near->fired_at >= near->expected
+      && near->fired_at - near->expected < 3600000ull,
+      "near timer fired at %"PRIu64" (%"PRIu64")", near->fired_at, near->expected);
+
+  CHECK_TRUE(far->fired == 1, "far timer fired %d times", far->fired);
+  CHECK_TRUE(far->fired_at >= far->expected
+      && far->fired_at - far->expected < 3600000ull,
+      "far timer fired at %"PRIu64" (%"PRIu64")", far->fired_at, far->expected);
+  CHECK_TRUE(!_order_broken, "timers fired in order");
+
+  END_TEST();
+}
+
+static void
+test_timer_stop_in_callback(void) {
+  struct test_timer *first, *second, *third, *periodic;
+
+  START_TEST();
+
+  first = &_timers[0];
+  second = &_timers[1];
+  third = &_timers[2];
+  periodic = &_timers[3];
+  periodic->timer.class = &_periodic_class;
+
+  /* all timers share the same timeslice */
+  _start_timer(first, 5 * OONF_TIMER_SLICE);
+  _start_timer(second, 5 * OONF_TIMER_SLICE);
+  _start_timer(third, 5 * OONF_TIMER_SLICE);
+  CHECK_TRUE(first->expected == second->expected && second->expected == third->expected,
+      "timers in the same timeslice");
+
+  /* the first timer stops the second one in its callback */
+  _stop_in_callback = second;
+  _run_until(_now + 10 * OONF_TIMER_SLICE, OONF_TIMER_SLICE);
+
+  CHECK_TRUE(first->fired == 1, "first timer fired %d times", first->fired);
+  CHECK_TRUE(second->fired == 0, "stopped timer fired %d times", second->fired);
+  CHECK_TRUE(third->fired == 1, "third timer fired %d times", third->fired);
+  CHECK_TRUE(!oonf_timer_is_active(&second->timer), "stopped timer is not active");
+
+  /* a periodic timer stops itself in its callback */
+  oonf_timer_start_ext(&periodic->timer, OONF_TIMER_SLICE, OONF_TIMER_SLICE);
+  _stop_in_callback = periodic;
+  _run_until(_now + 10 * OONF_TIMER_SLICE, OONF_TIMER_SLICE);
+
+  CHECK_TRUE(periodic->fired == 1, "periodic timer fired %d times", periodic->fired);
+  CHECK_TRUE(!oonf_timer_is_active(&periodic->timer), "periodic timer is not active");
+
+  END_TEST();
+}
+
+int
+main(int argc __attribute__ ((unused)), char **argv __attribute__ ((unused))) {
+  struct oonf_subsystem *timer;
+
+  timer = oonf_subsystem_get(OONF_TIMER_SUBSYSTEM);
+  if (timer == NULL || timer->init()) {
+    return 1;
+  }
+
+  BEGIN_TESTING(clear_elements);
+
+  test_timer_cascade();
+  test_timer_overflow();
+  test_timer_stop_in_callback();
+
+  return FINISH_TESTING();
+}
@@ -0,0 +1,721 @@
+
+/*
+ * The olsr.org Optimized Link-State Routing daemon version 2 (olsrd2)
+ * Copyright (c) 2004-2015, the olsr.org team - see HISTORY file
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in
+ *   the documentation and/or other materials provided with the
+ *   distribution.
+ * * Neither the name of olsr.org, olsrd nor the names of its
+ *   contributors may be used to endorse or promote products derived
+ *   from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Visit http://www.olsr.org for more information.
+ *
+ * If you find this software useful feel free to make a donation
+ * to the project. For more information see the website or contact
+ * the copyright holders.
+ *
+ */
+
+/**
+ * @file
+ *
+ * Compares incremental olsrv2 routing calculations with full ones on
+ * random topologies. Like the olsrv2 routing benchmark, the TC
+ * database is changed through the olsrv2_tc API, NHDP, the originator
+ * set and the kernel routing layer are replaced by stubs. The clock
+ * is simulated, so each time slice runs a single step of the routing
+ * job and the topology can be changed during a calculation.
+ *
+ * test_olsrv2_routing_tcdb is the same test with the shortest path
+ * calculation walking the tc database instead of the compact graph.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "common/avl.h"
+#include "common/avl_comp.h"
+#include "common/common_types.h"
+#include "common/list.h"
+#include "common/netaddr.h"
+#include "common/prng.h"
+#include "core/oonf_subsystem.h"
+#include "subsystems/oonf_class.h"
+#include "subsystems/oonf_clock.h"
+#include "subsystems/oonf_job.h"
+#include "subsystems/oonf_timer.h"
+#include "subsystems/os_clock.h"
+#include "subsystems/os_routing.h"
+
+#include "nhdp/nhdp_db.h"
+#include "nhdp/nhdp_domain.h"
+#include "nhdp/nhdp_interfaces.h"
+
+#include "olsrv2/olsrv2.h"
+#include "olsrv2/olsrv2_lan.h"
+#include "olsrv2/olsrv2_originator.h"
+#include "olsrv2/olsrv2_routing.h"
+#include "olsrv2/olsrv2_tc.h"
+
+#include "cunit/cunit.h"
+
+/* number of tc nodes, node 0 is the local node */
+#define NODE_COUNT 60
+
+/* number of neighbors of the local node */
+#define NEIGH_COUNT 4
+
+/* links of each node to random other nodes */
+#define RANDOM_LINKS 2
+
+/* validity time of tc nodes, longer than the test */
+#define TEST_VTIME 3600000
+
+/* stubbed NHDP database with a single domain */
+static struct nhdp_domain _domain;
+static struct list_entity _domain_list;
+static struct list_entity _neigh_list;
+static struct avl_tree _neigh_originator_tree;
+static struct avl_tree _interface_address_tree;
+static struct nhdp_neighbor *_neighbors[NEIGH_COUNT];
+static struct nhdp_link _links[NEIGH_COUNT];
+
+static struct oonf_class _neighbor_class = {
+  .name = NHDP_CLASS_NEIGHBOR,
+  .size = sizeof(struct nhdp_neighbor),
+};
+
+static struct os_interface _os_if = {
+  .name = "test0",
+};
+static struct nhdp_interface _nhdp_if;
+
+/* stubbed olsrv2 originator and lan database */
+static struct netaddr _originator;
+static struct avl_tree _originator_tree;
+static struct avl_tree _lan_tree;
+
+/* random topology, each link is two tc edges */
+static struct netaddr _addresses[NODE_COUNT];
+static struct olsrv2_tc_node *_tc_nodes[NODE_COUNT];
+static uint32_t _link_src[NODE_COUNT * (RANDOM_LINKS + 1)];
+static uint32_t _link_dst[NODE_COUNT * (RANDOM_LINKS + 1)];
+static uint32_t _link_count;
+
+/* routes handed to the stubbed kernel and not yet acknowledged */
+static struct os_route *_kernel_routes[NODE_COUNT * 8];
+static size_t _kernel_count;
+
+/* number of routes handed to the stubbed kernel */
+static size_t _kernel_changes;
+
+/* simulated clock, advances with every call */
+static uint64_t _now_ns;
+
+/* copy of a routing entry */
+struct _route_copy {
+  struct os_route_parameter p;
+  struct netaddr next_originator;
+  struct netaddr last_originator;
+  uint32_t path_cost;
+  uint8_t path_hops;
+  bool set;
+};
+
+/* routing entries after the incremental and the full calculation */
+static struct _route_copy _incremental_routes[NODE_COUNT * 4];
+static struct _route_copy _full_routes[NODE_COUNT * 4];
+
+/*
+ * stubs for the clock, NHDP, olsrv2 and kernel functions used by the routing code
+ */
+
+int
+os_clock_linux_gettime64_ns(uint64_t *t64) {
+  /* longer than a job slice, so every slice runs a single step */
+  _now_ns += OONF_JOB_SLICE * 2000000ull;
+  *t64 = _now_ns;
+  return 0;
+}
+
+int
+os_clock_linux_gettime64(uint64_t *t64) {
+  *t64 = _now_ns / 1000000ull;
+  return 0;
+}
+
+struct list_entity *
+nhdp_db_get_neigh_list(void) {
+  return &_neigh_list;
+}
+
+struct avl_tree *
+nhdp_db_get_neigh_originator_tree(void) {
+  return &_neigh_originator_tree;
+}
+
+struct list_entity *
+nhdp_domain_get_list(void) {
+  return &_domain_list;
+}
+
+void
+nhdp_domain_listener_add(struct nhdp_domain_listener *listener __attribute__((unused))) {
+}
+
+void
+nhdp_domain_listener_remove(struct nhdp_domain_listener *listener __attribute__((unused))) {
+}
+
+struct avl_tree *
+nhdp_interface_get_address_tree(void) {
+  return &_interface_address_tree;
+}
+
+bool
+olsrv2_is_routable(struct netaddr *addr __attribute__((unused))) {
+  return true;
+}
+
+bool
+olsrv2_is_nhdp_routable(struct netaddr *addr __attribute__((unused))) {
+  return true;
+}
+
+struct avl_tree *
+olsrv2_lan_get_tree(void) {
+  return &_lan_tree;
+}
+
+const struct netaddr *
+olsrv2_originator_get(int af_type) {
+  return af_type == AF_INET ? &_originator : &NETADDR_UNSPEC;
+}
+
+bool
+olsrv2_originator_is_local(const struct netaddr *addr) {
+  return netaddr_cmp(addr, &_originator) == 0;
+}
+
+struct avl_tree *
+olsrv2_originator_get_tree(void) {
+  return &_originator_tree;
+}
+
+bool
+os_routing_linux_supports_nexthop_objects(void) {
+  return false;
+}
+
+int
+os_routing_linux_set(struct os_route *route,
+    bool set __attribute__((unused)), bool del_similar __attribute__((unused))) {
+  if (_kernel_count == ARRAYSIZE(_kernel_routes)) {
+    return -1;
+  }
+  _kernel_routes[_kernel_count++] = route;
+  _kernel_changes++;
+  return 0;
+}
+
+int
+os_routing_linux_query(struct os_route *route __attribute__((unused))) {
+  return -1;
+}
+
+void
+os_routing_linux_interrupt(struct os_route *route) {
+  size_t i;
+
+  for (i = 0; i < _kernel_count; i++) {
+    if (_kernel_routes[i] == route) {
+      _kernel_routes[i] = NULL;
+    }
+  }
+}
+
+bool
+os_routing_linux_is_in_progress(struct os_route *route) {
+  size_t i;
+
+  for (i = 0; i < _kernel_count; i++) {
+    if (_kernel_routes[i] == route) {
+      return true;
+    }
+  }
+  return false;
+}
+
+void
+os_routing_linux_init_wildcard_route(struct os_route *route) {
+  memset(route, 0, sizeof(*route));
+}
+
+int
+os_routing_linux_set_nexthop(struct os_nexthop *nexthop __attribute__((unused)),
+    bool set __attribute__((unused))) {
+  return -1;
+}
+
+void
+os_routing_linux_interrupt_nexthop(struct os_nexthop *nexthop __attribute__((unused))) {
+}
+
+/**
+ * Initialize a subsystem linked into the test
+ * @param name name of subsystem
+ */
+static void
+_init_subsystem(const char *name) {
+  struct oonf_subsystem *subsystem;
+
+  subsystem = oonf_subsystem_get(name);
+  if (subsystem != NULL && subsystem->init != NULL) {
+    subsystem->init();
+  }
+}
+
+/**
+ * @param src index of source node
+ * @param dst index of destination node
+ * @return tc edge between the nodes, NULL if not linked
+ */
+static struct olsrv2_tc_edge *
+_get_edge(uint32_t src, uint32_t dst) {
+  struct olsrv2_tc_edge *edge;
+
+  return avl_find_element(&_tc_nodes[src]->_edges, &_addresses[dst], edge, _node);
+}
+
+/**
+ * @param prng random number generator
+ * @return random link cost, with lots of equal cost paths
+ */
+static uint32_t
+_get_random_cost(struct prng_state *prng) {
+  return 1024 * (1 + prng_next32(prng) % 4);
+}
+
+/**
+ * Set the cost of a tc edge, including the NHDP neighbor
+ * if the edge starts at the local node
+ * @param src index of source node
+ * @param dst index of destination node
+ * @param cost new link cost
+ */
+static void
+_set_edge_cost(uint32_t src, uint32_t dst, uint32_t cost) {
+  struct nhdp_neighbor_domaindata *neighdata;
+
+  _get_edge(src, dst)->cost[_domain.index] = cost;
+  if (src == 0) {
+    neighdata = nhdp_domain_get_neighbordata(&_domain, _neighbors[dst - 1]);
+    neighdata->metric.in = cost;
+    neighdata->metric.out = cost;
+  }
+  olsrv2_tc_trigger_change(_tc_nodes[src]);
+}
+
+/**
+ * Add a link between two nodes, or the missing direction
+ * of a link that is only announced by one of them
+ * @param prng random number generator
+ * @param n1 index of first node
+ * @param n2 index of second node
+ */
+static void
+_add_link(struct prng_state *prng, uint32_t n1, uint32_t n2) {
+  struct olsrv2_tc_edge *edge;
+  int i;
+
+  if (n1 == n2) {
+    return;
+  }
+
+  if (_get_edge(n1, n2) != NULL) {
+    for (i = 0; i < 2; i++) {
+      edge = _get_edge(i == 0 ? n1 : n2, i == 0 ? n2 : n1);
+      if (edge->virtual) {
+        olsrv2_tc_edge_add(edge->src, &edge->dst->target.prefix.dst);
+        edge->cost[_domain.index] = _get_random_cost(prng);
+      }
+    }
+    return;
+  }
+
+  if (_link_count == ARRAYSIZE(_link_src)) {
+    return;
+  }
+
+  olsrv2_tc_edge_add(_tc_nodes[n1], &_addresses[n2]);
+  olsrv2_tc_edge_add(_tc_nodes[n2], &_addresses[n1]);
+  _get_edge(n1, n2)->cost[_domain.index] = _get_random_cost(prng);
+  _get_edge(n2, n1)->cost[_domain.index] = _get_random_cost(prng);
+
+  _link_src[_link_count] = n1;
+  _link_dst[_link_count] = n2;
+  _link_count++;
+}
+
+/**
+ * Remove one direction of a link. The link is removed from the tc
+ * database when the second direction is removed too.
+ * @param link index of link
+ * @param reverse true to remove the direction from destination to source
+ */
+static void
+_remove_edge(uint32_t link, bool reverse) {
+  struct olsrv2_tc_edge *edge;
+
+  edge = _get_edge(_link_src[link], _link_dst[link]);
+  if (reverse) {
+    edge = edge->inverse;
+  }
+  if (edge->virtual) {
+    edge = edge->inverse;
+  }
+
+  if (!edge->inverse->virtual) {
+    /* edge becomes virtual */
+    olsrv2_tc_edge_remove(edge);
+    return;
+  }
+
+  olsrv2_tc_edge_remove(edge);
+
+  _link_count--;
+  _link_src[link] = _link_src[_link_count];
+  _link_dst[link] = _link_dst[_link_count];
+}
+
+/**
+ * Create a random topology in the TC database and the NHDP
+ * neighbors of node 0, which is the local node. Every third
+ * node is a source-specific gateway for its attached network.
+ * @param prng random number generator
+ */
+static void
+_create_topology(struct prng_state *prng) {
+  struct nhdp_neighbor_domaindata *neighdata;
+  struct olsrv2_tc_attachment *attached;
+  struct nhdp_neighbor *neigh;
+  struct os_route_key key;
+  struct netaddr prefix;
+  uint32_t i, j, addr;
+
+  for (i = 0; i < NODE_COUNT; i++) {
+    /* originators are 10.0.0.0/8, attached networks 64.0.0.0/24 ... */
+    addr = htonl(0x0a000001 + i);
+    netaddr_from_binary(&_addresses[i], &addr, 4, AF_INET);
+    _tc_nodes[i] = olsrv2_tc_node_add(&_addresses[i], TEST_VTIME, 0);
+
+    addr = htonl(0x40000000 + (i << 8));
+    netaddr_from_binary_prefix(&prefix, &addr, 4, AF_INET, 24);
+    os_routing_init_sourcespec_prefix(&key, &prefix);
+
+    attached = olsrv2_tc_endpoint_add(_tc_nodes[i], &key, false);
+    attached->cost[_domain.index] = 1;
+
+    if (i % 3 != 1) {
+      continue;
+    }
+
+    os_routing_init_sourcespec_src_prefix(&key, &prefix);
+    attached = olsrv2_tc_endpoint_add(_tc_nodes[i], &key, false);
+    attached->cost[_domain.index] = 1;
+
+    _tc_nodes[i]->source_specific = true;
+    _tc_nodes[i]->ss_attached_networks[_domain.index] = true;
+  }
+  memcpy(&_originator, &_addresses[0], sizeof(_originator));
+
+  /* the local node is linked to the first nodes */
+  for (i = 1; i <= NEIGH_COUNT; i++) {
+    _add_link(prng, 0, i);
+  }
+  for (i = 1; i < NODE_COUNT; i++) {
+    for (j = 0; j < RANDOM_LINKS; j++) {
+      _add_link(prng, i, 1 + prng_next32(prng) % (NODE_COUNT - 1));
+    }
+  }
+
+  /* the links of the local node are its symmetric NHDP neighbors */
+  for (i = 0; i < NEIGH_COUNT; i++) {
+    neigh = oonf_class_malloc(&_neighbor_class);
+    _neighbors[i] = neigh;
+
+    memcpy(&neigh->originator, &_addresses[i + 1], sizeof(neigh->originator));
+    neigh->symmetric = 1;
+    list_init_head(&neigh->_links);
+    avl_init(&neigh->_neigh_addresses, avl_comp_netaddr, false);
+    avl_init(&neigh->_link_addresses, avl_comp_netaddr, false);
+
+    memcpy(&_links[i].if_addr, &neigh->originator, sizeof(_links[i].if_addr));
+    _links[i].local_if = &_nhdp_if;
+    _links[i].neigh = neigh;
+
+    neighdata = nhdp_domain_get_neighbordata(&_domain, neigh);
+    neighdata->best_link = &_links[i];
+    neighdata->best_link_ifindex = 1;
+
+    list_add_tail(&_neigh_list, &neigh->_global_node);
+    neigh->_originator_node.key = &neigh->originator;
+    avl_insert(&_neigh_originator_tree, &neigh->_originator_node);
+
+    _set_edge_cost(0, i + 1, _get_edge(0, i + 1)->cost[_domain.index]);
+  }
+}
+
+/**
+ * Apply a random change to the topology: a new link cost, a new
+ * or removed edge or a node changing its source-specific status.
+ * The links of the local node are never removed.
+ * @param prng random number generator
+ */
+static void
+_change_topology(struct prng_state *prng) {
+  struct olsrv2_tc_node *node;
+  uint32_t link, n1, n2;
+
+  switch (prng_next32(prng) % 4) {
+    case 0:
+      link = prng_next32(prng) % _link_count;
+      n1 = _link_src[link];
+      n2 = _link_dst[link];
+      if (prng_next32(prng) % 2) {
+        _set_edge_cost(n1, n2, _get_random_cost(prng));
+      }
+      else {
+        _set_edge_cost(n2, n1, _get_random_cost(prng));
+      }
+      break;
+    case 1:
+      link = prng_next32(prng) % _link_count;
+      if (_link_src[link] != 0) {
+        _remove_edge(link, prng_next32(prng) % 2);
+      }
+      break;
+    case 2:
+      n1 = 1 + prng_next32(prng) % (NODE_COUNT - 1);
+      n2 = 1 + prng_next32(prng) % (NODE_COUNT - 1);
+      _add_link(prng, n1, n2);
+      break;
+    default:
+      node = _tc_nodes[1 + prng_next32(prng) % (NODE_COUNT - 1)];
+      node->source_specific = !node->source_specific;
+      node->ss_attached_networks[_domain.index] = node->source_specific;
+      olsrv2_tc_trigger_change(node);
+      break;
+  }
+}
+
+/**
+ * Acknowledge all routes handed to the stubbed kernel
+ */
+static void
+_ack_kernel_routes(void) {
+  struct os_route *route;
+  size_t i;
+
+  for (i = 0; i < _kernel_count; i++) {
+    route = _kernel_routes[i];
+    _kernel_routes[i] = NULL;
+
+    if (route != NULL && route->cb_finished != NULL) {
+      route->cb_finished(route, 0);
+    }
+  }
+  _kernel_count = 0;
+}
+
+/**
+ * Run routing calculations until the routing job is finished
+ * and hand the kernel routes back as successfully set
+ */
+static void
+_run_routing(void) {
+  olsrv2_routing_force_update(true);
+  while (oonf_job_is_pending()) {
+    oonf_job_run_slice();
+  }
+  _ack_kernel_routes();
+}
+
+/**
+ * Copy the routing entries of the domain
+ * @param copy array for routing entries
+ * @param size size of the array
+ * @return number of routing entries
+ */
+static size_t
+_copy_routes(struct _route_copy *copy, size_t size) {
+  struct olsrv2_routing_entry *rtentry;
+  size_t count;
+
+  count = 0;
+  avl_for_each_element(olsrv2_routing_get_tree(&_domain), rtentry, _node) {
+    if (count == size) {
+      break;
+    }
+
+    memset(&copy[count], 0, sizeof(copy[count]));
+    memcpy(&copy[count].p, &rtentry->route.p, sizeof(copy[count].p));
+    memcpy(&copy[count].next_originator, &rtentry->next_originator,
+        sizeof(copy[count].next_originator));
+    memcpy(&copy[count].last_originator, &rtentry->last_originator,
+        sizeof(copy[count].last_originator));
+    copy[count].path_cost = rtentry->path_cost;
+    copy[count].path_hops = rtentry->path_hops;
+    copy[count].set = rtentry->set;
+    count++;
+  }
+  return count;
+}
+
+static void
+clear_elements(void) {
+}
+
+static void
+test_routing_random(void) {
+  struct os_route_str rbuf;
+  struct prng_state prng;
+  size_t incremental_count, full_count, changes, i;
+  int run, calc, change;
+  bool success = true;
+
+  START_TEST();
+
+  prng_seed(&prng, 42);
+  _create_topology(&prng);
+  _run_routing();
+
+  CHECK_TRUE(olsrv2_routing_get_tree(&_domain)->count > NODE_COUNT,
+      "routing entries: %u", olsrv2_routing_get_tree(&_domain)->count);
+
+  for (run = 0; run < 200 && success; run++) {
+    /* a few incremental calculations, some with changes during the job */
+    for (calc = 0; calc < 4; calc++) {
+      for (change = prng_next32(&prng) % 4; change >= 0; change--) {
+        _change_topology(&prng);
+      }
+
+      if (prng_next32(&prng) % 3 == 0) {
+        olsrv2_routing_force_update(true);
+        for (i = prng_next32(&prng) % 16; i > 0 && oonf_job_is_pending(); i--) {
+          oonf_job_run_slice();
+        }
+        _change_topology(&prng);
+      }
+      _run_routing();
+    }
+
+    /* finish changes of a calculation that was aborted by the last one */
+    _run_routing();
+    incremental_count = _copy_routes(_incremental_routes, ARRAYSIZE(_incremental_routes));
+
+    /* pretend the local originator set changed, which forces a full calculation */
+    _originator_tree.count ^= 1;
+    _kernel_changes = 0;
+    _run_routing();
+    changes = _kernel_changes;
+    full_count = _copy_routes(_full_routes, ARRAYSIZE(_full_routes));
+
+    /* find the first routing entry that differs */
+    for (i = 0; i < incremental_count && i < full_count; i++) {
+      if (memcmp(&_incremental_routes[i], &_full_routes[i], sizeof(_full_routes[i])) != 0) {
+        break;
+      }
+    }
+    success = i == incremental_count && i == full_count && changes == 0;
+
+    CHECK_TRUE(success, "run %d: %"PRINTF_SIZE_T_SPECIFIER" incremental and %"
+        PRINTF_SIZE_T_SPECIFIER" full routes, %"PRINTF_SIZE_T_SPECIFIER" kernel changes,"
+        " first difference: %s", run, incremental_count, full_count, changes,
+        i < incremental_count ? os_routing_to_string(&rbuf, &_incremental_routes[i].p) : "-");
+  }
+
+  END_TEST();
+}
+
+static void
+test_routing_multipath(void) {
+  struct olsrv2_routing_entry *rtentry;
+  size_t multipath;
+
+  START_TEST();
+
+  multipath = 0;
+  avl_for_each_element(olsrv2_routing_get_tree(&_domain), rtentry, _node) {
+    if (rtentry->route.p.nexthop_count > 1) {
+      multipath++;
+    }
+  }
+
+  /* otherwise the comparison did not cover multipath routes */
+  CHECK_TRUE(multipath > 0, "multipath routes: %"PRINTF_SIZE_T_SPECIFIER, multipath);
+
+  END_TEST();
+}
+
+int
+main(int argc __attribute__ ((unused)), char **argv __attribute__ ((unused))) {
+  struct olsrv2_routing_domain parameter;
+
+  _init_subsystem(OONF_CLOCK_SUBSYSTEM);
+  _init_subsystem(OONF_CLASS_SUBSYSTEM);
+  _init_subsystem(OONF_TIMER_SUBSYSTEM);
+  _init_subsystem(OONF_JOB_SUBSYSTEM);
+
+  list_init_head(&_domain_list);
+  list_init_head(&_neigh_list);
+  avl_init(&_neigh_originator_tree, avl_comp_netaddr, false);
+  avl_init(&_interface_address_tree, avl_comp_netaddr, false);
+  avl_init(&_originator_tree, avl_comp_netaddr, false);
+  avl_init(&_lan_tree, os_routing_avl_cmp_route_key, false);
+  _nhdp_if.os_if_listener.data = &_os_if;
+
+  list_add_tail(&_domain_list, &_domain._node);
+  oonf_class_add(&_neighbor_class);
+
+  olsrv2_tc_init();
+  olsrv2_routing_init();
+
+  memset(&parameter, 0, sizeof(parameter));
+  parameter.protocol = 100;
+  parameter.table = 254;
+  parameter.distance = 2;
+  parameter.multipath = 3;
+  olsrv2_routing_set_domain_parameter(&_domain, &parameter);
+
+  BEGIN_TESTING(clear_elements);
+
+  test_routing_random();
+  test_routing_multipath();
+
+  return FINISH_TESTING();
+}